@@ -28,6 +28,7 @@
 #include "tink/crypto_format.h"
 #include "tink/internal/monitoring_util.h"
 #include "tink/internal/registry_impl.h"
+#include "tink/internal/trial_decryption.h"
 #include "tink/internal/util.h"
 #include "tink/monitoring/monitoring.h"
 #include "tink/primitive_set.h"
@@ -63,8 +64,11 @@ class AeadSetWrapper : public Aead {
       std::unique_ptr<MonitoringClient> monitoring_decryption_client = nullptr)
       : aead_set_(std::move(aead_set)),
         monitoring_encryption_client_(std::move(monitoring_encryption_client)),
-        monitoring_decryption_client_(std::move(monitoring_decryption_client)) {
-  }
+        monitoring_decryption_client_(std::move(monitoring_decryption_client)),
+        timed_encryption_client_(internal::AsTimedMonitoringClient(
+            monitoring_encryption_client_.get())),
+        timed_decryption_client_(internal::AsTimedMonitoringClient(
+            monitoring_decryption_client_.get())) {}
 
   util::StatusOr<std::string> Encrypt(
       absl::string_view plaintext,
@@ -78,10 +82,14 @@ class AeadSetWrapper : public Aead {
   std::unique_ptr<PrimitiveSet<Aead>> aead_set_;
   std::unique_ptr<MonitoringClient> monitoring_encryption_client_;
   std::unique_ptr<MonitoringClient> monitoring_decryption_client_;
+  // Set if the corresponding monitoring client also records latencies.
+  TimedMonitoringClient* const timed_encryption_client_;
+  TimedMonitoringClient* const timed_decryption_client_;
 };
 
 util::StatusOr<std::string> AeadSetWrapper::Encrypt(
     absl::string_view plaintext, absl::string_view associated_data) const {
+  internal::MonitoringLatencyTimer timer(timed_encryption_client_);
   associated_data = internal::EnsureStringNonNull(associated_data);
   const Aead& primitive = aead_set_->get_primary()->get_primitive();
   util::StatusOr<std::string> ciphertext =
@@ -95,6 +103,7 @@ util::StatusOr<std::string> AeadSetWrapper::Encrypt(
   if (monitoring_encryption_client_ != nullptr) {
     monitoring_encryption_client_->Log(aead_set_->get_primary()->get_key_id(),
                                        plaintext.size());
+    timer.LogLatency(aead_set_->get_primary()->get_key_id(), plaintext.size());
   }
   const std::string& key_id = aead_set_->get_primary()->get_identifier();
   return absl::StrCat(key_id, *ciphertext);
@@ -102,9 +111,13 @@ util::StatusOr<std::string> AeadSetWrapper::Encrypt(
 
 util::StatusOr<std::string> AeadSetWrapper::Decrypt(
     absl::string_view ciphertext, absl::string_view associated_data) const {
+  internal::MonitoringLatencyTimer timer(timed_decryption_client_);
   // BoringSSL expects a non-null pointer for plaintext and associated_data,
   // regardless of whether the size is 0.
   associated_data = internal::EnsureStringNonNull(associated_data);
+  // Shared by all attempts, which only signal failures with a boolean so that
+  // trying many keys does not allocate a status per key.
+  std::string plaintext;
 
   if (ciphertext.length() > CryptoFormat::kNonRawPrefixSize) {
     absl::string_view key_id =
@@ -116,13 +129,14 @@ util::StatusOr<std::string> AeadSetWrapper::Decrypt(
           ciphertext.substr(CryptoFormat::kNonRawPrefixSize);
       for (const std::unique_ptr<PrimitiveSet<Aead>::Entry<Aead>>& aead_entry :
            **primitives) {
-        Aead& aead = aead_entry->get_primitive();
-        util::StatusOr<std::string> plaintext =
-            aead.Decrypt(raw_ciphertext, associated_data);
-        if (plaintext.ok()) {
+        util::StatusOr<Aead*> aead = aead_entry->get_or_create_primitive();
+        if (!aead.ok()) continue;
+        if (internal::TryDecrypt(**aead, raw_ciphertext, associated_data,
+                                 &plaintext)) {
           if (monitoring_decryption_client_ != nullptr) {
             monitoring_decryption_client_->Log(aead_entry->get_key_id(),
                                                raw_ciphertext.size());
+            timer.LogLatency(aead_entry->get_key_id(), raw_ciphertext.size());
           }
           return plaintext;
         }
@@ -131,26 +145,25 @@ util::StatusOr<std::string> AeadSetWrapper::Decrypt(
   }
 
   // No matching key succeeded with decryption, try all RAW keys.
-  util::StatusOr<const PrimitiveSet<Aead>::Primitives*> raw_primitives =
-      aead_set_->get_raw_primitives();
-  if (raw_primitives.ok()) {
-    for (const std::unique_ptr<PrimitiveSet<Aead>::Entry<Aead>>& aead_entry :
-         **raw_primitives) {
-      Aead& aead = aead_entry->get_primitive();
-      util::StatusOr<std::string> plaintext =
-          aead.Decrypt(ciphertext, associated_data);
-      if (plaintext.ok()) {
-        if (monitoring_decryption_client_ != nullptr) {
-          monitoring_decryption_client_->Log(aead_entry->get_key_id(),
-                                             ciphertext.size());
-        }
-        return plaintext;
+  for (const PrimitiveSet<Aead>::Entry<Aead>* aead_entry :
+       aead_set_->get_raw_primitives_in_trial_order()) {
+    util::StatusOr<Aead*> aead = aead_entry->get_or_create_primitive();
+    if (!aead.ok()) continue;
+    if (internal::TryDecrypt(**aead, ciphertext, associated_data,
+                             &plaintext)) {
+      aead_set_->RecordRawPrimitiveSuccess(aead_entry);
+      if (monitoring_decryption_client_ != nullptr) {
+        monitoring_decryption_client_->Log(aead_entry->get_key_id(),
+                                           ciphertext.size());
+        timer.LogLatency(aead_entry->get_key_id(), ciphertext.size());
       }
+      return plaintext;
     }
   }
   if (monitoring_decryption_client_ != nullptr) {
     monitoring_decryption_client_->LogFailure();
   }
+  // The error status is only built once all candidate keys failed.
   return util::Status(absl::StatusCode::kInvalidArgument, "decryption failed");
 }
 
@@ -340,6 +340,61 @@ TEST_F(AeadSetWrapperTestWithMonitoring,
       Not(IsOk()));
 }
 
+// Test that latencies of successful operations are reported to monitoring
+// clients which record them.
+TEST(AeadSetWrapperTest, WrapKeysetWithTimedMonitoringLogsLatencies) {
+  Registry::Reset();
+  auto monitoring_client_factory =
+      absl::make_unique<MockMonitoringClientFactory>();
+  auto encryption_monitoring_client =
+      absl::make_unique<StrictMock<MockTimedMonitoringClient>>();
+  MockTimedMonitoringClient* encryption_monitoring_client_ptr =
+      encryption_monitoring_client.get();
+  auto decryption_monitoring_client =
+      absl::make_unique<StrictMock<MockTimedMonitoringClient>>();
+  MockTimedMonitoringClient* decryption_monitoring_client_ptr =
+      decryption_monitoring_client.get();
+  EXPECT_CALL(*monitoring_client_factory, New(_))
+      .WillOnce(Return(ByMove(util::StatusOr<std::unique_ptr<MonitoringClient>>(
+          std::move(encryption_monitoring_client)))))
+      .WillOnce(Return(ByMove(util::StatusOr<std::unique_ptr<MonitoringClient>>(
+          std::move(decryption_monitoring_client)))));
+  ASSERT_THAT(
+      internal::RegistryImpl::GlobalInstance().RegisterMonitoringClientFactory(
+          std::move(monitoring_client_factory)),
+      IsOk());
+
+  KeysetInfo keyset_info = CreateTestKeysetInfo();
+  auto aead_primitive_set = absl::make_unique<PrimitiveSet<Aead>>(
+      absl::flat_hash_map<std::string, std::string>{{"key", "value"}});
+  util::StatusOr<PrimitiveSet<Aead>::Entry<Aead>*> primary =
+      aead_primitive_set->AddPrimitive(absl::make_unique<DummyAead>("aead"),
+                                       keyset_info.key_info(0));
+  ASSERT_THAT(primary, IsOk());
+  ASSERT_THAT(aead_primitive_set->set_primary(*primary), IsOk());
+  const uint32_t kPrimaryKeyId = keyset_info.key_info(0).key_id();
+
+  util::StatusOr<std::unique_ptr<Aead>> aead =
+      AeadWrapper().Wrap(std::move(aead_primitive_set));
+  ASSERT_THAT(aead, IsOk());
+
+  constexpr absl::string_view kPlaintext = "This is some plaintext!";
+  EXPECT_CALL(*encryption_monitoring_client_ptr,
+              Log(kPrimaryKeyId, kPlaintext.size()));
+  EXPECT_CALL(*encryption_monitoring_client_ptr,
+              LogLatency(kPrimaryKeyId, kPlaintext.size(), _));
+  util::StatusOr<std::string> ciphertext = (*aead)->Encrypt(kPlaintext, "");
+  ASSERT_THAT(ciphertext, IsOk());
+
+  EXPECT_CALL(*decryption_monitoring_client_ptr, Log(kPrimaryKeyId, _));
+  EXPECT_CALL(*decryption_monitoring_client_ptr,
+              LogLatency(kPrimaryKeyId, _, _));
+  EXPECT_THAT((*aead)->Decrypt(*ciphertext, ""), IsOk());
+
+  // Cleanup the registry to avoid mock leaks.
+  Registry::Reset();
+}
+
 }  // namespace
 }  // namespace tink
 }  // namespace crypto
@@ -0,0 +1,71 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+
+#include "tink/aead/async_aead_adapter.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "tink/aead.h"
+#include "tink/async_aead.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+
+// static
+util::StatusOr<std::unique_ptr<AsyncAead>> AsyncAeadAdapter::New(
+    std::shared_ptr<const Aead> aead, Executor* executor) {
+  if (aead == nullptr) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "aead must be non-null");
+  }
+  if (executor == nullptr) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "executor must be non-null");
+  }
+  std::unique_ptr<AsyncAead> adapter(
+      new AsyncAeadAdapter(std::move(aead), executor));
+  return std::move(adapter);
+}
+
+void AsyncAeadAdapter::EncryptAsync(absl::string_view plaintext,
+                                    absl::string_view associated_data,
+                                    DoneCallback done) const {
+  executor_->Schedule([aead = aead_, plaintext = std::string(plaintext),
+                       associated_data = std::string(associated_data),
+                       done = std::move(done)]() {
+    done(aead->Encrypt(plaintext, associated_data));
+  });
+}
+
+void AsyncAeadAdapter::DecryptAsync(absl::string_view ciphertext,
+                                    absl::string_view associated_data,
+                                    DoneCallback done) const {
+  executor_->Schedule([aead = aead_, ciphertext = std::string(ciphertext),
+                       associated_data = std::string(associated_data),
+                       done = std::move(done)]() {
+    done(aead->Decrypt(ciphertext, associated_data));
+  });
+}
+
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,74 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef TINK_AEAD_ASYNC_AEAD_ADAPTER_H_
+#define TINK_AEAD_ASYNC_AEAD_ADAPTER_H_
+
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "tink/aead.h"
+#include "tink/async_aead.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+
+// AsyncAead that runs the operations of a synchronous Aead on an executor
+// owned by the caller. Each operation occupies a thread of the executor while
+// it runs, so for remote primitives the asynchronous variants of the KMS
+// integrations should be preferred where they exist.
+class AsyncAeadAdapter : public AsyncAead {
+ public:
+  // Interface for running the operations, typically on a thread pool owned
+  // by the caller.
+  class Executor {
+   public:
+    // Runs `task`, either on another thread or before returning. Tasks may
+    // run concurrently.
+    virtual void Schedule(std::function<void()> task) = 0;
+
+    virtual ~Executor() = default;
+  };
+
+  // `executor` must outlive the returned object and the operations started
+  // on it.
+  static crypto::tink::util::StatusOr<std::unique_ptr<AsyncAead>> New(
+      std::shared_ptr<const Aead> aead, Executor* executor);
+
+  void EncryptAsync(absl::string_view plaintext,
+                    absl::string_view associated_data,
+                    DoneCallback done) const override;
+
+  void DecryptAsync(absl::string_view ciphertext,
+                    absl::string_view associated_data,
+                    DoneCallback done) const override;
+
+ private:
+  AsyncAeadAdapter(std::shared_ptr<const Aead> aead, Executor* executor)
+      : aead_(std::move(aead)), executor_(executor) {}
+
+  const std::shared_ptr<const Aead> aead_;
+  Executor* const executor_;
+};
+
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_AEAD_ASYNC_AEAD_ADAPTER_H_
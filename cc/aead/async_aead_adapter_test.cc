@@ -0,0 +1,149 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+
+#include "tink/aead/async_aead_adapter.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "tink/aead.h"
+#include "tink/async_aead.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "tink/util/test_matchers.h"
+#include "tink/util/test_util.h"
+
+namespace crypto {
+namespace tink {
+namespace {
+
+using ::crypto::tink::test::DummyAead;
+using ::crypto::tink::test::IsOk;
+using ::crypto::tink::test::IsOkAndHolds;
+using ::crypto::tink::test::StatusIs;
+using ::testing::Eq;
+using ::testing::Not;
+
+class InlineExecutor : public AsyncAeadAdapter::Executor {
+ public:
+  void Schedule(std::function<void()> task) override { task(); }
+};
+
+class ThreadExecutor : public AsyncAeadAdapter::Executor {
+ public:
+  void Schedule(std::function<void()> task) override {
+    absl::MutexLock lock(&mutex_);
+    threads_.emplace_back(std::move(task));
+  }
+
+  ~ThreadExecutor() override {
+    for (std::thread& thread : threads_) {
+      thread.join();
+    }
+  }
+
+ private:
+  absl::Mutex mutex_;
+  std::vector<std::thread> threads_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Waits for the result of an asynchronous operation.
+class Result {
+ public:
+  AsyncAead::DoneCallback Callback() {
+    return [this](util::StatusOr<std::string> result) {
+      result_ = std::move(result);
+      done_.Notify();
+    };
+  }
+
+  util::StatusOr<std::string> Wait() {
+    done_.WaitForNotification();
+    return result_;
+  }
+
+ private:
+  absl::Notification done_;
+  util::StatusOr<std::string> result_;
+};
+
+TEST(AsyncAeadAdapterTest, NewFailsWithNullArguments) {
+  InlineExecutor executor;
+  EXPECT_THAT(AsyncAeadAdapter::New(nullptr, &executor).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(
+      AsyncAeadAdapter::New(std::make_shared<DummyAead>("dummy"), nullptr)
+          .status(),
+      StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(AsyncAeadAdapterTest, EncryptDecryptInline) {
+  auto aead = std::make_shared<DummyAead>("dummy");
+  InlineExecutor executor;
+  util::StatusOr<std::unique_ptr<AsyncAead>> async_aead =
+      AsyncAeadAdapter::New(aead, &executor);
+  ASSERT_THAT(async_aead, IsOk());
+
+  Result encrypt_result;
+  (*async_aead)->EncryptAsync("plaintext", "aad", encrypt_result.Callback());
+  util::StatusOr<std::string> ciphertext = encrypt_result.Wait();
+  ASSERT_THAT(ciphertext, IsOk());
+  EXPECT_THAT(*ciphertext, Eq(*aead->Encrypt("plaintext", "aad")));
+
+  Result decrypt_result;
+  (*async_aead)->DecryptAsync(*ciphertext, "aad", decrypt_result.Callback());
+  EXPECT_THAT(decrypt_result.Wait(), IsOkAndHolds("plaintext"));
+
+  Result wrong_aad_result;
+  (*async_aead)->DecryptAsync(*ciphertext, "other aad",
+                              wrong_aad_result.Callback());
+  EXPECT_THAT(wrong_aad_result.Wait().status(), Not(IsOk()));
+}
+
+TEST(AsyncAeadAdapterTest, ArgumentsAreCopied) {
+  auto aead = std::make_shared<DummyAead>("dummy");
+  Result encrypt_result;
+  ThreadExecutor executor;
+  util::StatusOr<std::unique_ptr<AsyncAead>> async_aead =
+      AsyncAeadAdapter::New(aead, &executor);
+  ASSERT_THAT(async_aead, IsOk());
+
+  {
+    std::string plaintext = "plaintext";
+    std::string associated_data = "aad";
+    (*async_aead)->EncryptAsync(plaintext, associated_data,
+                                encrypt_result.Callback());
+    plaintext.assign("overwritten");
+    associated_data.assign("overwritten");
+  }
+  EXPECT_THAT(encrypt_result.Wait(),
+              IsOkAndHolds(*aead->Encrypt("plaintext", "aad")));
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
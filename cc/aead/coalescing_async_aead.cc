@@ -0,0 +1,239 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+
+#include "tink/aead/coalescing_async_aead.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/internal/endian.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "tink/async_aead.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+
+namespace {
+
+bool IsRetryable(absl::StatusCode code) {
+  return code == absl::StatusCode::kUnavailable ||
+         code == absl::StatusCode::kDeadlineExceeded;
+}
+
+// Returns a string that identifies a decryption. The ciphertext is prefixed
+// with its length, so that different pairs of inputs have different keys.
+std::string DecryptionKey(absl::string_view ciphertext,
+                          absl::string_view associated_data) {
+  char ciphertext_size[8];
+  absl::big_endian::Store64(ciphertext_size, ciphertext.size());
+  return absl::StrCat(absl::string_view(ciphertext_size, 8), ciphertext,
+                      associated_data);
+}
+
+}  // namespace
+
+class CoalescingAsyncAead::Coalescer
+    : public std::enable_shared_from_this<CoalescingAsyncAead::Coalescer> {
+ public:
+  Coalescer(std::shared_ptr<const AsyncAead> aead,
+            const CoalescingAsyncAeadOptions& options)
+      : aead_(std::move(aead)),
+        options_(options),
+        retry_budget_(options.max_retry_budget) {}
+
+  void Encrypt(absl::string_view plaintext, absl::string_view associated_data,
+               DoneCallback done);
+
+  void Decrypt(absl::string_view ciphertext,
+               absl::string_view associated_data, DoneCallback done);
+
+  int64_t num_coalesced_decryptions() const {
+    absl::MutexLock lock(&mutex_);
+    return num_coalesced_decryptions_;
+  }
+
+  int64_t num_retries() const {
+    absl::MutexLock lock(&mutex_);
+    return num_retries_;
+  }
+
+ private:
+  struct Operation {
+    bool encrypt;
+    std::string input;
+    std::string associated_data;
+    DoneCallback done;
+  };
+
+  // Starts `operation` on the wrapped primitive. `attempt` is 0 for the first
+  // attempt.
+  void Run(std::shared_ptr<const Operation> operation, int attempt);
+
+  // Returns true and takes from the retry budget if a retry is allowed.
+  bool TakeRetry();
+
+  // Passes `result` to all the callers waiting for the decryption `key`.
+  void FinishDecryption(const std::string& key,
+                        const util::StatusOr<std::string>& result);
+
+  const std::shared_ptr<const AsyncAead> aead_;
+  const CoalescingAsyncAeadOptions options_;
+
+  mutable absl::Mutex mutex_;
+  // Callbacks of the decryptions in flight, by DecryptionKey().
+  absl::flat_hash_map<std::string, std::vector<DoneCallback>>
+      pending_decryptions_ ABSL_GUARDED_BY(mutex_);
+  double retry_budget_ ABSL_GUARDED_BY(mutex_);
+  int64_t num_coalesced_decryptions_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t num_retries_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+void CoalescingAsyncAead::Coalescer::Encrypt(absl::string_view plaintext,
+                                             absl::string_view associated_data,
+                                             DoneCallback done) {
+  Run(std::make_shared<const Operation>(
+          Operation{/*encrypt=*/true, std::string(plaintext),
+                    std::string(associated_data), std::move(done)}),
+      /*attempt=*/0);
+}
+
+void CoalescingAsyncAead::Coalescer::Decrypt(
+    absl::string_view ciphertext, absl::string_view associated_data,
+    DoneCallback done) {
+  std::string key = DecryptionKey(ciphertext, associated_data);
+  {
+    absl::MutexLock lock(&mutex_);
+    std::vector<DoneCallback>& waiters = pending_decryptions_[key];
+    waiters.push_back(std::move(done));
+    if (waiters.size() > 1) {
+      ++num_coalesced_decryptions_;
+      return;
+    }
+  }
+  DoneCallback finish = [coalescer = shared_from_this(),
+                         key](util::StatusOr<std::string> result) {
+    coalescer->FinishDecryption(key, result);
+  };
+  Run(std::make_shared<const Operation>(
+          Operation{/*encrypt=*/false, std::string(ciphertext),
+                    std::string(associated_data), std::move(finish)}),
+      /*attempt=*/0);
+}
+
+void CoalescingAsyncAead::Coalescer::Run(
+    std::shared_ptr<const Operation> operation, int attempt) {
+  if (attempt == 0 && options_.max_retries > 0) {
+    absl::MutexLock lock(&mutex_);
+    retry_budget_ =
+        std::min<double>(retry_budget_ + options_.retry_budget_ratio,
+                         options_.max_retry_budget);
+  }
+  DoneCallback done = [coalescer = shared_from_this(), operation,
+                       attempt](util::StatusOr<std::string> result) {
+    if (!result.ok() && IsRetryable(result.status().code()) &&
+        attempt < coalescer->options_.max_retries && coalescer->TakeRetry()) {
+      coalescer->Run(operation, attempt + 1);
+      return;
+    }
+    operation->done(std::move(result));
+  };
+  if (operation->encrypt) {
+    aead_->EncryptAsync(operation->input, operation->associated_data,
+                        std::move(done));
+  } else {
+    aead_->DecryptAsync(operation->input, operation->associated_data,
+                        std::move(done));
+  }
+}
+
+bool CoalescingAsyncAead::Coalescer::TakeRetry() {
+  absl::MutexLock lock(&mutex_);
+  if (retry_budget_ < 1) return false;
+  retry_budget_ -= 1;
+  ++num_retries_;
+  return true;
+}
+
+void CoalescingAsyncAead::Coalescer::FinishDecryption(
+    const std::string& key, const util::StatusOr<std::string>& result) {
+  std::vector<DoneCallback> waiters;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = pending_decryptions_.find(key);
+    waiters = std::move(it->second);
+    pending_decryptions_.erase(it);
+  }
+  for (DoneCallback& waiter : waiters) {
+    waiter(result);
+  }
+}
+
+// static
+util::StatusOr<std::unique_ptr<CoalescingAsyncAead>> CoalescingAsyncAead::New(
+    std::shared_ptr<const AsyncAead> aead,
+    const CoalescingAsyncAeadOptions& options) {
+  if (aead == nullptr) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "aead must be non-null");
+  }
+  if (options.max_retries < 0) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "max_retries must not be negative");
+  }
+  if (options.retry_budget_ratio < 0 || options.max_retry_budget < 0) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "the retry budget must not be negative");
+  }
+  std::unique_ptr<CoalescingAsyncAead> coalescing_aead(
+      new CoalescingAsyncAead(
+          std::make_shared<Coalescer>(std::move(aead), options)));
+  return std::move(coalescing_aead);
+}
+
+void CoalescingAsyncAead::EncryptAsync(absl::string_view plaintext,
+                                       absl::string_view associated_data,
+                                       DoneCallback done) const {
+  coalescer_->Encrypt(plaintext, associated_data, std::move(done));
+}
+
+void CoalescingAsyncAead::DecryptAsync(absl::string_view ciphertext,
+                                       absl::string_view associated_data,
+                                       DoneCallback done) const {
+  coalescer_->Decrypt(ciphertext, associated_data, std::move(done));
+}
+
+int64_t CoalescingAsyncAead::num_coalesced_decryptions() const {
+  return coalescer_->num_coalesced_decryptions();
+}
+
+int64_t CoalescingAsyncAead::num_retries() const {
+  return coalescer_->num_retries();
+}
+
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,86 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef TINK_AEAD_COALESCING_ASYNC_AEAD_H_
+#define TINK_AEAD_COALESCING_ASYNC_AEAD_H_
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "tink/async_aead.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+
+struct CoalescingAsyncAeadOptions {
+  // Maximum number of times an operation that failed with UNAVAILABLE or
+  // DEADLINE_EXCEEDED is retried.
+  int max_retries = 0;
+  // Fraction of the operations that may be retried over time, so that
+  // retries do not multiply the load on a remote service that is already
+  // failing. Each operation adds this to the retry budget, and each retry
+  // takes 1 from it.
+  double retry_budget_ratio = 0.1;
+  // Initial and maximum value of the retry budget.
+  int max_retry_budget = 10;
+};
+
+// AsyncAead that reduces the number of operations on another AsyncAead,
+// typically one backed by a KMS key:
+//   - concurrent decryptions of the same ciphertext with the same associated
+//     data, as when many requests unwrap the same DEK at once, share a single
+//     operation on the wrapped primitive;
+//   - failed operations are retried within a budget, see
+//     CoalescingAsyncAeadOptions.
+// Encryptions are never coalesced, since each must return a new ciphertext.
+class CoalescingAsyncAead : public AsyncAead {
+ public:
+  static crypto::tink::util::StatusOr<std::unique_ptr<CoalescingAsyncAead>>
+  New(std::shared_ptr<const AsyncAead> aead,
+      const CoalescingAsyncAeadOptions& options);
+
+  void EncryptAsync(absl::string_view plaintext,
+                    absl::string_view associated_data,
+                    DoneCallback done) const override;
+
+  void DecryptAsync(absl::string_view ciphertext,
+                    absl::string_view associated_data,
+                    DoneCallback done) const override;
+
+  // Number of decryptions that joined a decryption already in flight.
+  int64_t num_coalesced_decryptions() const;
+  // Number of operations that were retried.
+  int64_t num_retries() const;
+
+ private:
+  // Shared with the callbacks of the operations in flight, so that they may
+  // complete after this object is destroyed.
+  class Coalescer;
+
+  explicit CoalescingAsyncAead(std::shared_ptr<Coalescer> coalescer)
+      : coalescer_(std::move(coalescer)) {}
+
+  const std::shared_ptr<Coalescer> coalescer_;
+};
+
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_AEAD_COALESCING_ASYNC_AEAD_H_
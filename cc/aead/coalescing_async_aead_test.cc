@@ -0,0 +1,321 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+
+#include "tink/aead/coalescing_async_aead.h"
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tink/aead.h"
+#include "tink/aead/async_aead_adapter.h"
+#include "tink/async_aead.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "tink/util/test_matchers.h"
+#include "tink/util/test_util.h"
+
+namespace crypto {
+namespace tink {
+namespace {
+
+using ::crypto::tink::test::DummyAead;
+using ::crypto::tink::test::IsOk;
+using ::crypto::tink::test::IsOkAndHolds;
+using ::crypto::tink::test::StatusIs;
+using ::testing::Eq;
+using ::testing::Gt;
+using ::testing::SizeIs;
+
+// AsyncAead whose operations complete when the test calls CompleteNext().
+// Not thread-safe.
+class FakeAsyncAead : public AsyncAead {
+ public:
+  void EncryptAsync(absl::string_view plaintext,
+                    absl::string_view associated_data,
+                    DoneCallback done) const override {
+    pending_.push_back(std::move(done));
+  }
+
+  void DecryptAsync(absl::string_view ciphertext,
+                    absl::string_view associated_data,
+                    DoneCallback done) const override {
+    pending_.push_back(std::move(done));
+  }
+
+  // Completes the oldest pending operation with `result`.
+  void CompleteNext(util::StatusOr<std::string> result) {
+    DoneCallback done = std::move(pending_.front());
+    pending_.pop_front();
+    done(std::move(result));
+  }
+
+  void CompleteNext(absl::string_view result) {
+    CompleteNext(util::StatusOr<std::string>(std::string(result)));
+  }
+
+  int num_pending() const { return pending_.size(); }
+
+ private:
+  mutable std::deque<DoneCallback> pending_;
+};
+
+// Collects the results of operations.
+class Results {
+ public:
+  AsyncAead::DoneCallback Callback() {
+    return [this](util::StatusOr<std::string> result) {
+      results_.push_back(std::move(result));
+    };
+  }
+
+  const std::vector<util::StatusOr<std::string>>& results() const {
+    return results_;
+  }
+
+ private:
+  std::vector<util::StatusOr<std::string>> results_;
+};
+
+TEST(CoalescingAsyncAeadTest, NewFailsWithInvalidArguments) {
+  auto aead = std::make_shared<FakeAsyncAead>();
+  EXPECT_THAT(
+      CoalescingAsyncAead::New(nullptr, CoalescingAsyncAeadOptions())
+          .status(),
+      StatusIs(absl::StatusCode::kInvalidArgument));
+  CoalescingAsyncAeadOptions options;
+  options.max_retries = -1;
+  EXPECT_THAT(CoalescingAsyncAead::New(aead, options).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  options = CoalescingAsyncAeadOptions();
+  options.retry_budget_ratio = -0.5;
+  EXPECT_THAT(CoalescingAsyncAead::New(aead, options).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(CoalescingAsyncAeadTest, CoalescesIdenticalDecryptions) {
+  auto aead = std::make_shared<FakeAsyncAead>();
+  util::StatusOr<std::unique_ptr<CoalescingAsyncAead>> coalescing_aead =
+      CoalescingAsyncAead::New(aead, CoalescingAsyncAeadOptions());
+  ASSERT_THAT(coalescing_aead, IsOk());
+
+  Results same;
+  Results other_ciphertext;
+  Results other_aad;
+  for (int i = 0; i < 3; ++i) {
+    (*coalescing_aead)->DecryptAsync("ciphertext", "aad", same.Callback());
+  }
+  (*coalescing_aead)
+      ->DecryptAsync("other ciphertext", "aad", other_ciphertext.Callback());
+  (*coalescing_aead)
+      ->DecryptAsync("ciphertext", "other aad", other_aad.Callback());
+  EXPECT_THAT(aead->num_pending(), Eq(3));
+  EXPECT_THAT((*coalescing_aead)->num_coalesced_decryptions(), Eq(2));
+
+  aead->CompleteNext("plaintext");
+  aead->CompleteNext("other plaintext");
+  aead->CompleteNext(
+      util::Status(absl::StatusCode::kInvalidArgument, "wrong aad"));
+  ASSERT_THAT(same.results(), SizeIs(3));
+  for (const util::StatusOr<std::string>& result : same.results()) {
+    EXPECT_THAT(result, IsOkAndHolds("plaintext"));
+  }
+  ASSERT_THAT(other_ciphertext.results(), SizeIs(1));
+  EXPECT_THAT(other_ciphertext.results()[0], IsOkAndHolds("other plaintext"));
+  ASSERT_THAT(other_aad.results(), SizeIs(1));
+  EXPECT_THAT(other_aad.results()[0].status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+
+  // Decryptions started after completion are not coalesced with it.
+  (*coalescing_aead)->DecryptAsync("ciphertext", "aad", same.Callback());
+  EXPECT_THAT(aead->num_pending(), Eq(1));
+}
+
+TEST(CoalescingAsyncAeadTest, DoesNotCoalesceEncryptions) {
+  auto aead = std::make_shared<FakeAsyncAead>();
+  util::StatusOr<std::unique_ptr<CoalescingAsyncAead>> coalescing_aead =
+      CoalescingAsyncAead::New(aead, CoalescingAsyncAeadOptions());
+  ASSERT_THAT(coalescing_aead, IsOk());
+
+  Results results;
+  (*coalescing_aead)->EncryptAsync("plaintext", "aad", results.Callback());
+  (*coalescing_aead)->EncryptAsync("plaintext", "aad", results.Callback());
+  EXPECT_THAT(aead->num_pending(), Eq(2));
+  aead->CompleteNext("ciphertext 1");
+  aead->CompleteNext("ciphertext 2");
+  ASSERT_THAT(results.results(), SizeIs(2));
+  EXPECT_THAT(results.results()[0], IsOkAndHolds("ciphertext 1"));
+  EXPECT_THAT(results.results()[1], IsOkAndHolds("ciphertext 2"));
+}
+
+TEST(CoalescingAsyncAeadTest, RetriesTransientErrors) {
+  auto aead = std::make_shared<FakeAsyncAead>();
+  CoalescingAsyncAeadOptions options;
+  options.max_retries = 2;
+  util::StatusOr<std::unique_ptr<CoalescingAsyncAead>> coalescing_aead =
+      CoalescingAsyncAead::New(aead, options);
+  ASSERT_THAT(coalescing_aead, IsOk());
+
+  Results results;
+  (*coalescing_aead)->EncryptAsync("plaintext", "aad", results.Callback());
+  aead->CompleteNext(util::Status(absl::StatusCode::kUnavailable, "down"));
+  aead->CompleteNext(
+      util::Status(absl::StatusCode::kDeadlineExceeded, "too slow"));
+  aead->CompleteNext("ciphertext");
+  ASSERT_THAT(results.results(), SizeIs(1));
+  EXPECT_THAT(results.results()[0], IsOkAndHolds("ciphertext"));
+  EXPECT_THAT((*coalescing_aead)->num_retries(), Eq(2));
+
+  // Other errors and errors after max_retries are returned.
+  (*coalescing_aead)->DecryptAsync("ciphertext", "aad", results.Callback());
+  aead->CompleteNext(util::Status(absl::StatusCode::kInvalidArgument, "bad"));
+  (*coalescing_aead)->DecryptAsync("ciphertext", "aad", results.Callback());
+  for (int i = 0; i < 3; ++i) {
+    aead->CompleteNext(util::Status(absl::StatusCode::kUnavailable, "down"));
+  }
+  EXPECT_THAT(aead->num_pending(), Eq(0));
+  ASSERT_THAT(results.results(), SizeIs(3));
+  EXPECT_THAT(results.results()[1].status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(results.results()[2].status(),
+              StatusIs(absl::StatusCode::kUnavailable));
+}
+
+TEST(CoalescingAsyncAeadTest, RetriesAreLimitedByBudget) {
+  auto aead = std::make_shared<FakeAsyncAead>();
+  CoalescingAsyncAeadOptions options;
+  options.max_retries = 1;
+  options.retry_budget_ratio = 0.5;
+  options.max_retry_budget = 2;
+  util::StatusOr<std::unique_ptr<CoalescingAsyncAead>> coalescing_aead =
+      CoalescingAsyncAead::New(aead, options);
+  ASSERT_THAT(coalescing_aead, IsOk());
+
+  // The budget starts at 2, and each operation adds 0.5 up to 2.
+  Results results;
+  for (int i = 0; i < 4; ++i) {
+    (*coalescing_aead)->EncryptAsync("plaintext", "aad", results.Callback());
+  }
+  for (int i = 0; i < 4; ++i) {
+    aead->CompleteNext(util::Status(absl::StatusCode::kUnavailable, "down"));
+  }
+  EXPECT_THAT((*coalescing_aead)->num_retries(), Eq(2));
+  EXPECT_THAT(aead->num_pending(), Eq(2));
+  EXPECT_THAT(results.results(), SizeIs(2));
+}
+
+// Aead with a fixed latency, standing in for a remote KMS.
+class SlowAead : public Aead {
+ public:
+  explicit SlowAead(absl::Duration latency)
+      : aead_("remote"), latency_(latency) {}
+
+  util::StatusOr<std::string> Encrypt(
+      absl::string_view plaintext,
+      absl::string_view associated_data) const override {
+    ++num_calls_;
+    absl::SleepFor(latency_);
+    return aead_.Encrypt(plaintext, associated_data);
+  }
+
+  util::StatusOr<std::string> Decrypt(
+      absl::string_view ciphertext,
+      absl::string_view associated_data) const override {
+    ++num_calls_;
+    absl::SleepFor(latency_);
+    return aead_.Decrypt(ciphertext, associated_data);
+  }
+
+  int num_calls() const { return num_calls_.load(); }
+
+ private:
+  DummyAead aead_;
+  absl::Duration latency_;
+  mutable std::atomic<int> num_calls_{0};
+};
+
+class ThreadExecutor : public AsyncAeadAdapter::Executor {
+ public:
+  void Schedule(std::function<void()> task) override {
+    absl::MutexLock lock(&mutex_);
+    threads_.emplace_back(std::move(task));
+  }
+
+  ~ThreadExecutor() override {
+    for (std::thread& thread : threads_) {
+      thread.join();
+    }
+  }
+
+ private:
+  absl::Mutex mutex_;
+  std::vector<std::thread> threads_ ABSL_GUARDED_BY(mutex_);
+};
+
+TEST(CoalescingAsyncAeadTest, ConcurrentUnwrapsWithLatency) {
+  auto remote_aead = std::make_shared<SlowAead>(absl::Milliseconds(100));
+  util::StatusOr<std::string> wrapped_key =
+      DummyAead("remote").Encrypt("key", "");
+  ASSERT_THAT(wrapped_key, IsOk());
+
+  constexpr int kNumDecryptions = 50;
+  std::vector<util::StatusOr<std::string>> results(kNumDecryptions);
+  absl::BlockingCounter done(kNumDecryptions);
+  ThreadExecutor executor;
+  util::StatusOr<std::unique_ptr<AsyncAead>> async_aead =
+      AsyncAeadAdapter::New(remote_aead, &executor);
+  ASSERT_THAT(async_aead, IsOk());
+  util::StatusOr<std::unique_ptr<CoalescingAsyncAead>> coalescing_aead =
+      CoalescingAsyncAead::New(*std::move(async_aead),
+                               CoalescingAsyncAeadOptions());
+  ASSERT_THAT(coalescing_aead, IsOk());
+
+  for (int i = 0; i < kNumDecryptions; ++i) {
+    (*coalescing_aead)
+        ->DecryptAsync(*wrapped_key, "",
+                       [&, i](util::StatusOr<std::string> result) {
+                         results[i] = std::move(result);
+                         done.DecrementCount();
+                       });
+  }
+  done.Wait();
+  for (const util::StatusOr<std::string>& result : results) {
+    EXPECT_THAT(result, IsOkAndHolds("key"));
+  }
+  EXPECT_THAT((*coalescing_aead)->num_coalesced_decryptions(), Gt(0));
+  EXPECT_THAT(remote_aead->num_calls() +
+                  (*coalescing_aead)->num_coalesced_decryptions(),
+              Eq(kNumDecryptions));
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
@@ -15,6 +15,7 @@
 ///////////////////////////////////////////////////////////////////////////////
 #include "tink/aead/internal/aead_from_zero_copy.h"
 
+#include <cstdint>
 #include <string>
 
 #include "absl/memory/memory.h"
@@ -54,6 +55,21 @@ util::StatusOr<std::string> AeadFromZeroCopy::Decrypt(
   return result;
 }
 
+bool AeadFromZeroCopy::TryDecrypt(absl::string_view ciphertext,
+                                  absl::string_view associated_data,
+                                  std::string* plaintext) const {
+  subtle::ResizeStringUninitialized(
+      plaintext, aead_->MaxDecryptionSize(ciphertext.size()));
+  int64_t bytes_written = 0;
+  if (!aead_->TryDecrypt(ciphertext, associated_data,
+                         absl::MakeSpan(&(*plaintext)[0], plaintext->size()),
+                         &bytes_written)) {
+    return false;
+  }
+  plaintext->resize(bytes_written);
+  return true;
+}
+
 }  // namespace internal
 }  // namespace tink
 }  // namespace crypto
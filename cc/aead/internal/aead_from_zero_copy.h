@@ -24,6 +24,7 @@
 #include "absl/status/status.h"
 #include "tink/aead.h"
 #include "tink/aead/internal/zero_copy_aead.h"
+#include "tink/internal/trial_decryption.h"
 #include "tink/subtle/subtle_util.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
@@ -37,7 +38,7 @@ namespace internal {
 //
 // std::unique_ptr<Aead> aead =
 //   std::make_unique<AeadFromZeroCopy>(std::move(zero_copy_aead));
-class AeadFromZeroCopy : public Aead {
+class AeadFromZeroCopy : public Aead, public TrialDecryptionAead {
  public:
   explicit AeadFromZeroCopy(std::unique_ptr<ZeroCopyAead> aead)
       : aead_(std::move(aead)) {}
@@ -50,6 +51,10 @@ class AeadFromZeroCopy : public Aead {
       absl::string_view ciphertext,
       absl::string_view associated_data) const override;
 
+  bool TryDecrypt(absl::string_view ciphertext,
+                  absl::string_view associated_data,
+                  std::string* plaintext) const override;
+
  private:
   const std::unique_ptr<ZeroCopyAead> aead_;
 };
@@ -29,6 +29,7 @@
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "openssl/crypto.h"
+#include "openssl/err.h"
 #include "openssl/evp.h"
 #include "tink/aead/internal/aead_util.h"
 #include "tink/internal/err_util.h"
@@ -47,6 +48,9 @@ ABSL_CONST_INIT const int kAesGcmTagSizeInBytes = 16;
 
 namespace {
 
+// Largest tag size of the supported AEADs.
+constexpr size_t kMaxTagSizeInBytes = 16;
+
 // Sets `iv` to the given `context`, as well as the "direction"
 // (encrypt/decrypt) based on `encryption`.
 util::Status SetIvAndDirection(EVP_CIPHER_CTX *context, absl::string_view iv,
@@ -188,8 +192,6 @@ class OpenSslOneShotAeadImpl : public SslOneShotAead {
                                   absl::string_view associated_data,
                                   absl::string_view iv,
                                   absl::Span<char> out) const override {
-    absl::string_view ad = internal::EnsureStringNonNull(associated_data);
-
     if (ciphertext.size() < tag_size_) {
       return util::Status(
           absl::StatusCode::kInvalidArgument,
@@ -218,13 +220,41 @@ class OpenSslOneShotAeadImpl : public SslOneShotAead {
                        associated_data.size()));
     }
 
+    int64_t plaintext_size = 0;
+    if (!Open(ciphertext, associated_data, iv, out, &plaintext_size)) {
+      return util::Status(absl::StatusCode::kInternal, "Authentication failed");
+    }
+    return plaintext_size;
+  }
+
+  bool TryDecrypt(absl::string_view ciphertext,
+                  absl::string_view associated_data, absl::string_view iv,
+                  absl::Span<char> out,
+                  int64_t *plaintext_size) const override {
+    if (ciphertext.size() < tag_size_ ||
+        out.size() < PlaintextSize(ciphertext.size()) ||
+        BuffersOverlap(ciphertext,
+                       absl::string_view(out.data(), out.size())) ||
+        associated_data.size() > std::numeric_limits<int>::max()) {
+      return false;
+    }
+    return Open(ciphertext, associated_data, iv, out, plaintext_size);
+  }
+
+ private:
+  // Decrypts and authenticates `ciphertext`, whose size as well as the size of
+  // `out` and `associated_data` have already been checked. Returns false if
+  // decryption fails, in which case `out` is zeroed.
+  bool Open(absl::string_view ciphertext, absl::string_view associated_data,
+            absl::string_view iv, absl::Span<char> out,
+            int64_t *plaintext_size) const {
+    absl::string_view ad = internal::EnsureStringNonNull(associated_data);
+
     internal::SslUniquePtr<EVP_CIPHER_CTX> context(EVP_CIPHER_CTX_new());
     EVP_CIPHER_CTX_copy(context.get(), context_.get());
 
-    util::Status res =
-        SetIvAndDirection(context.get(), iv, /*encryption=*/false);
-    if (!res.ok()) {
-      return res;
+    if (!SetIvAndDirection(context.get(), iv, /*encryption=*/false).ok()) {
+      return false;
     }
 
     int len = 0;
@@ -232,8 +262,7 @@ class OpenSslOneShotAeadImpl : public SslOneShotAead {
     if (EVP_DecryptUpdate(context.get(), /*out=*/nullptr, &len,
                           reinterpret_cast<const uint8_t *>(ad.data()),
                           ad.size()) <= 0) {
-      return util::Status(absl::StatusCode::kInternal,
-                          "Failed to set associated_data");
+      return false;
     }
 
     const int64_t raw_ciphertext_size = ciphertext.size() - tag_size_;
@@ -242,14 +271,17 @@ class OpenSslOneShotAeadImpl : public SslOneShotAead {
         ciphertext.substr(0, raw_ciphertext_size);
     // This copy is needed since EVP_CIPHER_CTX_ctrl requires a non-const
     // pointer even if the EVP_CTRL_AEAD_SET_TAG operation doesn't modify the
-    // content of the buffer.
-    auto tag = std::string(ciphertext.substr(raw_ciphertext_size, tag_size_));
+    // content of the buffer. A stack buffer avoids a heap allocation per call.
+    uint8_t tag[kMaxTagSizeInBytes];
+    if (tag_size_ > sizeof(tag)) {
+      return false;
+    }
+    std::copy_n(ciphertext.data() + raw_ciphertext_size, tag_size_, tag);
 
     // Set the tag.
     if (EVP_CIPHER_CTX_ctrl(context.get(), EVP_CTRL_AEAD_SET_TAG, tag_size_,
-                            reinterpret_cast<uint8_t *>(&tag[0])) <= 0) {
-      return util::Status(absl::StatusCode::kInternal,
-                          "Could not set authentication tag");
+                            tag) <= 0) {
+      return false;
     }
 
     // If out.empty() accessing the 0th element would result in an out of
@@ -258,7 +290,7 @@ class OpenSslOneShotAeadImpl : public SslOneShotAead {
     char buffer_if_size_is_zero = '\0';
     auto out_buffer = absl::Span<char>(&buffer_if_size_is_zero, /*length=*/1);
     if (!out.empty()) {
-      out_buffer = out.subspan(0, min_out_buff_size - tag_size_);
+      out_buffer = out.subspan(0, raw_ciphertext_size);
     }
 
     // Zero the plaintext buffer in case decryption fails before returning an
@@ -269,19 +301,18 @@ class OpenSslOneShotAeadImpl : public SslOneShotAead {
     util::StatusOr<int64_t> written_bytes =
         UpdateCipher(context.get(), raw_ciphertext, out_buffer);
     if (!written_bytes.ok()) {
-      return written_bytes.status();
+      return false;
     }
 
     if (!EVP_DecryptFinal_ex(context.get(), /*out=*/nullptr, &len)) {
-      return util::Status(absl::StatusCode::kInternal, "Authentication failed");
+      return false;
     }
 
     // Decryption executed correctly, cancel cleanup on the output buffer.
     std::move(output_eraser).Cancel();
-    return *written_bytes;
+    *plaintext_size = *written_bytes;
+    return true;
   }
-
- private:
   const internal::SslUniquePtr<EVP_CIPHER_CTX> context_;
   const size_t tag_size_;
 };
@@ -363,6 +394,45 @@ class BoringSslOneShotAeadImpl : public SslOneShotAead {
                        min_out_buff_size, " got ", out.size()));
     }
 
+    int64_t plaintext_size = 0;
+    if (!Open(ciphertext, associated_data, iv, out, &plaintext_size)) {
+      return util::Status(
+          absl::StatusCode::kInternal,
+          absl::StrCat("Authentication failed: ", internal::GetSslErrors()));
+    }
+    return plaintext_size;
+  }
+
+  bool TryDecrypt(absl::string_view ciphertext,
+                  absl::string_view associated_data, absl::string_view iv,
+                  absl::Span<char> out,
+                  int64_t *plaintext_size) const override {
+    if (BuffersOverlap(ciphertext,
+                       absl::string_view(out.data(), out.size())) ||
+        ciphertext.size() < tag_size_ ||
+        out.size() < PlaintextSize(ciphertext.size())) {
+      return false;
+    }
+    if (!Open(ciphertext, associated_data, iv, out, plaintext_size)) {
+      // The details of the failure are not needed.
+      ERR_clear_error();
+      return false;
+    }
+    return true;
+  }
+
+ private:
+  // Decrypts and authenticates `ciphertext`, whose size as well as the size of
+  // `out` have already been checked. Returns false if decryption fails.
+  bool Open(absl::string_view ciphertext, absl::string_view associated_data,
+            absl::string_view iv, absl::Span<char> out,
+            int64_t *plaintext_size) const {
+    // BoringSSL expects a non-null pointer for all inputs, regardless of
+    // whether their size is 0.
+    ciphertext = internal::EnsureStringNonNull(ciphertext);
+    associated_data = internal::EnsureStringNonNull(associated_data);
+    iv = internal::EnsureStringNonNull(iv);
+
     // If out.empty() accessing the 0th element would result in an out of
     // bound violation. This makes sure we pass a pointer to at least one byte
     // when calling into OpenSSL.
@@ -380,12 +450,10 @@ class BoringSslOneShotAeadImpl : public SslOneShotAead {
             ciphertext.size(),
             /*ad=*/reinterpret_cast<const uint8_t *>(associated_data.data()),
             /*ad_len=*/associated_data.size())) {
-      return util::Status(
-          absl::StatusCode::kInternal,
-          absl::StrCat("Authentication failed: ", internal::GetSslErrors()));
+      return false;
     }
-
-    return out_len;
+    *plaintext_size = out_len;
+    return true;
   }
 
   const internal::SslUniquePtr<EVP_AEAD_CTX> context_;
@@ -62,6 +62,20 @@ class SslOneShotAead {
                                           absl::string_view associated_data,
                                           absl::string_view iv,
                                           absl::Span<char> out) const = 0;
+
+  // Same as Decrypt(), but signals any failure only by returning false,
+  // without building an error status. On success, writes the size of the
+  // plaintext to `plaintext_size` and returns true.
+  virtual bool TryDecrypt(absl::string_view ciphertext,
+                          absl::string_view associated_data,
+                          absl::string_view iv, absl::Span<char> out,
+                          int64_t *plaintext_size) const {
+    util::StatusOr<int64_t> written_bytes =
+        Decrypt(ciphertext, associated_data, iv, out);
+    if (!written_bytes.ok()) return false;
+    *plaintext_size = *written_bytes;
+    return true;
+  }
 };
 
 // Create one-shot crypters for the supported algorithms.
@@ -72,6 +72,20 @@ class ZeroCopyAead {
   virtual crypto::tink::util::StatusOr<int64_t> Decrypt(
       absl::string_view ciphertext, absl::string_view associated_data,
       absl::Span<char> buffer) const = 0;
+
+  // Same as Decrypt(), but signals any failure only by returning false,
+  // without building an error status. On success, writes the size of the
+  // plaintext to `plaintext_size` and returns true.
+  virtual bool TryDecrypt(absl::string_view ciphertext,
+                          absl::string_view associated_data,
+                          absl::Span<char> buffer,
+                          int64_t* plaintext_size) const {
+    crypto::tink::util::StatusOr<int64_t> written_bytes =
+        Decrypt(ciphertext, associated_data, buffer);
+    if (!written_bytes.ok()) return false;
+    *plaintext_size = *written_bytes;
+    return true;
+  }
 };
 
 }  // namespace internal
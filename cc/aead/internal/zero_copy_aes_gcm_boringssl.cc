@@ -129,6 +129,21 @@ util::StatusOr<int64_t> ZeroCopyAesGcmBoringSsl::Decrypt(
   return aead_->Decrypt(ciphertext_and_tag, associated_data, iv, buffer);
 }
 
+bool ZeroCopyAesGcmBoringSsl::TryDecrypt(absl::string_view ciphertext,
+                                         absl::string_view associated_data,
+                                         absl::Span<char> buffer,
+                                         int64_t *plaintext_size) const {
+  if (ciphertext.size() < kIvSizeInBytes + kTagSizeInBytes ||
+      buffer.size() < MaxDecryptionSize(ciphertext.size()) ||
+      BuffersOverlap(ciphertext, absl::string_view(buffer.data(),
+                                                   buffer.size()))) {
+    return false;
+  }
+  return aead_->TryDecrypt(ciphertext.substr(kIvSizeInBytes), associated_data,
+                           ciphertext.substr(0, kIvSizeInBytes), buffer,
+                           plaintext_size);
+}
+
 }  // namespace internal
 }  // namespace tink
 }  // namespace crypto
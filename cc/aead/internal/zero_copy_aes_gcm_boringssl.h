@@ -48,6 +48,10 @@ class ZeroCopyAesGcmBoringSsl : public ZeroCopyAead {
       absl::string_view ciphertext, absl::string_view associated_data,
       absl::Span<char> buffer) const override;
 
+  bool TryDecrypt(absl::string_view ciphertext,
+                  absl::string_view associated_data, absl::Span<char> buffer,
+                  int64_t *plaintext_size) const override;
+
  private:
   explicit ZeroCopyAesGcmBoringSsl(std::unique_ptr<SslOneShotAead> aead)
       : aead_(std::move(aead)) {}
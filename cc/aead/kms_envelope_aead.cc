@@ -26,8 +26,13 @@
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "tink/aead.h"
+#include "tink/async_aead.h"
 #include "tink/registry.h"
+#include "tink/util/secret_data.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
 #include "proto/tink.pb.h"
@@ -54,25 +59,91 @@ std::string GetEnvelopeCiphertext(absl::string_view encrypted_dek,
                       encrypted_dek, encrypted_plaintext);
 }
 
+// Splits a ciphertext of KMS envelope encryption into its encrypted DEK and
+// encrypted plaintext.
+util::Status ParseEnvelopeCiphertext(absl::string_view ciphertext,
+                                     absl::string_view* encrypted_dek,
+                                     absl::string_view* encrypted_plaintext) {
+  if (ciphertext.size() < kEncryptedDekPrefixSize) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "ciphertext too short");
+  }
+  auto enc_dek_size = absl::big_endian::Load32(
+      reinterpret_cast<const uint8_t*>(ciphertext.data()));
+  if (enc_dek_size > ciphertext.size() - kEncryptedDekPrefixSize ||
+      enc_dek_size < 0) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "invalid ciphertext");
+  }
+  *encrypted_dek = ciphertext.substr(kEncryptedDekPrefixSize, enc_dek_size);
+  *encrypted_plaintext =
+      ciphertext.substr(kEncryptedDekPrefixSize + enc_dek_size);
+  return util::OkStatus();
+}
+
+// Returns the primitive of the DEK that the remote AEAD decrypted into
+// `dek_decrypt_result`, and clears the key bytes.
+util::StatusOr<std::unique_ptr<Aead>> GetDekPrimitive(
+    absl::string_view type_url,
+    util::StatusOr<std::string>* dek_decrypt_result) {
+  if (!dek_decrypt_result->ok()) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        absl::StrCat("invalid ciphertext: ",
+                                     dek_decrypt_result->status().message()));
+  }
+  google::crypto::tink::KeyData dek;
+  dek.set_type_url(std::string(type_url));
+  dek.set_value(dek_decrypt_result->value());
+  dek.set_key_material_type(google::crypto::tink::KeyData::SYMMETRIC);
+  auto aead_result = Registry::GetPrimitive<Aead>(dek);
+  util::SafeZeroString(dek.mutable_value());
+  util::SafeZeroString(&dek_decrypt_result->value());
+  return aead_result;
+}
+
 }  // namespace
 
 // static
 util::StatusOr<std::unique_ptr<Aead>> KmsEnvelopeAead::New(
     const google::crypto::tink::KeyTemplate& dek_template,
     std::unique_ptr<Aead> remote_aead) {
+  return New(dek_template, std::move(remote_aead),
+             KmsEnvelopeAeadCacheOptions());
+}
+
+// static
+util::StatusOr<std::unique_ptr<Aead>> KmsEnvelopeAead::New(
+    const google::crypto::tink::KeyTemplate& dek_template,
+    std::unique_ptr<Aead> remote_aead,
+    const KmsEnvelopeAeadCacheOptions& cache_options) {
   if (remote_aead == nullptr) {
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "remote_aead must be non-null");
   }
+  if (cache_options.max_messages_per_dek < 1 ||
+      cache_options.max_messages_per_dek > kMaxMessagesPerDek) {
+    return util::Status(
+        absl::StatusCode::kInvalidArgument,
+        absl::StrCat("max_messages_per_dek must be between 1 and ",
+                     kMaxMessagesPerDek));
+  }
+  if (cache_options.max_dek_lifetime < absl::ZeroDuration()) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "max_dek_lifetime must not be negative");
+  }
+  if (cache_options.max_decrypted_deks < 0) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "max_decrypted_deks must not be negative");
+  }
   auto km_result = Registry::get_key_manager<Aead>(dek_template.type_url());
   if (!km_result.ok()) return km_result.status();
   std::unique_ptr<Aead> envelope_aead(
-      new KmsEnvelopeAead(dek_template, std::move(remote_aead)));
+      new KmsEnvelopeAead(dek_template, std::move(remote_aead), cache_options));
   return std::move(envelope_aead);
 }
 
-util::StatusOr<std::string> KmsEnvelopeAead::Encrypt(
-    absl::string_view plaintext, absl::string_view associated_data) const {
+util::StatusOr<std::shared_ptr<const KmsEnvelopeAead::Dek>>
+KmsEnvelopeAead::NewDek() const {
   // Generate DEK.
   auto dek_result = Registry::NewKeyData(dek_template_);
   if (!dek_result.ok()) return dek_result.status();
@@ -83,55 +154,203 @@ util::StatusOr<std::string> KmsEnvelopeAead::Encrypt(
       remote_aead_->Encrypt(dek->value(), kEmptyAssociatedData);
   if (!dek_encrypt_result.ok()) return dek_encrypt_result.status();
 
-  // Encrypt plaintext using DEK.
   auto aead_result = Registry::GetPrimitive<Aead>(*dek);
+  util::SafeZeroString(dek->mutable_value());
   if (!aead_result.ok()) return aead_result.status();
-  auto aead = std::move(aead_result.value());
-  auto encrypt_result = aead->Encrypt(plaintext, associated_data);
+
+  auto new_dek = std::make_shared<Dek>();
+  new_dek->encrypted_dek = std::move(dek_encrypt_result.value());
+  new_dek->aead = std::move(aead_result.value());
+  return std::shared_ptr<const Dek>(std::move(new_dek));
+}
+
+util::StatusOr<std::shared_ptr<const KmsEnvelopeAead::Dek>>
+KmsEnvelopeAead::GetEncryptionDek() const {
+  KmsEnvelopeAeadCacheStats* stats = cache_options_.stats.get();
+  if (cache_options_.max_messages_per_dek > 1) {
+    absl::MutexLock lock(&mutex_);
+    if (encryption_dek_ != nullptr &&
+        encryption_dek_uses_ < cache_options_.max_messages_per_dek &&
+        absl::Now() < encryption_dek_expiry_) {
+      ++encryption_dek_uses_;
+      if (stats != nullptr) ++stats->encrypt_hits_;
+      return encryption_dek_;
+    }
+  }
+  if (stats != nullptr) ++stats->encrypt_misses_;
+
+  // The remote AEAD is called without holding the lock, so that concurrent
+  // calls that hit the cache are not blocked by it.
+  auto dek_result = NewDek();
+  if (!dek_result.ok()) return dek_result.status();
+  std::shared_ptr<const Dek> dek = std::move(dek_result.value());
+  if (cache_options_.max_messages_per_dek > 1 ||
+      cache_options_.max_decrypted_deks > 0) {
+    absl::MutexLock lock(&mutex_);
+    if (cache_options_.max_messages_per_dek > 1) {
+      encryption_dek_ = dek;
+      encryption_dek_uses_ = 1;
+      encryption_dek_expiry_ = absl::Now() + cache_options_.max_dek_lifetime;
+    }
+    if (cache_options_.max_decrypted_deks > 0) {
+      // Ciphertexts are often decrypted by the process that encrypted them.
+      CacheDecryptionAead(dek);
+    }
+  }
+  return std::move(dek);
+}
+
+void KmsEnvelopeAead::CacheDecryptionAead(
+    std::shared_ptr<const Dek> dek) const {
+  if (decryption_dek_index_.contains(dek->encrypted_dek)) return;
+  decryption_deks_.push_front(std::move(dek));
+  decryption_dek_index_[decryption_deks_.front()->encrypted_dek] =
+      decryption_deks_.begin();
+  while (decryption_deks_.size() >
+         static_cast<size_t>(cache_options_.max_decrypted_deks)) {
+    decryption_dek_index_.erase(decryption_deks_.back()->encrypted_dek);
+    decryption_deks_.pop_back();
+  }
+}
+
+util::StatusOr<std::shared_ptr<const Aead>> KmsEnvelopeAead::GetDecryptionAead(
+    absl::string_view encrypted_dek) const {
+  KmsEnvelopeAeadCacheStats* stats = cache_options_.stats.get();
+  if (cache_options_.max_decrypted_deks > 0) {
+    absl::MutexLock lock(&mutex_);
+    auto it = decryption_dek_index_.find(encrypted_dek);
+    if (it != decryption_dek_index_.end()) {
+      decryption_deks_.splice(decryption_deks_.begin(), decryption_deks_,
+                              it->second);
+      if (stats != nullptr) ++stats->decrypt_hits_;
+      const std::shared_ptr<const Dek>& dek = *it->second;
+      return std::shared_ptr<const Aead>(dek, dek->aead.get());
+    }
+  }
+  if (stats != nullptr) ++stats->decrypt_misses_;
+
+  // Decrypt the DEK with remote.
+  auto dek_decrypt_result =
+      remote_aead_->Decrypt(encrypted_dek, kEmptyAssociatedData);
+  auto aead_result =
+      GetDekPrimitive(dek_template_.type_url(), &dek_decrypt_result);
+  if (!aead_result.ok()) return aead_result.status();
+
+  auto new_dek = std::make_shared<Dek>();
+  new_dek->encrypted_dek = std::string(encrypted_dek);
+  new_dek->aead = std::move(aead_result.value());
+  if (cache_options_.max_decrypted_deks > 0) {
+    absl::MutexLock lock(&mutex_);
+    CacheDecryptionAead(new_dek);
+  }
+  const Aead* aead = new_dek->aead.get();
+  return std::shared_ptr<const Aead>(std::move(new_dek), aead);
+}
+
+util::StatusOr<std::string> KmsEnvelopeAead::Encrypt(
+    absl::string_view plaintext, absl::string_view associated_data) const {
+  auto dek_result = GetEncryptionDek();
+  if (!dek_result.ok()) return dek_result.status();
+  const Dek& dek = *dek_result.value();
+
+  // Encrypt plaintext using DEK.
+  auto encrypt_result = dek.aead->Encrypt(plaintext, associated_data);
   if (!encrypt_result.ok()) return encrypt_result.status();
 
   // Build and return ciphertext.
-  return GetEnvelopeCiphertext(dek_encrypt_result.value(),
-                               encrypt_result.value());
+  return GetEnvelopeCiphertext(dek.encrypted_dek, encrypt_result.value());
 }
 
 util::StatusOr<std::string> KmsEnvelopeAead::Decrypt(
     absl::string_view ciphertext, absl::string_view associated_data) const {
-  // Parse the ciphertext.
-  if (ciphertext.size() < kEncryptedDekPrefixSize) {
+  absl::string_view encrypted_dek;
+  absl::string_view encrypted_plaintext;
+  util::Status status =
+      ParseEnvelopeCiphertext(ciphertext, &encrypted_dek, &encrypted_plaintext);
+  if (!status.ok()) return status;
+  auto aead_result = GetDecryptionAead(encrypted_dek);
+  if (!aead_result.ok()) return aead_result.status();
+  return aead_result.value()->Decrypt(encrypted_plaintext, associated_data);
+}
+
+// static
+util::StatusOr<std::unique_ptr<AsyncAead>> KmsEnvelopeAsyncAead::New(
+    const google::crypto::tink::KeyTemplate& dek_template,
+    std::shared_ptr<const AsyncAead> remote_aead) {
+  if (remote_aead == nullptr) {
     return util::Status(absl::StatusCode::kInvalidArgument,
-                        "ciphertext too short");
+                        "remote_aead must be non-null");
   }
-  auto enc_dek_size = absl::big_endian::Load32(
-      reinterpret_cast<const uint8_t*>(ciphertext.data()));
-  if (enc_dek_size > ciphertext.size() - kEncryptedDekPrefixSize ||
-      enc_dek_size < 0) {
-    return util::Status(absl::StatusCode::kInvalidArgument,
-                        "invalid ciphertext");
+  auto km_result = Registry::get_key_manager<Aead>(dek_template.type_url());
+  if (!km_result.ok()) return km_result.status();
+  std::unique_ptr<AsyncAead> envelope_aead(
+      new KmsEnvelopeAsyncAead(dek_template, std::move(remote_aead)));
+  return std::move(envelope_aead);
+}
+
+void KmsEnvelopeAsyncAead::EncryptAsync(absl::string_view plaintext,
+                                        absl::string_view associated_data,
+                                        DoneCallback done) const {
+  // Generate DEK and encrypt plaintext using it.
+  auto dek_result = Registry::NewKeyData(dek_template_);
+  if (!dek_result.ok()) {
+    done(dek_result.status());
+    return;
   }
-  // Decrypt the DEK with remote.
-  auto dek_decrypt_result = remote_aead_->Decrypt(
-      ciphertext.substr(kEncryptedDekPrefixSize, enc_dek_size),
-      kEmptyAssociatedData);
-  if (!dek_decrypt_result.ok()) {
-    return util::Status(absl::StatusCode::kInvalidArgument,
-                        absl::StrCat("invalid ciphertext: ",
-                                     dek_decrypt_result.status().message()));
+  auto dek = std::move(dek_result.value());
+  auto aead_result = Registry::GetPrimitive<Aead>(*dek);
+  util::StatusOr<std::string> encrypt_result =
+      aead_result.ok()
+          ? aead_result.value()->Encrypt(plaintext, associated_data)
+          : util::StatusOr<std::string>(aead_result.status());
+  if (!encrypt_result.ok()) {
+    util::SafeZeroString(dek->mutable_value());
+    done(encrypt_result.status());
+    return;
   }
 
-  // Create AEAD from DEK.
-  google::crypto::tink::KeyData dek;
-  dek.set_type_url(dek_template_.type_url());
-  dek.set_value(dek_decrypt_result.value());
-  dek.set_key_material_type(google::crypto::tink::KeyData::SYMMETRIC);
+  // Wrap DEK key values with remote, and build the ciphertext once done.
+  remote_aead_->EncryptAsync(
+      dek->value(), kEmptyAssociatedData,
+      [encrypted_plaintext = std::move(encrypt_result.value()),
+       done = std::move(done)](util::StatusOr<std::string> encrypted_dek) {
+        if (!encrypted_dek.ok()) {
+          done(encrypted_dek.status());
+          return;
+        }
+        done(GetEnvelopeCiphertext(encrypted_dek.value(),
+                                   encrypted_plaintext));
+      });
+  util::SafeZeroString(dek->mutable_value());
+}
 
-  // Encrypt plaintext using DEK.
-  auto aead_result = Registry::GetPrimitive<Aead>(dek);
-  if (!aead_result.ok()) return aead_result.status();
-  auto aead = std::move(aead_result.value());
-  return aead->Decrypt(
-      ciphertext.substr(kEncryptedDekPrefixSize + enc_dek_size),
-      associated_data);
+void KmsEnvelopeAsyncAead::DecryptAsync(absl::string_view ciphertext,
+                                        absl::string_view associated_data,
+                                        DoneCallback done) const {
+  absl::string_view encrypted_dek;
+  absl::string_view encrypted_plaintext;
+  util::Status status =
+      ParseEnvelopeCiphertext(ciphertext, &encrypted_dek, &encrypted_plaintext);
+  if (!status.ok()) {
+    done(status);
+    return;
+  }
+
+  // Decrypt the DEK with remote, and the plaintext once done.
+  remote_aead_->DecryptAsync(
+      encrypted_dek, kEmptyAssociatedData,
+      [type_url = dek_template_.type_url(),
+       encrypted_plaintext = std::string(encrypted_plaintext),
+       associated_data = std::string(associated_data),
+       done = std::move(done)](util::StatusOr<std::string> dek_decrypt_result) {
+        auto aead_result = GetDekPrimitive(type_url, &dek_decrypt_result);
+        if (!aead_result.ok()) {
+          done(aead_result.status());
+          return;
+        }
+        done(aead_result.value()->Decrypt(encrypted_plaintext,
+                                          associated_data));
+      });
 }
 
 }  // namespace tink
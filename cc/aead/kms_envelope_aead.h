@@ -17,12 +17,20 @@
 #ifndef TINK_AEAD_KMS_ENVELOPE_AEAD_H_
 #define TINK_AEAD_KMS_ENVELOPE_AEAD_H_
 
+#include <atomic>
+#include <cstdint>
+#include <list>
 #include <memory>
 #include <string>
 #include <utility>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "tink/aead.h"
+#include "tink/async_aead.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
 #include "proto/tink.pb.h"
@@ -44,12 +52,66 @@ namespace tink {
 //  - Encrypted DEK: variable length that is equal to the value
 //    specified in the last 4 bytes.
 //  - AEAD payload: variable length.
+//
+// By default every Encrypt() generates a new DEK and every call to Encrypt()
+// or Decrypt() makes a call to the remote AEAD. KmsEnvelopeAeadCacheOptions
+// enables reusing DEKs instead.
+
+// Hit and miss counters of the DEK caches of a KmsEnvelopeAead. This class is
+// thread-safe.
+class KmsEnvelopeAeadCacheStats {
+ public:
+  // Number of Encrypt() calls that reused the current DEK.
+  int64_t encrypt_hits() const { return encrypt_hits_.load(); }
+  // Number of Encrypt() calls that generated and wrapped a new DEK.
+  int64_t encrypt_misses() const { return encrypt_misses_.load(); }
+  // Number of Decrypt() calls that found the unwrapped DEK in the cache.
+  int64_t decrypt_hits() const { return decrypt_hits_.load(); }
+  // Number of Decrypt() calls that unwrapped the DEK with the remote AEAD.
+  int64_t decrypt_misses() const { return decrypt_misses_.load(); }
+
+ private:
+  friend class KmsEnvelopeAead;
+
+  std::atomic<int64_t> encrypt_hits_{0};
+  std::atomic<int64_t> encrypt_misses_{0};
+  std::atomic<int64_t> decrypt_hits_{0};
+  std::atomic<int64_t> decrypt_misses_{0};
+};
+
+struct KmsEnvelopeAeadCacheOptions {
+  // Maximum number of messages that Encrypt() encrypts with the same DEK,
+  // between 1 (a new DEK for every message) and kMaxMessagesPerDek.
+  int64_t max_messages_per_dek = 1;
+  // Maximum time during which Encrypt() uses the same DEK.
+  absl::Duration max_dek_lifetime = absl::Minutes(10);
+  // Maximum number of unwrapped DEKs that Decrypt() keeps, keyed by their
+  // encrypted value. The least recently used DEK is evicted first. 0 disables
+  // the cache.
+  int max_decrypted_deks = 0;
+  // If not null, receives the hit and miss counts of both caches.
+  std::shared_ptr<KmsEnvelopeAeadCacheStats> stats;
+};
+
 class KmsEnvelopeAead : public Aead {
  public:
+  // Upper bound of KmsEnvelopeAeadCacheOptions::max_messages_per_dek. DEK
+  // templates may use random 96-bit nonces, with which a key must not encrypt
+  // more than 2^32 messages.
+  static constexpr int64_t kMaxMessagesPerDek = int64_t{1} << 32;
+
   static crypto::tink::util::StatusOr<std::unique_ptr<Aead>> New(
       const google::crypto::tink::KeyTemplate& dek_template,
       std::unique_ptr<Aead> remote_aead);
 
+  // Same as above, but reuses DEKs as specified by `cache_options`. Only the
+  // DEK primitives are kept; the key bytes are cleared once the primitive
+  // has been created.
+  static crypto::tink::util::StatusOr<std::unique_ptr<Aead>> New(
+      const google::crypto::tink::KeyTemplate& dek_template,
+      std::unique_ptr<Aead> remote_aead,
+      const KmsEnvelopeAeadCacheOptions& cache_options);
+
   crypto::tink::util::StatusOr<std::string> Encrypt(
       absl::string_view plaintext,
       absl::string_view associated_data) const override;
@@ -61,12 +123,81 @@ class KmsEnvelopeAead : public Aead {
   ~KmsEnvelopeAead() override = default;
 
  private:
+  // A DEK primitive, with the encrypted DEK.
+  struct Dek {
+    std::string encrypted_dek;
+    std::unique_ptr<Aead> aead;
+  };
+
   KmsEnvelopeAead(const google::crypto::tink::KeyTemplate& dek_template,
-                  std::unique_ptr<Aead> remote_aead) :
-      dek_template_(dek_template), remote_aead_(std::move(remote_aead)) {}
+                  std::unique_ptr<Aead> remote_aead,
+                  const KmsEnvelopeAeadCacheOptions& cache_options)
+      : dek_template_(dek_template),
+        remote_aead_(std::move(remote_aead)),
+        cache_options_(cache_options) {}
+
+  // Generates a new DEK and wraps it with the remote AEAD.
+  crypto::tink::util::StatusOr<std::shared_ptr<const Dek>> NewDek() const;
+
+  // Returns the DEK that Encrypt() should use.
+  crypto::tink::util::StatusOr<std::shared_ptr<const Dek>> GetEncryptionDek()
+      const;
+
+  // Returns the primitive of `encrypted_dek`, unwrapping it with the remote
+  // AEAD if it is not cached.
+  crypto::tink::util::StatusOr<std::shared_ptr<const Aead>> GetDecryptionAead(
+      absl::string_view encrypted_dek) const;
+
+  // Adds `dek` to the decryption cache, evicting the least recently used
+  // DEKs if it is full.
+  void CacheDecryptionAead(std::shared_ptr<const Dek> dek) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
   google::crypto::tink::KeyTemplate dek_template_;
   std::unique_ptr<Aead> remote_aead_;
+  const KmsEnvelopeAeadCacheOptions cache_options_;
+
+  mutable absl::Mutex mutex_;
+  // DEK used by Encrypt(), the number of messages it encrypted, and when it
+  // stops being used.
+  mutable std::shared_ptr<const Dek> encryption_dek_ ABSL_GUARDED_BY(mutex_);
+  mutable int64_t encryption_dek_uses_ ABSL_GUARDED_BY(mutex_) = 0;
+  mutable absl::Time encryption_dek_expiry_ ABSL_GUARDED_BY(mutex_);
+  // Cached DEKs of Decrypt(), most recently used first, and an index from
+  // encrypted DEKs into the list.
+  mutable std::list<std::shared_ptr<const Dek>> decryption_deks_
+      ABSL_GUARDED_BY(mutex_);
+  mutable absl::flat_hash_map<
+      absl::string_view, std::list<std::shared_ptr<const Dek>>::iterator>
+      decryption_dek_index_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Asynchronous variant of KmsEnvelopeAead, for remote AEADs that implement
+// AsyncAead. The plaintext is encrypted with a new DEK before the DEK is
+// wrapped by the remote AEAD, and decrypted once the remote AEAD has
+// unwrapped the DEK. The ciphertexts are the same as those of
+// KmsEnvelopeAead.
+class KmsEnvelopeAsyncAead : public AsyncAead {
+ public:
+  static crypto::tink::util::StatusOr<std::unique_ptr<AsyncAead>> New(
+      const google::crypto::tink::KeyTemplate& dek_template,
+      std::shared_ptr<const AsyncAead> remote_aead);
+
+  void EncryptAsync(absl::string_view plaintext,
+                    absl::string_view associated_data,
+                    DoneCallback done) const override;
+
+  void DecryptAsync(absl::string_view ciphertext,
+                    absl::string_view associated_data,
+                    DoneCallback done) const override;
+
+ private:
+  KmsEnvelopeAsyncAead(const google::crypto::tink::KeyTemplate& dek_template,
+                       std::shared_ptr<const AsyncAead> remote_aead)
+      : dek_template_(dek_template), remote_aead_(std::move(remote_aead)) {}
+
+  const google::crypto::tink::KeyTemplate dek_template_;
+  const std::shared_ptr<const AsyncAead> remote_aead_;
 };
 
 }  // namespace tink
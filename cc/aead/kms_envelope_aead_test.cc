@@ -18,23 +18,36 @@
 
 #include <stdint.h>
 
+#include <atomic>
+#include <deque>
+#include <functional>
 #include <memory>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/base/internal/endian.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "tink/aead.h"
 #include "tink/aead/aead_config.h"
 #include "tink/aead/aead_key_templates.h"
+#include "tink/aead/async_aead_adapter.h"
+#include "tink/aead/limited_async_aead.h"
+#include "tink/async_aead.h"
 #include "tink/keyset_handle.h"
 #include "tink/mac/mac_key_templates.h"
 #include "tink/registry.h"
+#include "tink/util/fake_kms_client.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
 #include "tink/util/test_matchers.h"
@@ -47,6 +60,7 @@ namespace {
 
 using ::crypto::tink::Aead;
 using ::crypto::tink::test::DummyAead;
+using ::crypto::tink::test::FakeKmsClient;
 using ::crypto::tink::test::IsOk;
 using ::crypto::tink::test::IsOkAndHolds;
 using ::crypto::tink::test::StatusIs;
@@ -65,6 +79,73 @@ class KmsEnvelopeAeadTest : public Test {
   void TearDown() override { Registry::Reset(); }
 };
 
+// Remote AEAD that counts how often it is called.
+class CountingRemoteAead : public Aead {
+ public:
+  explicit CountingRemoteAead(absl::string_view name) : aead_(name) {}
+
+  util::StatusOr<std::string> Encrypt(
+      absl::string_view plaintext,
+      absl::string_view associated_data) const override {
+    ++num_encryptions_;
+    return aead_.Encrypt(plaintext, associated_data);
+  }
+
+  util::StatusOr<std::string> Decrypt(
+      absl::string_view ciphertext,
+      absl::string_view associated_data) const override {
+    ++num_decryptions_;
+    return aead_.Decrypt(ciphertext, associated_data);
+  }
+
+  int num_encryptions() const { return num_encryptions_.load(); }
+  int num_decryptions() const { return num_decryptions_.load(); }
+
+ private:
+  DummyAead aead_;
+  mutable std::atomic<int> num_encryptions_{0};
+  mutable std::atomic<int> num_decryptions_{0};
+};
+
+// Aead that forwards to another one, which must outlive it.
+class ForwardingAead : public Aead {
+ public:
+  explicit ForwardingAead(const Aead* aead) : aead_(aead) {}
+
+  util::StatusOr<std::string> Encrypt(
+      absl::string_view plaintext,
+      absl::string_view associated_data) const override {
+    return aead_->Encrypt(plaintext, associated_data);
+  }
+
+  util::StatusOr<std::string> Decrypt(
+      absl::string_view ciphertext,
+      absl::string_view associated_data) const override {
+    return aead_->Decrypt(ciphertext, associated_data);
+  }
+
+ private:
+  const Aead* aead_;
+};
+
+// Returns a KmsEnvelopeAead whose remote AEAD is `*remote_aead`, which must
+// outlive it.
+util::StatusOr<std::unique_ptr<Aead>> NewEnvelopeAeadWithRemote(
+    const CountingRemoteAead* remote_aead,
+    const KmsEnvelopeAeadCacheOptions& cache_options) {
+  return KmsEnvelopeAead::New(AeadKeyTemplates::Aes128Gcm(),
+                              absl::make_unique<ForwardingAead>(remote_aead),
+                              cache_options);
+}
+
+// Returns the encrypted DEK of `ciphertext`.
+std::string EncryptedDek(absl::string_view ciphertext) {
+  uint32_t enc_dek_size = absl::big_endian::Load32(
+      reinterpret_cast<const uint8_t*>(ciphertext.data()));
+  return std::string(
+      ciphertext.substr(kEncryptedDekPrefixSize, enc_dek_size));
+}
+
 TEST_F(KmsEnvelopeAeadTest, EncryptDecryptSucceed) {
   ASSERT_THAT(AeadConfig::Register(), IsOk());
 
@@ -235,6 +316,349 @@ TEST_F(KmsEnvelopeAeadTest, MultipleEncryptionsProduceDifferentDeks) {
   }
 }
 
+TEST_F(KmsEnvelopeAeadTest, NewFailsWithInvalidCacheOptions) {
+  ASSERT_THAT(AeadConfig::Register(), IsOk());
+  CountingRemoteAead remote_aead(kRemoteAeadName);
+
+  KmsEnvelopeAeadCacheOptions options;
+  options.max_messages_per_dek = 0;
+  EXPECT_THAT(NewEnvelopeAeadWithRemote(&remote_aead, options).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  options.max_messages_per_dek = KmsEnvelopeAead::kMaxMessagesPerDek + 1;
+  EXPECT_THAT(NewEnvelopeAeadWithRemote(&remote_aead, options).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+
+  options = KmsEnvelopeAeadCacheOptions();
+  options.max_dek_lifetime = -absl::Seconds(1);
+  EXPECT_THAT(NewEnvelopeAeadWithRemote(&remote_aead, options).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+
+  options = KmsEnvelopeAeadCacheOptions();
+  options.max_decrypted_deks = -1;
+  EXPECT_THAT(NewEnvelopeAeadWithRemote(&remote_aead, options).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST_F(KmsEnvelopeAeadTest, ReusesDekUpToMaxMessagesPerDek) {
+  ASSERT_THAT(AeadConfig::Register(), IsOk());
+  CountingRemoteAead remote_aead(kRemoteAeadName);
+  KmsEnvelopeAeadCacheOptions options;
+  options.max_messages_per_dek = 3;
+  options.max_dek_lifetime = absl::Hours(1);
+  options.stats = std::make_shared<KmsEnvelopeAeadCacheStats>();
+  util::StatusOr<std::unique_ptr<Aead>> aead =
+      NewEnvelopeAeadWithRemote(&remote_aead, options);
+  ASSERT_THAT(aead, IsOk());
+
+  std::vector<std::string> ciphertexts;
+  for (int i = 0; i < 7; ++i) {
+    util::StatusOr<std::string> ciphertext =
+        (*aead)->Encrypt("plaintext", "aad");
+    ASSERT_THAT(ciphertext, IsOk());
+    ciphertexts.push_back(*std::move(ciphertext));
+  }
+  EXPECT_THAT(remote_aead.num_encryptions(), Eq(3));
+  EXPECT_THAT(options.stats->encrypt_misses(), Eq(3));
+  EXPECT_THAT(options.stats->encrypt_hits(), Eq(4));
+
+  // Messages encrypted with the same DEK have different ciphertexts.
+  EXPECT_THAT(EncryptedDek(ciphertexts[1]), Eq(EncryptedDek(ciphertexts[0])));
+  EXPECT_THAT(ciphertexts[1], Not(Eq(ciphertexts[0])));
+  EXPECT_THAT(EncryptedDek(ciphertexts[3]),
+              Not(Eq(EncryptedDek(ciphertexts[2]))));
+  for (const std::string& ciphertext : ciphertexts) {
+    EXPECT_THAT((*aead)->Decrypt(ciphertext, "aad"), IsOkAndHolds("plaintext"));
+  }
+}
+
+TEST_F(KmsEnvelopeAeadTest, DoesNotReuseExpiredDek) {
+  ASSERT_THAT(AeadConfig::Register(), IsOk());
+  CountingRemoteAead remote_aead(kRemoteAeadName);
+  KmsEnvelopeAeadCacheOptions options;
+  options.max_messages_per_dek = 100;
+  options.max_dek_lifetime = absl::ZeroDuration();
+  util::StatusOr<std::unique_ptr<Aead>> aead =
+      NewEnvelopeAeadWithRemote(&remote_aead, options);
+  ASSERT_THAT(aead, IsOk());
+
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_THAT((*aead)->Encrypt("plaintext", "aad"), IsOk());
+  }
+  EXPECT_THAT(remote_aead.num_encryptions(), Eq(3));
+}
+
+TEST_F(KmsEnvelopeAeadTest, DecryptCachesLeastRecentlyUsedDeks) {
+  ASSERT_THAT(AeadConfig::Register(), IsOk());
+  CountingRemoteAead remote_aead(kRemoteAeadName);
+  util::StatusOr<std::unique_ptr<Aead>> encrypter = NewEnvelopeAeadWithRemote(
+      &remote_aead, KmsEnvelopeAeadCacheOptions());
+  ASSERT_THAT(encrypter, IsOk());
+  std::vector<std::string> ciphertexts;
+  for (int i = 0; i < 3; ++i) {
+    util::StatusOr<std::string> ciphertext =
+        (*encrypter)->Encrypt("plaintext", "aad");
+    ASSERT_THAT(ciphertext, IsOk());
+    ciphertexts.push_back(*std::move(ciphertext));
+  }
+
+  KmsEnvelopeAeadCacheOptions options;
+  options.max_decrypted_deks = 2;
+  options.stats = std::make_shared<KmsEnvelopeAeadCacheStats>();
+  util::StatusOr<std::unique_ptr<Aead>> decrypter =
+      NewEnvelopeAeadWithRemote(&remote_aead, options);
+  ASSERT_THAT(decrypter, IsOk());
+
+  for (int i : {0, 1, 0, 2, 0, 1}) {
+    EXPECT_THAT((*decrypter)->Decrypt(ciphertexts[i], "aad"),
+                IsOkAndHolds("plaintext"));
+  }
+  // DEK 1 is evicted when DEK 2 is added, since DEK 0 was used more recently.
+  EXPECT_THAT(remote_aead.num_decryptions(), Eq(4));
+  EXPECT_THAT(options.stats->decrypt_misses(), Eq(4));
+  EXPECT_THAT(options.stats->decrypt_hits(), Eq(2));
+
+  // A cached DEK still authenticates the payload.
+  EXPECT_THAT((*decrypter)->Decrypt(ciphertexts[1], "other aad").status(),
+              Not(IsOk()));
+}
+
+TEST_F(KmsEnvelopeAeadTest, DecryptUsesDeksOfEncrypt) {
+  ASSERT_THAT(AeadConfig::Register(), IsOk());
+  CountingRemoteAead remote_aead(kRemoteAeadName);
+  KmsEnvelopeAeadCacheOptions options;
+  options.max_messages_per_dek = 10;
+  options.max_decrypted_deks = 1;
+  util::StatusOr<std::unique_ptr<Aead>> aead =
+      NewEnvelopeAeadWithRemote(&remote_aead, options);
+  ASSERT_THAT(aead, IsOk());
+
+  util::StatusOr<std::string> ciphertext = (*aead)->Encrypt("plaintext", "aad");
+  ASSERT_THAT(ciphertext, IsOk());
+  EXPECT_THAT((*aead)->Decrypt(*ciphertext, "aad"), IsOkAndHolds("plaintext"));
+  EXPECT_THAT(remote_aead.num_decryptions(), Eq(0));
+}
+
+TEST_F(KmsEnvelopeAeadTest, ConcurrentEncryptionsWithDekReuse) {
+  ASSERT_THAT(AeadConfig::Register(), IsOk());
+  CountingRemoteAead remote_aead(kRemoteAeadName);
+  KmsEnvelopeAeadCacheOptions options;
+  options.max_messages_per_dek = 10;
+  options.max_dek_lifetime = absl::Hours(1);
+  util::StatusOr<std::unique_ptr<Aead>> aead =
+      NewEnvelopeAeadWithRemote(&remote_aead, options);
+  ASSERT_THAT(aead, IsOk());
+
+  constexpr int kNumThreads = 4;
+  constexpr int kNumMessagesPerThread = 50;
+  std::vector<std::vector<std::string>> ciphertexts(kNumThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kNumMessagesPerThread; ++i) {
+        util::StatusOr<std::string> ciphertext =
+            (*aead)->Encrypt("plaintext", "aad");
+        if (ciphertext.ok()) ciphertexts[t].push_back(*std::move(ciphertext));
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  EXPECT_THAT(remote_aead.num_encryptions(),
+              testing::Ge(kNumThreads * kNumMessagesPerThread / 10));
+  for (const std::vector<std::string>& thread_ciphertexts : ciphertexts) {
+    ASSERT_THAT(thread_ciphertexts, SizeIs(kNumMessagesPerThread));
+    for (const std::string& ciphertext : thread_ciphertexts) {
+      EXPECT_THAT((*aead)->Decrypt(ciphertext, "aad"),
+                  IsOkAndHolds("plaintext"));
+    }
+  }
+}
+
+class InlineExecutor : public AsyncAeadAdapter::Executor {
+ public:
+  void Schedule(std::function<void()> task) override { task(); }
+};
+
+// Runs tasks on a fixed number of threads.
+class ThreadPoolExecutor : public AsyncAeadAdapter::Executor {
+ public:
+  explicit ThreadPoolExecutor(int num_threads) {
+    for (int i = 0; i < num_threads; ++i) {
+      threads_.emplace_back([this]() { Run(); });
+    }
+  }
+
+  void Schedule(std::function<void()> task) override {
+    absl::MutexLock lock(&mutex_);
+    tasks_.push_back(std::move(task));
+  }
+
+  ~ThreadPoolExecutor() override {
+    {
+      absl::MutexLock lock(&mutex_);
+      stopping_ = true;
+    }
+    for (std::thread& thread : threads_) {
+      thread.join();
+    }
+  }
+
+ private:
+  bool HasTaskOrIsStopping() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return !tasks_.empty() || stopping_;
+  }
+
+  void Run() {
+    while (true) {
+      std::function<void()> task;
+      {
+        absl::MutexLock lock(&mutex_);
+        mutex_.Await(
+            absl::Condition(this, &ThreadPoolExecutor::HasTaskOrIsStopping));
+        if (tasks_.empty()) return;
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      task();
+    }
+  }
+
+  absl::Mutex mutex_;
+  std::deque<std::function<void()>> tasks_ ABSL_GUARDED_BY(mutex_);
+  bool stopping_ ABSL_GUARDED_BY(mutex_) = false;
+  std::vector<std::thread> threads_;
+};
+
+// Returns the AEAD of a new key of a FakeKmsClient.
+util::StatusOr<std::unique_ptr<Aead>> NewFakeKmsAead() {
+  util::StatusOr<std::string> key_uri = FakeKmsClient::CreateFakeKeyUri();
+  if (!key_uri.ok()) return key_uri.status();
+  util::StatusOr<std::unique_ptr<FakeKmsClient>> client =
+      FakeKmsClient::New(*key_uri, /*credentials_path=*/"");
+  if (!client.ok()) return client.status();
+  return (*client)->GetAead(*key_uri);
+}
+
+// Runs an asynchronous operation and waits for its result.
+util::StatusOr<std::string> Wait(
+    const std::function<void(AsyncAead::DoneCallback)>& operation) {
+  util::StatusOr<std::string> result;
+  absl::BlockingCounter done(1);
+  operation([&](util::StatusOr<std::string> operation_result) {
+    result = std::move(operation_result);
+    done.DecrementCount();
+  });
+  done.Wait();
+  return result;
+}
+
+TEST_F(KmsEnvelopeAeadTest, AsyncNewFailsIfRemoteAeadIsNull) {
+  ASSERT_THAT(AeadConfig::Register(), IsOk());
+  EXPECT_THAT(
+      KmsEnvelopeAsyncAead::New(AeadKeyTemplates::Aes128Gcm(), nullptr)
+          .status(),
+      StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST_F(KmsEnvelopeAeadTest, AsyncEncryptDecryptWithFakeKms) {
+  ASSERT_THAT(AeadConfig::Register(), IsOk());
+  util::StatusOr<std::unique_ptr<Aead>> kms_aead = NewFakeKmsAead();
+  ASSERT_THAT(kms_aead, IsOk());
+  std::shared_ptr<const Aead> remote_aead = *std::move(kms_aead);
+  InlineExecutor executor;
+  util::StatusOr<std::unique_ptr<AsyncAead>> async_remote_aead =
+      AsyncAeadAdapter::New(remote_aead, &executor);
+  ASSERT_THAT(async_remote_aead, IsOk());
+  util::StatusOr<std::unique_ptr<AsyncAead>> async_aead =
+      KmsEnvelopeAsyncAead::New(AeadKeyTemplates::Aes128Gcm(),
+                                *std::move(async_remote_aead));
+  ASSERT_THAT(async_aead, IsOk());
+
+  util::StatusOr<std::string> ciphertext =
+      Wait([&](AsyncAead::DoneCallback done) {
+        (*async_aead)->EncryptAsync("plaintext", "aad", std::move(done));
+      });
+  ASSERT_THAT(ciphertext, IsOk());
+  EXPECT_THAT(Wait([&](AsyncAead::DoneCallback done) {
+                (*async_aead)->DecryptAsync(*ciphertext, "aad",
+                                            std::move(done));
+              }),
+              IsOkAndHolds("plaintext"));
+  EXPECT_THAT(Wait([&](AsyncAead::DoneCallback done) {
+                (*async_aead)->DecryptAsync(*ciphertext, "other aad",
+                                            std::move(done));
+              }).status(),
+              Not(IsOk()));
+  EXPECT_THAT(Wait([&](AsyncAead::DoneCallback done) {
+                (*async_aead)->DecryptAsync("abc", "aad", std::move(done));
+              }).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+
+  // The ciphertexts are the same as those of KmsEnvelopeAead.
+  util::StatusOr<std::unique_ptr<Aead>> aead = KmsEnvelopeAead::New(
+      AeadKeyTemplates::Aes128Gcm(),
+      absl::make_unique<ForwardingAead>(remote_aead.get()));
+  ASSERT_THAT(aead, IsOk());
+  EXPECT_THAT((*aead)->Decrypt(*ciphertext, "aad"), IsOkAndHolds("plaintext"));
+  util::StatusOr<std::string> sync_ciphertext =
+      (*aead)->Encrypt("plaintext", "aad");
+  ASSERT_THAT(sync_ciphertext, IsOk());
+  EXPECT_THAT(Wait([&](AsyncAead::DoneCallback done) {
+                (*async_aead)->DecryptAsync(*sync_ciphertext, "aad",
+                                            std::move(done));
+              }),
+              IsOkAndHolds("plaintext"));
+}
+
+TEST_F(KmsEnvelopeAeadTest, AsyncManyConcurrentOperations) {
+  ASSERT_THAT(AeadConfig::Register(), IsOk());
+  util::StatusOr<std::unique_ptr<Aead>> kms_aead = NewFakeKmsAead();
+  ASSERT_THAT(kms_aead, IsOk());
+  ThreadPoolExecutor executor(4);
+  util::StatusOr<std::unique_ptr<AsyncAead>> async_remote_aead =
+      AsyncAeadAdapter::New(*std::move(kms_aead), &executor);
+  ASSERT_THAT(async_remote_aead, IsOk());
+  LimitedAsyncAeadOptions options;
+  options.max_concurrent_operations = 16;
+  util::StatusOr<std::unique_ptr<LimitedAsyncAead>> limited_remote_aead =
+      LimitedAsyncAead::New(*std::move(async_remote_aead), options);
+  ASSERT_THAT(limited_remote_aead, IsOk());
+  util::StatusOr<std::unique_ptr<AsyncAead>> async_aead =
+      KmsEnvelopeAsyncAead::New(AeadKeyTemplates::Aes128Gcm(),
+                                *std::move(limited_remote_aead));
+  ASSERT_THAT(async_aead, IsOk());
+
+  constexpr int kNumOperations = 2000;
+  std::vector<util::StatusOr<std::string>> ciphertexts(kNumOperations);
+  absl::BlockingCounter encryptions(kNumOperations);
+  for (int i = 0; i < kNumOperations; ++i) {
+    (*async_aead)
+        ->EncryptAsync(absl::StrCat("plaintext ", i), "aad",
+                       [&, i](util::StatusOr<std::string> ciphertext) {
+                         ciphertexts[i] = std::move(ciphertext);
+                         encryptions.DecrementCount();
+                       });
+  }
+  encryptions.Wait();
+
+  std::vector<util::StatusOr<std::string>> plaintexts(kNumOperations);
+  absl::BlockingCounter decryptions(kNumOperations);
+  for (int i = 0; i < kNumOperations; ++i) {
+    ASSERT_THAT(ciphertexts[i], IsOk());
+    (*async_aead)
+        ->DecryptAsync(*ciphertexts[i], "aad",
+                       [&, i](util::StatusOr<std::string> plaintext) {
+                         plaintexts[i] = std::move(plaintext);
+                         decryptions.DecrementCount();
+                       });
+  }
+  decryptions.Wait();
+  for (int i = 0; i < kNumOperations; ++i) {
+    EXPECT_THAT(plaintexts[i], IsOkAndHolds(absl::StrCat("plaintext ", i)));
+  }
+}
+
 }  // namespace
 }  // namespace tink
 }  // namespace crypto
@@ -0,0 +1,215 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+
+#include "tink/aead/limited_async_aead.h"
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tink/async_aead.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+
+class LimitedAsyncAead::Limiter
+    : public std::enable_shared_from_this<LimitedAsyncAead::Limiter> {
+ public:
+  struct Operation {
+    bool encrypt;
+    std::string input;
+    std::string associated_data;
+    DoneCallback done;
+    absl::Time enqueue_time;
+  };
+
+  Limiter(std::shared_ptr<const AsyncAead> aead,
+          const LimitedAsyncAeadOptions& options)
+      : aead_(std::move(aead)), options_(options) {}
+
+  // Starts `operation`, or queues it if the limit is reached.
+  void Submit(Operation operation);
+
+  int num_in_flight() const {
+    absl::MutexLock lock(&mutex_);
+    return num_in_flight_;
+  }
+
+  int num_queued() const {
+    absl::MutexLock lock(&mutex_);
+    return queue_.size();
+  }
+
+ private:
+  // Starts `operation` on the wrapped primitive.
+  void Start(Operation operation);
+
+  // Called when an operation completed. Starts queued operations, unless
+  // another thread already does.
+  void Release();
+
+  const std::shared_ptr<const AsyncAead> aead_;
+  const LimitedAsyncAeadOptions options_;
+
+  mutable absl::Mutex mutex_;
+  int num_in_flight_ ABSL_GUARDED_BY(mutex_) = 0;
+  std::deque<Operation> queue_ ABSL_GUARDED_BY(mutex_);
+  // Whether a thread is in the loop of Release() that starts queued
+  // operations. Operations that complete synchronously while it is running
+  // leave the queue to it, so that the stack does not grow with the queue.
+  bool dispatching_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+void LimitedAsyncAead::Limiter::Submit(Operation operation) {
+  {
+    absl::MutexLock lock(&mutex_);
+    if (num_in_flight_ < options_.max_concurrent_operations &&
+        queue_.empty()) {
+      ++num_in_flight_;
+    } else if (queue_.size() <
+               static_cast<size_t>(options_.max_queued_operations)) {
+      if (options_.max_queue_time != absl::InfiniteDuration()) {
+        operation.enqueue_time = absl::Now();
+      }
+      queue_.push_back(std::move(operation));
+      return;
+    } else {
+      operation.done(util::Status(absl::StatusCode::kResourceExhausted,
+                                  "too many queued operations"));
+      return;
+    }
+  }
+  Start(std::move(operation));
+}
+
+void LimitedAsyncAead::Limiter::Start(Operation operation) {
+  DoneCallback done = [limiter = shared_from_this(),
+                       done = std::move(operation.done)](
+                          util::StatusOr<std::string> result) {
+    done(std::move(result));
+    limiter->Release();
+  };
+  if (operation.encrypt) {
+    aead_->EncryptAsync(operation.input, operation.associated_data,
+                        std::move(done));
+  } else {
+    aead_->DecryptAsync(operation.input, operation.associated_data,
+                        std::move(done));
+  }
+}
+
+void LimitedAsyncAead::Limiter::Release() {
+  std::vector<Operation> expired;
+  mutex_.Lock();
+  --num_in_flight_;
+  if (dispatching_) {
+    mutex_.Unlock();
+    return;
+  }
+  dispatching_ = true;
+  while (true) {
+    bool has_next = false;
+    Operation next;
+    while (!queue_.empty() &&
+           num_in_flight_ < options_.max_concurrent_operations) {
+      Operation operation = std::move(queue_.front());
+      queue_.pop_front();
+      if (options_.max_queue_time != absl::InfiniteDuration() &&
+          absl::Now() - operation.enqueue_time > options_.max_queue_time) {
+        expired.push_back(std::move(operation));
+        continue;
+      }
+      ++num_in_flight_;
+      next = std::move(operation);
+      has_next = true;
+      break;
+    }
+    if (!has_next && expired.empty()) {
+      dispatching_ = false;
+      mutex_.Unlock();
+      return;
+    }
+    mutex_.Unlock();
+    for (Operation& operation : expired) {
+      operation.done(util::Status(absl::StatusCode::kDeadlineExceeded,
+                                  "operation waited too long in the queue"));
+    }
+    expired.clear();
+    if (has_next) Start(std::move(next));
+    mutex_.Lock();
+  }
+}
+
+// static
+util::StatusOr<std::unique_ptr<LimitedAsyncAead>> LimitedAsyncAead::New(
+    std::shared_ptr<const AsyncAead> aead,
+    const LimitedAsyncAeadOptions& options) {
+  if (aead == nullptr) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "aead must be non-null");
+  }
+  if (options.max_concurrent_operations < 1) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "max_concurrent_operations must be positive");
+  }
+  if (options.max_queued_operations < 0) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "max_queued_operations must not be negative");
+  }
+  if (options.max_queue_time < absl::ZeroDuration()) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "max_queue_time must not be negative");
+  }
+  std::unique_ptr<LimitedAsyncAead> limited_aead(new LimitedAsyncAead(
+      std::make_shared<Limiter>(std::move(aead), options)));
+  return std::move(limited_aead);
+}
+
+void LimitedAsyncAead::EncryptAsync(absl::string_view plaintext,
+                                    absl::string_view associated_data,
+                                    DoneCallback done) const {
+  limiter_->Submit({/*encrypt=*/true, std::string(plaintext),
+                    std::string(associated_data), std::move(done),
+                    absl::InfinitePast()});
+}
+
+void LimitedAsyncAead::DecryptAsync(absl::string_view ciphertext,
+                                    absl::string_view associated_data,
+                                    DoneCallback done) const {
+  limiter_->Submit({/*encrypt=*/false, std::string(ciphertext),
+                    std::string(associated_data), std::move(done),
+                    absl::InfinitePast()});
+}
+
+int LimitedAsyncAead::num_in_flight() const {
+  return limiter_->num_in_flight();
+}
+
+int LimitedAsyncAead::num_queued() const { return limiter_->num_queued(); }
+
+}  // namespace tink
+}  // namespace crypto
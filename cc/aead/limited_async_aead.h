@@ -0,0 +1,80 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef TINK_AEAD_LIMITED_ASYNC_AEAD_H_
+#define TINK_AEAD_LIMITED_ASYNC_AEAD_H_
+
+#include <memory>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "tink/async_aead.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+
+struct LimitedAsyncAeadOptions {
+  // Maximum number of operations in flight on the wrapped primitive.
+  int max_concurrent_operations = 64;
+  // Maximum number of operations waiting to be started. Operations beyond
+  // this fail with RESOURCE_EXHAUSTED.
+  int max_queued_operations = 4096;
+  // Operations that waited longer than this to be started fail with
+  // DEADLINE_EXCEEDED instead.
+  absl::Duration max_queue_time = absl::InfiniteDuration();
+};
+
+// AsyncAead that limits the number of operations in flight on another
+// AsyncAead, for example to stay within the request quota of a KMS. Further
+// operations are queued and started in order as earlier ones complete, on
+// the thread that completed them.
+class LimitedAsyncAead : public AsyncAead {
+ public:
+  static crypto::tink::util::StatusOr<std::unique_ptr<LimitedAsyncAead>> New(
+      std::shared_ptr<const AsyncAead> aead,
+      const LimitedAsyncAeadOptions& options);
+
+  void EncryptAsync(absl::string_view plaintext,
+                    absl::string_view associated_data,
+                    DoneCallback done) const override;
+
+  void DecryptAsync(absl::string_view ciphertext,
+                    absl::string_view associated_data,
+                    DoneCallback done) const override;
+
+  // Number of operations that were started and have not completed yet.
+  int num_in_flight() const;
+  // Number of operations waiting to be started.
+  int num_queued() const;
+
+ private:
+  // Shared with the callbacks of the operations in flight, so that they may
+  // complete after this object is destroyed.
+  class Limiter;
+
+  explicit LimitedAsyncAead(std::shared_ptr<Limiter> limiter)
+      : limiter_(std::move(limiter)) {}
+
+  const std::shared_ptr<Limiter> limiter_;
+};
+
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_AEAD_LIMITED_ASYNC_AEAD_H_
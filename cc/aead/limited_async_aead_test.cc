@@ -0,0 +1,249 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+
+#include "tink/aead/limited_async_aead.h"
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tink/async_aead.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "tink/util/test_matchers.h"
+
+namespace crypto {
+namespace tink {
+namespace {
+
+using ::crypto::tink::test::IsOk;
+using ::crypto::tink::test::IsOkAndHolds;
+using ::crypto::tink::test::StatusIs;
+using ::testing::Eq;
+using ::testing::SizeIs;
+
+// AsyncAead whose operations complete when the test calls CompleteNext(), or
+// immediately after set_complete_immediately(). Not thread-safe.
+class FakeAsyncAead : public AsyncAead {
+ public:
+  void EncryptAsync(absl::string_view plaintext,
+                    absl::string_view associated_data,
+                    DoneCallback done) const override {
+    Add(absl::StrCat("encrypted ", plaintext), std::move(done));
+  }
+
+  void DecryptAsync(absl::string_view ciphertext,
+                    absl::string_view associated_data,
+                    DoneCallback done) const override {
+    Add(absl::StrCat("decrypted ", ciphertext), std::move(done));
+  }
+
+  // Completes the oldest pending operation.
+  void CompleteNext() {
+    std::pair<std::string, DoneCallback> operation =
+        std::move(pending_.front());
+    pending_.pop_front();
+    operation.second(operation.first);
+  }
+
+  void set_complete_immediately() { complete_immediately_ = true; }
+
+  int num_pending() const { return pending_.size(); }
+
+ private:
+  void Add(std::string result, DoneCallback done) const {
+    if (complete_immediately_) {
+      done(std::move(result));
+    } else {
+      pending_.emplace_back(std::move(result), std::move(done));
+    }
+  }
+
+  bool complete_immediately_ = false;
+  mutable std::deque<std::pair<std::string, DoneCallback>> pending_;
+};
+
+// Collects the results of operations.
+class Results {
+ public:
+  AsyncAead::DoneCallback Callback() {
+    return [this](util::StatusOr<std::string> result) {
+      results_.push_back(std::move(result));
+    };
+  }
+
+  const std::vector<util::StatusOr<std::string>>& results() const {
+    return results_;
+  }
+
+ private:
+  std::vector<util::StatusOr<std::string>> results_;
+};
+
+TEST(LimitedAsyncAeadTest, NewFailsWithInvalidArguments) {
+  auto aead = std::make_shared<FakeAsyncAead>();
+  EXPECT_THAT(
+      LimitedAsyncAead::New(nullptr, LimitedAsyncAeadOptions()).status(),
+      StatusIs(absl::StatusCode::kInvalidArgument));
+
+  LimitedAsyncAeadOptions options;
+  options.max_concurrent_operations = 0;
+  EXPECT_THAT(LimitedAsyncAead::New(aead, options).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+
+  options = LimitedAsyncAeadOptions();
+  options.max_queued_operations = -1;
+  EXPECT_THAT(LimitedAsyncAead::New(aead, options).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+
+  options = LimitedAsyncAeadOptions();
+  options.max_queue_time = -absl::Seconds(1);
+  EXPECT_THAT(LimitedAsyncAead::New(aead, options).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(LimitedAsyncAeadTest, QueuesOperationsBeyondLimit) {
+  auto aead = std::make_shared<FakeAsyncAead>();
+  LimitedAsyncAeadOptions options;
+  options.max_concurrent_operations = 2;
+  util::StatusOr<std::unique_ptr<LimitedAsyncAead>> limited_aead =
+      LimitedAsyncAead::New(aead, options);
+  ASSERT_THAT(limited_aead, IsOk());
+
+  Results results;
+  for (int i = 0; i < 5; ++i) {
+    (*limited_aead)->EncryptAsync(absl::StrCat(i), "aad", results.Callback());
+  }
+  (*limited_aead)->DecryptAsync("5", "aad", results.Callback());
+  EXPECT_THAT(aead->num_pending(), Eq(2));
+  EXPECT_THAT((*limited_aead)->num_in_flight(), Eq(2));
+  EXPECT_THAT((*limited_aead)->num_queued(), Eq(4));
+
+  aead->CompleteNext();
+  EXPECT_THAT(aead->num_pending(), Eq(2));
+  EXPECT_THAT((*limited_aead)->num_queued(), Eq(3));
+  while (aead->num_pending() > 0) {
+    aead->CompleteNext();
+  }
+  EXPECT_THAT((*limited_aead)->num_in_flight(), Eq(0));
+  EXPECT_THAT((*limited_aead)->num_queued(), Eq(0));
+
+  // Operations are started in order.
+  ASSERT_THAT(results.results(), SizeIs(6));
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_THAT(results.results()[i],
+                IsOkAndHolds(absl::StrCat("encrypted ", i)));
+  }
+  EXPECT_THAT(results.results()[5], IsOkAndHolds("decrypted 5"));
+}
+
+TEST(LimitedAsyncAeadTest, FailsOperationsBeyondQueueLimit) {
+  auto aead = std::make_shared<FakeAsyncAead>();
+  LimitedAsyncAeadOptions options;
+  options.max_concurrent_operations = 1;
+  options.max_queued_operations = 1;
+  util::StatusOr<std::unique_ptr<LimitedAsyncAead>> limited_aead =
+      LimitedAsyncAead::New(aead, options);
+  ASSERT_THAT(limited_aead, IsOk());
+
+  Results results;
+  for (int i = 0; i < 3; ++i) {
+    (*limited_aead)->EncryptAsync(absl::StrCat(i), "aad", results.Callback());
+  }
+  ASSERT_THAT(results.results(), SizeIs(1));
+  EXPECT_THAT(results.results()[0].status(),
+              StatusIs(absl::StatusCode::kResourceExhausted));
+  aead->CompleteNext();
+  aead->CompleteNext();
+  EXPECT_THAT(results.results(), SizeIs(3));
+}
+
+TEST(LimitedAsyncAeadTest, FailsOperationsThatWaitedTooLong) {
+  auto aead = std::make_shared<FakeAsyncAead>();
+  LimitedAsyncAeadOptions options;
+  options.max_concurrent_operations = 1;
+  options.max_queue_time = absl::Milliseconds(1);
+  util::StatusOr<std::unique_ptr<LimitedAsyncAead>> limited_aead =
+      LimitedAsyncAead::New(aead, options);
+  ASSERT_THAT(limited_aead, IsOk());
+
+  Results results;
+  (*limited_aead)->EncryptAsync("0", "aad", results.Callback());
+  (*limited_aead)->EncryptAsync("1", "aad", results.Callback());
+  absl::SleepFor(absl::Milliseconds(10));
+  (*limited_aead)->EncryptAsync("2", "aad", results.Callback());
+  aead->CompleteNext();
+  aead->CompleteNext();
+
+  ASSERT_THAT(results.results(), SizeIs(3));
+  EXPECT_THAT(results.results()[0], IsOkAndHolds("encrypted 0"));
+  EXPECT_THAT(results.results()[1].status(),
+              StatusIs(absl::StatusCode::kDeadlineExceeded));
+  EXPECT_THAT(results.results()[2], IsOkAndHolds("encrypted 2"));
+  EXPECT_THAT(aead->num_pending(), Eq(0));
+}
+
+TEST(LimitedAsyncAeadTest, DrainsLongQueueOfSynchronousOperations) {
+  auto aead = std::make_shared<FakeAsyncAead>();
+  LimitedAsyncAeadOptions options;
+  options.max_concurrent_operations = 1;
+  options.max_queued_operations = 100000;
+  util::StatusOr<std::unique_ptr<LimitedAsyncAead>> limited_aead =
+      LimitedAsyncAead::New(aead, options);
+  ASSERT_THAT(limited_aead, IsOk());
+
+  Results results;
+  for (int i = 0; i < 100000; ++i) {
+    (*limited_aead)->EncryptAsync("plaintext", "aad", results.Callback());
+  }
+  // Queued operations are started in a loop rather than recursively from
+  // the callbacks of the previous ones.
+  aead->set_complete_immediately();
+  aead->CompleteNext();
+  EXPECT_THAT(results.results(), SizeIs(100000));
+  EXPECT_THAT((*limited_aead)->num_in_flight(), Eq(0));
+}
+
+TEST(LimitedAsyncAeadTest, OperationsCanCompleteAfterDestruction) {
+  auto aead = std::make_shared<FakeAsyncAead>();
+  LimitedAsyncAeadOptions options;
+  options.max_concurrent_operations = 1;
+  util::StatusOr<std::unique_ptr<LimitedAsyncAead>> limited_aead =
+      LimitedAsyncAead::New(aead, options);
+  ASSERT_THAT(limited_aead, IsOk());
+
+  Results results;
+  (*limited_aead)->EncryptAsync("0", "aad", results.Callback());
+  (*limited_aead)->EncryptAsync("1", "aad", results.Callback());
+  limited_aead->reset();
+  aead->CompleteNext();
+  aead->CompleteNext();
+  EXPECT_THAT(results.results(), SizeIs(2));
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
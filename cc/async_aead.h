@@ -0,0 +1,64 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef TINK_ASYNC_AEAD_H_
+#define TINK_ASYNC_AEAD_H_
+
+#include <functional>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+
+///////////////////////////////////////////////////////////////////////////////
+// Asynchronous variant of the Aead interface, for primitives whose operations
+// wait for a remote service, such as AEADs backed by a KMS. A call returns
+// once the operation is started, and the result is passed to a callback, so
+// that many operations can be in flight without blocking a thread each.
+//
+// Implementations are expected to be thread safe.
+class AsyncAead {
+ public:
+  // Receives the result of an operation. Called exactly once, either before
+  // the operation returns or later on a thread of the implementation.
+  using DoneCallback =
+      std::function<void(crypto::tink::util::StatusOr<std::string>)>;
+
+  // Starts the encryption of 'plaintext' with 'associated_data' as
+  // associated data, with the same semantics as Aead::Encrypt. The arguments
+  // only need to remain valid until this call returns.
+  virtual void EncryptAsync(absl::string_view plaintext,
+                            absl::string_view associated_data,
+                            DoneCallback done) const = 0;
+
+  // Starts the decryption of 'ciphertext' with 'associated_data' as
+  // associated data, with the same semantics as Aead::Decrypt. The arguments
+  // only need to remain valid until this call returns.
+  virtual void DecryptAsync(absl::string_view ciphertext,
+                            absl::string_view associated_data,
+                            DoneCallback done) const = 0;
+
+  virtual ~AsyncAead() = default;
+};
+
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_ASYNC_AEAD_H_
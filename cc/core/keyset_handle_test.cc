@@ -62,6 +62,7 @@ using crypto::tink::test::AddRawKey;
 using crypto::tink::test::AddTinkKey;
 using crypto::tink::test::DummyAead;
 using crypto::tink::test::IsOk;
+using crypto::tink::test::IsOkAndHolds;
 using crypto::tink::test::StatusIs;
 using google::crypto::tink::EcdsaKeyFormat;
 using google::crypto::tink::EncryptedKeyset;
@@ -769,6 +770,63 @@ TEST_F(KeysetHandleTest, GetPrimitive) {
   EXPECT_EQ(aead->Decrypt(raw_encryption, aad).value(), plaintext);
 }
 
+TEST_F(KeysetHandleTest, GetPrimitiveWithLazyKeys) {
+  Keyset keyset;
+  KeyData key_data_0 =
+      *Registry::NewKeyData(AeadKeyTemplates::Aes128Gcm()).value();
+  AddKeyData(key_data_0, /*key_id=*/0,
+             google::crypto::tink::OutputPrefixType::TINK,
+             KeyStatusType::ENABLED, &keyset);
+  KeyData key_data_1 =
+      *Registry::NewKeyData(AeadKeyTemplates::Aes256Gcm()).value();
+  AddKeyData(key_data_1, /*key_id=*/1,
+             google::crypto::tink::OutputPrefixType::TINK,
+             KeyStatusType::ENABLED, &keyset);
+  KeyData key_data_2 =
+      *Registry::NewKeyData(AeadKeyTemplates::Aes256Gcm()).value();
+  AddKeyData(key_data_2, /*key_id=*/2,
+             google::crypto::tink::OutputPrefixType::RAW,
+             KeyStatusType::ENABLED, &keyset);
+  // An invalid non-primary key is only noticed when it is used.
+  KeyData invalid_key_data = key_data_2;
+  invalid_key_data.set_value("invalid");
+  AddKeyData(invalid_key_data, /*key_id=*/3,
+             google::crypto::tink::OutputPrefixType::RAW,
+             KeyStatusType::ENABLED, &keyset);
+  keyset.set_primary_key_id(0);
+  std::unique_ptr<KeysetHandle> old_keyset_handle =
+      TestKeysetHandle::GetKeysetHandle(keyset);
+  keyset.set_primary_key_id(1);
+  std::unique_ptr<KeysetHandle> keyset_handle =
+      TestKeysetHandle::GetKeysetHandle(keyset);
+
+  EXPECT_THAT(keyset_handle->GetPrimitive<Aead>().status(), Not(IsOk()));
+  util::StatusOr<std::unique_ptr<Aead>> aead =
+      keyset_handle->GetPrimitiveWithLazyKeys<Aead>();
+  ASSERT_THAT(aead, IsOk());
+
+  std::string plaintext = "plaintext";
+  std::string aad = "aad";
+  util::StatusOr<std::string> encryption = (*aead)->Encrypt(plaintext, aad);
+  ASSERT_THAT(encryption, IsOk());
+  EXPECT_THAT((*aead)->Decrypt(*encryption, aad), IsOkAndHolds(plaintext));
+
+  // Ciphertexts of the non-primary keys still decrypt.
+  std::string old_encryption =
+      old_keyset_handle->GetPrimitiveWithLazyKeys<Aead>()
+          .value()
+          ->Encrypt(plaintext, aad)
+          .value();
+  EXPECT_THAT((*aead)->Decrypt(old_encryption, aad), IsOkAndHolds(plaintext));
+  std::string raw_encryption = Registry::GetPrimitive<Aead>(key_data_2)
+                                   .value()
+                                   ->Encrypt(plaintext, aad)
+                                   .value();
+  EXPECT_THAT((*aead)->Decrypt(raw_encryption, aad), IsOkAndHolds(plaintext));
+  EXPECT_THAT((*aead)->Decrypt("invalid ciphertext", aad).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
 // Tests that GetPrimitive(nullptr) fails with a non-ok status.
 TEST_F(KeysetHandleTest, GetPrimitiveNullptrKeyManager) {
   Keyset keyset;
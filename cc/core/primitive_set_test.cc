@@ -16,6 +16,7 @@
 
 #include "tink/primitive_set.h"
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <thread>  // NOLINT(build/c++11)
@@ -32,9 +33,13 @@
 
 using ::crypto::tink::test::DummyMac;
 using ::crypto::tink::test::IsOk;
+using ::crypto::tink::test::IsOkAndHolds;
+using ::crypto::tink::test::StatusIs;
 using ::google::crypto::tink::KeysetInfo;
 using ::google::crypto::tink::KeyStatusType;
 using ::google::crypto::tink::OutputPrefixType;
+using ::testing::ElementsAre;
+using ::testing::UnorderedElementsAre;
 using ::testing::UnorderedElementsAreArray;
 
 namespace crypto {
@@ -810,6 +815,211 @@ TEST_F(PrimitiveSetTest, LegacyGetAll) {
   EXPECT_THAT(mac_id_and_type, UnorderedElementsAreArray(expected_result));
 }
 
+TEST_F(PrimitiveSetTest, LazyPrimitiveIsCreatedOnFirstUse) {
+  int num_created = 0;
+  PrimitiveSet<Mac>::PrimitiveGetter getter =
+      [&num_created](const google::crypto::tink::KeyData& key_data)
+      -> util::StatusOr<std::unique_ptr<Mac>> {
+    num_created++;
+    return {absl::make_unique<DummyMac>(key_data.type_url())};
+  };
+  google::crypto::tink::KeyData key_data;
+  key_data.set_type_url("lazy");
+
+  util::StatusOr<PrimitiveSet<Mac>> pset =
+      PrimitiveSet<Mac>::Builder()
+          .AddPrimaryPrimitive(absl::make_unique<DummyMac>("primary"),
+                               CreateKey(1, OutputPrefixType::TINK,
+                                         KeyStatusType::ENABLED, "primary"))
+          .AddLazyPrimitive(key_data, getter,
+                            CreateKey(2, OutputPrefixType::TINK,
+                                      KeyStatusType::ENABLED, "lazy"))
+          .Build();
+  ASSERT_THAT(pset, IsOk());
+  EXPECT_EQ(num_created, 0);
+
+  KeysetInfo::KeyInfo key_info =
+      CreateKey(2, OutputPrefixType::TINK, KeyStatusType::ENABLED, "lazy");
+  util::StatusOr<const PrimitiveSet<Mac>::Primitives*> entries =
+      pset->get_primitives(CryptoFormat::GetOutputPrefix(key_info).value());
+  ASSERT_THAT(entries, IsOk());
+  ASSERT_EQ((*entries)->size(), 1);
+  for (int i = 0; i < 3; i++) {
+    util::StatusOr<Mac*> mac = (*entries)->front()->get_or_create_primitive();
+    ASSERT_THAT(mac, IsOk());
+    EXPECT_THAT((*mac)->ComputeMac(""), IsOkAndHolds("13:0:DummyMac:lazy"));
+  }
+  EXPECT_EQ(num_created, 1);
+}
+
+TEST_F(PrimitiveSetTest, LazyPrimitiveCreatedOnceUnderConcurrency) {
+  std::atomic<int> num_created{0};
+  PrimitiveSet<Mac>::PrimitiveGetter getter =
+      [&num_created](const google::crypto::tink::KeyData& key_data)
+      -> util::StatusOr<std::unique_ptr<Mac>> {
+    num_created++;
+    return {absl::make_unique<DummyMac>("lazy")};
+  };
+  util::StatusOr<PrimitiveSet<Mac>> pset =
+      PrimitiveSet<Mac>::Builder()
+          .AddPrimaryPrimitive(absl::make_unique<DummyMac>("primary"),
+                               CreateKey(1, OutputPrefixType::RAW,
+                                         KeyStatusType::ENABLED, "primary"))
+          .AddLazyPrimitive(google::crypto::tink::KeyData(), getter,
+                            CreateKey(2, OutputPrefixType::RAW,
+                                      KeyStatusType::ENABLED, "lazy"))
+          .Build();
+  ASSERT_THAT(pset, IsOk());
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; i++) {
+    threads.emplace_back([&pset]() {
+      for (auto* entry : pset->get_all()) {
+        EXPECT_THAT(entry->get_or_create_primitive(), IsOk());
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_created, 1);
+}
+
+TEST_F(PrimitiveSetTest, LazyPrimitiveCreationFailureIsRemembered) {
+  int num_created = 0;
+  PrimitiveSet<Mac>::PrimitiveGetter getter =
+      [&num_created](const google::crypto::tink::KeyData& key_data)
+      -> util::StatusOr<std::unique_ptr<Mac>> {
+    num_created++;
+    return util::Status(absl::StatusCode::kInvalidArgument, "bad key");
+  };
+  util::StatusOr<PrimitiveSet<Mac>> pset =
+      PrimitiveSet<Mac>::Builder()
+          .AddPrimaryPrimitive(absl::make_unique<DummyMac>("primary"),
+                               CreateKey(1, OutputPrefixType::TINK,
+                                         KeyStatusType::ENABLED, "primary"))
+          .AddLazyPrimitive(google::crypto::tink::KeyData(), getter,
+                            CreateKey(2, OutputPrefixType::RAW,
+                                      KeyStatusType::ENABLED, "lazy"))
+          .Build();
+  ASSERT_THAT(pset, IsOk());
+
+  util::StatusOr<const PrimitiveSet<Mac>::Primitives*> raw_entries =
+      pset->get_raw_primitives();
+  ASSERT_THAT(raw_entries, IsOk());
+  ASSERT_EQ((*raw_entries)->size(), 1);
+  const auto& entry = (*raw_entries)->front();
+  EXPECT_THAT(entry->get_or_create_primitive().status(),
+              StatusIs(absl::StatusCode::kInvalidArgument, "bad key"));
+  EXPECT_THAT(entry->get_or_create_primitive().status(),
+              StatusIs(absl::StatusCode::kInvalidArgument, "bad key"));
+  EXPECT_EQ(num_created, 1);
+}
+
+TEST_F(PrimitiveSetTest, LazyPrimitiveRequiresEnabledKeyAndGetter) {
+  PrimitiveSet<Mac>::PrimitiveGetter getter =
+      [](const google::crypto::tink::KeyData& key_data)
+      -> util::StatusOr<std::unique_ptr<Mac>> {
+    return {absl::make_unique<DummyMac>("lazy")};
+  };
+  EXPECT_THAT(PrimitiveSet<Mac>::Builder()
+                  .AddLazyPrimitive(google::crypto::tink::KeyData(), getter,
+                                    CreateKey(1, OutputPrefixType::TINK,
+                                              KeyStatusType::DISABLED, "lazy"))
+                  .Build()
+                  .status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(PrimitiveSet<Mac>::Builder()
+                  .AddLazyPrimitive(google::crypto::tink::KeyData(), nullptr,
+                                    CreateKey(1, OutputPrefixType::TINK,
+                                              KeyStatusType::ENABLED, "lazy"))
+                  .Build()
+                  .status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+// Returns the key IDs of `entries`.
+std::vector<uint32_t> KeyIds(const PrimitiveSet<Mac>::OrderedEntries& entries) {
+  std::vector<uint32_t> key_ids;
+  for (const PrimitiveSet<Mac>::Entry<Mac>* entry : entries) {
+    key_ids.push_back(entry->get_key_id());
+  }
+  return key_ids;
+}
+
+util::StatusOr<PrimitiveSet<Mac>> RawPrimitiveSet(bool adaptive_raw_order) {
+  PrimitiveSet<Mac>::Builder builder;
+  builder.AddPrimaryPrimitive(
+      absl::make_unique<DummyMac>("tink"),
+      CreateKey(100, OutputPrefixType::TINK, KeyStatusType::ENABLED, "tink"));
+  for (uint32_t key_id = 1; key_id <= 4; key_id++) {
+    builder.AddPrimitive(
+        absl::make_unique<DummyMac>("raw"),
+        CreateKey(key_id, OutputPrefixType::RAW, KeyStatusType::ENABLED, "raw"));
+  }
+  if (adaptive_raw_order) builder.EnableAdaptiveRawOrder();
+  return std::move(builder).Build();
+}
+
+TEST_F(PrimitiveSetTest, RawPrimitivesInTrialOrderDefaultsToInsertionOrder) {
+  util::StatusOr<PrimitiveSet<Mac>> pset =
+      RawPrimitiveSet(/*adaptive_raw_order=*/false);
+  ASSERT_THAT(pset, IsOk());
+  PrimitiveSet<Mac>::OrderedEntries entries =
+      pset->get_raw_primitives_in_trial_order();
+  ASSERT_THAT(KeyIds(entries), ElementsAre(1, 2, 3, 4));
+
+  pset->RecordRawPrimitiveSuccess(entries[3]);
+  EXPECT_THAT(KeyIds(pset->get_raw_primitives_in_trial_order()),
+              ElementsAre(1, 2, 3, 4));
+}
+
+TEST_F(PrimitiveSetTest, AdaptiveRawOrder) {
+  util::StatusOr<PrimitiveSet<Mac>> pset =
+      RawPrimitiveSet(/*adaptive_raw_order=*/true);
+  ASSERT_THAT(pset, IsOk());
+  PrimitiveSet<Mac>::OrderedEntries entries =
+      pset->get_raw_primitives_in_trial_order();
+  ASSERT_THAT(KeyIds(entries), ElementsAre(1, 2, 3, 4));
+  const PrimitiveSet<Mac>::Entry<Mac>* key_2 = entries[1];
+  const PrimitiveSet<Mac>::Entry<Mac>* key_3 = entries[2];
+  const PrimitiveSet<Mac>::Entry<Mac>* key_4 = entries[3];
+
+  // The most recent success comes first.
+  pset->RecordRawPrimitiveSuccess(key_3);
+  EXPECT_THAT(KeyIds(pset->get_raw_primitives_in_trial_order()),
+              ElementsAre(3, 1, 2, 4));
+  pset->RecordRawPrimitiveSuccess(key_4);
+  EXPECT_THAT(KeyIds(pset->get_raw_primitives_in_trial_order()),
+              ElementsAre(4, 3, 1, 2));
+  // The others are ordered by their number of successes.
+  pset->RecordRawPrimitiveSuccess(key_2);
+  pset->RecordRawPrimitiveSuccess(key_4);
+  pset->RecordRawPrimitiveSuccess(key_2);
+  EXPECT_THAT(KeyIds(pset->get_raw_primitives_in_trial_order()),
+              ElementsAre(2, 4, 3, 1));
+}
+
+TEST_F(PrimitiveSetTest, AdaptiveRawOrderConcurrentUse) {
+  util::StatusOr<PrimitiveSet<Mac>> pset =
+      RawPrimitiveSet(/*adaptive_raw_order=*/true);
+  ASSERT_THAT(pset, IsOk());
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; i++) {
+    threads.emplace_back([&pset, i]() {
+      for (int j = 0; j < 1000; j++) {
+        PrimitiveSet<Mac>::OrderedEntries entries =
+            pset->get_raw_primitives_in_trial_order();
+        EXPECT_THAT(KeyIds(entries), UnorderedElementsAre(1, 2, 3, 4));
+        pset->RecordRawPrimitiveSuccess(entries[(i + j) % entries.size()]);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
 }  // namespace
 }  // namespace tink
 }  // namespace crypto
@@ -25,6 +25,7 @@
 #include "tink/deterministic_aead.h"
 #include "tink/internal/monitoring_util.h"
 #include "tink/internal/registry_impl.h"
+#include "tink/internal/trial_decryption.h"
 #include "tink/internal/util.h"
 #include "tink/monitoring/monitoring.h"
 #include "tink/primitive_set.h"
@@ -60,8 +61,11 @@ class  DeterministicAeadSetWrapper : public DeterministicAead {
       std::unique_ptr<MonitoringClient> monitoring_decryption_client = nullptr)
       : daead_set_(std::move(daead_set)),
         monitoring_encryption_client_(std::move(monitoring_encryption_client)),
-        monitoring_decryption_client_(std::move(monitoring_decryption_client))
-        {}
+        monitoring_decryption_client_(std::move(monitoring_decryption_client)),
+        timed_encryption_client_(internal::AsTimedMonitoringClient(
+            monitoring_encryption_client_.get())),
+        timed_decryption_client_(internal::AsTimedMonitoringClient(
+            monitoring_decryption_client_.get())) {}
 
   crypto::tink::util::StatusOr<std::string> EncryptDeterministically(
       absl::string_view plaintext,
@@ -77,11 +81,15 @@ class  DeterministicAeadSetWrapper : public DeterministicAead {
   std::unique_ptr<PrimitiveSet<DeterministicAead>> daead_set_;
   std::unique_ptr<MonitoringClient> monitoring_encryption_client_;
   std::unique_ptr<MonitoringClient> monitoring_decryption_client_;
+  // Set if the corresponding monitoring client also records latencies.
+  TimedMonitoringClient* const timed_encryption_client_;
+  TimedMonitoringClient* const timed_decryption_client_;
 };
 
 util::StatusOr<std::string>
 DeterministicAeadSetWrapper::EncryptDeterministically(
     absl::string_view plaintext, absl::string_view associated_data) const {
+  internal::MonitoringLatencyTimer timer(timed_encryption_client_);
   // BoringSSL expects a non-null pointer for plaintext and associated_data,
   // regardless of whether the size is 0.
   plaintext = internal::EnsureStringNonNull(plaintext);
@@ -99,6 +107,8 @@ DeterministicAeadSetWrapper::EncryptDeterministically(
   if (monitoring_encryption_client_ != nullptr) {
     monitoring_encryption_client_->Log(daead_set_->get_primary()->get_key_id(),
                                        plaintext.size());
+    timer.LogLatency(daead_set_->get_primary()->get_key_id(),
+                     plaintext.size());
   }
   const std::string& key_id = daead_set_->get_primary()->get_identifier();
   return key_id + encrypt_result.value();
@@ -107,9 +117,13 @@ DeterministicAeadSetWrapper::EncryptDeterministically(
 util::StatusOr<std::string>
 DeterministicAeadSetWrapper::DecryptDeterministically(
     absl::string_view ciphertext, absl::string_view associated_data) const {
+  internal::MonitoringLatencyTimer timer(timed_decryption_client_);
   // BoringSSL expects a non-null pointer for plaintext and associated_data,
   // regardless of whether the size is 0.
   associated_data = internal::EnsureStringNonNull(associated_data);
+  // Shared by all attempts, which only signal failures with a boolean so that
+  // trying many keys does not allocate a status per key.
+  std::string plaintext;
 
   if (ciphertext.length() > CryptoFormat::kNonRawPrefixSize) {
     absl::string_view key_id =
@@ -119,15 +133,18 @@ DeterministicAeadSetWrapper::DecryptDeterministically(
       absl::string_view raw_ciphertext =
           ciphertext.substr(CryptoFormat::kNonRawPrefixSize);
       for (const auto& daead_entry : *(primitives_result.value())) {
-        DeterministicAead& daead = daead_entry->get_primitive();
-        auto decrypt_result =
-            daead.DecryptDeterministically(raw_ciphertext, associated_data);
-        if (decrypt_result.ok()) {
+        util::StatusOr<DeterministicAead*> daead =
+            daead_entry->get_or_create_primitive();
+        if (!daead.ok()) continue;
+        if (internal::TryDecryptDeterministically(**daead, raw_ciphertext,
+                                                  associated_data,
+                                                  &plaintext)) {
           if (monitoring_decryption_client_ != nullptr) {
             monitoring_decryption_client_->Log(daead_entry->get_key_id(),
                                                raw_ciphertext.size());
+            timer.LogLatency(daead_entry->get_key_id(), raw_ciphertext.size());
           }
-          return std::move(decrypt_result.value());
+          return plaintext;
         } else {
           // LOG that a matching key didn't decrypt the ciphertext.
         }
@@ -136,19 +153,20 @@ DeterministicAeadSetWrapper::DecryptDeterministically(
   }
 
   // No matching key succeeded with decryption, try all RAW keys.
-  auto raw_primitives_result = daead_set_->get_raw_primitives();
-  if (raw_primitives_result.ok()) {
-    for (const auto& daead_entry : *(raw_primitives_result.value())) {
-      DeterministicAead& daead = daead_entry->get_primitive();
-      auto decrypt_result =
-          daead.DecryptDeterministically(ciphertext, associated_data);
-      if (decrypt_result.ok()) {
-        if (monitoring_decryption_client_ != nullptr) {
-          monitoring_decryption_client_->Log(daead_entry->get_key_id(),
-                                             ciphertext.size());
-        }
-        return std::move(decrypt_result.value());
+  for (const auto* daead_entry :
+       daead_set_->get_raw_primitives_in_trial_order()) {
+    util::StatusOr<DeterministicAead*> daead =
+        daead_entry->get_or_create_primitive();
+    if (!daead.ok()) continue;
+    if (internal::TryDecryptDeterministically(**daead, ciphertext,
+                                              associated_data, &plaintext)) {
+      daead_set_->RecordRawPrimitiveSuccess(daead_entry);
+      if (monitoring_decryption_client_ != nullptr) {
+        monitoring_decryption_client_->Log(daead_entry->get_key_id(),
+                                           ciphertext.size());
+        timer.LogLatency(daead_entry->get_key_id(), ciphertext.size());
       }
+      return plaintext;
     }
   }
   if (monitoring_decryption_client_ != nullptr) {
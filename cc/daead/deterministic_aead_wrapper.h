@@ -44,6 +44,9 @@ class DeterministicAeadWrapper
   crypto::tink::util::StatusOr<std::unique_ptr<DeterministicAead>> Wrap(
       std::unique_ptr<PrimitiveSet<DeterministicAead>> primitive_set)
       const override;
+
+  // Non-primary entries are only instantiated when they are first used.
+  bool SupportsLazyPrimitives() const override { return true; }
 };
 
 }  // namespace tink
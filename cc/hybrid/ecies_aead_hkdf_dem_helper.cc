@@ -22,12 +22,22 @@
 
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
+#include "absl/strings/string_view.h"
 #include "tink/aead.h"
 #include "tink/deterministic_aead.h"
-#include "tink/key_manager.h"
+#include "tink/mac.h"
 #include "tink/registry.h"
+#include "tink/subtle/aes_ctr_boringssl.h"
+#include "tink/subtle/aes_gcm_boringssl.h"
+#include "tink/subtle/aes_siv_boringssl.h"
+#include "tink/subtle/encrypt_then_authenticate.h"
+#include "tink/subtle/hmac_boringssl.h"
+#include "tink/subtle/ind_cpa_cipher.h"
+#include "tink/subtle/xchacha20_poly1305_boringssl.h"
+#include "tink/util/enums.h"
 #include "tink/util/errors.h"
-#include "tink/util/protobuf_helper.h"
+#include "tink/util/secret_data.h"
+#include "tink/util/status.h"
 #include "tink/util/statusor.h"
 #include "proto/aes_ctr.pb.h"
 #include "proto/aes_ctr_hmac_aead.pb.h"
@@ -42,43 +52,38 @@ namespace tink {
 namespace {
 
 using ::crypto::tink::subtle::AeadOrDaead;
-using ::google::crypto::tink::AesCtrHmacAeadKey;
 using ::google::crypto::tink::AesCtrHmacAeadKeyFormat;
-using ::google::crypto::tink::AesGcmKey;
 using ::google::crypto::tink::AesGcmKeyFormat;
-using ::google::crypto::tink::AesSivKey;
 using ::google::crypto::tink::AesSivKeyFormat;
+using ::google::crypto::tink::HmacParams;
 using ::google::crypto::tink::KeyTemplate;
-using ::google::crypto::tink::XChaCha20Poly1305Key;
 using ::google::crypto::tink::XChaCha20Poly1305KeyFormat;
 
-// Internal implementaton of the EciesAeadHkdfDemHelper class, paremetrized by
-// the Primitive used for data encapsulation (i.e Aead or DeterministicAead).
+// Returns an error if no key manager for 'dem_key_template' is registered or
+// if its key format is invalid. The key format is only validated here, so
+// that the DEM can be constructed directly from the key material for each
+// message.
 template <class EncryptionPrimitive>
-class EciesAeadHkdfDemHelperImpl : public EciesAeadHkdfDemHelper {
- public:
-  static util::StatusOr<std::unique_ptr<const EciesAeadHkdfDemHelper>> New(
-      const google::crypto::tink::KeyTemplate& dem_key_template,
-      const DemKeyParams& key_params, const std::string& dem_type_url) {
-    auto key_manager_or =
-        Registry::get_key_manager<EncryptionPrimitive>(dem_type_url);
-    if (!key_manager_or.ok()) {
-      return ToStatusF(
-          absl::StatusCode::kFailedPrecondition,
-          "No manager for DEM key type '%s' found in the registry.",
-          dem_type_url);
-    }
-    const KeyManager<EncryptionPrimitive>* key_manager = key_manager_or.value();
-    return {absl::make_unique<EciesAeadHkdfDemHelperImpl<EncryptionPrimitive>>(
-        key_manager, dem_key_template, key_params)};
+util::Status ValidateDemKeyTemplate(const KeyTemplate& dem_key_template) {
+  auto key_manager_or = Registry::get_key_manager<EncryptionPrimitive>(
+      dem_key_template.type_url());
+  if (!key_manager_or.ok()) {
+    return ToStatusF(absl::StatusCode::kFailedPrecondition,
+                     "No manager for DEM key type '%s' found in the registry.",
+                     dem_key_template.type_url());
   }
+  return key_manager_or.value()
+      ->get_key_factory()
+      .NewKey(dem_key_template.value())
+      .status();
+}
 
-  EciesAeadHkdfDemHelperImpl(
-      const KeyManager<EncryptionPrimitive>* key_manager,
-      const google::crypto::tink::KeyTemplate& key_template,
-      DemKeyParams key_params)
-      : EciesAeadHkdfDemHelper(key_template, key_params),
-        key_manager_(key_manager) {}
+// Internal implementaton of the EciesAeadHkdfDemHelper class, which
+// constructs the subtle primitives of the DEM directly.
+class EciesAeadHkdfDemHelperImpl : public EciesAeadHkdfDemHelper {
+ public:
+  explicit EciesAeadHkdfDemHelperImpl(DemKeyParams key_params)
+      : EciesAeadHkdfDemHelper(key_params) {}
 
  protected:
   crypto::tink::util::StatusOr<
@@ -88,24 +93,48 @@ class EciesAeadHkdfDemHelperImpl : public EciesAeadHkdfDemHelper {
       return util::Status(absl::StatusCode::kInternal,
                           "Wrong length of symmetric key.");
     }
-    auto key_or = key_manager_->get_key_factory().NewKey(key_template_.value());
-    if (!key_or.ok()) return key_or.status();
-    auto key = std::move(key_or).value();
-    if (!ReplaceKeyBytes(symmetric_key_value, key.get())) {
-      return util::Status(absl::StatusCode::kInternal,
-                          "Generation of DEM-key failed.");
+    switch (key_params_.key_type) {
+      case AES_GCM_KEY:
+        return ToAeadOrDaead(subtle::AesGcmBoringSsl::New(symmetric_key_value));
+      case AES_CTR_HMAC_AEAD_KEY:
+        return ToAeadOrDaead(NewAesCtrHmacAead(symmetric_key_value));
+      case XCHACHA20_POLY1305_KEY:
+        return ToAeadOrDaead(
+            subtle::XChacha20Poly1305BoringSsl::New(symmetric_key_value));
+      case AES_SIV_KEY:
+        return ToAeadOrDaead(subtle::AesSivBoringSsl::New(symmetric_key_value));
     }
-
-    util::StatusOr<std::unique_ptr<EncryptionPrimitive>> primitive_or =
-        key_manager_->GetPrimitive(*key);
-    ZeroKeyBytes(key.get());
-
-    if (!primitive_or.ok()) return primitive_or.status();
-    return absl::make_unique<AeadOrDaead>(std::move(primitive_or.value()));
+    return util::Status(absl::StatusCode::kInternal,
+                        "Generation of DEM-key failed.");
   }
 
  private:
-  const KeyManager<EncryptionPrimitive>* key_manager_;  // not owned
+  template <class EncryptionPrimitive>
+  static util::StatusOr<std::unique_ptr<AeadOrDaead>> ToAeadOrDaead(
+      util::StatusOr<std::unique_ptr<EncryptionPrimitive>> primitive) {
+    if (!primitive.ok()) return primitive.status();
+    return absl::make_unique<AeadOrDaead>(*std::move(primitive));
+  }
+
+  util::StatusOr<std::unique_ptr<Aead>> NewAesCtrHmacAead(
+      const util::SecretData& symmetric_key_value) const {
+    absl::string_view key_bytes =
+        util::SecretDataAsStringView(symmetric_key_value);
+    util::StatusOr<std::unique_ptr<subtle::IndCpaCipher>> aes_ctr =
+        subtle::AesCtrBoringSsl::New(
+            util::SecretDataFromStringView(
+                key_bytes.substr(0, key_params_.aes_ctr_key_size_in_bytes)),
+            key_params_.aes_ctr_iv_size_in_bytes);
+    if (!aes_ctr.ok()) return aes_ctr.status();
+    util::StatusOr<std::unique_ptr<Mac>> hmac = subtle::HmacBoringSsl::New(
+        key_params_.hmac_hash_type, key_params_.hmac_tag_size_in_bytes,
+        util::SecretDataFromStringView(
+            key_bytes.substr(key_params_.aes_ctr_key_size_in_bytes)));
+    if (!hmac.ok()) return hmac.status();
+    return subtle::EncryptThenAuthenticate::New(
+        *std::move(aes_ctr), *std::move(hmac),
+        key_params_.hmac_tag_size_in_bytes);
+  }
 };
 
 }  // namespace
@@ -129,8 +158,12 @@ EciesAeadHkdfDemHelper::GetKeyParams(const KeyTemplate& key_template) {
     }
     uint32_t dem_key_size = key_format.aes_ctr_key_format().key_size() +
                             key_format.hmac_key_format().key_size();
+    const HmacParams& hmac_params = key_format.hmac_key_format().params();
     return {{AES_CTR_HMAC_AEAD_KEY, dem_key_size,
-             key_format.aes_ctr_key_format().key_size()}};
+             key_format.aes_ctr_key_format().key_size(),
+             key_format.aes_ctr_key_format().params().iv_size(),
+             util::Enums::ProtoToSubtle(hmac_params.hash()),
+             hmac_params.tag_size()}};
   }
   if (type_url ==
       "type.googleapis.com/google.crypto.tink.XChaCha20Poly1305Key") {
@@ -159,87 +192,13 @@ EciesAeadHkdfDemHelper::New(const KeyTemplate& dem_key_template) {
   auto key_params_or = GetKeyParams(dem_key_template);
   if (!key_params_or.ok()) return key_params_or.status();
   DemKeyParams key_params = key_params_or.value();
-  const std::string& dem_type_url = dem_key_template.type_url();
-
-  if (key_params.key_type == AES_SIV_KEY) {
-    return EciesAeadHkdfDemHelperImpl<DeterministicAead>::New(
-        dem_key_template, key_params, dem_type_url);
-  } else {
-    return EciesAeadHkdfDemHelperImpl<Aead>::New(dem_key_template, key_params,
-                                                 dem_type_url);
-  }
-}
 
-bool EciesAeadHkdfDemHelper::ReplaceKeyBytes(
-    const util::SecretData& key_bytes,
-    portable_proto::MessageLite* proto) const {
-  switch (key_params_.key_type) {
-    case AES_GCM_KEY: {
-      AesGcmKey* key = static_cast<AesGcmKey*>(proto);
-      key->set_key_value(std::string(util::SecretDataAsStringView(key_bytes)));
-      return true;
-    }
-    case AES_CTR_HMAC_AEAD_KEY: {
-      AesCtrHmacAeadKey* key = static_cast<AesCtrHmacAeadKey*>(proto);
-      auto aes_ctr_key = key->mutable_aes_ctr_key();
-      aes_ctr_key->set_key_value(
-          std::string(util::SecretDataAsStringView(key_bytes).substr(
-              0, key_params_.aes_ctr_key_size_in_bytes)));
-      auto hmac_key = key->mutable_hmac_key();
-      hmac_key->set_key_value(
-          std::string(util::SecretDataAsStringView(key_bytes).substr(
-              key_params_.aes_ctr_key_size_in_bytes)));
-      return true;
-    }
-    case XCHACHA20_POLY1305_KEY: {
-      XChaCha20Poly1305Key* key = static_cast<XChaCha20Poly1305Key*>(proto);
-      key->set_key_value(std::string(util::SecretDataAsStringView(key_bytes)));
-      return true;
-    }
-    case AES_SIV_KEY: {
-      AesSivKey* key = static_cast<AesSivKey*>(proto);
-      key->set_key_value(std::string(util::SecretDataAsStringView(key_bytes)));
-      return true;
-    }
-  }
-  return false;
-}
-
-void EciesAeadHkdfDemHelper::ZeroKeyBytes(
-    portable_proto::MessageLite* proto) const {
-  switch (key_params_.key_type) {
-    case AES_GCM_KEY: {
-      AesGcmKey* key = static_cast<AesGcmKey*>(proto);
-      std::unique_ptr<std::string> key_value =
-          absl::WrapUnique(key->release_key_value());
-      util::SafeZeroString(key_value.get());
-      break;
-    }
-    case AES_CTR_HMAC_AEAD_KEY: {
-      AesCtrHmacAeadKey* key = static_cast<AesCtrHmacAeadKey*>(proto);
-      std::unique_ptr<std::string> aes_ctr_key_value =
-          absl::WrapUnique(key->mutable_aes_ctr_key()->release_key_value());
-      util::SafeZeroString(aes_ctr_key_value.get());
-      std::unique_ptr<std::string> hmac_key_value =
-          absl::WrapUnique(key->mutable_hmac_key()->release_key_value());
-      util::SafeZeroString(hmac_key_value.get());
-      break;
-    }
-    case XCHACHA20_POLY1305_KEY: {
-      XChaCha20Poly1305Key* key = static_cast<XChaCha20Poly1305Key*>(proto);
-      std::unique_ptr<std::string> key_value =
-          absl::WrapUnique(key->release_key_value());
-      util::SafeZeroString(key_value.get());
-      break;
-    }
-    case AES_SIV_KEY: {
-      AesSivKey* key = static_cast<AesSivKey*>(proto);
-      std::unique_ptr<std::string> key_value =
-          absl::WrapUnique(key->release_key_value());
-      util::SafeZeroString(key_value.get());
-      break;
-    }
-  }
+  util::Status status =
+      key_params.key_type == AES_SIV_KEY
+          ? ValidateDemKeyTemplate<DeterministicAead>(dem_key_template)
+          : ValidateDemKeyTemplate<Aead>(dem_key_template);
+  if (!status.ok()) return status;
+  return {absl::make_unique<EciesAeadHkdfDemHelperImpl>(key_params)};
 }
 
 }  // namespace tink
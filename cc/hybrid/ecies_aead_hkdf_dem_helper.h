@@ -21,8 +21,7 @@
 
 #include "tink/aead.h"
 #include "tink/daead/subtle/aead_or_daead.h"
-#include "tink/key_manager.h"
-#include "tink/util/protobuf_helper.h"
+#include "tink/subtle/common_enums.h"
 #include "tink/util/secret_data.h"
 #include "tink/util/statusor.h"
 #include "proto/tink.pb.h"
@@ -47,7 +46,8 @@ class EciesAeadHkdfDemHelper {
 
   // Creates and returns a new AeadOrDaead object that uses
   // the key material given in 'symmetric_key', which must
-  // be of length dem_key_size_in_bytes().
+  // be of length dem_key_size_in_bytes(). The DEM is constructed
+  // directly from the key material, without key protos or the registry.
   virtual crypto::tink::util::StatusOr<
       std::unique_ptr<crypto::tink::subtle::AeadOrDaead>>
   GetAeadOrDaead(const util::SecretData& symmetric_key_value) const = 0;
@@ -63,22 +63,19 @@ class EciesAeadHkdfDemHelper {
   struct DemKeyParams {
     DemKeyType key_type;
     uint32_t key_size_in_bytes;
+    // Only set for AES_CTR_HMAC_AEAD_KEY.
     uint32_t aes_ctr_key_size_in_bytes;
+    uint32_t aes_ctr_iv_size_in_bytes;
+    subtle::HashType hmac_hash_type;
+    uint32_t hmac_tag_size_in_bytes;
   };
 
-  EciesAeadHkdfDemHelper(const google::crypto::tink::KeyTemplate& key_template,
-                         DemKeyParams key_params)
-      : key_template_(key_template), key_params_(key_params) {}
+  explicit EciesAeadHkdfDemHelper(DemKeyParams key_params)
+      : key_params_(key_params) {}
 
   static util::StatusOr<DemKeyParams> GetKeyParams(
       const ::google::crypto::tink::KeyTemplate& key_template);
 
-  bool ReplaceKeyBytes(const util::SecretData& key_bytes,
-                       portable_proto::MessageLite* proto) const;
-
-  void ZeroKeyBytes(portable_proto::MessageLite* proto) const;
-
-  const google::crypto::tink::KeyTemplate key_template_;
   const DemKeyParams key_params_;
 };
 
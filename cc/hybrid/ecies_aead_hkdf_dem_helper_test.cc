@@ -23,12 +23,20 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "tink/aead.h"
+#include "tink/aead/aes_ctr_hmac_aead_key_manager.h"
 #include "tink/aead/aes_gcm_key_manager.h"
+#include "tink/aead/xchacha20_poly1305_key_manager.h"
 #include "tink/daead/aes_siv_key_manager.h"
+#include "tink/internal/ssl_util.h"
 #include "tink/registry.h"
 #include "tink/util/secret_data.h"
 #include "tink/util/test_matchers.h"
 #include "tink/util/test_util.h"
+#include "proto/aes_ctr_hmac_aead.pb.h"
+#include "proto/common.pb.h"
+#include "proto/xchacha20_poly1305.pb.h"
 
 namespace crypto {
 namespace tink {
@@ -36,8 +44,12 @@ namespace {
 
 using ::crypto::tink::subtle::AeadOrDaead;
 using ::crypto::tink::test::IsOk;
+using ::crypto::tink::test::IsOkAndHolds;
 using ::crypto::tink::test::StatusIs;
 using ::crypto::tink::util::StatusOr;
+using ::google::crypto::tink::AesCtrHmacAeadKey;
+using ::google::crypto::tink::AesCtrHmacAeadKeyFormat;
+using ::google::crypto::tink::HashType;
 using ::testing::HasSubstr;
 
 // Checks whether Decrypt(Encrypt(message)) == message with the given dem.
@@ -120,6 +132,88 @@ TEST(EciesAeadHkdfDemHelperTest, DemHelperWithSomeDeterministicAeadKeyType) {
               IsOk());
 }
 
+TEST(EciesAeadHkdfDemHelperTest, AesCtrHmacDemMatchesKeyManagerPrimitive) {
+  AesCtrHmacAeadKeyFormat key_format;
+  key_format.mutable_aes_ctr_key_format()->set_key_size(16);
+  key_format.mutable_aes_ctr_key_format()->mutable_params()->set_iv_size(16);
+  key_format.mutable_hmac_key_format()->set_key_size(32);
+  key_format.mutable_hmac_key_format()->mutable_params()->set_hash(
+      HashType::SHA256);
+  key_format.mutable_hmac_key_format()->mutable_params()->set_tag_size(16);
+  std::unique_ptr<AesCtrHmacAeadKeyManager> key_manager(
+      new AesCtrHmacAeadKeyManager());
+  std::string dem_key_type = key_manager->get_key_type();
+  ASSERT_THAT(Registry::RegisterKeyTypeManager(std::move(key_manager), true),
+              IsOk());
+
+  google::crypto::tink::KeyTemplate dem_key_template;
+  dem_key_template.set_type_url(dem_key_type);
+  dem_key_template.set_value(key_format.SerializeAsString());
+  StatusOr<std::unique_ptr<const EciesAeadHkdfDemHelper>> dem_helper =
+      EciesAeadHkdfDemHelper::New(dem_key_template);
+  ASSERT_THAT(dem_helper, IsOk());
+  ASSERT_EQ((*dem_helper)->dem_key_size_in_bytes(), 48);
+
+  std::string aes_ctr_key = test::HexDecodeOrDie(
+      "000102030405060708090a0b0c0d0e0f");
+  std::string hmac_key = test::HexDecodeOrDie(
+      "101112131415161718191a1b1c1d1e1f101112131415161718191a1b1c1d1e1f");
+  StatusOr<std::unique_ptr<AeadOrDaead>> dem =
+      (*dem_helper)
+          ->GetAeadOrDaead(util::SecretDataFromStringView(
+              absl::StrCat(aes_ctr_key, hmac_key)));
+  ASSERT_THAT(dem, IsOk());
+  EXPECT_THAT(EncryptThenDecrypt(**dem, "test_plaintext", "test_ad"), IsOk());
+
+  // The DEM is the AEAD of an AesCtrHmacAeadKey with the same key material.
+  AesCtrHmacAeadKey key;
+  key.mutable_aes_ctr_key()->set_key_value(aes_ctr_key);
+  *key.mutable_aes_ctr_key()->mutable_params() =
+      key_format.aes_ctr_key_format().params();
+  key.mutable_hmac_key()->set_key_value(hmac_key);
+  *key.mutable_hmac_key()->mutable_params() =
+      key_format.hmac_key_format().params();
+  StatusOr<std::unique_ptr<Aead>> aead =
+      AesCtrHmacAeadKeyManager().GetPrimitive<Aead>(key);
+  ASSERT_THAT(aead, IsOk());
+  StatusOr<std::string> ciphertext =
+      (*dem)->Encrypt("test_plaintext", "test_ad");
+  ASSERT_THAT(ciphertext, IsOk());
+  EXPECT_THAT((*aead)->Decrypt(*ciphertext, "test_ad"),
+              IsOkAndHolds("test_plaintext"));
+}
+
+TEST(EciesAeadHkdfDemHelperTest, XChaCha20Poly1305Dem) {
+  if (!internal::IsBoringSsl()) {
+    GTEST_SKIP() << "XChaCha20-Poly1305 is not supported when OpenSSL is used";
+  }
+  std::unique_ptr<XChaCha20Poly1305KeyManager> key_manager(
+      new XChaCha20Poly1305KeyManager());
+  std::string dem_key_type = key_manager->get_key_type();
+  ASSERT_THAT(Registry::RegisterKeyTypeManager(std::move(key_manager), true),
+              IsOk());
+
+  google::crypto::tink::KeyTemplate dem_key_template;
+  dem_key_template.set_type_url(dem_key_type);
+  dem_key_template.set_value(
+      google::crypto::tink::XChaCha20Poly1305KeyFormat().SerializeAsString());
+  StatusOr<std::unique_ptr<const EciesAeadHkdfDemHelper>> dem_helper =
+      EciesAeadHkdfDemHelper::New(dem_key_template);
+  ASSERT_THAT(dem_helper, IsOk());
+  ASSERT_EQ((*dem_helper)->dem_key_size_in_bytes(), 32);
+
+  StatusOr<std::unique_ptr<AeadOrDaead>> dem =
+      (*dem_helper)->GetAeadOrDaead(util::SecretDataFromStringView(
+          std::string(32, 'k')));
+  ASSERT_THAT(dem, IsOk());
+  EXPECT_THAT(EncryptThenDecrypt(**dem, "test_plaintext", "test_ad"), IsOk());
+  EXPECT_THAT((*dem_helper)
+                  ->GetAeadOrDaead(util::SecretDataFromStringView(
+                      std::string(16, 'k')))
+                  .status(),
+              StatusIs(absl::StatusCode::kInternal));
+}
+
 }  // namespace
 }  // namespace tink
 }  // namespace crypto
@@ -312,6 +312,57 @@ TEST_F(EciesAeadHkdfHybridDecryptTest, testAesSivHybridDecryption) {
   }
 }
 
+TEST_F(EciesAeadHkdfHybridDecryptTest, EncryptWithEphemeralKeyPool) {
+  ASSERT_TRUE(Registry::RegisterKeyTypeManager(
+                  absl::make_unique<AesGcmKeyManager>(), true)
+                  .ok());
+  for (auto key_params : GetCommonHybridKeyParamsList()) {
+    auto ecies_key = test::GetEciesAesGcmHkdfTestKey(
+        key_params.ec_curve, key_params.ec_point_format, key_params.hash_type,
+        16);
+    auto hybrid_encrypt =
+        EciesAeadHkdfHybridEncrypt::New(ecies_key.public_key(), 2);
+    ASSERT_TRUE(hybrid_encrypt.ok()) << hybrid_encrypt.status();
+    auto hybrid_decrypt = EciesAeadHkdfHybridDecrypt::New(ecies_key);
+    ASSERT_TRUE(hybrid_decrypt.ok()) << hybrid_decrypt.status();
+    ASSERT_THAT((*hybrid_encrypt)->RefillEphemeralKeyPool(), IsOkAndHolds(2));
+
+    // The first two ciphertexts use precomputed key pairs, the third one does
+    // not.
+    std::vector<std::string> kem_bytes;
+    for (int i = 0; i < 3; ++i) {
+      auto ciphertext =
+          (*hybrid_encrypt)->Encrypt("some plaintext", "some context info");
+      ASSERT_TRUE(ciphertext.ok()) << ciphertext.status();
+      EXPECT_THAT(
+          (*hybrid_decrypt)->Decrypt(*ciphertext, "some context info"),
+          IsOkAndHolds(Eq("some plaintext")));
+      for (const std::string& previous : kem_bytes) {
+        EXPECT_NE(ciphertext->substr(0, previous.size()), previous);
+      }
+      kem_bytes.push_back(ciphertext->substr(0, 32));
+    }
+  }
+}
+
+TEST_F(EciesAeadHkdfHybridDecryptTest, RefillWithoutEphemeralKeyPoolFails) {
+  ASSERT_TRUE(Registry::RegisterKeyTypeManager(
+                  absl::make_unique<AesGcmKeyManager>(), true)
+                  .ok());
+  auto ecies_key = test::GetEciesAesGcmHkdfTestKey(
+      EllipticCurveType::NIST_P256, EcPointFormat::UNCOMPRESSED,
+      HashType::SHA256, 16);
+  auto hybrid_encrypt =
+      EciesAeadHkdfHybridEncrypt::New(ecies_key.public_key(), 0);
+  ASSERT_TRUE(hybrid_encrypt.ok()) << hybrid_encrypt.status();
+  EXPECT_EQ((*hybrid_encrypt)->RefillEphemeralKeyPool().status().code(),
+            absl::StatusCode::kFailedPrecondition);
+  EXPECT_EQ(EciesAeadHkdfHybridEncrypt::New(ecies_key.public_key(), -1)
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
 struct TestVector {
   EciesAeadHkdfPrivateKey private_key;
   std::string ciphertext;
@@ -64,13 +64,23 @@ util::Status Validate(const EciesAeadHkdfPublicKey& key) {
 // static
 util::StatusOr<std::unique_ptr<HybridEncrypt>> EciesAeadHkdfHybridEncrypt::New(
     const EciesAeadHkdfPublicKey& recipient_key) {
+  util::StatusOr<std::unique_ptr<EciesAeadHkdfHybridEncrypt>> hybrid_encrypt =
+      New(recipient_key, /*ephemeral_key_pool_capacity=*/0);
+  if (!hybrid_encrypt.ok()) return hybrid_encrypt.status();
+  return {*std::move(hybrid_encrypt)};
+}
+
+// static
+util::StatusOr<std::unique_ptr<EciesAeadHkdfHybridEncrypt>>
+EciesAeadHkdfHybridEncrypt::New(const EciesAeadHkdfPublicKey& recipient_key,
+                                int ephemeral_key_pool_capacity) {
   util::Status status = Validate(recipient_key);
   if (!status.ok()) return status;
 
   auto kem_result = subtle::EciesHkdfSenderKemBoringSsl::New(
       util::Enums::ProtoToSubtle(
           recipient_key.params().kem_params().curve_type()),
-      recipient_key.x(), recipient_key.y());
+      recipient_key.x(), recipient_key.y(), ephemeral_key_pool_capacity);
   if (!kem_result.ok()) return kem_result.status();
 
   auto dem_result = EciesAeadHkdfDemHelper::New(
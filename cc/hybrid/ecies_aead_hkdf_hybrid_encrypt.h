@@ -39,10 +39,26 @@ class EciesAeadHkdfHybridEncrypt : public HybridEncrypt {
   static crypto::tink::util::StatusOr<std::unique_ptr<HybridEncrypt>> New(
       const google::crypto::tink::EciesAeadHkdfPublicKey& recipient_key);
 
+  // Same as above, but keeps a pool of at most `ephemeral_key_pool_capacity`
+  // precomputed ephemeral key pairs, which Encrypt() uses while the pool is
+  // not empty. Each key pair is used for one ciphertext only.
+  static crypto::tink::util::StatusOr<
+      std::unique_ptr<EciesAeadHkdfHybridEncrypt>>
+  New(const google::crypto::tink::EciesAeadHkdfPublicKey& recipient_key,
+      int ephemeral_key_pool_capacity);
+
   crypto::tink::util::StatusOr<std::string> Encrypt(
       absl::string_view plaintext,
       absl::string_view context_info) const override;
 
+  // Precomputes ephemeral key pairs until the pool is full, and returns the
+  // number of key pairs that were added. Meant to be called from a
+  // background thread while the primitive is idle. Returns an error if the
+  // primitive was created without a pool.
+  crypto::tink::util::StatusOr<int> RefillEphemeralKeyPool() const {
+    return sender_kem_->RefillEphemeralKeyPool();
+  }
+
  private:
   EciesAeadHkdfHybridEncrypt(
       const google::crypto::tink::EciesAeadHkdfPublicKey& recipient_key,
@@ -0,0 +1,149 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/hybrid/hpke_session.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "tink/hybrid/internal/hpke_context.h"
+#include "tink/hybrid/internal/hpke_util.h"
+#include "tink/util/secret_data.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "proto/hpke.pb.h"
+
+namespace crypto {
+namespace tink {
+
+namespace {
+
+util::Status MessageLimitReached() {
+  return util::Status(absl::StatusCode::kResourceExhausted,
+                      "HPKE session message limit reached.");
+}
+
+}  // namespace
+
+using ::google::crypto::tink::HpkePrivateKey;
+using ::google::crypto::tink::HpkePublicKey;
+
+util::StatusOr<std::unique_ptr<HpkeSenderSession>> HpkeSenderSession::New(
+    const HpkePublicKey& recipient_public_key, absl::string_view context_info) {
+  if (!recipient_public_key.has_params()) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "Recipient public key is missing HPKE parameters.");
+  }
+  util::StatusOr<internal::HpkeParams> params =
+      internal::HpkeParamsProtoToStruct(recipient_public_key.params());
+  if (!params.ok()) return params.status();
+  util::StatusOr<std::unique_ptr<internal::HpkeContext>> context =
+      internal::HpkeContext::SetupSender(
+          *params, recipient_public_key.public_key(), context_info);
+  if (!context.ok()) return context.status();
+  return absl::WrapUnique(new HpkeSenderSession(*std::move(context)));
+}
+
+util::StatusOr<std::string> HpkeSenderSession::Seal(
+    absl::string_view plaintext, absl::string_view associated_data) {
+  absl::MutexLock lock(&mutex_);
+  if (broken_) {
+    return util::Status(absl::StatusCode::kFailedPrecondition,
+                        "HPKE session failed to seal a batch of messages.");
+  }
+  if (num_messages_ >= kMaxHpkeSessionMessages) return MessageLimitReached();
+  util::StatusOr<std::string> ciphertext =
+      context_->Seal(plaintext, associated_data);
+  if (ciphertext.ok()) ++num_messages_;
+  return ciphertext;
+}
+
+util::StatusOr<std::vector<std::string>> HpkeSenderSession::SealBatch(
+    absl::Span<const absl::string_view> plaintexts,
+    absl::string_view associated_data) {
+  absl::MutexLock lock(&mutex_);
+  if (broken_) {
+    return util::Status(absl::StatusCode::kFailedPrecondition,
+                        "HPKE session failed to seal a batch of messages.");
+  }
+  if (plaintexts.size() > kMaxHpkeSessionMessages - num_messages_) {
+    return MessageLimitReached();
+  }
+  std::vector<std::string> ciphertexts;
+  ciphertexts.reserve(plaintexts.size());
+  for (absl::string_view plaintext : plaintexts) {
+    util::StatusOr<std::string> ciphertext =
+        context_->Seal(plaintext, associated_data);
+    if (!ciphertext.ok()) {
+      broken_ = !ciphertexts.empty();
+      return ciphertext.status();
+    }
+    ciphertexts.push_back(*std::move(ciphertext));
+    ++num_messages_;
+  }
+  return std::move(ciphertexts);
+}
+
+uint64_t HpkeSenderSession::num_messages() const {
+  absl::MutexLock lock(&mutex_);
+  return num_messages_;
+}
+
+util::StatusOr<std::unique_ptr<HpkeRecipientSession>> HpkeRecipientSession::New(
+    const HpkePrivateKey& recipient_private_key,
+    absl::string_view encapsulated_key, absl::string_view context_info) {
+  if (!recipient_private_key.public_key().has_params()) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "Recipient private key is missing HPKE parameters.");
+  }
+  util::StatusOr<internal::HpkeParams> params =
+      internal::HpkeParamsProtoToStruct(
+          recipient_private_key.public_key().params());
+  if (!params.ok()) return params.status();
+  util::StatusOr<std::unique_ptr<internal::HpkeContext>> context =
+      internal::HpkeContext::SetupRecipient(
+          *params,
+          util::SecretDataFromStringView(recipient_private_key.private_key()),
+          encapsulated_key, context_info);
+  if (!context.ok()) return context.status();
+  return absl::WrapUnique(new HpkeRecipientSession(*std::move(context)));
+}
+
+util::StatusOr<std::string> HpkeRecipientSession::Open(
+    absl::string_view ciphertext, absl::string_view associated_data) {
+  absl::MutexLock lock(&mutex_);
+  if (num_messages_ >= kMaxHpkeSessionMessages) return MessageLimitReached();
+  util::StatusOr<std::string> plaintext =
+      context_->Open(ciphertext, associated_data);
+  if (plaintext.ok()) ++num_messages_;
+  return plaintext;
+}
+
+uint64_t HpkeRecipientSession::num_messages() const {
+  absl::MutexLock lock(&mutex_);
+  return num_messages_;
+}
+
+}  // namespace tink
+}  // namespace crypto
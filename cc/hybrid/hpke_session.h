@@ -0,0 +1,132 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_HYBRID_HPKE_SESSION_H_
+#define TINK_HYBRID_HPKE_SESSION_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "tink/hybrid/internal/hpke_context.h"
+#include "tink/util/statusor.h"
+#include "proto/hpke.pb.h"
+
+namespace crypto {
+namespace tink {
+
+// Long-lived HPKE (RFC 9180) sessions, for sending a sequence of messages to
+// the same recipient with a single key encapsulation. HybridEncrypt, in
+// contrast, performs a key encapsulation for every message.
+//
+// The sender sends EncapsulatedKey() to the recipient once, followed by the
+// ciphertexts of the messages. Each message is encrypted with a nonce derived
+// from its position in the session, so the recipient must open the messages
+// in the order in which they were sealed, and the transport must neither
+// drop nor reorder them. A message that fails to open does not advance the
+// position of the recipient.
+//
+// A session seals or opens at most kMaxHpkeSessionMessages messages; after
+// that, a new session must be set up. Sessions are thread-safe, but messages
+// sealed concurrently are ordered arbitrarily.
+
+// Maximum number of messages of a session.
+constexpr uint64_t kMaxHpkeSessionMessages = uint64_t{1} << 32;
+
+class HpkeSenderSession {
+ public:
+  // Sets up a session with the recipient of `recipient_public_key`.
+  // `context_info` is bound to the session, like the context info of
+  // HybridEncrypt.
+  static crypto::tink::util::StatusOr<std::unique_ptr<HpkeSenderSession>> New(
+      const google::crypto::tink::HpkePublicKey& recipient_public_key,
+      absl::string_view context_info);
+
+  // Not copyable or movable.
+  HpkeSenderSession(const HpkeSenderSession&) = delete;
+  HpkeSenderSession& operator=(const HpkeSenderSession&) = delete;
+
+  // KEM encapsulation that the recipient needs to set up its session.
+  absl::string_view EncapsulatedKey() const {
+    return context_->EncapsulatedKey();
+  }
+
+  // Encrypts `plaintext` as the next message of the session.
+  crypto::tink::util::StatusOr<std::string> Seal(
+      absl::string_view plaintext, absl::string_view associated_data);
+
+  // Encrypts `plaintexts` as the next messages of the session, in order, with
+  // the same `associated_data`. Fails without sealing any message if the
+  // session does not have room for all of them. If sealing fails midway, the
+  // session cannot be used anymore, since the recipient would not be able to
+  // open the following messages.
+  crypto::tink::util::StatusOr<std::vector<std::string>> SealBatch(
+      absl::Span<const absl::string_view> plaintexts,
+      absl::string_view associated_data);
+
+  // Number of messages sealed so far.
+  uint64_t num_messages() const;
+
+ private:
+  explicit HpkeSenderSession(std::unique_ptr<internal::HpkeContext> context)
+      : context_(std::move(context)) {}
+
+  mutable absl::Mutex mutex_;
+  // Sealing and opening is serialized by `mutex_`.
+  const std::unique_ptr<internal::HpkeContext> context_;
+  uint64_t num_messages_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool broken_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+class HpkeRecipientSession {
+ public:
+  // Sets up the recipient side of the session of which the sender returned
+  // `encapsulated_key`, with the same `context_info`.
+  static crypto::tink::util::StatusOr<std::unique_ptr<HpkeRecipientSession>>
+  New(const google::crypto::tink::HpkePrivateKey& recipient_private_key,
+      absl::string_view encapsulated_key, absl::string_view context_info);
+
+  // Not copyable or movable.
+  HpkeRecipientSession(const HpkeRecipientSession&) = delete;
+  HpkeRecipientSession& operator=(const HpkeRecipientSession&) = delete;
+
+  // Decrypts `ciphertext`, which must be the next message of the session.
+  crypto::tink::util::StatusOr<std::string> Open(
+      absl::string_view ciphertext, absl::string_view associated_data);
+
+  // Number of messages opened so far.
+  uint64_t num_messages() const;
+
+ private:
+  explicit HpkeRecipientSession(std::unique_ptr<internal::HpkeContext> context)
+      : context_(std::move(context)) {}
+
+  mutable absl::Mutex mutex_;
+  // Sealing and opening is serialized by `mutex_`.
+  const std::unique_ptr<internal::HpkeContext> context_;
+  uint64_t num_messages_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_HYBRID_HPKE_SESSION_H_
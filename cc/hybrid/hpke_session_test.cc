@@ -0,0 +1,170 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/hybrid/hpke_session.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tink/hybrid/internal/hpke_test_util.h"
+#include "tink/util/statusor.h"
+#include "tink/util/test_matchers.h"
+#include "proto/hpke.pb.h"
+
+namespace crypto {
+namespace tink {
+namespace {
+
+using ::crypto::tink::internal::CreateHpkeParams;
+using ::crypto::tink::internal::CreateHpkePrivateKey;
+using ::crypto::tink::internal::CreateHpkePublicKey;
+using ::crypto::tink::internal::DefaultHpkeTestParams;
+using ::crypto::tink::internal::HpkeTestParams;
+using ::crypto::tink::test::IsOk;
+using ::crypto::tink::test::IsOkAndHolds;
+using ::crypto::tink::test::StatusIs;
+using ::google::crypto::tink::HpkeAead;
+using ::google::crypto::tink::HpkeKdf;
+using ::google::crypto::tink::HpkeKem;
+using ::google::crypto::tink::HpkeParams;
+using ::testing::Eq;
+using ::testing::Not;
+using ::testing::SizeIs;
+
+class HpkeSessionTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    HpkeParams hpke_params =
+        CreateHpkeParams(HpkeKem::DHKEM_X25519_HKDF_SHA256,
+                         HpkeKdf::HKDF_SHA256, HpkeAead::AES_128_GCM);
+    HpkeTestParams params = DefaultHpkeTestParams();
+    util::StatusOr<std::unique_ptr<HpkeSenderSession>> sender =
+        HpkeSenderSession::New(
+            CreateHpkePublicKey(hpke_params, params.recipient_public_key),
+            "context info");
+    ASSERT_THAT(sender, IsOk());
+    sender_ = *std::move(sender);
+    util::StatusOr<std::unique_ptr<HpkeRecipientSession>> recipient =
+        HpkeRecipientSession::New(
+            CreateHpkePrivateKey(hpke_params, params.recipient_private_key),
+            sender_->EncapsulatedKey(), "context info");
+    ASSERT_THAT(recipient, IsOk());
+    recipient_ = *std::move(recipient);
+  }
+
+  std::unique_ptr<HpkeSenderSession> sender_;
+  std::unique_ptr<HpkeRecipientSession> recipient_;
+};
+
+TEST_F(HpkeSessionTest, SealAndOpenInOrder) {
+  std::vector<std::string> ciphertexts;
+  for (int i = 0; i < 10; ++i) {
+    util::StatusOr<std::string> ciphertext =
+        sender_->Seal(absl::StrCat("message ", i), "associated data");
+    ASSERT_THAT(ciphertext, IsOk());
+    ciphertexts.push_back(*ciphertext);
+  }
+  EXPECT_THAT(sender_->num_messages(), Eq(10));
+
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_THAT(recipient_->Open(ciphertexts[i], "associated data"),
+                IsOkAndHolds(Eq(absl::StrCat("message ", i))));
+  }
+  EXPECT_THAT(recipient_->num_messages(), Eq(10));
+}
+
+TEST_F(HpkeSessionTest, SealBatch) {
+  util::StatusOr<std::string> first = sender_->Seal("first", "");
+  ASSERT_THAT(first, IsOk());
+  std::vector<absl::string_view> plaintexts = {"a", "b", "", "d"};
+  util::StatusOr<std::vector<std::string>> ciphertexts =
+      sender_->SealBatch(plaintexts, "associated data");
+  ASSERT_THAT(ciphertexts, IsOk());
+  ASSERT_THAT(*ciphertexts, SizeIs(plaintexts.size()));
+  EXPECT_THAT(sender_->num_messages(), Eq(5));
+
+  EXPECT_THAT(recipient_->Open(*first, ""), IsOkAndHolds(Eq("first")));
+  for (int i = 0; i < plaintexts.size(); ++i) {
+    EXPECT_THAT(recipient_->Open((*ciphertexts)[i], "associated data"),
+                IsOkAndHolds(Eq(plaintexts[i])));
+  }
+}
+
+TEST_F(HpkeSessionTest, OpenOutOfOrderFails) {
+  util::StatusOr<std::string> first = sender_->Seal("first", "");
+  ASSERT_THAT(first, IsOk());
+  util::StatusOr<std::string> second = sender_->Seal("second", "");
+  ASSERT_THAT(second, IsOk());
+
+  EXPECT_THAT(recipient_->Open(*second, ""), Not(IsOk()));
+  // The failed message does not advance the recipient.
+  EXPECT_THAT(recipient_->num_messages(), Eq(0));
+  EXPECT_THAT(recipient_->Open(*first, ""), IsOkAndHolds(Eq("first")));
+  EXPECT_THAT(recipient_->Open(*second, ""), IsOkAndHolds(Eq("second")));
+}
+
+TEST_F(HpkeSessionTest, OpenWithWrongAssociatedDataFails) {
+  util::StatusOr<std::string> ciphertext = sender_->Seal("message", "ad");
+  ASSERT_THAT(ciphertext, IsOk());
+
+  EXPECT_THAT(recipient_->Open(*ciphertext, "other ad"), Not(IsOk()));
+  EXPECT_THAT(recipient_->Open(*ciphertext, "ad"),
+              IsOkAndHolds(Eq("message")));
+}
+
+TEST_F(HpkeSessionTest, RecipientWithWrongContextInfoFails) {
+  HpkeParams hpke_params =
+      CreateHpkeParams(HpkeKem::DHKEM_X25519_HKDF_SHA256, HpkeKdf::HKDF_SHA256,
+                       HpkeAead::AES_128_GCM);
+  util::StatusOr<std::unique_ptr<HpkeRecipientSession>> recipient =
+      HpkeRecipientSession::New(
+          CreateHpkePrivateKey(hpke_params,
+                               DefaultHpkeTestParams().recipient_private_key),
+          sender_->EncapsulatedKey(), "other context info");
+  ASSERT_THAT(recipient, IsOk());
+  util::StatusOr<std::string> ciphertext = sender_->Seal("message", "");
+  ASSERT_THAT(ciphertext, IsOk());
+
+  EXPECT_THAT((*recipient)->Open(*ciphertext, ""), Not(IsOk()));
+}
+
+TEST(HpkeSessionNewTest, BadParamsFail) {
+  HpkeParams hpke_params = CreateHpkeParams(
+      HpkeKem::KEM_UNKNOWN, HpkeKdf::HKDF_SHA256, HpkeAead::AES_128_GCM);
+  HpkeTestParams params = DefaultHpkeTestParams();
+  EXPECT_THAT(HpkeSenderSession::New(CreateHpkePublicKey(
+                                         hpke_params,
+                                         params.recipient_public_key),
+                                     "")
+                  .status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(HpkeRecipientSession::New(
+                  CreateHpkePrivateKey(hpke_params,
+                                       params.recipient_private_key),
+                  params.encapsulated_key, "")
+                  .status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
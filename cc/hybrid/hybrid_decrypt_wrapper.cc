@@ -45,8 +45,9 @@ class HybridDecryptSetWrapper : public HybridDecrypt {
       std::unique_ptr<PrimitiveSet<HybridDecrypt>> hybrid_decrypt_set,
       std::unique_ptr<MonitoringClient> monitoring_decryption_client = nullptr)
       : hybrid_decrypt_set_(std::move(hybrid_decrypt_set)),
-        monitoring_decryption_client_(std::move(monitoring_decryption_client)) {
-  }
+        monitoring_decryption_client_(std::move(monitoring_decryption_client)),
+        timed_decryption_client_(internal::AsTimedMonitoringClient(
+            monitoring_decryption_client_.get())) {}
 
   crypto::tink::util::StatusOr<std::string> Decrypt(
       absl::string_view ciphertext,
@@ -57,10 +58,13 @@ class HybridDecryptSetWrapper : public HybridDecrypt {
  private:
   std::unique_ptr<PrimitiveSet<HybridDecrypt>> hybrid_decrypt_set_;
   std::unique_ptr<MonitoringClient> monitoring_decryption_client_;
+  // Set if monitoring_decryption_client_ also records latencies.
+  TimedMonitoringClient* const timed_decryption_client_;
 };
 
 util::StatusOr<std::string> HybridDecryptSetWrapper::Decrypt(
     absl::string_view ciphertext, absl::string_view context_info) const {
+  internal::MonitoringLatencyTimer timer(timed_decryption_client_);
   // BoringSSL expects a non-null pointer for context_info,
   // regardless of whether the size is 0.
   context_info = internal::EnsureStringNonNull(context_info);
@@ -73,13 +77,17 @@ util::StatusOr<std::string> HybridDecryptSetWrapper::Decrypt(
       absl::string_view raw_ciphertext =
           ciphertext.substr(CryptoFormat::kNonRawPrefixSize);
       for (auto& hybrid_decrypt_entry : *(primitives_result.value())) {
-        HybridDecrypt& hybrid_decrypt = hybrid_decrypt_entry->get_primitive();
+        util::StatusOr<HybridDecrypt*> hybrid_decrypt =
+            hybrid_decrypt_entry->get_or_create_primitive();
+        if (!hybrid_decrypt.ok()) continue;
         auto decrypt_result =
-            hybrid_decrypt.Decrypt(raw_ciphertext, context_info);
+            (*hybrid_decrypt)->Decrypt(raw_ciphertext, context_info);
         if (decrypt_result.ok()) {
           if (monitoring_decryption_client_ != nullptr) {
             monitoring_decryption_client_->Log(
                 hybrid_decrypt_entry->get_key_id(), ciphertext.size());
+            timer.LogLatency(hybrid_decrypt_entry->get_key_id(),
+                             ciphertext.size());
           }
           return std::move(decrypt_result.value());
         } else {
@@ -90,14 +98,15 @@ util::StatusOr<std::string> HybridDecryptSetWrapper::Decrypt(
   }
 
   // No matching key succeeded with decryption, try all RAW keys.
-  auto raw_primitives_result = hybrid_decrypt_set_->get_raw_primitives();
-  if (raw_primitives_result.ok()) {
-    for (auto& hybrid_decrypt_entry : *(raw_primitives_result.value())) {
-      HybridDecrypt& hybrid_decrypt = hybrid_decrypt_entry->get_primitive();
-      auto decrypt_result = hybrid_decrypt.Decrypt(ciphertext, context_info);
-      if (decrypt_result.ok()) {
-        return std::move(decrypt_result.value());
-      }
+  for (auto* hybrid_decrypt_entry :
+       hybrid_decrypt_set_->get_raw_primitives_in_trial_order()) {
+    util::StatusOr<HybridDecrypt*> hybrid_decrypt =
+        hybrid_decrypt_entry->get_or_create_primitive();
+    if (!hybrid_decrypt.ok()) continue;
+    auto decrypt_result = (*hybrid_decrypt)->Decrypt(ciphertext, context_info);
+    if (decrypt_result.ok()) {
+      hybrid_decrypt_set_->RecordRawPrimitiveSuccess(hybrid_decrypt_entry);
+      return std::move(decrypt_result.value());
     }
   }
   if (monitoring_decryption_client_ != nullptr) {
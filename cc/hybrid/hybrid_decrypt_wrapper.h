@@ -38,6 +38,9 @@ class HybridDecryptWrapper
   util::StatusOr<std::unique_ptr<HybridDecrypt>> Wrap(
       std::unique_ptr<PrimitiveSet<HybridDecrypt>> primitive_set)
       const override;
+
+  // Non-primary entries are only instantiated when they are first used.
+  bool SupportsLazyPrimitives() const override { return true; }
 };
 
 }  // namespace tink
@@ -60,8 +60,9 @@ class HybridEncryptSetWrapper : public HybridEncrypt {
       std::unique_ptr<PrimitiveSet<HybridEncrypt>> hybrid_encrypt_set,
       std::unique_ptr<MonitoringClient> monitoring_encryption_client = nullptr)
       : hybrid_encrypt_set_(std::move(hybrid_encrypt_set)),
-        monitoring_encryption_client_(std::move(monitoring_encryption_client)) {
-  }
+        monitoring_encryption_client_(std::move(monitoring_encryption_client)),
+        timed_encryption_client_(internal::AsTimedMonitoringClient(
+            monitoring_encryption_client_.get())) {}
 
   crypto::tink::util::StatusOr<std::string> Encrypt(
       absl::string_view plaintext,
@@ -72,10 +73,13 @@ class HybridEncryptSetWrapper : public HybridEncrypt {
  private:
   std::unique_ptr<PrimitiveSet<HybridEncrypt>> hybrid_encrypt_set_;
   std::unique_ptr<MonitoringClient> monitoring_encryption_client_;
+  // Set if monitoring_encryption_client_ also records latencies.
+  TimedMonitoringClient* const timed_encryption_client_;
 };
 
 util::StatusOr<std::string> HybridEncryptSetWrapper::Encrypt(
     absl::string_view plaintext, absl::string_view context_info) const {
+  internal::MonitoringLatencyTimer timer(timed_encryption_client_);
   // BoringSSL expects a non-null pointer for plaintext and context_info,
   // regardless of whether the size is 0.
   plaintext = internal::EnsureStringNonNull(plaintext);
@@ -93,6 +97,8 @@ util::StatusOr<std::string> HybridEncryptSetWrapper::Encrypt(
   if (monitoring_encryption_client_ != nullptr) {
     monitoring_encryption_client_->Log(
         hybrid_encrypt_set_->get_primary()->get_key_id(), plaintext.size());
+    timer.LogLatency(hybrid_encrypt_set_->get_primary()->get_key_id(),
+                     plaintext.size());
   }
   const std::string& key_id = primary->get_identifier();
   return key_id + encrypt_result.value();
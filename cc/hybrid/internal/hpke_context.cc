@@ -56,8 +56,24 @@ util::StatusOr<std::unique_ptr<HpkeContext>> HpkeContext::SetupSender(
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "Recipient public key is empty.");
   }
+  util::StatusOr<HpkeAlgorithmsBoringSsl> algorithms =
+      HpkeAlgorithmsBoringSsl::New(params);
+  if (!algorithms.ok()) {
+    return algorithms.status();
+  }
+  return SetupSender(*algorithms, recipient_public_key, info);
+}
+
+util::StatusOr<std::unique_ptr<HpkeContext>> HpkeContext::SetupSender(
+    const HpkeAlgorithmsBoringSsl& algorithms,
+    absl::string_view recipient_public_key, absl::string_view info) {
+  if (recipient_public_key.empty()) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "Recipient public key is empty.");
+  }
   util::StatusOr<SenderHpkeContextBoringSsl> sender_context =
-      HpkeContextBoringSsl::SetupSender(params, recipient_public_key, info);
+      HpkeContextBoringSsl::SetupSender(algorithms, recipient_public_key,
+                                        info);
   if (!sender_context.ok()) {
     return sender_context.status();
   }
@@ -76,9 +92,24 @@ util::StatusOr<std::unique_ptr<HpkeContext>> HpkeContext::SetupRecipient(
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "Encapsulated key is empty.");
   }
+  util::StatusOr<std::unique_ptr<HpkeRecipientKeyBoringSsl>> recipient_key =
+      HpkeRecipientKeyBoringSsl::New(params, recipient_private_key);
+  if (!recipient_key.ok()) {
+    return recipient_key.status();
+  }
+  return SetupRecipient(**recipient_key, encapsulated_key, info);
+}
+
+util::StatusOr<std::unique_ptr<HpkeContext>> HpkeContext::SetupRecipient(
+    const HpkeRecipientKeyBoringSsl& recipient_key,
+    absl::string_view encapsulated_key, absl::string_view info) {
+  if (encapsulated_key.empty()) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "Encapsulated key is empty.");
+  }
   util::StatusOr<std::unique_ptr<HpkeContextBoringSsl>> context =
-      HpkeContextBoringSsl::SetupRecipient(params, recipient_private_key,
-                                           encapsulated_key, info);
+      HpkeContextBoringSsl::SetupRecipient(recipient_key, encapsulated_key,
+                                           info);
   if (!context.ok()) {
     return context.status();
   }
@@ -69,6 +69,12 @@ class HpkeContext {
       const HpkeParams& params, absl::string_view recipient_public_key,
       absl::string_view info);
 
+  // Same as above, but with algorithms that were already resolved, for
+  // setting up many sender contexts with the same parameters.
+  static crypto::tink::util::StatusOr<std::unique_ptr<HpkeContext>> SetupSender(
+      const HpkeAlgorithmsBoringSsl& algorithms,
+      absl::string_view recipient_public_key, absl::string_view info);
+
   // Sets up an HPKE recipient context.  Returns an error if initialization
   // fails.  Otherwise, returns a unique pointer to the recipient context.
   //
@@ -81,6 +87,12 @@ class HpkeContext {
                  const util::SecretData& recipient_private_key,
                  absl::string_view encapsulated_key, absl::string_view info);
 
+  // Same as above, but with a recipient key that was already parsed, for
+  // setting up many recipient contexts with the same key.
+  static crypto::tink::util::StatusOr<std::unique_ptr<HpkeContext>>
+  SetupRecipient(const HpkeRecipientKeyBoringSsl& recipient_key,
+                 absl::string_view encapsulated_key, absl::string_view info);
+
   absl::string_view EncapsulatedKey() const {
     return encapsulated_key_;
   }
@@ -34,10 +34,8 @@ namespace crypto {
 namespace tink {
 namespace internal {
 
-util::StatusOr<SenderHpkeContextBoringSsl>
-HpkeContextBoringSsl::SetupSender(const HpkeParams& params,
-                                  absl::string_view recipient_public_key,
-                                  absl::string_view context_info) {
+util::StatusOr<HpkeAlgorithmsBoringSsl> HpkeAlgorithmsBoringSsl::New(
+    const HpkeParams& params) {
   util::StatusOr<const EVP_HPKE_KEM *> kem = KemParam(params);
   if (!kem.ok()) {
     return kem.status();
@@ -50,11 +48,52 @@ HpkeContextBoringSsl::SetupSender(const HpkeParams& params,
   if (!aead.ok()) {
     return aead.status();
   }
+  return HpkeAlgorithmsBoringSsl{*kem, *kdf, *aead};
+}
+
+util::StatusOr<std::unique_ptr<HpkeRecipientKeyBoringSsl>>
+HpkeRecipientKeyBoringSsl::New(const HpkeParams& params,
+                               const util::SecretData& recipient_private_key) {
+  util::StatusOr<HpkeAlgorithmsBoringSsl> algorithms =
+      HpkeAlgorithmsBoringSsl::New(params);
+  if (!algorithms.ok()) {
+    return algorithms.status();
+  }
+  auto recipient_key =
+      absl::WrapUnique(new HpkeRecipientKeyBoringSsl(*algorithms));
+  if (!EVP_HPKE_KEY_init(
+          recipient_key->key_.get(), algorithms->kem,
+          reinterpret_cast<const uint8_t *>(recipient_private_key.data()),
+          recipient_private_key.size())) {
+    return util::Status(
+        absl::StatusCode::kInvalidArgument,
+        "Unable to initialize BoringSSL HPKE recipient private key.");
+  }
+  return std::move(recipient_key);
+}
+
+util::StatusOr<SenderHpkeContextBoringSsl>
+HpkeContextBoringSsl::SetupSender(const HpkeParams& params,
+                                  absl::string_view recipient_public_key,
+                                  absl::string_view context_info) {
+  util::StatusOr<HpkeAlgorithmsBoringSsl> algorithms =
+      HpkeAlgorithmsBoringSsl::New(params);
+  if (!algorithms.ok()) {
+    return algorithms.status();
+  }
+  return SetupSender(*algorithms, recipient_public_key, context_info);
+}
+
+util::StatusOr<SenderHpkeContextBoringSsl>
+HpkeContextBoringSsl::SetupSender(const HpkeAlgorithmsBoringSsl& algorithms,
+                                  absl::string_view recipient_public_key,
+                                  absl::string_view context_info) {
   uint8_t enc[EVP_HPKE_MAX_ENC_LENGTH];
   size_t enc_len;
   SslUniquePtr<EVP_HPKE_CTX> context(EVP_HPKE_CTX_new());
   if (!EVP_HPKE_CTX_setup_sender(
-          context.get(), enc, &enc_len, sizeof(enc), *kem, *kdf, *aead,
+          context.get(), enc, &enc_len, sizeof(enc), algorithms.kem,
+          algorithms.kdf, algorithms.aead,
           reinterpret_cast<const uint8_t *>(recipient_public_key.data()),
           recipient_public_key.size(),
           reinterpret_cast<const uint8_t *>(context_info.data()),
@@ -74,30 +113,22 @@ util::StatusOr<std::unique_ptr<HpkeContextBoringSsl>>
 HpkeContextBoringSsl::SetupRecipient(
     const HpkeParams& params, const util::SecretData& recipient_private_key,
     absl::string_view encapsulated_key, absl::string_view info) {
-  util::StatusOr<const EVP_HPKE_KEM *> kem = KemParam(params);
-  if (!kem.ok()) {
-    return kem.status();
-  }
-  util::StatusOr<const EVP_HPKE_KDF *> kdf = KdfParam(params);
-  if (!kdf.ok()) {
-    return kdf.status();
-  }
-  util::StatusOr<const EVP_HPKE_AEAD *> aead = AeadParam(params);
-  if (!aead.ok()) {
-    return aead.status();
-  }
-  bssl::ScopedEVP_HPKE_KEY hpke_key;
-  if (!EVP_HPKE_KEY_init(
-          hpke_key.get(), *kem,
-          reinterpret_cast<const uint8_t *>(recipient_private_key.data()),
-          recipient_private_key.size())) {
-    return util::Status(
-        absl::StatusCode::kInvalidArgument,
-        "Unable to initialize BoringSSL HPKE recipient private key.");
+  util::StatusOr<std::unique_ptr<HpkeRecipientKeyBoringSsl>> recipient_key =
+      HpkeRecipientKeyBoringSsl::New(params, recipient_private_key);
+  if (!recipient_key.ok()) {
+    return recipient_key.status();
   }
+  return SetupRecipient(**recipient_key, encapsulated_key, info);
+}
+
+util::StatusOr<std::unique_ptr<HpkeContextBoringSsl>>
+HpkeContextBoringSsl::SetupRecipient(
+    const HpkeRecipientKeyBoringSsl& recipient_key,
+    absl::string_view encapsulated_key, absl::string_view info) {
   SslUniquePtr<EVP_HPKE_CTX> context(EVP_HPKE_CTX_new());
   if (!EVP_HPKE_CTX_setup_recipient(
-          context.get(), hpke_key.get(), *kdf, *aead,
+          context.get(), recipient_key.key(),
+          recipient_key.algorithms().kdf, recipient_key.algorithms().aead,
           reinterpret_cast<const uint8_t *>(encapsulated_key.data()),
           encapsulated_key.size(),
           reinterpret_cast<const uint8_t *>(info.data()), info.size())) {
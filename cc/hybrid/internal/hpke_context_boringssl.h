@@ -37,6 +37,45 @@ namespace internal {
 
 struct SenderHpkeContextBoringSsl;
 
+// HPKE algorithms resolved from HpkeParams, so that contexts can be set up
+// without converting the parameters for each message.
+struct HpkeAlgorithmsBoringSsl {
+  // Returns an error if `params` contains an unsupported algorithm.
+  static crypto::tink::util::StatusOr<HpkeAlgorithmsBoringSsl> New(
+      const HpkeParams& params);
+
+  const EVP_HPKE_KEM* kem;
+  const EVP_HPKE_KDF* kdf;
+  const EVP_HPKE_AEAD* aead;
+};
+
+// Recipient private key, parsed once for setting up any number of recipient
+// contexts, together with the HPKE algorithms it is used with.
+class HpkeRecipientKeyBoringSsl {
+ public:
+  // Returns an error if `params` contains an unsupported algorithm or if
+  // `recipient_private_key` is not a valid key for the KEM.
+  static crypto::tink::util::StatusOr<
+      std::unique_ptr<HpkeRecipientKeyBoringSsl>>
+  New(const HpkeParams& params, const util::SecretData& recipient_private_key);
+
+  // Not copyable or movable.
+  HpkeRecipientKeyBoringSsl(const HpkeRecipientKeyBoringSsl&) = delete;
+  HpkeRecipientKeyBoringSsl& operator=(const HpkeRecipientKeyBoringSsl&) =
+      delete;
+
+  const HpkeAlgorithmsBoringSsl& algorithms() const { return algorithms_; }
+
+  const EVP_HPKE_KEY* key() const { return key_.get(); }
+
+ private:
+  explicit HpkeRecipientKeyBoringSsl(const HpkeAlgorithmsBoringSsl& algorithms)
+      : algorithms_(algorithms) {}
+
+  const HpkeAlgorithmsBoringSsl algorithms_;
+  bssl::ScopedEVP_HPKE_KEY key_;
+};
+
 class HpkeContextBoringSsl {
  public:
   // Sets up an HPKE sender context.  Returns an error if initialization
@@ -49,6 +88,11 @@ class HpkeContextBoringSsl {
   SetupSender(const HpkeParams& params, absl::string_view recipient_public_key,
               absl::string_view info);
 
+  // Same as above, but with algorithms that were already resolved.
+  static crypto::tink::util::StatusOr<SenderHpkeContextBoringSsl>
+  SetupSender(const HpkeAlgorithmsBoringSsl& algorithms,
+              absl::string_view recipient_public_key, absl::string_view info);
+
   // Sets up an HPKE recipient context.  Returns an error if initialization
   // fails.  Otherwise, returns a unique pointer to the recipient context.
   //
@@ -61,6 +105,11 @@ class HpkeContextBoringSsl {
                  const util::SecretData& recipient_private_key,
                  absl::string_view encapsulated_key, absl::string_view info);
 
+  // Same as above, but with a recipient key that was already parsed.
+  static crypto::tink::util::StatusOr<std::unique_ptr<HpkeContextBoringSsl>>
+  SetupRecipient(const HpkeRecipientKeyBoringSsl& recipient_key,
+                 absl::string_view encapsulated_key, absl::string_view info);
+
   // Performs an AEAD encryption of `plaintext` with `associated_data`. Returns
   // an error if encryption fails.  Otherwise, returns the ciphertext.
   crypto::tink::util::StatusOr<std::string> Seal(
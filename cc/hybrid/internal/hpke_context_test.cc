@@ -22,6 +22,7 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "tink/hybrid/internal/hpke_context_boringssl.h"
 #include "tink/hybrid/internal/hpke_test_util.h"
 #include "tink/hybrid/internal/hpke_util.h"
 #include "tink/util/secret_data.h"
@@ -87,6 +88,41 @@ TEST_P(HpkeContextTest, SealAndOpen) {
   }
 }
 
+TEST_P(HpkeContextTest, SealAndOpenWithResolvedAlgorithmsAndKey) {
+  HpkeParams hpke_params = GetParam();
+  util::StatusOr<HpkeTestParams> params = CreateHpkeTestParams(hpke_params);
+  ASSERT_THAT(params, IsOk());
+  util::StatusOr<HpkeAlgorithmsBoringSsl> algorithms =
+      HpkeAlgorithmsBoringSsl::New(hpke_params);
+  ASSERT_THAT(algorithms, IsOk());
+  util::StatusOr<std::unique_ptr<HpkeRecipientKeyBoringSsl>> recipient_key =
+      HpkeRecipientKeyBoringSsl::New(
+          hpke_params,
+          util::SecretDataFromStringView(params->recipient_private_key));
+  ASSERT_THAT(recipient_key, IsOk());
+
+  // Both resolved values can be used for more than one context.
+  for (int i = 0; i < 2; ++i) {
+    util::StatusOr<std::unique_ptr<HpkeContext>> sender_hpke_context =
+        HpkeContext::SetupSender(*algorithms, params->recipient_public_key,
+                                 params->application_info);
+    ASSERT_THAT(sender_hpke_context, IsOk());
+    util::StatusOr<std::unique_ptr<HpkeContext>> recipient_hpke_context =
+        HpkeContext::SetupRecipient(**recipient_key,
+                                    (*sender_hpke_context)->EncapsulatedKey(),
+                                    params->application_info);
+    ASSERT_THAT(recipient_hpke_context, IsOk());
+
+    util::StatusOr<std::string> ciphertext = (*sender_hpke_context)
+        ->Seal(params->plaintext, params->associated_data);
+    ASSERT_THAT(ciphertext, IsOk());
+    util::StatusOr<std::string> plaintext =
+        (*recipient_hpke_context)->Open(*ciphertext, params->associated_data);
+    ASSERT_THAT(plaintext, IsOk());
+    EXPECT_THAT(*plaintext, Eq(params->plaintext));
+  }
+}
+
 TEST_P(HpkeContextTest, Export) {
   HpkeParams hpke_params = GetParam();
   util::StatusOr<HpkeTestParams> params = CreateHpkeTestParams(hpke_params);
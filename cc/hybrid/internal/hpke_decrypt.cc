@@ -22,6 +22,7 @@
 
 #include "absl/status/status.h"
 #include "tink/hybrid/internal/hpke_context.h"
+#include "tink/hybrid/internal/hpke_context_boringssl.h"
 #include "tink/hybrid/internal/hpke_util.h"
 #include "tink/util/secret_data.h"
 #include "tink/util/status.h"
@@ -50,32 +51,38 @@ util::StatusOr<std::unique_ptr<HybridDecrypt>> HpkeDecrypt::New(
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "Recipient private key is missing HPKE parameters.");
   }
-  return {absl::WrapUnique(new HpkeDecrypt(
-      recipient_private_key.public_key().params(),
-      util::SecretDataFromStringView(recipient_private_key.private_key())))};
+  const google::crypto::tink::HpkeParams& hpke_params =
+      recipient_private_key.public_key().params();
+  util::StatusOr<int32_t> encoding_size =
+      internal::HpkeEncapsulatedKeyLength(hpke_params.kem());
+  if (!encoding_size.ok()) return encoding_size.status();
+  util::StatusOr<internal::HpkeParams> params =
+      internal::HpkeParamsProtoToStruct(hpke_params);
+  if (!params.ok()) return params.status();
+  util::StatusOr<std::unique_ptr<internal::HpkeRecipientKeyBoringSsl>>
+      recipient_key = internal::HpkeRecipientKeyBoringSsl::New(
+          *params,
+          util::SecretDataFromStringView(recipient_private_key.private_key()));
+  if (!recipient_key.ok()) return recipient_key.status();
+  return {absl::WrapUnique(
+      new HpkeDecrypt(*encoding_size, *std::move(recipient_key)))};
 }
 
 util::StatusOr<std::string> HpkeDecrypt::Decrypt(
     absl::string_view ciphertext, absl::string_view context_info) const {
-  util::StatusOr<int32_t> encoding_size =
-      internal::HpkeEncapsulatedKeyLength(hpke_params_.kem());
-  if (!encoding_size.ok()) return encoding_size.status();
-
   // Verify that ciphertext length is at least the encapsulated key length.
-  if (ciphertext.size() < *encoding_size) {
+  if (ciphertext.size() < encapsulated_key_length_) {
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "Ciphertext is too short.");
   }
-  absl::string_view encapsulated_key = ciphertext.substr(0, *encoding_size);
-  absl::string_view ciphertext_payload = ciphertext.substr(*encoding_size);
-
-  util::StatusOr<internal::HpkeParams> params =
-      internal::HpkeParamsProtoToStruct(hpke_params_);
-  if (!params.ok()) return params.status();
+  absl::string_view encapsulated_key =
+      ciphertext.substr(0, encapsulated_key_length_);
+  absl::string_view ciphertext_payload =
+      ciphertext.substr(encapsulated_key_length_);
 
   util::StatusOr<std::unique_ptr<internal::HpkeContext>> recipient_context =
-      internal::HpkeContext::SetupRecipient(*params, recipient_private_key_,
-                                            encapsulated_key, context_info);
+      internal::HpkeContext::SetupRecipient(*recipient_key_, encapsulated_key,
+                                            context_info);
   if (!recipient_context.ok()) return recipient_context.status();
 
   return (*recipient_context)->Open(ciphertext_payload, /*associated_data=*/"");
@@ -17,12 +17,13 @@
 #ifndef TINK_HYBRID_INTERNAL_HPKE_DECRYPT_H_
 #define TINK_HYBRID_INTERNAL_HPKE_DECRYPT_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
 
+#include "tink/hybrid/internal/hpke_context_boringssl.h"
 #include "tink/hybrid_decrypt.h"
-#include "tink/util/secret_data.h"
 #include "tink/util/statusor.h"
 #include "proto/hpke.pb.h"
 
@@ -45,13 +46,15 @@ class HpkeDecrypt : public HybridDecrypt {
       absl::string_view context_info) const override;
 
  private:
-  HpkeDecrypt(const google::crypto::tink::HpkeParams& hpke_params,
-              const util::SecretData& recipient_private_key)
-      : hpke_params_(hpke_params),
-        recipient_private_key_(recipient_private_key) {}
-
-  google::crypto::tink::HpkeParams hpke_params_;
-  util::SecretData recipient_private_key_;
+  HpkeDecrypt(int32_t encapsulated_key_length,
+              std::shared_ptr<const internal::HpkeRecipientKeyBoringSsl>
+                  recipient_key)
+      : encapsulated_key_length_(encapsulated_key_length),
+        recipient_key_(std::move(recipient_key)) {}
+
+  int32_t encapsulated_key_length_;
+  // Parsed by New(), and shared by copies of this object.
+  std::shared_ptr<const internal::HpkeRecipientKeyBoringSsl> recipient_key_;
 };
 
 }  // namespace tink
@@ -21,6 +21,7 @@
 
 #include "absl/status/status.h"
 #include "tink/hybrid/internal/hpke_context.h"
+#include "tink/hybrid/internal/hpke_context_boringssl.h"
 #include "tink/hybrid/internal/hpke_util.h"
 #include "proto/hpke.pb.h"
 
@@ -39,18 +40,21 @@ util::StatusOr<std::unique_ptr<HybridEncrypt>> HpkeEncrypt::New(
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "Recipient public key is missing HPKE parameters.");
   }
-  return {absl::WrapUnique(new HpkeEncrypt(recipient_public_key))};
+  util::StatusOr<internal::HpkeParams> params =
+      internal::HpkeParamsProtoToStruct(recipient_public_key.params());
+  if (!params.ok()) return params.status();
+  util::StatusOr<internal::HpkeAlgorithmsBoringSsl> algorithms =
+      internal::HpkeAlgorithmsBoringSsl::New(*params);
+  if (!algorithms.ok()) return algorithms.status();
+  return {absl::WrapUnique(
+      new HpkeEncrypt(recipient_public_key.public_key(), *algorithms))};
 }
 
 util::StatusOr<std::string> HpkeEncrypt::Encrypt(
     absl::string_view plaintext, absl::string_view context_info) const {
-  util::StatusOr<internal::HpkeParams> params =
-      internal::HpkeParamsProtoToStruct(recipient_public_key_.params());
-  if (!params.ok()) return params.status();
-
   util::StatusOr<std::unique_ptr<internal::HpkeContext>> sender_context =
-      internal::HpkeContext::SetupSender(
-          *params, recipient_public_key_.public_key(), context_info);
+      internal::HpkeContext::SetupSender(algorithms_, recipient_public_key_,
+                                         context_info);
   if (!sender_context.ok()) return sender_context.status();
 
   util::StatusOr<std::string> ciphertext =
@@ -20,6 +20,8 @@
 #include <memory>
 #include <string>
 
+#include "absl/strings/string_view.h"
+#include "tink/hybrid/internal/hpke_context_boringssl.h"
 #include "tink/hybrid_encrypt.h"
 #include "tink/util/statusor.h"
 #include "proto/hpke.pb.h"
@@ -43,11 +45,13 @@ class HpkeEncrypt : public HybridEncrypt {
       absl::string_view context_info) const override;
 
  private:
-  explicit HpkeEncrypt(
-      const google::crypto::tink::HpkePublicKey& recipient_public_key)
-      : recipient_public_key_(recipient_public_key) {}
+  HpkeEncrypt(absl::string_view recipient_public_key,
+              const internal::HpkeAlgorithmsBoringSsl& algorithms)
+      : recipient_public_key_(recipient_public_key), algorithms_(algorithms) {}
 
-  google::crypto::tink::HpkePublicKey recipient_public_key_;
+  std::string recipient_public_key_;
+  // Resolved from the parameters of the recipient public key by New().
+  internal::HpkeAlgorithmsBoringSsl algorithms_;
 };
 
 }  // namespace tink
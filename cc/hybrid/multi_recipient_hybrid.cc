@@ -0,0 +1,230 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/hybrid/multi_recipient_hybrid.h"
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/internal/endian.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "tink/aead.h"
+#include "tink/subtle/aes_gcm_boringssl.h"
+#include "tink/subtle/random.h"
+#include "tink/subtle/subtle_util.h"
+#include "tink/util/secret_data.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+
+namespace {
+
+constexpr uint8_t kVersion = 0x01;
+constexpr int kVersionSize = 1;
+constexpr int kNumRecipientsSize = 2;
+constexpr int kIdLengthSize = 1;
+constexpr int kEncryptedDataKeyLengthSize = 4;
+constexpr int kDataKeySize = 32;
+constexpr std::size_t kMaxRecipients = std::numeric_limits<uint16_t>::max();
+constexpr std::size_t kMaxIdLength = std::numeric_limits<uint8_t>::max();
+
+// Returns the AES-GCM ciphertext of `plaintext` under `data_key`.
+util::StatusOr<std::string> EncryptPayload(const util::SecretData& data_key,
+                                           absl::string_view plaintext,
+                                           absl::string_view context_info) {
+  util::StatusOr<std::unique_ptr<Aead>> aead =
+      subtle::AesGcmBoringSsl::New(data_key);
+  if (!aead.ok()) return aead.status();
+  return (*aead)->Encrypt(plaintext, context_info);
+}
+
+}  // namespace
+
+util::StatusOr<std::unique_ptr<MultiRecipientHybridEncrypt>>
+MultiRecipientHybridEncrypt::New(std::vector<Recipient> recipients) {
+  if (recipients.empty()) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "At least one recipient is required.");
+  }
+  if (recipients.size() > kMaxRecipients) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "Too many recipients.");
+  }
+  absl::flat_hash_set<absl::string_view> ids;
+  for (const Recipient& recipient : recipients) {
+    if (recipient.id.size() > kMaxIdLength) {
+      return util::Status(absl::StatusCode::kInvalidArgument,
+                          "Recipient id is too long.");
+    }
+    if (!ids.insert(recipient.id).second) {
+      return util::Status(absl::StatusCode::kInvalidArgument,
+                          "Recipient ids must be unique.");
+    }
+    if (recipient.hybrid_encrypt == nullptr) {
+      return util::Status(absl::StatusCode::kInvalidArgument,
+                          "Recipient primitive must be non-null.");
+    }
+  }
+  return absl::WrapUnique(
+      new MultiRecipientHybridEncrypt(std::move(recipients)));
+}
+
+util::StatusOr<std::string> MultiRecipientHybridEncrypt::Encrypt(
+    absl::string_view plaintext, absl::string_view context_info) const {
+  return Encrypt(plaintext, context_info, /*executor=*/nullptr);
+}
+
+util::StatusOr<std::string> MultiRecipientHybridEncrypt::Encrypt(
+    absl::string_view plaintext, absl::string_view context_info,
+    Executor* executor) const {
+  util::SecretData data_key = subtle::Random::GetRandomKeyBytes(kDataKeySize);
+  absl::string_view data_key_view = util::SecretDataAsStringView(data_key);
+  std::vector<util::StatusOr<std::string>> encrypted_data_keys(
+      recipients_.size());
+  util::StatusOr<std::string> payload;
+  if (executor == nullptr || recipients_.size() == 1) {
+    for (std::size_t i = 0; i < recipients_.size(); ++i) {
+      encrypted_data_keys[i] =
+          recipients_[i].hybrid_encrypt->Encrypt(data_key_view, context_info);
+    }
+    payload = EncryptPayload(data_key, plaintext, context_info);
+  } else {
+    absl::BlockingCounter done(recipients_.size());
+    for (std::size_t i = 0; i < recipients_.size(); ++i) {
+      executor->Schedule([&, i]() {
+        encrypted_data_keys[i] = recipients_[i].hybrid_encrypt->Encrypt(
+            data_key_view, context_info);
+        done.DecrementCount();
+      });
+    }
+    payload = EncryptPayload(data_key, plaintext, context_info);
+    done.Wait();
+  }
+  if (!payload.ok()) return payload.status();
+
+  std::size_t size = kVersionSize + kNumRecipientsSize + payload->size();
+  for (std::size_t i = 0; i < recipients_.size(); ++i) {
+    if (!encrypted_data_keys[i].ok()) return encrypted_data_keys[i].status();
+    size += kIdLengthSize + recipients_[i].id.size() +
+            kEncryptedDataKeyLengthSize + encrypted_data_keys[i]->size();
+  }
+  std::string ciphertext;
+  subtle::ResizeStringUninitialized(&ciphertext, size);
+  char* out = &ciphertext[0];
+  *out++ = static_cast<char>(kVersion);
+  absl::big_endian::Store16(out, recipients_.size());
+  out += kNumRecipientsSize;
+  for (std::size_t i = 0; i < recipients_.size(); ++i) {
+    const std::string& id = recipients_[i].id;
+    const std::string& encrypted_data_key = *encrypted_data_keys[i];
+    *out++ = static_cast<char>(id.size());
+    std::memcpy(out, id.data(), id.size());
+    out += id.size();
+    absl::big_endian::Store32(out, encrypted_data_key.size());
+    out += kEncryptedDataKeyLengthSize;
+    std::memcpy(out, encrypted_data_key.data(), encrypted_data_key.size());
+    out += encrypted_data_key.size();
+  }
+  std::memcpy(out, payload->data(), payload->size());
+  return std::move(ciphertext);
+}
+
+util::StatusOr<std::unique_ptr<HybridDecrypt>> MultiRecipientHybridDecrypt::New(
+    absl::string_view recipient_id,
+    std::unique_ptr<HybridDecrypt> hybrid_decrypt) {
+  if (recipient_id.size() > kMaxIdLength) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "Recipient id is too long.");
+  }
+  if (hybrid_decrypt == nullptr) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "Recipient primitive must be non-null.");
+  }
+  return {absl::WrapUnique(new MultiRecipientHybridDecrypt(
+      recipient_id, std::move(hybrid_decrypt)))};
+}
+
+util::StatusOr<std::string> MultiRecipientHybridDecrypt::Decrypt(
+    absl::string_view ciphertext, absl::string_view context_info) const {
+  if (ciphertext.size() < kVersionSize + kNumRecipientsSize ||
+      static_cast<uint8_t>(ciphertext[0]) != kVersion) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "Invalid ciphertext header.");
+  }
+  uint16_t num_recipients =
+      absl::big_endian::Load16(ciphertext.data() + kVersionSize);
+  absl::string_view rest =
+      ciphertext.substr(kVersionSize + kNumRecipientsSize);
+  absl::string_view encrypted_data_key;
+  bool found = false;
+  // Only the lengths of the other entries are read, to skip them.
+  for (uint16_t i = 0; i < num_recipients; ++i) {
+    if (rest.size() < kIdLengthSize) {
+      return util::Status(absl::StatusCode::kInvalidArgument,
+                          "Invalid ciphertext header.");
+    }
+    std::size_t id_length = static_cast<uint8_t>(rest[0]);
+    if (rest.size() <
+        kIdLengthSize + id_length + kEncryptedDataKeyLengthSize) {
+      return util::Status(absl::StatusCode::kInvalidArgument,
+                          "Invalid ciphertext header.");
+    }
+    absl::string_view id = rest.substr(kIdLengthSize, id_length);
+    rest.remove_prefix(kIdLengthSize + id_length);
+    uint32_t length = absl::big_endian::Load32(rest.data());
+    rest.remove_prefix(kEncryptedDataKeyLengthSize);
+    if (length > rest.size()) {
+      return util::Status(absl::StatusCode::kInvalidArgument,
+                          "Invalid ciphertext header.");
+    }
+    if (!found && id == recipient_id_) {
+      encrypted_data_key = rest.substr(0, length);
+      found = true;
+    }
+    rest.remove_prefix(length);
+  }
+  if (!found) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "Ciphertext is not encrypted for this recipient.");
+  }
+  util::StatusOr<std::string> data_key =
+      hybrid_decrypt_->Decrypt(encrypted_data_key, context_info);
+  if (!data_key.ok()) return data_key.status();
+  util::SecretData data_key_bytes = util::SecretDataFromStringView(*data_key);
+  util::SafeZeroString(&*data_key);
+  if (data_key_bytes.size() != kDataKeySize) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "Invalid data key size.");
+  }
+  util::StatusOr<std::unique_ptr<Aead>> aead =
+      subtle::AesGcmBoringSsl::New(data_key_bytes);
+  if (!aead.ok()) return aead.status();
+  return (*aead)->Decrypt(rest, context_info);
+}
+
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,123 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_HYBRID_MULTI_RECIPIENT_HYBRID_H_
+#define TINK_HYBRID_MULTI_RECIPIENT_HYBRID_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tink/hybrid_decrypt.h"
+#include "tink/hybrid_encrypt.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+
+// Multi-recipient hybrid encryption. The plaintext is encrypted once with a
+// fresh AES-256-GCM data key, and only the data key is encrypted for each
+// recipient, with the HybridEncrypt primitive of that recipient (for example
+// HPKE or ECIES-AEAD-HKDF). Each recipient is identified by a short id chosen
+// by the caller, so that a recipient decrypts only its own copy of the data
+// key.
+//
+// The ciphertext format is:
+//   version (1 byte, 0x01)
+//   number of recipients (2 bytes, big endian)
+//   for each recipient:
+//     length of the recipient id (1 byte) || recipient id
+//     length of the encrypted data key (4 bytes, big endian) ||
+//         encrypted data key
+//   AES-256-GCM ciphertext of the plaintext (iv || ciphertext || tag)
+//
+// `context_info` is the context info of each data key encryption and the
+// associated data of the AES-GCM encryption.
+class MultiRecipientHybridEncrypt : public HybridEncrypt {
+ public:
+  // Interface for running the data key encryptions of one Encrypt call,
+  // typically on a thread pool owned by the caller.
+  class Executor {
+   public:
+    // Runs `task`, either on another thread or before returning. Tasks of
+    // the same Encrypt call may run concurrently.
+    virtual void Schedule(std::function<void()> task) = 0;
+
+    virtual ~Executor() = default;
+  };
+
+  struct Recipient {
+    // At most 255 bytes, and unique among the recipients.
+    std::string id;
+    std::shared_ptr<const HybridEncrypt> hybrid_encrypt;
+  };
+
+  // Returns an error if `recipients` is empty, has more than 65535 entries,
+  // or contains an invalid or duplicate id or a null primitive.
+  static crypto::tink::util::StatusOr<
+      std::unique_ptr<MultiRecipientHybridEncrypt>>
+  New(std::vector<Recipient> recipients);
+
+  // Encrypts the data key for the recipients one after the other.
+  crypto::tink::util::StatusOr<std::string> Encrypt(
+      absl::string_view plaintext,
+      absl::string_view context_info) const override;
+
+  // Same as above, but schedules the data key encryptions on `executor` and
+  // encrypts the plaintext on the calling thread in the meantime. Returns
+  // once all tasks have returned.
+  crypto::tink::util::StatusOr<std::string> Encrypt(
+      absl::string_view plaintext, absl::string_view context_info,
+      Executor* executor) const;
+
+ private:
+  explicit MultiRecipientHybridEncrypt(std::vector<Recipient> recipients)
+      : recipients_(std::move(recipients)) {}
+
+  const std::vector<Recipient> recipients_;
+};
+
+// Decrypts the ciphertexts of MultiRecipientHybridEncrypt for a single
+// recipient. Only the data key of this recipient is decrypted.
+class MultiRecipientHybridDecrypt : public HybridDecrypt {
+ public:
+  // `hybrid_decrypt` must be the counterpart of the primitive with which the
+  // recipient with id `recipient_id` was added to MultiRecipientHybridEncrypt.
+  static crypto::tink::util::StatusOr<std::unique_ptr<HybridDecrypt>> New(
+      absl::string_view recipient_id,
+      std::unique_ptr<HybridDecrypt> hybrid_decrypt);
+
+  crypto::tink::util::StatusOr<std::string> Decrypt(
+      absl::string_view ciphertext,
+      absl::string_view context_info) const override;
+
+ private:
+  MultiRecipientHybridDecrypt(absl::string_view recipient_id,
+                              std::unique_ptr<HybridDecrypt> hybrid_decrypt)
+      : recipient_id_(recipient_id),
+        hybrid_decrypt_(std::move(hybrid_decrypt)) {}
+
+  const std::string recipient_id_;
+  const std::unique_ptr<HybridDecrypt> hybrid_decrypt_;
+};
+
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_HYBRID_MULTI_RECIPIENT_HYBRID_H_
@@ -0,0 +1,245 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/hybrid/multi_recipient_hybrid.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "tink/aead/aes_gcm_key_manager.h"
+#include "tink/hybrid/ecies_aead_hkdf_hybrid_decrypt.h"
+#include "tink/hybrid/ecies_aead_hkdf_hybrid_encrypt.h"
+#include "tink/hybrid/failing_hybrid.h"
+#include "tink/hybrid_decrypt.h"
+#include "tink/hybrid_encrypt.h"
+#include "tink/registry.h"
+#include "tink/subtle/random.h"
+#include "tink/util/statusor.h"
+#include "tink/util/test_matchers.h"
+#include "tink/util/test_util.h"
+#include "proto/common.pb.h"
+#include "proto/ecies_aead_hkdf.pb.h"
+
+namespace crypto {
+namespace tink {
+namespace {
+
+using ::crypto::tink::test::IsOk;
+using ::crypto::tink::test::IsOkAndHolds;
+using ::crypto::tink::test::StatusIs;
+using ::google::crypto::tink::EciesAeadHkdfPrivateKey;
+using ::google::crypto::tink::EcPointFormat;
+using ::google::crypto::tink::EllipticCurveType;
+using ::google::crypto::tink::HashType;
+using ::testing::Eq;
+using ::testing::Lt;
+using ::testing::Not;
+
+// Runs each task on a new thread. The threads are joined on destruction.
+class ThreadExecutor : public MultiRecipientHybridEncrypt::Executor {
+ public:
+  void Schedule(std::function<void()> task) override {
+    absl::MutexLock lock(&mutex_);
+    threads_.emplace_back(std::move(task));
+  }
+
+  int num_tasks() {
+    absl::MutexLock lock(&mutex_);
+    return threads_.size();
+  }
+
+  ~ThreadExecutor() override {
+    for (std::thread& thread : threads_) {
+      thread.join();
+    }
+  }
+
+ private:
+  absl::Mutex mutex_;
+  std::vector<std::thread> threads_ ABSL_GUARDED_BY(mutex_);
+};
+
+class MultiRecipientHybridTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_THAT(Registry::RegisterKeyTypeManager(
+                    absl::make_unique<AesGcmKeyManager>(), true),
+                IsOk());
+    for (int i = 0; i < 3; ++i) {
+      keys_.push_back(test::GetEciesAesGcmHkdfTestKey(
+          EllipticCurveType::NIST_P256, EcPointFormat::UNCOMPRESSED,
+          HashType::SHA256, 16));
+    }
+  }
+
+  std::vector<MultiRecipientHybridEncrypt::Recipient> Recipients() {
+    std::vector<MultiRecipientHybridEncrypt::Recipient> recipients;
+    for (int i = 0; i < keys_.size(); ++i) {
+      util::StatusOr<std::unique_ptr<HybridEncrypt>> hybrid_encrypt =
+          EciesAeadHkdfHybridEncrypt::New(keys_[i].public_key());
+      EXPECT_THAT(hybrid_encrypt, IsOk());
+      recipients.push_back({absl::StrCat("recipient-", i),
+                            std::move(*hybrid_encrypt)});
+    }
+    return recipients;
+  }
+
+  std::unique_ptr<HybridDecrypt> Decrypter(int i) {
+    util::StatusOr<std::unique_ptr<HybridDecrypt>> hybrid_decrypt =
+        EciesAeadHkdfHybridDecrypt::New(keys_[i]);
+    EXPECT_THAT(hybrid_decrypt, IsOk());
+    util::StatusOr<std::unique_ptr<HybridDecrypt>> decrypter =
+        MultiRecipientHybridDecrypt::New(absl::StrCat("recipient-", i),
+                                         *std::move(hybrid_decrypt));
+    EXPECT_THAT(decrypter, IsOk());
+    return *std::move(decrypter);
+  }
+
+  std::vector<EciesAeadHkdfPrivateKey> keys_;
+};
+
+TEST_F(MultiRecipientHybridTest, EncryptDecrypt) {
+  util::StatusOr<std::unique_ptr<MultiRecipientHybridEncrypt>> encrypter =
+      MultiRecipientHybridEncrypt::New(Recipients());
+  ASSERT_THAT(encrypter, IsOk());
+  std::string plaintext = subtle::Random::GetRandomBytes(1000);
+  util::StatusOr<std::string> ciphertext =
+      (*encrypter)->Encrypt(plaintext, "context info");
+  ASSERT_THAT(ciphertext, IsOk());
+
+  for (int i = 0; i < keys_.size(); ++i) {
+    EXPECT_THAT(Decrypter(i)->Decrypt(*ciphertext, "context info"),
+                IsOkAndHolds(Eq(plaintext)));
+    EXPECT_THAT(Decrypter(i)->Decrypt(*ciphertext, "other context info"),
+                Not(IsOk()));
+  }
+}
+
+TEST_F(MultiRecipientHybridTest, PlaintextIsEncryptedOnce) {
+  util::StatusOr<std::unique_ptr<MultiRecipientHybridEncrypt>> encrypter =
+      MultiRecipientHybridEncrypt::New(Recipients());
+  ASSERT_THAT(encrypter, IsOk());
+  std::string plaintext = subtle::Random::GetRandomBytes(100000);
+  util::StatusOr<std::string> ciphertext =
+      (*encrypter)->Encrypt(plaintext, "");
+  ASSERT_THAT(ciphertext, IsOk());
+  EXPECT_THAT(ciphertext->size(), Lt(plaintext.size() + 1000));
+}
+
+TEST_F(MultiRecipientHybridTest, EncryptWithExecutor) {
+  util::StatusOr<std::unique_ptr<MultiRecipientHybridEncrypt>> encrypter =
+      MultiRecipientHybridEncrypt::New(Recipients());
+  ASSERT_THAT(encrypter, IsOk());
+  ThreadExecutor executor;
+  util::StatusOr<std::string> ciphertext =
+      (*encrypter)->Encrypt("plaintext", "context info", &executor);
+  ASSERT_THAT(ciphertext, IsOk());
+  EXPECT_THAT(executor.num_tasks(), Eq(keys_.size()));
+
+  for (int i = 0; i < keys_.size(); ++i) {
+    EXPECT_THAT(Decrypter(i)->Decrypt(*ciphertext, "context info"),
+                IsOkAndHolds(Eq("plaintext")));
+  }
+}
+
+TEST_F(MultiRecipientHybridTest, UnknownRecipientFails) {
+  std::vector<MultiRecipientHybridEncrypt::Recipient> recipients =
+      Recipients();
+  recipients.pop_back();
+  util::StatusOr<std::unique_ptr<MultiRecipientHybridEncrypt>> encrypter =
+      MultiRecipientHybridEncrypt::New(std::move(recipients));
+  ASSERT_THAT(encrypter, IsOk());
+  util::StatusOr<std::string> ciphertext =
+      (*encrypter)->Encrypt("plaintext", "");
+  ASSERT_THAT(ciphertext, IsOk());
+
+  EXPECT_THAT(Decrypter(keys_.size() - 1)->Decrypt(*ciphertext, "").status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST_F(MultiRecipientHybridTest, FailingRecipientFailsEncryption) {
+  std::vector<MultiRecipientHybridEncrypt::Recipient> recipients =
+      Recipients();
+  recipients.push_back({"failing", CreateAlwaysFailingHybridEncrypt()});
+  util::StatusOr<std::unique_ptr<MultiRecipientHybridEncrypt>> encrypter =
+      MultiRecipientHybridEncrypt::New(std::move(recipients));
+  ASSERT_THAT(encrypter, IsOk());
+
+  EXPECT_THAT((*encrypter)->Encrypt("plaintext", ""), Not(IsOk()));
+  ThreadExecutor executor;
+  EXPECT_THAT((*encrypter)->Encrypt("plaintext", "", &executor), Not(IsOk()));
+}
+
+TEST_F(MultiRecipientHybridTest, ModifiedCiphertextFails) {
+  // With other recipients, modifying their entries would not be detected.
+  std::vector<MultiRecipientHybridEncrypt::Recipient> recipients =
+      Recipients();
+  recipients.resize(1);
+  util::StatusOr<std::unique_ptr<MultiRecipientHybridEncrypt>> encrypter =
+      MultiRecipientHybridEncrypt::New(std::move(recipients));
+  ASSERT_THAT(encrypter, IsOk());
+  util::StatusOr<std::string> ciphertext =
+      (*encrypter)->Encrypt("plaintext", "");
+  ASSERT_THAT(ciphertext, IsOk());
+  std::unique_ptr<HybridDecrypt> decrypter = Decrypter(0);
+
+  for (int i = 0; i < ciphertext->size(); ++i) {
+    std::string modified = *ciphertext;
+    modified[i] ^= 1;
+    EXPECT_THAT(decrypter->Decrypt(modified, ""), Not(IsOk())) << i;
+  }
+  for (int size = 0; size < ciphertext->size(); ++size) {
+    EXPECT_THAT(decrypter->Decrypt(ciphertext->substr(0, size), ""),
+                Not(IsOk()))
+        << size;
+  }
+}
+
+TEST_F(MultiRecipientHybridTest, InvalidRecipientsFail) {
+  EXPECT_THAT(MultiRecipientHybridEncrypt::New({}).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+
+  std::vector<MultiRecipientHybridEncrypt::Recipient> duplicate_ids =
+      Recipients();
+  duplicate_ids[1].id = duplicate_ids[0].id;
+  EXPECT_THAT(MultiRecipientHybridEncrypt::New(duplicate_ids).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+
+  std::vector<MultiRecipientHybridEncrypt::Recipient> long_id = Recipients();
+  long_id[0].id = std::string(256, 'a');
+  EXPECT_THAT(MultiRecipientHybridEncrypt::New(long_id).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+
+  std::vector<MultiRecipientHybridEncrypt::Recipient> null_primitive =
+      Recipients();
+  null_primitive[0].hybrid_encrypt = nullptr;
+  EXPECT_THAT(MultiRecipientHybridEncrypt::New(null_primitive).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
@@ -23,6 +23,7 @@
 #include "absl/strings/string_view.h"
 #include "aws/core/auth/AWSCredentialsProvider.h"
 #include "aws/core/client/AWSClient.h"
+#include "aws/core/client/AsyncCallerContext.h"
 #include "aws/core/utils/Outcome.h"
 #include "aws/core/utils/memory/AWSMemory.h"
 #include "aws/kms/KMSClient.h"
@@ -32,6 +33,7 @@
 #include "aws/kms/model/EncryptRequest.h"
 #include "aws/kms/model/EncryptResult.h"
 #include "tink/aead.h"
+#include "tink/async_aead.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
 
@@ -62,33 +64,19 @@ std::string AwsErrorToString(Aws::Client::AWSError<Aws::KMS::KMSErrors> err) {
                       err.GetExceptionName(), ": ", err.GetMessage());
 }
 
-}  // namespace
-
-AwsKmsAead::AwsKmsAead(absl::string_view key_arn,
-                       std::shared_ptr<Aws::KMS::KMSClient> aws_client) :
-    key_arn_(key_arn), aws_client_(aws_client) {
-}
-
-// static
-StatusOr<std::unique_ptr<Aead>>
-AwsKmsAead::New(absl::string_view key_arn,
-                std::shared_ptr<Aws::KMS::KMSClient> aws_client) {
-  if (key_arn.empty()) {
-    return Status(absl::StatusCode::kInvalidArgument,
-                  "Key ARN cannot be empty.");
-  }
-  if (aws_client == nullptr) {
-    return Status(absl::StatusCode::kInvalidArgument,
-                  "AWS KMS client cannot be null.");
-  }
-  std::unique_ptr<Aead> aead(new AwsKmsAead(key_arn, aws_client));
-  return std::move(aead);
+// Returns UNAVAILABLE for errors that the AWS SDK considers transient, such
+// as throttling, so that callers can retry them.
+absl::StatusCode AwsErrorToStatusCode(
+    const Aws::Client::AWSError<Aws::KMS::KMSErrors>& err) {
+  return err.ShouldRetry() ? absl::StatusCode::kUnavailable
+                           : absl::StatusCode::kInvalidArgument;
 }
 
-StatusOr<std::string> AwsKmsAead::Encrypt(
-    absl::string_view plaintext, absl::string_view associated_data) const {
+Aws::KMS::Model::EncryptRequest GetEncryptRequest(
+    const std::string& key_arn, absl::string_view plaintext,
+    absl::string_view associated_data) {
   Aws::KMS::Model::EncryptRequest req;
-  req.SetKeyId(key_arn_.c_str());
+  req.SetKeyId(key_arn.c_str());
   Aws::Utils::ByteBuffer plaintext_buffer(
       reinterpret_cast<const unsigned char*>(plaintext.data()),
       plaintext.length());
@@ -97,7 +85,11 @@ StatusOr<std::string> AwsKmsAead::Encrypt(
     req.AddEncryptionContext("associatedData",
                              HexEncode(associated_data).c_str());
   }
-  auto outcome = aws_client_->Encrypt(req);
+  return req;
+}
+
+StatusOr<std::string> GetCiphertext(
+    const Aws::KMS::Model::EncryptOutcome& outcome) {
   if (outcome.IsSuccess()) {
     auto& blob = outcome.GetResult().GetCiphertextBlob();
     std::string ciphertext(
@@ -106,15 +98,16 @@ StatusOr<std::string> AwsKmsAead::Encrypt(
     return ciphertext;
   }
   auto& err = outcome.GetError();
-  return util::Status(absl::StatusCode::kInvalidArgument,
+  return util::Status(AwsErrorToStatusCode(err),
                       absl::StrCat("AWS KMS encryption failed with error: ",
                                    AwsErrorToString(err)));
 }
 
-StatusOr<std::string> AwsKmsAead::Decrypt(
-    absl::string_view ciphertext, absl::string_view associated_data) const {
+Aws::KMS::Model::DecryptRequest GetDecryptRequest(
+    const std::string& key_arn, absl::string_view ciphertext,
+    absl::string_view associated_data) {
   Aws::KMS::Model::DecryptRequest req;
-  req.SetKeyId(key_arn_.c_str());
+  req.SetKeyId(key_arn.c_str());
   Aws::Utils::ByteBuffer ciphertext_buffer(
       reinterpret_cast<const unsigned char*>(ciphertext.data()),
       ciphertext.length());
@@ -123,9 +116,14 @@ StatusOr<std::string> AwsKmsAead::Decrypt(
     req.AddEncryptionContext("associatedData",
                              HexEncode(associated_data).c_str());
   }
-  auto outcome = aws_client_->Decrypt(req);
+  return req;
+}
+
+StatusOr<std::string> GetPlaintext(
+    const std::string& key_arn,
+    const Aws::KMS::Model::DecryptOutcome& outcome) {
   if (outcome.IsSuccess()) {
-    if (outcome.GetResult().GetKeyId() != Aws::String(key_arn_.c_str())) {
+    if (outcome.GetResult().GetKeyId() != Aws::String(key_arn.c_str())) {
       return util::Status(absl::StatusCode::kInvalidArgument,
                           "AWS KMS decryption failed: wrong key ARN.");
     }
@@ -136,11 +134,88 @@ StatusOr<std::string> AwsKmsAead::Decrypt(
     return plaintext;
   }
   auto& err = outcome.GetError();
-  return util::Status(absl::StatusCode::kInvalidArgument,
+  return util::Status(AwsErrorToStatusCode(err),
                       absl::StrCat("AWS KMS decryption failed with error: ",
                                    AwsErrorToString(err)));
 }
 
+}  // namespace
+
+AwsKmsAead::AwsKmsAead(absl::string_view key_arn,
+                       std::shared_ptr<Aws::KMS::KMSClient> aws_client) :
+    key_arn_(key_arn), aws_client_(aws_client) {
+}
+
+// static
+StatusOr<std::unique_ptr<Aead>>
+AwsKmsAead::New(absl::string_view key_arn,
+                std::shared_ptr<Aws::KMS::KMSClient> aws_client) {
+  if (key_arn.empty()) {
+    return Status(absl::StatusCode::kInvalidArgument,
+                  "Key ARN cannot be empty.");
+  }
+  if (aws_client == nullptr) {
+    return Status(absl::StatusCode::kInvalidArgument,
+                  "AWS KMS client cannot be null.");
+  }
+  std::unique_ptr<Aead> aead(new AwsKmsAead(key_arn, aws_client));
+  return std::move(aead);
+}
+
+// static
+StatusOr<std::unique_ptr<AsyncAead>>
+AwsKmsAead::NewAsync(absl::string_view key_arn,
+                     std::shared_ptr<Aws::KMS::KMSClient> aws_client) {
+  if (key_arn.empty()) {
+    return Status(absl::StatusCode::kInvalidArgument,
+                  "Key ARN cannot be empty.");
+  }
+  if (aws_client == nullptr) {
+    return Status(absl::StatusCode::kInvalidArgument,
+                  "AWS KMS client cannot be null.");
+  }
+  std::unique_ptr<AsyncAead> aead(new AwsKmsAead(key_arn, aws_client));
+  return std::move(aead);
+}
+
+StatusOr<std::string> AwsKmsAead::Encrypt(
+    absl::string_view plaintext, absl::string_view associated_data) const {
+  return GetCiphertext(aws_client_->Encrypt(
+      GetEncryptRequest(key_arn_, plaintext, associated_data)));
+}
+
+StatusOr<std::string> AwsKmsAead::Decrypt(
+    absl::string_view ciphertext, absl::string_view associated_data) const {
+  return GetPlaintext(
+      key_arn_, aws_client_->Decrypt(GetDecryptRequest(key_arn_, ciphertext,
+                                                       associated_data)));
+}
+
+void AwsKmsAead::EncryptAsync(absl::string_view plaintext,
+                              absl::string_view associated_data,
+                              DoneCallback done) const {
+  aws_client_->EncryptAsync(
+      GetEncryptRequest(key_arn_, plaintext, associated_data),
+      [done](const Aws::KMS::KMSClient* client,
+             const Aws::KMS::Model::EncryptRequest& request,
+             const Aws::KMS::Model::EncryptOutcome& outcome,
+             const std::shared_ptr<const Aws::Client::AsyncCallerContext>&
+                 context) { done(GetCiphertext(outcome)); });
+}
+
+void AwsKmsAead::DecryptAsync(absl::string_view ciphertext,
+                              absl::string_view associated_data,
+                              DoneCallback done) const {
+  aws_client_->DecryptAsync(
+      GetDecryptRequest(key_arn_, ciphertext, associated_data),
+      [key_arn = key_arn_, done](
+          const Aws::KMS::KMSClient* client,
+          const Aws::KMS::Model::DecryptRequest& request,
+          const Aws::KMS::Model::DecryptOutcome& outcome,
+          const std::shared_ptr<const Aws::Client::AsyncCallerContext>&
+              context) { done(GetPlaintext(key_arn, outcome)); });
+}
+
 }  // namespace awskms
 }  // namespace integration
 }  // namespace tink
@@ -20,6 +20,7 @@
 #include "absl/strings/string_view.h"
 #include "aws/kms/KMSClient.h"
 #include "tink/aead.h"
+#include "tink/async_aead.h"
 #include "tink/util/statusor.h"
 
 namespace crypto {
@@ -30,7 +31,10 @@ namespace awskms {
 // AwsKmsAead is an implementation of AEAD that forwards
 // encryption/decryption requests to a key managed by
 // <a href="https://aws.amazon.com/kms/">AWS KMS</a>.
-class AwsKmsAead : public Aead {
+//
+// It also implements AsyncAead, whose operations use the asynchronous
+// requests of the AWS SDK and complete on the executor of the client.
+class AwsKmsAead : public Aead, public AsyncAead {
  public:
   // Creates a new AwsKmsAead that is bound to the key specified in 'key_arn',
   // and that uses the given client when communicating with the KMS.
@@ -38,6 +42,11 @@ class AwsKmsAead : public Aead {
   New(absl::string_view key_arn,
       std::shared_ptr<Aws::KMS::KMSClient> aws_client);
 
+  // Same as above, but returns the asynchronous interface.
+  static crypto::tink::util::StatusOr<std::unique_ptr<AsyncAead>>
+  NewAsync(absl::string_view key_arn,
+           std::shared_ptr<Aws::KMS::KMSClient> aws_client);
+
   crypto::tink::util::StatusOr<std::string> Encrypt(
       absl::string_view plaintext,
       absl::string_view associated_data) const override;
@@ -46,6 +55,14 @@ class AwsKmsAead : public Aead {
       absl::string_view ciphertext,
       absl::string_view associated_data) const override;
 
+  void EncryptAsync(absl::string_view plaintext,
+                    absl::string_view associated_data,
+                    DoneCallback done) const override;
+
+  void DecryptAsync(absl::string_view ciphertext,
+                    absl::string_view associated_data,
+                    DoneCallback done) const override;
+
   virtual ~AwsKmsAead() {}
 
  private:
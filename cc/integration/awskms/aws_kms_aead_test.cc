@@ -37,6 +37,13 @@ class AwsKmsAeadTest : public ::testing::Test {
   // TODO(b/266054896): add a test with a mock KMSClient.
 };
 
+TEST_F(AwsKmsAeadTest, NewAsyncFailsWithInvalidArguments) {
+  EXPECT_FALSE(AwsKmsAead::NewAsync("", nullptr).ok());
+  EXPECT_FALSE(
+      AwsKmsAead::NewAsync("arn:aws:kms:us-east-1:123456789012:key/abc",
+                           nullptr)
+          .ok());
+}
 
 }  // namespace
 }  // namespace subtle
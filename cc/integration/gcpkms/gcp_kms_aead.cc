@@ -26,7 +26,10 @@
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "tink/aead.h"
+#include "tink/async_aead.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
 
@@ -44,10 +47,65 @@ using google::cloud::kms::v1::EncryptResponse;
 using google::cloud::kms::v1::KeyManagementService;
 using grpc::ClientContext;
 
+namespace {
+
+// State of an asynchronous RPC, kept alive until its callback is destroyed.
+template <typename Request, typename Response>
+struct AsyncCall {
+  ClientContext context;
+  Request request;
+  Response response;
+};
+
+EncryptRequest GetEncryptRequest(const std::string& key_name,
+                                 absl::string_view plaintext,
+                                 absl::string_view associated_data) {
+  EncryptRequest req;
+  req.set_name(key_name);
+  req.set_plaintext(std::string(plaintext));
+  req.set_additional_authenticated_data(std::string(associated_data));
+  return req;
+}
+
+DecryptRequest GetDecryptRequest(const std::string& key_name,
+                                 absl::string_view ciphertext,
+                                 absl::string_view associated_data) {
+  DecryptRequest req;
+  req.set_name(key_name);
+  req.set_ciphertext(std::string(ciphertext));
+  req.set_additional_authenticated_data(std::string(associated_data));
+  return req;
+}
+
+// Returns the status of a failed asynchronous RPC. Transient errors keep
+// their code so that callers can retry them.
+Status GetAsyncRpcStatus(const grpc::Status& status,
+                         absl::string_view operation) {
+  absl::StatusCode code;
+  switch (status.error_code()) {
+    case grpc::StatusCode::DEADLINE_EXCEEDED:
+      code = absl::StatusCode::kDeadlineExceeded;
+      break;
+    case grpc::StatusCode::UNAVAILABLE:
+      code = absl::StatusCode::kUnavailable;
+      break;
+    case grpc::StatusCode::RESOURCE_EXHAUSTED:
+      code = absl::StatusCode::kResourceExhausted;
+      break;
+    default:
+      code = absl::StatusCode::kInvalidArgument;
+  }
+  return Status(code, absl::StrCat("GCP KMS ", operation,
+                                   " failed: ", status.error_message()));
+}
+
+}  // namespace
+
 GcpKmsAead::GcpKmsAead(
     absl::string_view key_name,
-    std::shared_ptr<KeyManagementService::Stub> kms_stub)
-    : key_name_(key_name), kms_stub_(kms_stub) {}
+    std::shared_ptr<KeyManagementService::Stub> kms_stub,
+    absl::Duration rpc_deadline)
+    : key_name_(key_name), kms_stub_(kms_stub), rpc_deadline_(rpc_deadline) {}
 
 // static
 StatusOr<std::unique_ptr<Aead>>
@@ -61,21 +119,46 @@ GcpKmsAead::New(absl::string_view key_name,
     return Status(absl::StatusCode::kInvalidArgument,
                         "KMS stub cannot be null.");
   }
-  std::unique_ptr<Aead> aead(new GcpKmsAead(key_name, kms_stub));
+  std::unique_ptr<Aead> aead(
+      new GcpKmsAead(key_name, kms_stub, absl::InfiniteDuration()));
+  return std::move(aead);
+}
+
+// static
+StatusOr<std::unique_ptr<AsyncAead>> GcpKmsAead::NewAsync(
+    absl::string_view key_name,
+    std::shared_ptr<KeyManagementService::Stub> kms_stub,
+    absl::Duration rpc_deadline) {
+  if (key_name.empty()) {
+    return Status(absl::StatusCode::kInvalidArgument,
+                  "Key URI cannot be empty.");
+  }
+  if (kms_stub == nullptr) {
+    return Status(absl::StatusCode::kInvalidArgument,
+                  "KMS stub cannot be null.");
+  }
+  if (rpc_deadline <= absl::ZeroDuration()) {
+    return Status(absl::StatusCode::kInvalidArgument,
+                  "RPC deadline must be positive.");
+  }
+  std::unique_ptr<AsyncAead> aead(
+      new GcpKmsAead(key_name, kms_stub, rpc_deadline));
   return std::move(aead);
 }
 
+void GcpKmsAead::InitClientContext(ClientContext* context) const {
+  context->AddMetadata("x-goog-request-params",
+                       absl::StrCat("name=", key_name_));
+}
+
 StatusOr<std::string> GcpKmsAead::Encrypt(
     absl::string_view plaintext, absl::string_view associated_data) const {
-  EncryptRequest req;
-  req.set_name(key_name_);
-  req.set_plaintext(std::string(plaintext));
-  req.set_additional_authenticated_data(std::string(associated_data));
+  EncryptRequest req =
+      GetEncryptRequest(key_name_, plaintext, associated_data);
 
   EncryptResponse resp;
   ClientContext context;
-  context.AddMetadata("x-goog-request-params",
-                      absl::StrCat("name=", key_name_));
+  InitClientContext(&context);
 
   auto status =  kms_stub_->Encrypt(&context, req, &resp);
 
@@ -87,15 +170,12 @@ StatusOr<std::string> GcpKmsAead::Encrypt(
 
 StatusOr<std::string> GcpKmsAead::Decrypt(
     absl::string_view ciphertext, absl::string_view associated_data) const {
-  DecryptRequest req;
-  req.set_name(key_name_);
-  req.set_ciphertext(std::string(ciphertext));
-  req.set_additional_authenticated_data(std::string(associated_data));
+  DecryptRequest req =
+      GetDecryptRequest(key_name_, ciphertext, associated_data);
 
   DecryptResponse resp;
   ClientContext context;
-  context.AddMetadata("x-goog-request-params",
-                      absl::StrCat("name=", key_name_));
+  InitClientContext(&context);
 
   auto status =  kms_stub_->Decrypt(&context, req, &resp);
 
@@ -105,6 +185,46 @@ StatusOr<std::string> GcpKmsAead::Decrypt(
       absl::StrCat("GCP KMS encryption failed: ", status.error_message()));
 }
 
+void GcpKmsAead::EncryptAsync(absl::string_view plaintext,
+                              absl::string_view associated_data,
+                              DoneCallback done) const {
+  auto call = std::make_shared<AsyncCall<EncryptRequest, EncryptResponse>>();
+  call->request = GetEncryptRequest(key_name_, plaintext, associated_data);
+  InitClientContext(&call->context);
+  if (rpc_deadline_ != absl::InfiniteDuration()) {
+    call->context.set_deadline(absl::ToChronoTime(absl::Now() + rpc_deadline_));
+  }
+  kms_stub_->async()->Encrypt(
+      &call->context, &call->request, &call->response,
+      [call, done](grpc::Status status) {
+        if (status.ok()) {
+          done(std::move(*call->response.mutable_ciphertext()));
+          return;
+        }
+        done(GetAsyncRpcStatus(status, "encryption"));
+      });
+}
+
+void GcpKmsAead::DecryptAsync(absl::string_view ciphertext,
+                              absl::string_view associated_data,
+                              DoneCallback done) const {
+  auto call = std::make_shared<AsyncCall<DecryptRequest, DecryptResponse>>();
+  call->request = GetDecryptRequest(key_name_, ciphertext, associated_data);
+  InitClientContext(&call->context);
+  if (rpc_deadline_ != absl::InfiniteDuration()) {
+    call->context.set_deadline(absl::ToChronoTime(absl::Now() + rpc_deadline_));
+  }
+  kms_stub_->async()->Decrypt(
+      &call->context, &call->request, &call->response,
+      [call, done](grpc::Status status) {
+        if (status.ok()) {
+          done(std::move(*call->response.mutable_plaintext()));
+          return;
+        }
+        done(GetAsyncRpcStatus(status, "decryption"));
+      });
+}
+
 }  // namespace gcpkms
 }  // namespace integration
 }  // namespace tink
@@ -22,7 +22,9 @@
 
 #include "google/cloud/kms/v1/service.grpc.pb.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "tink/aead.h"
+#include "tink/async_aead.h"
 #include "tink/util/statusor.h"
 
 namespace crypto {
@@ -33,7 +35,10 @@ namespace gcpkms {
 // GcpKmsAead is an implementation of AEAD that forwards
 // encryption/decryption requests to a key managed by
 // <a href="https://cloud.google.com/kms/">Google Cloud KMS</a>.
-class GcpKmsAead : public Aead {
+//
+// It also implements AsyncAead, whose operations use the gRPC callback API
+// and complete on a thread of the gRPC library.
+class GcpKmsAead : public Aead, public AsyncAead {
  public:
   // Creates a new GcpKmsAead that is bound to the key specified in 'key_name',
   // and that uses the channel when communicating with the KMS.
@@ -45,6 +50,14 @@ class GcpKmsAead : public Aead {
       std::shared_ptr<google::cloud::kms::v1::KeyManagementService::Stub>
           kms_stub);
 
+  // Same as above, but returns the asynchronous interface. Each RPC fails
+  // with DEADLINE_EXCEEDED if it takes longer than 'rpc_deadline'.
+  static crypto::tink::util::StatusOr<std::unique_ptr<AsyncAead>> NewAsync(
+      absl::string_view key_name,
+      std::shared_ptr<google::cloud::kms::v1::KeyManagementService::Stub>
+          kms_stub,
+      absl::Duration rpc_deadline = absl::InfiniteDuration());
+
   crypto::tink::util::StatusOr<std::string> Encrypt(
       absl::string_view plaintext,
       absl::string_view associated_data) const override;
@@ -53,16 +66,30 @@ class GcpKmsAead : public Aead {
       absl::string_view ciphertext,
       absl::string_view associated_data) const override;
 
+  void EncryptAsync(absl::string_view plaintext,
+                    absl::string_view associated_data,
+                    DoneCallback done) const override;
+
+  void DecryptAsync(absl::string_view ciphertext,
+                    absl::string_view associated_data,
+                    DoneCallback done) const override;
+
   virtual ~GcpKmsAead() = default;
 
  private:
   GcpKmsAead(
       absl::string_view key_name,
       std::shared_ptr<google::cloud::kms::v1::KeyManagementService::Stub>
-          kms_stub);
+          kms_stub,
+      absl::Duration rpc_deadline);
+
+  // Prepares `context` for an RPC on the key.
+  void InitClientContext(grpc::ClientContext* context) const;
+
   std::string key_name_;  // The location of a crypto key in GCP KMS.
   std::shared_ptr<google::cloud::kms::v1::KeyManagementService::Stub>
       kms_stub_;
+  absl::Duration rpc_deadline_;  // Only used by the asynchronous operations.
 };
 
 
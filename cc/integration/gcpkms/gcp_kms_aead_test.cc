@@ -29,6 +29,12 @@ class GcpKmsAeadTest : public ::testing::Test {
   // google::cloud::kms::v1::KeyManagementService::StubInterface is available.
 };
 
+TEST_F(GcpKmsAeadTest, NewAsyncFailsWithInvalidArguments) {
+  EXPECT_FALSE(GcpKmsAead::NewAsync("", nullptr).ok());
+  EXPECT_FALSE(GcpKmsAead::NewAsync(
+                   "projects/p/locations/l/keyRings/r/cryptoKeys/k", nullptr)
+                   .ok());
+}
 
 }  // namespace
 }  // namespace subtle
@@ -0,0 +1,127 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/internal/ec_ephemeral_key_pool.h"
+
+#include <unistd.h>
+
+#include <memory>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "openssl/ec.h"
+#include "tink/internal/ec_util.h"
+#include "tink/internal/err_util.h"
+#include "tink/internal/ssl_unique_ptr.h"
+#include "tink/subtle/common_enums.h"
+#include "tink/util/secret_data.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace internal {
+
+namespace {
+
+// Generates a key pair on `group`, or on curve25519 if `group` is null.
+util::StatusOr<EcEphemeralKey> GenerateKey(const EC_GROUP* group) {
+  EcEphemeralKey key;
+  if (group == nullptr) {
+    util::StatusOr<std::unique_ptr<X25519Key>> x25519_key = NewX25519Key();
+    if (!x25519_key.ok()) return x25519_key.status();
+    key.x25519_key = util::MakeSecretUniquePtr<X25519Key>(**x25519_key);
+    util::SafeZeroMemory((*x25519_key)->private_key,
+                         sizeof((*x25519_key)->private_key));
+    return std::move(key);
+  }
+  key.ec_key.reset(EC_KEY_new());
+  if (key.ec_key == nullptr ||
+      EC_KEY_set_group(key.ec_key.get(), group) != 1 ||
+      EC_KEY_generate_key(key.ec_key.get()) != 1) {
+    return util::Status(
+        absl::StatusCode::kInternal,
+        absl::StrCat("EC_KEY_generate_key failed: ", GetSslErrors()));
+  }
+  return std::move(key);
+}
+
+}  // namespace
+
+EcEphemeralKeyPool::EcEphemeralKeyPool(subtle::EllipticCurveType curve,
+                                       int capacity)
+    : curve_(curve), capacity_(capacity), pid_(getpid()) {}
+
+void EcEphemeralKeyPool::DiscardKeysAfterFork() {
+  pid_t pid = getpid();
+  if (pid != pid_) {
+    keys_.clear();
+    pid_ = pid;
+  }
+}
+
+util::StatusOr<int> EcEphemeralKeyPool::Refill() {
+  SslUniquePtr<EC_GROUP> group;
+  if (curve_ != subtle::EllipticCurveType::CURVE25519) {
+    util::StatusOr<SslUniquePtr<EC_GROUP>> ec_group =
+        EcGroupFromCurveType(curve_);
+    if (!ec_group.ok()) return ec_group.status();
+    group = *std::move(ec_group);
+  }
+  int added = 0;
+  while (true) {
+    {
+      absl::MutexLock lock(&mutex_);
+      DiscardKeysAfterFork();
+      if (keys_.size() >= capacity_) {
+        return added;
+      }
+    }
+    // The key pair is generated without holding the lock, so that senders
+    // are not blocked while the pool is refilled.
+    util::StatusOr<EcEphemeralKey> key = GenerateKey(group.get());
+    if (!key.ok()) return key.status();
+    absl::MutexLock lock(&mutex_);
+    DiscardKeysAfterFork();
+    if (keys_.size() >= capacity_) {
+      return added;
+    }
+    keys_.push_back(*std::move(key));
+    ++added;
+  }
+}
+
+EcEphemeralKey EcEphemeralKeyPool::Take() {
+  absl::MutexLock lock(&mutex_);
+  DiscardKeysAfterFork();
+  if (keys_.empty()) {
+    return EcEphemeralKey();
+  }
+  EcEphemeralKey key = std::move(keys_.back());
+  keys_.pop_back();
+  return key;
+}
+
+int EcEphemeralKeyPool::size() {
+  absl::MutexLock lock(&mutex_);
+  DiscardKeysAfterFork();
+  return keys_.size();
+}
+
+}  // namespace internal
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,90 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_INTERNAL_EC_EPHEMERAL_KEY_POOL_H_
+#define TINK_INTERNAL_EC_EPHEMERAL_KEY_POOL_H_
+
+#include <sys/types.h>
+
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "openssl/ec.h"
+#include "tink/internal/ec_util.h"
+#include "tink/internal/ssl_unique_ptr.h"
+#include "tink/subtle/common_enums.h"
+#include "tink/util/secret_data.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace internal {
+
+// Ephemeral key pair taken from an EcEphemeralKeyPool. For NIST curves
+// `ec_key` is set, and for CURVE25519 `x25519_key` is set.
+struct EcEphemeralKey {
+  SslUniquePtr<EC_KEY> ec_key;
+  util::SecretUniquePtr<X25519Key> x25519_key;
+};
+
+// Pool of precomputed ephemeral key pairs for one curve, so that a sender
+// KEM only has to compute the shared secret on the request path.
+//
+// Refill() generates key pairs, and is meant to be called from a background
+// thread while the sender is idle. Each key pair is removed from the pool
+// before it is used, so it is used at most once, and its private key is
+// cleared when it is freed. After a fork(), the child process never uses key
+// pairs generated by its parent.
+//
+// This class is thread-safe.
+class EcEphemeralKeyPool {
+ public:
+  // Creates a pool of at most `capacity` key pairs for `curve`.
+  EcEphemeralKeyPool(subtle::EllipticCurveType curve, int capacity);
+
+  // Not copyable or movable.
+  EcEphemeralKeyPool(const EcEphemeralKeyPool&) = delete;
+  EcEphemeralKeyPool& operator=(const EcEphemeralKeyPool&) = delete;
+
+  // Generates key pairs until the pool is full, and returns the number of
+  // key pairs that were added.
+  util::StatusOr<int> Refill();
+
+  // Removes a key pair from the pool and returns it. Returns an empty
+  // EcEphemeralKey if the pool is empty.
+  EcEphemeralKey Take();
+
+  // Returns the number of key pairs in the pool.
+  int size();
+
+ private:
+  // Discards the key pairs if they were generated by another process.
+  void DiscardKeysAfterFork() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const subtle::EllipticCurveType curve_;
+  const int capacity_;
+  absl::Mutex mutex_;
+  // Process that generated `keys_`.
+  pid_t pid_ ABSL_GUARDED_BY(mutex_);
+  std::vector<EcEphemeralKey> keys_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace internal
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_INTERNAL_EC_EPHEMERAL_KEY_POOL_H_
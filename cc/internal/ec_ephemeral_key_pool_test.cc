@@ -0,0 +1,116 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/internal/ec_ephemeral_key_pool.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "openssl/bn.h"
+#include "openssl/ec.h"
+#include "tink/internal/ec_util.h"
+#include "tink/subtle/common_enums.h"
+#include "tink/util/test_matchers.h"
+
+namespace crypto {
+namespace tink {
+namespace internal {
+namespace {
+
+using ::crypto::tink::subtle::EllipticCurveType;
+using ::crypto::tink::test::IsOkAndHolds;
+using ::testing::Eq;
+using ::testing::IsNull;
+using ::testing::Ne;
+using ::testing::NotNull;
+
+TEST(EcEphemeralKeyPoolTest, RefillFillsPool) {
+  EcEphemeralKeyPool pool(EllipticCurveType::NIST_P256, /*capacity=*/5);
+  EXPECT_THAT(pool.size(), Eq(0));
+  EXPECT_THAT(pool.Refill(), IsOkAndHolds(5));
+  EXPECT_THAT(pool.size(), Eq(5));
+  EXPECT_THAT(pool.Refill(), IsOkAndHolds(0));
+}
+
+TEST(EcEphemeralKeyPoolTest, EachNistKeyIsTakenOnce) {
+  EcEphemeralKeyPool pool(EllipticCurveType::NIST_P384, /*capacity=*/3);
+  ASSERT_THAT(pool.Refill(), IsOkAndHolds(3));
+
+  SslUniquePtr<BIGNUM> previous_private_key;
+  for (int i = 0; i < 3; ++i) {
+    EcEphemeralKey key = pool.Take();
+    ASSERT_THAT(key.ec_key, NotNull());
+    EXPECT_FALSE(key.x25519_key);
+    EXPECT_THAT(EC_KEY_check_key(key.ec_key.get()), Eq(1));
+    const BIGNUM* private_key = EC_KEY_get0_private_key(key.ec_key.get());
+    ASSERT_THAT(private_key, NotNull());
+    if (previous_private_key != nullptr) {
+      EXPECT_THAT(BN_cmp(private_key, previous_private_key.get()), Ne(0));
+    }
+    previous_private_key.reset(BN_dup(private_key));
+    EXPECT_THAT(pool.size(), Eq(2 - i));
+  }
+  // The pool is empty.
+  EcEphemeralKey key = pool.Take();
+  EXPECT_THAT(key.ec_key, IsNull());
+  EXPECT_FALSE(key.x25519_key);
+}
+
+TEST(EcEphemeralKeyPoolTest, X25519Keys) {
+  EcEphemeralKeyPool pool(EllipticCurveType::CURVE25519, /*capacity=*/2);
+  ASSERT_THAT(pool.Refill(), IsOkAndHolds(2));
+
+  EcEphemeralKey first = pool.Take();
+  EcEphemeralKey second = pool.Take();
+  ASSERT_TRUE(first.x25519_key);
+  ASSERT_TRUE(second.x25519_key);
+  EXPECT_THAT(first.ec_key, IsNull());
+  std::string first_public_value(
+      reinterpret_cast<const char*>(first.x25519_key->public_value),
+      X25519KeyPubKeySize());
+  std::string second_public_value(
+      reinterpret_cast<const char*>(second.x25519_key->public_value),
+      X25519KeyPubKeySize());
+  EXPECT_THAT(first_public_value, Ne(second_public_value));
+  EXPECT_FALSE(pool.Take().x25519_key);
+}
+
+TEST(EcEphemeralKeyPoolTest, ChildProcessDiscardsKeys) {
+  EcEphemeralKeyPool pool(EllipticCurveType::NIST_P256, /*capacity=*/2);
+  ASSERT_THAT(pool.Refill(), IsOkAndHolds(2));
+
+  pid_t pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    bool discarded = pool.Take().ec_key == nullptr && pool.size() == 0;
+    _exit(discarded ? 0 : 1);
+  }
+  int status;
+  ASSERT_THAT(waitpid(pid, &status, 0), Eq(pid));
+  ASSERT_TRUE(WIFEXITED(status));
+  EXPECT_THAT(WEXITSTATUS(status), Eq(0));
+  // The parent still has its keys.
+  EXPECT_THAT(pool.size(), Eq(2));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,57 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/internal/evp_md_ctx_pool.h"
+
+#include <utility>
+
+namespace crypto {
+namespace tink {
+namespace internal {
+
+constexpr std::size_t EvpMdCtxPool::kMaxIdleContexts;
+
+EvpMdCtxPool::ScopedCtx EvpMdCtxPool::Get() {
+  {
+    absl::MutexLock lock(&mutex_);
+    if (!idle_contexts_.empty()) {
+      SslUniquePtr<EVP_MD_CTX> ctx = std::move(idle_contexts_.back());
+      idle_contexts_.pop_back();
+      return ScopedCtx(this, std::move(ctx));
+    }
+  }
+  return ScopedCtx(this, SslUniquePtr<EVP_MD_CTX>(EVP_MD_CTX_new()));
+}
+
+std::size_t EvpMdCtxPool::NumIdleContexts() const {
+  absl::MutexLock lock(&mutex_);
+  return idle_contexts_.size();
+}
+
+void EvpMdCtxPool::Put(SslUniquePtr<EVP_MD_CTX> ctx) {
+  {
+    absl::MutexLock lock(&mutex_);
+    if (idle_contexts_.size() < kMaxIdleContexts) {
+      idle_contexts_.push_back(std::move(ctx));
+      return;
+    }
+  }
+  // `ctx` is freed without holding the lock.
+}
+
+}  // namespace internal
+}  // namespace tink
+}  // namespace crypto
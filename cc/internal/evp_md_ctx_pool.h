@@ -0,0 +1,94 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_INTERNAL_EVP_MD_CTX_POOL_H_
+#define TINK_INTERNAL_EVP_MD_CTX_POOL_H_
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "openssl/evp.h"
+#include "tink/internal/ssl_unique_ptr.h"
+
+namespace crypto {
+namespace tink {
+namespace internal {
+
+// Keeps the EVP_MD_CTX objects of a primitive for reuse, so that a context is
+// not allocated and freed on every operation. Each concurrent caller gets its
+// own context, so the pool holds about as many contexts as there are threads
+// using the primitive.
+//
+// Contexts keep the state of their last use. Callers must initialize them
+// with EVP_DigestInit_ex(), EVP_DigestSignInit() or EVP_DigestVerifyInit()
+// before each use. When initialized again with the same digest or key, the
+// context reuses the digest state and the EVP_PKEY_CTX it already holds.
+//
+// This class is thread-safe.
+class EvpMdCtxPool {
+ public:
+  // A context borrowed from a pool, which is returned to the pool on
+  // destruction.
+  class ScopedCtx {
+   public:
+    ScopedCtx(ScopedCtx&& other) = default;
+    ScopedCtx& operator=(ScopedCtx&& other) = delete;
+    ~ScopedCtx() {
+      if (ctx_ != nullptr) pool_->Put(std::move(ctx_));
+    }
+
+    // Returns nullptr if the context could not be allocated.
+    EVP_MD_CTX* get() const { return ctx_.get(); }
+
+   private:
+    friend class EvpMdCtxPool;
+    ScopedCtx(EvpMdCtxPool* pool, SslUniquePtr<EVP_MD_CTX> ctx)
+        : pool_(pool), ctx_(std::move(ctx)) {}
+
+    EvpMdCtxPool* pool_;
+    SslUniquePtr<EVP_MD_CTX> ctx_;
+  };
+
+  // Maximum number of idle contexts kept by a pool.
+  static constexpr std::size_t kMaxIdleContexts = 64;
+
+  EvpMdCtxPool() = default;
+
+  // Not copyable or movable.
+  EvpMdCtxPool(const EvpMdCtxPool&) = delete;
+  EvpMdCtxPool& operator=(const EvpMdCtxPool&) = delete;
+
+  // Returns an idle context, or a new one if there is none.
+  ScopedCtx Get();
+
+  // Returns the number of idle contexts.
+  std::size_t NumIdleContexts() const;
+
+ private:
+  void Put(SslUniquePtr<EVP_MD_CTX> ctx);
+
+  mutable absl::Mutex mutex_;
+  std::vector<SslUniquePtr<EVP_MD_CTX>> idle_contexts_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace internal
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_INTERNAL_EVP_MD_CTX_POOL_H_
@@ -0,0 +1,93 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/internal/evp_md_ctx_pool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "openssl/evp.h"
+
+namespace crypto {
+namespace tink {
+namespace internal {
+namespace {
+
+using ::testing::Eq;
+using ::testing::Ne;
+
+TEST(EvpMdCtxPoolTest, ReusesContexts) {
+  EvpMdCtxPool pool;
+  EXPECT_THAT(pool.NumIdleContexts(), Eq(0));
+  EVP_MD_CTX* first;
+  {
+    EvpMdCtxPool::ScopedCtx ctx = pool.Get();
+    ASSERT_THAT(ctx.get(), Ne(nullptr));
+    first = ctx.get();
+    EXPECT_THAT(pool.NumIdleContexts(), Eq(0));
+  }
+  EXPECT_THAT(pool.NumIdleContexts(), Eq(1));
+  EvpMdCtxPool::ScopedCtx ctx = pool.Get();
+  EXPECT_THAT(ctx.get(), Eq(first));
+  EXPECT_THAT(pool.NumIdleContexts(), Eq(0));
+}
+
+TEST(EvpMdCtxPoolTest, ConcurrentUsersGetDistinctContexts) {
+  EvpMdCtxPool pool;
+  {
+    EvpMdCtxPool::ScopedCtx first = pool.Get();
+    EvpMdCtxPool::ScopedCtx second = pool.Get();
+    ASSERT_THAT(first.get(), Ne(nullptr));
+    EXPECT_THAT(second.get(), Ne(first.get()));
+  }
+  EXPECT_THAT(pool.NumIdleContexts(), Eq(2));
+}
+
+TEST(EvpMdCtxPoolTest, KeepsAtMostMaxIdleContexts) {
+  EvpMdCtxPool pool;
+  {
+    std::vector<EvpMdCtxPool::ScopedCtx> contexts;
+    for (std::size_t i = 0; i < EvpMdCtxPool::kMaxIdleContexts + 5; ++i) {
+      contexts.push_back(pool.Get());
+    }
+  }
+  EXPECT_THAT(pool.NumIdleContexts(), Eq(EvpMdCtxPool::kMaxIdleContexts));
+}
+
+TEST(EvpMdCtxPoolTest, ReusedContextComputesDigest) {
+  EvpMdCtxPool pool;
+  std::vector<uint8_t> first_digest(EVP_MAX_MD_SIZE);
+  std::vector<uint8_t> second_digest(EVP_MAX_MD_SIZE);
+  for (std::vector<uint8_t>* digest : {&first_digest, &second_digest}) {
+    EvpMdCtxPool::ScopedCtx ctx = pool.Get();
+    unsigned int digest_size;
+    ASSERT_THAT(EVP_DigestInit_ex(ctx.get(), EVP_sha256(), nullptr), Eq(1));
+    ASSERT_THAT(EVP_DigestUpdate(ctx.get(), "data", 4), Eq(1));
+    ASSERT_THAT(EVP_DigestFinal_ex(ctx.get(), digest->data(), &digest_size),
+                Eq(1));
+    EXPECT_THAT(digest_size, Eq(32));
+  }
+  EXPECT_THAT(pool.NumIdleContexts(), Eq(1));
+  EXPECT_THAT(second_digest, Eq(first_digest));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace tink
+}  // namespace crypto
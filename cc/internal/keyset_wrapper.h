@@ -26,6 +26,17 @@ namespace crypto {
 namespace tink {
 namespace internal {
 
+// Options for KeysetWrapper::WrapWithOptions().
+struct KeysetWrapOptions {
+  // If the underlying PrimitiveWrapper supports it, only the primitive for the
+  // primary key is created eagerly; the primitives of the other keys are
+  // created when they are used for the first time.
+  bool lazy_primitives = false;
+  // Entries with RAW output prefix are tried in an adaptive order (see
+  // PrimitiveSet::Builder::EnableAdaptiveRawOrder()).
+  bool adaptive_raw_order = false;
+};
+
 // A Keyset wrapper wraps a Tink Keyset into a set of primitives. This is a
 // Tink internal object, which is created from a PrimitiveWrapper.
 //
@@ -48,6 +59,13 @@ class KeysetWrapper {
       const google::crypto::tink::Keyset& keyset,
       const absl::flat_hash_map<std::string, std::string>& annotations)
       const = 0;
+
+  // Same as Wrap(), but builds the set of primitives according to `options`.
+  virtual crypto::tink::util::StatusOr<std::unique_ptr<Primitive>>
+  WrapWithOptions(
+      const google::crypto::tink::Keyset& keyset,
+      const absl::flat_hash_map<std::string, std::string>& annotations,
+      const KeysetWrapOptions& options) const = 0;
 };
 
 }  // namespace internal
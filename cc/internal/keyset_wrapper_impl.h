@@ -49,17 +49,35 @@ class KeysetWrapperImpl : public KeysetWrapper<Q> {
       const google::crypto::tink::Keyset& keyset,
       const absl::flat_hash_map<std::string, std::string>& annotations)
       const override {
+    return WrapWithOptions(keyset, annotations, KeysetWrapOptions());
+  }
+
+  crypto::tink::util::StatusOr<std::unique_ptr<Q>> WrapWithOptions(
+      const google::crypto::tink::Keyset& keyset,
+      const absl::flat_hash_map<std::string, std::string>& annotations,
+      const KeysetWrapOptions& options) const override {
     crypto::tink::util::Status status = ValidateKeyset(keyset);
     if (!status.ok()) return status;
+    bool lazy = options.lazy_primitives &&
+                transforming_wrapper_.SupportsLazyPrimitives();
     typename PrimitiveSet<P>::Builder primitives_builder;
     primitives_builder.AddAnnotations(annotations);
+    if (options.adaptive_raw_order) {
+      primitives_builder.EnableAdaptiveRawOrder();
+    }
     for (const google::crypto::tink::Keyset::Key& key : keyset.key()) {
       if (key.status() != google::crypto::tink::KeyStatusType::ENABLED) {
         continue;
       }
+      bool is_primary = key.key_id() == keyset.primary_key_id();
+      if (lazy && !is_primary) {
+        primitives_builder.AddLazyPrimitive(key.key_data(), primitive_getter_,
+                                            KeyInfoFromKey(key));
+        continue;
+      }
       auto primitive = primitive_getter_(key.key_data());
       if (!primitive.ok()) return primitive.status();
-      if (key.key_id() == keyset.primary_key_id()) {
+      if (is_primary) {
         primitives_builder.AddPrimaryPrimitive(std::move(primitive.value()),
                                                KeyInfoFromKey(key));
       } else {
@@ -169,6 +169,72 @@ TEST(KeysetWrapperImplTest, OnlyEnabled) {
                                    Pair(444, "four")));
 }
 
+// Like Wrapper, but supports lazily created entries. Entries whose primitive
+// cannot be created are output with the error message.
+class LazyWrapper : public PrimitiveWrapper<InputPrimitive, OutputPrimitive> {
+ public:
+  crypto::tink::util::StatusOr<std::unique_ptr<OutputPrimitive>> Wrap(
+      std::unique_ptr<PrimitiveSet<InputPrimitive>> primitive_set)
+      const override {
+    auto result = absl::make_unique<OutputPrimitive>();
+    for (const auto* entry : primitive_set->get_all()) {
+      util::StatusOr<InputPrimitive*> primitive =
+          entry->get_or_create_primitive();
+      result->push_back(std::make_pair(
+          entry->get_key_id(),
+          primitive.ok() ? **primitive
+                         : std::string(primitive.status().message())));
+    }
+    return std::move(result);
+  }
+
+  bool SupportsLazyPrimitives() const override { return true; }
+};
+
+TEST(KeysetWrapperImplTest, WrapWithLazyPrimitivesOnlyCreatesPrimaryEagerly) {
+  LazyWrapper wrapper;
+  int num_created = 0;
+  auto keyset_wrapper =
+      absl::make_unique<KeysetWrapperImpl<InputPrimitive, OutputPrimitive>>(
+          &wrapper, [&num_created](const google::crypto::tink::KeyData& key) {
+            num_created++;
+            return CreateIn(key);
+          });
+  google::crypto::tink::Keyset keyset =
+      CreateKeyset({{111, "one"}, {222, "two"}, {333, "error:three"}});
+  keyset.set_primary_key_id(222);
+
+  KeysetWrapOptions options;
+  options.lazy_primitives = true;
+  util::StatusOr<std::unique_ptr<OutputPrimitive>> wrapped =
+      keyset_wrapper->WrapWithOptions(keyset, /*annotations=*/{}, options);
+
+  // Creating the primitive for key 333 fails only when it is used.
+  ASSERT_THAT(wrapped, IsOk());
+  EXPECT_THAT(*wrapped.value(),
+              UnorderedElementsAre(Pair(111, "one"), Pair(222, "two"),
+                                   Pair(333, "error:three")));
+  EXPECT_EQ(num_created, 3);
+}
+
+TEST(KeysetWrapperImplTest, WrapWithLazyPrimitivesUnsupportedIsEager) {
+  Wrapper wrapper;
+  auto keyset_wrapper =
+      absl::make_unique<KeysetWrapperImpl<InputPrimitive, OutputPrimitive>>(
+          &wrapper, &CreateIn);
+  google::crypto::tink::Keyset keyset =
+      CreateKeyset({{1, "ok:one"}, {2, "error:two"}});
+  keyset.set_primary_key_id(1);
+
+  KeysetWrapOptions options;
+  options.lazy_primitives = true;
+  util::StatusOr<std::unique_ptr<OutputPrimitive>> wrapped =
+      keyset_wrapper->WrapWithOptions(keyset, /*annotations=*/{}, options);
+
+  ASSERT_THAT(wrapped, Not(IsOk()));
+  EXPECT_THAT(std::string(wrapped.status().message()), HasSubstr("error:two"));
+}
+
 // Mock PrimitiveWrapper with input primitive I and output primitive O.
 template <class I, class O>
 class MockWrapper : public PrimitiveWrapper<I, O> {
@@ -16,12 +16,15 @@
 #ifndef TINK_INTERNAL_MONITORING_UTIL_H_
 #define TINK_INTERNAL_MONITORING_UTIL_H_
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/strings/strip.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "tink/internal/key_status_util.h"
 #include "tink/key_status.h"
 #include "tink/monitoring/monitoring.h"
@@ -68,6 +71,36 @@ MonitoringKeySetInfoFromPrimitiveSet(const PrimitiveSet<P>& primitive_set) {
   return keyset_info;
 }
 
+// Returns `client` as a TimedMonitoringClient if it implements that interface,
+// and nullptr otherwise (including if `client` is nullptr).
+inline TimedMonitoringClient* AsTimedMonitoringClient(
+    MonitoringClient* client) {
+  return dynamic_cast<TimedMonitoringClient*>(client);
+}
+
+// Measures the latency of an operation for a TimedMonitoringClient, starting
+// at construction. If the client is nullptr, the clock is never read, so that
+// wrappers without a timed client do not pay for time measurements.
+// absl::GetCurrentTimeNanos() is based on the cycle counter where available.
+class MonitoringLatencyTimer {
+ public:
+  explicit MonitoringLatencyTimer(TimedMonitoringClient* client)
+      : client_(client),
+        start_nanos_(client == nullptr ? 0 : absl::GetCurrentTimeNanos()) {}
+
+  // Reports the time elapsed since construction to the client, if any.
+  void LogLatency(uint32_t key_id, int64_t num_bytes_as_input) const {
+    if (client_ == nullptr) return;
+    client_->LogLatency(
+        key_id, num_bytes_as_input,
+        absl::Nanoseconds(absl::GetCurrentTimeNanos() - start_nanos_));
+  }
+
+ private:
+  TimedMonitoringClient* const client_;
+  const int64_t start_nanos_;
+};
+
 }  // namespace internal
 }  // namespace tink
 }  // namespace crypto
@@ -145,6 +145,14 @@ class RegistryImpl {
       const absl::flat_hash_map<std::string, std::string>& annotations) const
       ABSL_LOCKS_EXCLUDED(maps_mutex_);
 
+  // Wraps a `keyset` and annotates it with `annotations`, building the set of
+  // primitives according to `options`.
+  template <class P>
+  crypto::tink::util::StatusOr<std::unique_ptr<P>> WrapKeysetWithOptions(
+      const google::crypto::tink::Keyset& keyset,
+      const absl::flat_hash_map<std::string, std::string>& annotations,
+      const KeysetWrapOptions& options) const ABSL_LOCKS_EXCLUDED(maps_mutex_);
+
   crypto::tink::util::StatusOr<google::crypto::tink::KeyData> DeriveKey(
       const google::crypto::tink::KeyTemplate& key_template,
       InputStream* randomness) const ABSL_LOCKS_EXCLUDED(maps_mutex_);
@@ -814,6 +822,20 @@ crypto::tink::util::StatusOr<std::unique_ptr<P>> RegistryImpl::WrapKeyset(
   return (*keyset_wrapper)->Wrap(keyset, annotations);
 }
 
+template <class P>
+crypto::tink::util::StatusOr<std::unique_ptr<P>>
+RegistryImpl::WrapKeysetWithOptions(
+    const google::crypto::tink::Keyset& keyset,
+    const absl::flat_hash_map<std::string, std::string>& annotations,
+    const KeysetWrapOptions& options) const {
+  crypto::tink::util::StatusOr<const KeysetWrapper<P>*> keyset_wrapper =
+      GetKeysetWrapper<P>();
+  if (!keyset_wrapper.ok()) {
+    return keyset_wrapper.status();
+  }
+  return (*keyset_wrapper)->WrapWithOptions(keyset, annotations, options);
+}
+
 inline crypto::tink::util::Status RegistryImpl::RestrictToFipsIfEmpty() const {
   absl::MutexLock lock(&maps_mutex_);
   // If we are already in FIPS mode, then do nothing..
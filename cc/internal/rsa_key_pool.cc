@@ -0,0 +1,193 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+
+#include "tink/internal/rsa_key_pool.h"
+
+#include <unistd.h>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "openssl/bn.h"
+#include "tink/internal/err_util.h"
+#include "tink/internal/rsa_util.h"
+#include "tink/internal/ssl_unique_ptr.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace internal {
+
+namespace {
+
+// Pools registered with RegisterRsaKeyPool().
+class RsaKeyPoolRegistry {
+ public:
+  static RsaKeyPoolRegistry& GlobalInstance() {
+    static RsaKeyPoolRegistry* instance = new RsaKeyPoolRegistry();
+    return *instance;
+  }
+
+  // Registers `pool`, replacing the pool with the same parameters.
+  void Register(std::shared_ptr<RsaKeyPool> pool) {
+    absl::MutexLock lock(&mutex_);
+    for (std::shared_ptr<RsaKeyPool>& registered : pools_) {
+      if (registered->Matches(pool->modulus_size_in_bits(), pool->e())) {
+        registered = std::move(pool);
+        return;
+      }
+    }
+    pools_.push_back(std::move(pool));
+  }
+
+  void Clear() {
+    absl::MutexLock lock(&mutex_);
+    pools_.clear();
+  }
+
+  // Returns the pool for `modulus_size_in_bits` and `e`, or nullptr.
+  std::shared_ptr<RsaKeyPool> Get(int modulus_size_in_bits, const BIGNUM* e) {
+    absl::MutexLock lock(&mutex_);
+    for (const std::shared_ptr<RsaKeyPool>& registered : pools_) {
+      if (registered->Matches(modulus_size_in_bits, e)) return registered;
+    }
+    return nullptr;
+  }
+
+ private:
+  absl::Mutex mutex_;
+  // Few pools are registered, so they are searched linearly.
+  std::vector<std::shared_ptr<RsaKeyPool>> pools_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace
+
+util::StatusOr<std::unique_ptr<RsaKeyPool>> RsaKeyPool::New(
+    int modulus_size_in_bits, const BIGNUM* e, int capacity) {
+  if (capacity < 1) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "capacity must be positive");
+  }
+  util::Status status = ValidateRsaModulusSize(modulus_size_in_bits);
+  if (!status.ok()) {
+    return status;
+  }
+  status = ValidateRsaPublicExponent(e);
+  if (!status.ok()) {
+    return status;
+  }
+  SslUniquePtr<BIGNUM> e_copy(BN_dup(e));
+  if (e_copy == nullptr) {
+    return util::Status(absl::StatusCode::kInternal, GetSslErrors());
+  }
+  return {absl::WrapUnique(
+      new RsaKeyPool(modulus_size_in_bits, std::move(e_copy), capacity))};
+}
+
+RsaKeyPool::RsaKeyPool(int modulus_size_in_bits, SslUniquePtr<BIGNUM> e,
+                       int capacity)
+    : modulus_size_in_bits_(modulus_size_in_bits),
+      e_(std::move(e)),
+      capacity_(capacity),
+      pid_(getpid()) {}
+
+void RsaKeyPool::DiscardKeysAfterFork() {
+  pid_t pid = getpid();
+  if (pid != pid_) {
+    keys_.clear();
+    pid_ = pid;
+  }
+}
+
+util::StatusOr<int> RsaKeyPool::Refill() {
+  int added = 0;
+  while (true) {
+    {
+      absl::MutexLock lock(&mutex_);
+      DiscardKeysAfterFork();
+      if (keys_.size() >= capacity_) {
+        return added;
+      }
+    }
+    // The key pair is generated without holding the lock, so that key
+    // creation is not blocked while the pool is refilled.
+    KeyPair key;
+    util::Status status = NewRsaKeyPair(modulus_size_in_bits_, e_.get(),
+                                        &key.private_key, &key.public_key);
+    if (!status.ok()) {
+      return status;
+    }
+    absl::MutexLock lock(&mutex_);
+    DiscardKeysAfterFork();
+    if (keys_.size() >= capacity_) {
+      return added;
+    }
+    keys_.push_back(std::move(key));
+    ++added;
+  }
+}
+
+bool RsaKeyPool::Take(RsaPrivateKey* private_key, RsaPublicKey* public_key) {
+  absl::MutexLock lock(&mutex_);
+  DiscardKeysAfterFork();
+  if (keys_.empty()) {
+    return false;
+  }
+  *private_key = std::move(keys_.back().private_key);
+  *public_key = std::move(keys_.back().public_key);
+  keys_.pop_back();
+  return true;
+}
+
+int RsaKeyPool::size() {
+  absl::MutexLock lock(&mutex_);
+  DiscardKeysAfterFork();
+  return keys_.size();
+}
+
+bool RsaKeyPool::Matches(int modulus_size_in_bits, const BIGNUM* e) const {
+  return modulus_size_in_bits == modulus_size_in_bits_ &&
+         BN_cmp(e, e_.get()) == 0;
+}
+
+void RegisterRsaKeyPool(std::shared_ptr<RsaKeyPool> pool) {
+  if (pool == nullptr) return;
+  RsaKeyPoolRegistry::GlobalInstance().Register(std::move(pool));
+}
+
+void UnregisterRsaKeyPools() { RsaKeyPoolRegistry::GlobalInstance().Clear(); }
+
+util::Status NewRsaKeyPairFromPool(int modulus_size_in_bits, const BIGNUM* e,
+                                   RsaPrivateKey* private_key,
+                                   RsaPublicKey* public_key) {
+  std::shared_ptr<RsaKeyPool> pool =
+      RsaKeyPoolRegistry::GlobalInstance().Get(modulus_size_in_bits, e);
+  if (pool != nullptr && pool->Take(private_key, public_key)) {
+    return util::OkStatus();
+  }
+  return NewRsaKeyPair(modulus_size_in_bits, e, private_key, public_key);
+}
+
+}  // namespace internal
+}  // namespace tink
+}  // namespace crypto
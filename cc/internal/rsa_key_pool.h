@@ -0,0 +1,118 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef TINK_INTERNAL_RSA_KEY_POOL_H_
+#define TINK_INTERNAL_RSA_KEY_POOL_H_
+
+#include <sys/types.h>
+
+#include <memory>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "openssl/bn.h"
+#include "tink/internal/rsa_util.h"
+#include "tink/internal/ssl_unique_ptr.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace internal {
+
+// Pool of pre-generated RSA key pairs for one modulus size and public
+// exponent, so that creating a key does not wait for RSA_generate_key_ex(),
+// which takes seconds for large moduli.
+//
+// Refill() generates key pairs, and is meant to be called from a background
+// thread. Each key pair is removed from the pool before it is returned, so it
+// is returned at most once. The private key material is kept in SecretData,
+// which is cleared when it is freed. After a fork(), the child process never
+// uses key pairs generated by its parent.
+//
+// This class is thread-safe.
+class RsaKeyPool {
+ public:
+  // Creates a pool of at most `capacity` key pairs with modulus size
+  // `modulus_size_in_bits` and public exponent `e`.
+  static util::StatusOr<std::unique_ptr<RsaKeyPool>> New(
+      int modulus_size_in_bits, const BIGNUM* e, int capacity);
+
+  // Not copyable or movable.
+  RsaKeyPool(const RsaKeyPool&) = delete;
+  RsaKeyPool& operator=(const RsaKeyPool&) = delete;
+
+  // Generates key pairs until the pool is full, and returns the number of
+  // key pairs that were added.
+  util::StatusOr<int> Refill();
+
+  // Removes a key pair from the pool and moves it to `private_key` and
+  // `public_key`. Returns false, and leaves both unchanged, if the pool is
+  // empty.
+  bool Take(RsaPrivateKey* private_key, RsaPublicKey* public_key);
+
+  // Returns the number of key pairs in the pool.
+  int size();
+
+  int modulus_size_in_bits() const { return modulus_size_in_bits_; }
+  const BIGNUM* e() const { return e_.get(); }
+
+  // Returns true if the pool holds keys with modulus size
+  // `modulus_size_in_bits` and public exponent `e`.
+  bool Matches(int modulus_size_in_bits, const BIGNUM* e) const;
+
+ private:
+  struct KeyPair {
+    RsaPrivateKey private_key;
+    RsaPublicKey public_key;
+  };
+
+  RsaKeyPool(int modulus_size_in_bits, SslUniquePtr<BIGNUM> e, int capacity);
+
+  // Discards the key pairs if they were generated by another process.
+  void DiscardKeysAfterFork() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const int modulus_size_in_bits_;
+  const SslUniquePtr<BIGNUM> e_;
+  const int capacity_;
+  absl::Mutex mutex_;
+  // Process that generated `keys_`.
+  pid_t pid_ ABSL_GUARDED_BY(mutex_);
+  std::vector<KeyPair> keys_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Makes NewRsaKeyPairFromPool() take key pairs from `pool` for its modulus
+// size and public exponent. Replaces a pool registered before for the same
+// parameters.
+void RegisterRsaKeyPool(std::shared_ptr<RsaKeyPool> pool);
+
+// Removes all pools registered with RegisterRsaKeyPool().
+void UnregisterRsaKeyPools();
+
+// Same as NewRsaKeyPair(), but takes the key pair from the registered pool
+// for `modulus_size_in_bits` and `e` if it is not empty. This is used by the
+// key managers of RSA signature keys.
+util::Status NewRsaKeyPairFromPool(int modulus_size_in_bits, const BIGNUM* e,
+                                   RsaPrivateKey* private_key,
+                                   RsaPublicKey* public_key);
+
+}  // namespace internal
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_INTERNAL_RSA_KEY_POOL_H_
@@ -0,0 +1,201 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+
+#include "tink/internal/rsa_key_pool.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <memory>
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "openssl/bn.h"
+#include "openssl/rsa.h"
+#include "tink/internal/rsa_util.h"
+#include "tink/internal/ssl_unique_ptr.h"
+#include "tink/util/statusor.h"
+#include "tink/util/test_matchers.h"
+
+namespace crypto {
+namespace tink {
+namespace internal {
+namespace {
+
+using ::crypto::tink::test::IsOk;
+using ::crypto::tink::test::IsOkAndHolds;
+using ::crypto::tink::test::StatusIs;
+using ::testing::Eq;
+using ::testing::IsEmpty;
+using ::testing::Ne;
+
+constexpr int kModulusSizeInBits = 2048;
+
+SslUniquePtr<BIGNUM> NewExponent(BN_ULONG value) {
+  SslUniquePtr<BIGNUM> e(BN_new());
+  BN_set_word(e.get(), value);
+  return e;
+}
+
+std::unique_ptr<RsaKeyPool> NewPool(int capacity) {
+  util::StatusOr<std::unique_ptr<RsaKeyPool>> pool = RsaKeyPool::New(
+      kModulusSizeInBits, NewExponent(RSA_F4).get(), capacity);
+  return pool.ok() ? *std::move(pool) : nullptr;
+}
+
+TEST(RsaKeyPoolTest, InvalidParametersFail) {
+  EXPECT_THAT(
+      RsaKeyPool::New(kModulusSizeInBits, NewExponent(RSA_F4).get(),
+                      /*capacity=*/0)
+          .status(),
+      StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(RsaKeyPool::New(/*modulus_size_in_bits=*/1024,
+                              NewExponent(RSA_F4).get(), /*capacity=*/1)
+                  .status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(RsaKeyPool::New(kModulusSizeInBits, NewExponent(3).get(),
+                              /*capacity=*/1)
+                  .status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(RsaKeyPoolTest, RefillFillsPool) {
+  std::unique_ptr<RsaKeyPool> pool = NewPool(/*capacity=*/2);
+  ASSERT_TRUE(pool);
+  EXPECT_THAT(pool->size(), Eq(0));
+  EXPECT_THAT(pool->Refill(), IsOkAndHolds(2));
+  EXPECT_THAT(pool->size(), Eq(2));
+  EXPECT_THAT(pool->Refill(), IsOkAndHolds(0));
+}
+
+TEST(RsaKeyPoolTest, EachKeyIsTakenOnce) {
+  std::unique_ptr<RsaKeyPool> pool = NewPool(/*capacity=*/2);
+  ASSERT_TRUE(pool);
+  ASSERT_THAT(pool->Refill(), IsOkAndHolds(2));
+
+  RsaPrivateKey first_private_key;
+  RsaPublicKey first_public_key;
+  ASSERT_TRUE(pool->Take(&first_private_key, &first_public_key));
+  RsaPrivateKey second_private_key;
+  RsaPublicKey second_public_key;
+  ASSERT_TRUE(pool->Take(&second_private_key, &second_public_key));
+  EXPECT_THAT(pool->size(), Eq(0));
+
+  EXPECT_THAT(first_public_key.n, Eq(first_private_key.n));
+  EXPECT_THAT(second_public_key.n, Eq(second_private_key.n));
+  EXPECT_THAT(first_public_key.n, Ne(second_public_key.n));
+  for (const RsaPrivateKey* private_key :
+       {&first_private_key, &second_private_key}) {
+    util::StatusOr<SslUniquePtr<RSA>> rsa = RsaPrivateKeyToRsa(*private_key);
+    ASSERT_THAT(rsa, IsOk());
+    EXPECT_THAT(RSA_bits(rsa->get()), Eq(kModulusSizeInBits));
+    EXPECT_THAT(RSA_check_key(rsa->get()), Eq(1));
+  }
+
+  // The pool is empty.
+  RsaPrivateKey private_key;
+  RsaPublicKey public_key;
+  EXPECT_FALSE(pool->Take(&private_key, &public_key));
+  EXPECT_THAT(public_key.n, IsEmpty());
+}
+
+TEST(RsaKeyPoolTest, ChildProcessDiscardsKeys) {
+  std::unique_ptr<RsaKeyPool> pool = NewPool(/*capacity=*/1);
+  ASSERT_TRUE(pool);
+  ASSERT_THAT(pool->Refill(), IsOkAndHolds(1));
+
+  pid_t pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    RsaPrivateKey private_key;
+    RsaPublicKey public_key;
+    bool discarded =
+        !pool->Take(&private_key, &public_key) && pool->size() == 0;
+    _exit(discarded ? 0 : 1);
+  }
+  int status;
+  ASSERT_THAT(waitpid(pid, &status, 0), Eq(pid));
+  ASSERT_TRUE(WIFEXITED(status));
+  EXPECT_THAT(WEXITSTATUS(status), Eq(0));
+  // The parent still has its keys.
+  EXPECT_THAT(pool->size(), Eq(1));
+}
+
+TEST(RsaKeyPoolTest, NewRsaKeyPairFromPoolTakesRegisteredKeys) {
+  std::shared_ptr<RsaKeyPool> pool = NewPool(/*capacity=*/1);
+  ASSERT_TRUE(pool);
+  ASSERT_THAT(pool->Refill(), IsOkAndHolds(1));
+  RegisterRsaKeyPool(pool);
+
+  // A key with other parameters is not taken from the pool.
+  RsaPrivateKey private_key;
+  RsaPublicKey public_key;
+  ASSERT_THAT(NewRsaKeyPairFromPool(/*modulus_size_in_bits=*/3072,
+                                    NewExponent(RSA_F4).get(), &private_key,
+                                    &public_key),
+              IsOk());
+  EXPECT_THAT(pool->size(), Eq(1));
+
+  ASSERT_THAT(NewRsaKeyPairFromPool(kModulusSizeInBits,
+                                    NewExponent(RSA_F4).get(), &private_key,
+                                    &public_key),
+              IsOk());
+  EXPECT_THAT(pool->size(), Eq(0));
+
+  // An empty pool falls back to generating the key.
+  ASSERT_THAT(NewRsaKeyPairFromPool(kModulusSizeInBits,
+                                    NewExponent(RSA_F4).get(), &private_key,
+                                    &public_key),
+              IsOk());
+  EXPECT_THAT(public_key.n.size(), Eq(kModulusSizeInBits / 8));
+
+  ASSERT_THAT(pool->Refill(), IsOkAndHolds(1));
+  UnregisterRsaKeyPools();
+  ASSERT_THAT(NewRsaKeyPairFromPool(kModulusSizeInBits,
+                                    NewExponent(RSA_F4).get(), &private_key,
+                                    &public_key),
+              IsOk());
+  EXPECT_THAT(pool->size(), Eq(1));
+}
+
+TEST(RsaKeyPoolTest, RegisteringReplacesPoolWithSameParameters) {
+  std::shared_ptr<RsaKeyPool> first_pool = NewPool(/*capacity=*/1);
+  std::shared_ptr<RsaKeyPool> second_pool = NewPool(/*capacity=*/1);
+  ASSERT_TRUE(first_pool);
+  ASSERT_TRUE(second_pool);
+  ASSERT_THAT(first_pool->Refill(), IsOkAndHolds(1));
+  ASSERT_THAT(second_pool->Refill(), IsOkAndHolds(1));
+  RegisterRsaKeyPool(first_pool);
+  RegisterRsaKeyPool(second_pool);
+
+  RsaPrivateKey private_key;
+  RsaPublicKey public_key;
+  ASSERT_THAT(NewRsaKeyPairFromPool(kModulusSizeInBits,
+                                    NewExponent(RSA_F4).get(), &private_key,
+                                    &public_key),
+              IsOk());
+  EXPECT_THAT(first_pool->size(), Eq(1));
+  EXPECT_THAT(second_pool->size(), Eq(0));
+  UnregisterRsaKeyPools();
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace tink
+}  // namespace crypto
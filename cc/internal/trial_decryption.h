@@ -0,0 +1,122 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+#ifndef TINK_INTERNAL_TRIAL_DECRYPTION_H_
+#define TINK_INTERNAL_TRIAL_DECRYPTION_H_
+
+#include <string>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "tink/aead.h"
+#include "tink/deterministic_aead.h"
+#include "tink/mac.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace internal {
+
+// Keyset wrappers try every candidate key in turn until one of them decrypts
+// or verifies the input; all failures but the last are discarded. The
+// interfaces below are optionally implemented by primitives next to their
+// public interface to report such failures with a plain boolean, so that
+// a failed attempt does not build (and allocate) an error status. Wrappers
+// build a single error status once all candidates have failed.
+
+// Optional interface of Aead implementations.
+class TrialDecryptionAead {
+ public:
+  virtual ~TrialDecryptionAead() = default;
+
+  // Decrypts `ciphertext` into `plaintext` and returns true, or returns false
+  // if decryption fails for any reason. The contents of `plaintext` are
+  // unspecified on failure; its capacity may be reused across calls.
+  virtual bool TryDecrypt(absl::string_view ciphertext,
+                          absl::string_view associated_data,
+                          std::string* plaintext) const = 0;
+};
+
+// Optional interface of DeterministicAead implementations.
+class TrialDecryptionDeterministicAead {
+ public:
+  virtual ~TrialDecryptionDeterministicAead() = default;
+
+  // Same as TrialDecryptionAead::TryDecrypt(), for DecryptDeterministically().
+  virtual bool TryDecryptDeterministically(absl::string_view ciphertext,
+                                           absl::string_view associated_data,
+                                           std::string* plaintext) const = 0;
+};
+
+// Optional interface of Mac implementations.
+class TrialVerificationMac {
+ public:
+  virtual ~TrialVerificationMac() = default;
+
+  // Returns true if `mac_value` is a valid MAC of `data`, and false otherwise.
+  virtual bool TryVerifyMac(absl::string_view mac_value,
+                            absl::string_view data) const = 0;
+};
+
+// Decrypts with `aead`, through TrialDecryptionAead if `aead` implements it.
+inline bool TryDecrypt(const Aead& aead, absl::string_view ciphertext,
+                       absl::string_view associated_data,
+                       std::string* plaintext) {
+  auto* trial_aead = dynamic_cast<const TrialDecryptionAead*>(&aead);
+  if (trial_aead != nullptr) {
+    return trial_aead->TryDecrypt(ciphertext, associated_data, plaintext);
+  }
+  util::StatusOr<std::string> result =
+      aead.Decrypt(ciphertext, associated_data);
+  if (!result.ok()) return false;
+  *plaintext = *std::move(result);
+  return true;
+}
+
+// Decrypts with `daead`, through TrialDecryptionDeterministicAead if `daead`
+// implements it.
+inline bool TryDecryptDeterministically(const DeterministicAead& daead,
+                                        absl::string_view ciphertext,
+                                        absl::string_view associated_data,
+                                        std::string* plaintext) {
+  auto* trial_daead =
+      dynamic_cast<const TrialDecryptionDeterministicAead*>(&daead);
+  if (trial_daead != nullptr) {
+    return trial_daead->TryDecryptDeterministically(ciphertext,
+                                                    associated_data, plaintext);
+  }
+  util::StatusOr<std::string> result =
+      daead.DecryptDeterministically(ciphertext, associated_data);
+  if (!result.ok()) return false;
+  *plaintext = *std::move(result);
+  return true;
+}
+
+// Verifies with `mac`, through TrialVerificationMac if `mac` implements it.
+inline bool TryVerifyMac(const Mac& mac, absl::string_view mac_value,
+                         absl::string_view data) {
+  auto* trial_mac = dynamic_cast<const TrialVerificationMac*>(&mac);
+  if (trial_mac != nullptr) {
+    return trial_mac->TryVerifyMac(mac_value, data);
+  }
+  return mac.VerifyMac(mac_value, data).ok();
+}
+
+}  // namespace internal
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_INTERNAL_TRIAL_DECRYPTION_H_
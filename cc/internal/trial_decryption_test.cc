@@ -0,0 +1,161 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+#include "tink/internal/trial_decryption.h"
+
+#include <memory>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/string_view.h"
+#include "tink/aead.h"
+#include "tink/deterministic_aead.h"
+#include "tink/internal/fips_utils.h"
+#include "tink/mac.h"
+#include "tink/subtle/aes_cmac_boringssl.h"
+#include "tink/subtle/aes_gcm_boringssl.h"
+#include "tink/subtle/aes_siv_boringssl.h"
+#include "tink/subtle/common_enums.h"
+#include "tink/subtle/hmac_boringssl.h"
+#include "tink/subtle/random.h"
+#include "tink/util/secret_data.h"
+#include "tink/util/statusor.h"
+#include "tink/util/test_matchers.h"
+#include "tink/util/test_util.h"
+
+namespace crypto {
+namespace tink {
+namespace internal {
+namespace {
+
+using ::crypto::tink::test::DummyAead;
+using ::crypto::tink::test::DummyDeterministicAead;
+using ::crypto::tink::test::DummyMac;
+using ::crypto::tink::test::IsOk;
+using ::testing::IsNull;
+using ::testing::Not;
+using ::testing::NotNull;
+
+constexpr absl::string_view kPlaintext = "plaintext";
+constexpr absl::string_view kAssociatedData = "associated data";
+
+TEST(TrialDecryptionTest, AesGcm) {
+  util::StatusOr<std::unique_ptr<Aead>> aead = subtle::AesGcmBoringSsl::New(
+      util::SecretDataFromStringView(subtle::Random::GetRandomBytes(16)));
+  ASSERT_THAT(aead, IsOk());
+  EXPECT_THAT(dynamic_cast<TrialDecryptionAead*>(aead->get()), NotNull());
+  util::StatusOr<std::string> ciphertext =
+      (*aead)->Encrypt(kPlaintext, kAssociatedData);
+  ASSERT_THAT(ciphertext, IsOk());
+
+  std::string plaintext;
+  EXPECT_TRUE(TryDecrypt(**aead, *ciphertext, kAssociatedData, &plaintext));
+  EXPECT_EQ(plaintext, kPlaintext);
+  // The same buffer can be reused across attempts.
+  EXPECT_FALSE(TryDecrypt(**aead, *ciphertext, "wrong", &plaintext));
+  EXPECT_TRUE(TryDecrypt(**aead, *ciphertext, kAssociatedData, &plaintext));
+  EXPECT_EQ(plaintext, kPlaintext);
+  EXPECT_FALSE(TryDecrypt(**aead, "short", kAssociatedData, &plaintext));
+  std::string modified_ciphertext = *ciphertext;
+  modified_ciphertext.back() ^= 1;
+  EXPECT_FALSE(
+      TryDecrypt(**aead, modified_ciphertext, kAssociatedData, &plaintext));
+}
+
+TEST(TrialDecryptionTest, AesSiv) {
+  if (IsFipsModeEnabled()) {
+    GTEST_SKIP() << "Not supported in FIPS-only mode";
+  }
+  util::StatusOr<std::unique_ptr<DeterministicAead>> daead =
+      subtle::AesSivBoringSsl::New(
+          util::SecretDataFromStringView(subtle::Random::GetRandomBytes(64)));
+  ASSERT_THAT(daead, IsOk());
+  util::StatusOr<std::string> ciphertext =
+      (*daead)->EncryptDeterministically(kPlaintext, kAssociatedData);
+  ASSERT_THAT(ciphertext, IsOk());
+
+  std::string plaintext;
+  EXPECT_TRUE(TryDecryptDeterministically(**daead, *ciphertext,
+                                          kAssociatedData, &plaintext));
+  EXPECT_EQ(plaintext, kPlaintext);
+  EXPECT_FALSE(
+      TryDecryptDeterministically(**daead, *ciphertext, "wrong", &plaintext));
+  EXPECT_FALSE(TryDecryptDeterministically(**daead, "short", kAssociatedData,
+                                           &plaintext));
+  // The status-returning API still reports why decryption failed.
+  EXPECT_THAT((*daead)->DecryptDeterministically(*ciphertext, "wrong").status(),
+              Not(IsOk()));
+}
+
+TEST(TrialDecryptionTest, Hmac) {
+  util::StatusOr<std::unique_ptr<Mac>> mac = subtle::HmacBoringSsl::New(
+      subtle::HashType::SHA256, /*tag_size=*/16,
+      util::SecretDataFromStringView(subtle::Random::GetRandomBytes(16)));
+  ASSERT_THAT(mac, IsOk());
+  util::StatusOr<std::string> tag = (*mac)->ComputeMac(kPlaintext);
+  ASSERT_THAT(tag, IsOk());
+
+  EXPECT_TRUE(TryVerifyMac(**mac, *tag, kPlaintext));
+  EXPECT_FALSE(TryVerifyMac(**mac, *tag, "other data"));
+  EXPECT_FALSE(TryVerifyMac(**mac, tag->substr(1), kPlaintext));
+}
+
+TEST(TrialDecryptionTest, AesCmac) {
+  if (IsFipsModeEnabled()) {
+    GTEST_SKIP() << "Not supported in FIPS-only mode";
+  }
+  util::StatusOr<std::unique_ptr<Mac>> mac = subtle::AesCmacBoringSsl::New(
+      util::SecretDataFromStringView(subtle::Random::GetRandomBytes(32)),
+      /*tag_size=*/16);
+  ASSERT_THAT(mac, IsOk());
+  util::StatusOr<std::string> tag = (*mac)->ComputeMac(kPlaintext);
+  ASSERT_THAT(tag, IsOk());
+
+  EXPECT_TRUE(TryVerifyMac(**mac, *tag, kPlaintext));
+  EXPECT_THAT((*mac)->VerifyMac(*tag, kPlaintext), IsOk());
+  EXPECT_FALSE(TryVerifyMac(**mac, *tag, "other data"));
+  EXPECT_FALSE(TryVerifyMac(**mac, tag->substr(1), kPlaintext));
+}
+
+TEST(TrialDecryptionTest, FallsBackToStatusApi) {
+  DummyAead aead("aead");
+  EXPECT_THAT(dynamic_cast<TrialDecryptionAead*>(&aead), IsNull());
+  util::StatusOr<std::string> ciphertext =
+      aead.Encrypt(kPlaintext, kAssociatedData);
+  ASSERT_THAT(ciphertext, IsOk());
+  std::string plaintext;
+  EXPECT_TRUE(TryDecrypt(aead, *ciphertext, kAssociatedData, &plaintext));
+  EXPECT_EQ(plaintext, kPlaintext);
+  EXPECT_FALSE(TryDecrypt(aead, *ciphertext, "wrong", &plaintext));
+
+  DummyDeterministicAead daead("daead");
+  ciphertext = daead.EncryptDeterministically(kPlaintext, kAssociatedData);
+  ASSERT_THAT(ciphertext, IsOk());
+  EXPECT_TRUE(TryDecryptDeterministically(daead, *ciphertext, kAssociatedData,
+                                          &plaintext));
+  EXPECT_EQ(plaintext, kPlaintext);
+
+  DummyMac mac("mac");
+  util::StatusOr<std::string> tag = mac.ComputeMac(kPlaintext);
+  ASSERT_THAT(tag, IsOk());
+  EXPECT_TRUE(TryVerifyMac(mac, *tag, kPlaintext));
+  EXPECT_FALSE(TryVerifyMac(mac, *tag, "other data"));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,168 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/jwt/internal/base64_url.h"
+
+#include <cstdint>
+#include <string>
+
+#include "tink/subtle/subtle_util.h"
+
+namespace crypto {
+namespace tink {
+namespace jwt_internal {
+
+namespace {
+
+constexpr char kAlphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+// Value of kDecodeTable for characters that are not in kAlphabet. All valid
+// values are smaller than 64, so this bit is only set for invalid characters.
+constexpr uint32_t kInvalid = 0x100;
+
+struct DecodeTable {
+  uint32_t values[256];
+};
+
+constexpr DecodeTable MakeDecodeTable() {
+  DecodeTable table = {};
+  for (int i = 0; i < 256; ++i) {
+    table.values[i] = kInvalid;
+  }
+  for (int i = 0; i < 64; ++i) {
+    table.values[static_cast<uint8_t>(kAlphabet[i])] = i;
+  }
+  return table;
+}
+
+constexpr DecodeTable kDecodeTable = MakeDecodeTable();
+
+// Encodes the 3 bytes at `in` into 4 characters at `out`.
+inline void EncodeBlock(const uint8_t* in, char* out) {
+  uint32_t block = (in[0] << 16) | (in[1] << 8) | in[2];
+  out[0] = kAlphabet[block >> 18];
+  out[1] = kAlphabet[(block >> 12) & 0x3f];
+  out[2] = kAlphabet[(block >> 6) & 0x3f];
+  out[3] = kAlphabet[block & 0x3f];
+}
+
+// Returns the 24 bits encoded by the 4 characters at `in`. Sets kInvalid in
+// `invalid` if one of the characters is not in kAlphabet.
+inline uint32_t DecodeBlock(const uint8_t* in, uint32_t* invalid) {
+  uint32_t a = kDecodeTable.values[in[0]];
+  uint32_t b = kDecodeTable.values[in[1]];
+  uint32_t c = kDecodeTable.values[in[2]];
+  uint32_t d = kDecodeTable.values[in[3]];
+  *invalid |= a | b | c | d;
+  return (a << 18) | (b << 12) | (c << 6) | d;
+}
+
+}  // namespace
+
+std::size_t Base64UrlEncodedSize(std::size_t size) {
+  return (size / 3) * 4 + ((size % 3) * 4 + 2) / 3;
+}
+
+void AppendBase64UrlEncoded(absl::string_view data, std::string* output) {
+  std::size_t start = output->size();
+  subtle::ResizeStringUninitialized(output,
+                                    start + Base64UrlEncodedSize(data.size()));
+  char* out = &(*output)[start];
+  const auto* in = reinterpret_cast<const uint8_t*>(data.data());
+  std::size_t i = 0;
+  for (; i + 3 <= data.size(); i += 3, out += 4) {
+    EncodeBlock(in + i, out);
+  }
+  std::size_t remaining = data.size() - i;
+  if (remaining > 0) {
+    uint8_t last_block[3] = {0, 0, 0};
+    char encoded[4];
+    for (std::size_t j = 0; j < remaining; ++j) {
+      last_block[j] = in[i + j];
+    }
+    EncodeBlock(last_block, encoded);
+    for (std::size_t j = 0; j < remaining + 1; ++j) {
+      out[j] = encoded[j];
+    }
+  }
+}
+
+std::string Base64UrlEncode(absl::string_view data) {
+  std::string output;
+  AppendBase64UrlEncoded(data, &output);
+  return output;
+}
+
+absl::optional<std::size_t> Base64UrlDecodedSize(std::size_t encoded_size) {
+  if (encoded_size % 4 == 1) {
+    return absl::nullopt;
+  }
+  return (encoded_size / 4) * 3 + (encoded_size % 4) * 3 / 4;
+}
+
+bool Base64UrlDecode(absl::string_view encoded, absl::Span<char> output) {
+  absl::optional<std::size_t> decoded_size =
+      Base64UrlDecodedSize(encoded.size());
+  if (!decoded_size.has_value() || output.size() < *decoded_size) {
+    return false;
+  }
+  const auto* in = reinterpret_cast<const uint8_t*>(encoded.data());
+  char* out = output.data();
+  // Invalid characters are collected here and checked once at the end, so
+  // that the loop does not branch on the input.
+  uint32_t invalid = 0;
+  std::size_t i = 0;
+  for (; i + 4 <= encoded.size(); i += 4, out += 3) {
+    uint32_t block = DecodeBlock(in + i, &invalid);
+    out[0] = static_cast<char>(block >> 16);
+    out[1] = static_cast<char>(block >> 8);
+    out[2] = static_cast<char>(block);
+  }
+  std::size_t remaining = encoded.size() - i;
+  if (remaining > 0) {
+    uint8_t last_block[4] = {kAlphabet[0], kAlphabet[0], kAlphabet[0],
+                             kAlphabet[0]};
+    for (std::size_t j = 0; j < remaining; ++j) {
+      last_block[j] = in[i + j];
+    }
+    uint32_t block = DecodeBlock(last_block, &invalid);
+    out[0] = static_cast<char>(block >> 16);
+    if (remaining == 3) {
+      out[1] = static_cast<char>(block >> 8);
+    }
+  }
+  return (invalid & kInvalid) == 0;
+}
+
+bool Base64UrlDecode(absl::string_view encoded, std::string* output) {
+  absl::optional<std::size_t> decoded_size =
+      Base64UrlDecodedSize(encoded.size());
+  if (!decoded_size.has_value()) {
+    return false;
+  }
+  subtle::ResizeStringUninitialized(output, *decoded_size);
+  if (!Base64UrlDecode(encoded,
+                       absl::MakeSpan(&(*output)[0], output->size()))) {
+    output->clear();
+    return false;
+  }
+  return true;
+}
+
+}  // namespace jwt_internal
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,62 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_JWT_INTERNAL_BASE64_URL_H_
+#define TINK_JWT_INTERNAL_BASE64_URL_H_
+
+#include <cstddef>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+
+namespace crypto {
+namespace tink {
+namespace jwt_internal {
+
+// Unpadded base64url encoding (RFC 4648, section 5), as used by JWS and JWK.
+//
+// The decoder is strict: it only accepts characters of the base64url
+// alphabet, so padding, whitespace and characters of the standard base64
+// alphabet are rejected. Characters are validated while they are decoded.
+
+// Returns the length of the encoding of `size` bytes.
+std::size_t Base64UrlEncodedSize(std::size_t size);
+
+// Appends the encoding of `data` to `output`.
+void AppendBase64UrlEncoded(absl::string_view data, std::string* output);
+
+// Returns the encoding of `data`.
+std::string Base64UrlEncode(absl::string_view data);
+
+// Returns the number of bytes encoded by `encoded_size` characters, or
+// nullopt if no encoding has this length.
+absl::optional<std::size_t> Base64UrlDecodedSize(std::size_t encoded_size);
+
+// Decodes `encoded` into the first Base64UrlDecodedSize(encoded.size()) bytes
+// of `output`. Returns false if `encoded` is not a valid encoding or if
+// `output` is too small; the content of `output` is then unspecified.
+bool Base64UrlDecode(absl::string_view encoded, absl::Span<char> output);
+
+// Same as above, but replaces the content of `output` with the decoding.
+bool Base64UrlDecode(absl::string_view encoded, std::string* output);
+
+}  // namespace jwt_internal
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_JWT_INTERNAL_BASE64_URL_H_
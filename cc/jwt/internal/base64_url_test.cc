@@ -0,0 +1,118 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/jwt/internal/base64_url.h"
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/escaping.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+
+using ::testing::Eq;
+
+namespace crypto {
+namespace tink {
+namespace jwt_internal {
+namespace {
+
+// Returns `size` bytes that cover all values of the encoding alphabet.
+std::string TestData(int size) {
+  std::string data;
+  for (int i = 0; i < size; ++i) {
+    data.push_back(static_cast<char>(i * 89 + 251));
+  }
+  return data;
+}
+
+TEST(Base64UrlTest, EncodeMatchesWebSafeBase64Escape) {
+  for (int size = 0; size < 100; ++size) {
+    std::string data = TestData(size);
+    std::string encoded = Base64UrlEncode(data);
+    EXPECT_THAT(encoded, Eq(absl::WebSafeBase64Escape(data)));
+    EXPECT_THAT(encoded.size(), Eq(Base64UrlEncodedSize(size)));
+  }
+}
+
+TEST(Base64UrlTest, AppendEncoded) {
+  std::string output = "prefix.";
+  AppendBase64UrlEncoded("abcd", &output);
+  EXPECT_THAT(output, Eq("prefix.YWJjZA"));
+}
+
+TEST(Base64UrlTest, DecodeEncoded) {
+  for (int size = 0; size < 100; ++size) {
+    std::string data = TestData(size);
+    std::string encoded = Base64UrlEncode(data);
+    ASSERT_THAT(Base64UrlDecodedSize(encoded.size()), Eq(size));
+    std::string decoded = "previous content";
+    ASSERT_TRUE(Base64UrlDecode(encoded, &decoded));
+    EXPECT_THAT(decoded, Eq(data));
+  }
+}
+
+TEST(Base64UrlTest, DecodeIntoBuffer) {
+  char buffer[5] = {'x', 'x', 'x', 'x', 'x'};
+  ASSERT_TRUE(Base64UrlDecode("YWJjZA", absl::MakeSpan(buffer)));
+  EXPECT_THAT(std::string(buffer, 5), Eq("abcdx"));
+  EXPECT_FALSE(Base64UrlDecode("YWJjZA", absl::MakeSpan(buffer, 3)));
+}
+
+TEST(Base64UrlTest, DecodeKnownValues) {
+  std::string decoded;
+  ASSERT_TRUE(Base64UrlDecode("", &decoded));
+  EXPECT_THAT(decoded, Eq(""));
+  ASSERT_TRUE(Base64UrlDecode("-_-_", &decoded));
+  EXPECT_THAT(decoded, Eq("\xfb\xff\xbf"));
+  ASSERT_TRUE(Base64UrlDecode("eyJhbGciOiJIUzI1NiJ9", &decoded));
+  EXPECT_THAT(decoded, Eq(R"({"alg":"HS256"})"));
+}
+
+TEST(Base64UrlTest, DecodeInvalidLengthFails) {
+  EXPECT_THAT(Base64UrlDecodedSize(1), Eq(absl::nullopt));
+  EXPECT_THAT(Base64UrlDecodedSize(5), Eq(absl::nullopt));
+  std::string decoded;
+  EXPECT_FALSE(Base64UrlDecode("A", &decoded));
+  EXPECT_FALSE(Base64UrlDecode("YWJjZ", &decoded));
+}
+
+TEST(Base64UrlTest, DecodeInvalidCharactersFails) {
+  std::string encoded = Base64UrlEncode(TestData(30));
+  for (char c : std::string("=+/ \n\r\t.\x80\xff\0", 11)) {
+    for (std::size_t i = 0; i < encoded.size(); ++i) {
+      std::string modified = encoded;
+      modified[i] = c;
+      std::string decoded;
+      EXPECT_FALSE(Base64UrlDecode(modified, &decoded))
+          << "character " << static_cast<int>(c) << " at " << i;
+      EXPECT_THAT(decoded, Eq(""));
+    }
+  }
+}
+
+TEST(Base64UrlTest, DecodePaddedFails) {
+  std::string decoded;
+  EXPECT_FALSE(Base64UrlDecode("YWI=", &decoded));
+  EXPECT_FALSE(Base64UrlDecode("YQ==", &decoded));
+  EXPECT_FALSE(Base64UrlDecode("YWJjZA==", &decoded));
+}
+
+}  // namespace
+}  // namespace jwt_internal
+}  // namespace tink
+}  // namespace crypto
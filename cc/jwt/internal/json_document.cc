@@ -0,0 +1,574 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/jwt/internal/json_document.h"
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace jwt_internal {
+
+namespace {
+
+// Same as the default recursion limit of the protobuf JSON parser.
+constexpr int kMaxDepth = 100;
+
+bool IsWhitespace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+bool IsIdentifierStart(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' ||
+         c == '$';
+}
+
+bool IsIdentifierChar(char c) { return IsIdentifierStart(c) || IsDigit(c); }
+
+int HexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+// Returns the length of the valid UTF-8 sequence at the start of `input`, or
+// 0 if it does not start with one.
+size_t Utf8SequenceLength(absl::string_view input) {
+  const unsigned char c0 = static_cast<unsigned char>(input[0]);
+  size_t length;
+  uint32_t code_point;
+  if (c0 < 0x80) {
+    return 1;
+  } else if (c0 >= 0xC2 && c0 <= 0xDF) {
+    length = 2;
+    code_point = c0 & 0x1F;
+  } else if (c0 >= 0xE0 && c0 <= 0xEF) {
+    length = 3;
+    code_point = c0 & 0x0F;
+  } else if (c0 >= 0xF0 && c0 <= 0xF4) {
+    length = 4;
+    code_point = c0 & 0x07;
+  } else {
+    return 0;
+  }
+  if (input.size() < length) return 0;
+  for (size_t i = 1; i < length; ++i) {
+    const unsigned char c = static_cast<unsigned char>(input[i]);
+    if ((c & 0xC0) != 0x80) return 0;
+    code_point = (code_point << 6) | (c & 0x3F);
+  }
+  // Reject overlong encodings, surrogates and code points above U+10FFFF.
+  if ((length == 3 && code_point < 0x800) ||
+      (length == 4 && (code_point < 0x10000 || code_point > 0x10FFFF)) ||
+      (code_point >= 0xD800 && code_point <= 0xDFFF)) {
+    return 0;
+  }
+  return length;
+}
+
+void AppendUtf8(uint32_t code_point, std::string* output) {
+  if (code_point < 0x80) {
+    output->push_back(static_cast<char>(code_point));
+  } else if (code_point < 0x800) {
+    output->push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+    output->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else if (code_point < 0x10000) {
+    output->push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+    output->push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    output->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else {
+    output->push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+    output->push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+    output->push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    output->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  }
+}
+
+// Escapes like the protobuf JSON serializer does.
+void AppendJsonString(absl::string_view value, std::string* output) {
+  output->push_back('"');
+  for (size_t i = 0; i < value.size(); ++i) {
+    const char c = value[i];
+    switch (c) {
+      case '"':
+        output->append("\\\"");
+        break;
+      case '\\':
+        output->append("\\\\");
+        break;
+      case '\b':
+        output->append("\\b");
+        break;
+      case '\f':
+        output->append("\\f");
+        break;
+      case '\n':
+        output->append("\\n");
+        break;
+      case '\r':
+        output->append("\\r");
+        break;
+      case '\t':
+        output->append("\\t");
+        break;
+      case '<':
+      case '>':
+      case '\x7f':
+        absl::StrAppendFormat(output, "\\u%04x",
+                              static_cast<unsigned char>(c));
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          absl::StrAppendFormat(output, "\\u%04x",
+                                static_cast<unsigned char>(c));
+        } else if (value.substr(i, 3) == "\xE2\x80\xA8" ||
+                   value.substr(i, 3) == "\xE2\x80\xA9") {
+          // U+2028 and U+2029 are not allowed in JavaScript strings.
+          absl::StrAppendFormat(output, "\\u%04x",
+                                value[i + 2] == '\xA8' ? 0x2028 : 0x2029);
+          i += 2;
+        } else {
+          output->push_back(c);
+        }
+    }
+  }
+  output->push_back('"');
+}
+
+// Formats like SimpleDtoa(), which the protobuf JSON serializer uses.
+void AppendJsonNumber(double value, std::string* output) {
+  std::string formatted = absl::StrFormat("%.15g", value);
+  double parsed;
+  if (!absl::SimpleAtod(formatted, &parsed) || parsed != value) {
+    formatted = absl::StrFormat("%.17g", value);
+  }
+  output->append(formatted);
+}
+
+}  // namespace
+
+// Single-pass recursive descent parser that fills a JsonDocument.
+class JsonParser {
+ public:
+  // Parses `json`, which must contain a single value of the given kind.
+  static util::StatusOr<JsonDocument> Parse(std::string json,
+                                            JsonValue::Kind kind) {
+    JsonDocument document(std::move(json));
+    if (!JsonParser(&document).ParseDocument(kind)) {
+      return util::Status(absl::StatusCode::kInvalidArgument, "invalid JSON");
+    }
+    return document;
+  }
+
+ private:
+  explicit JsonParser(JsonDocument* document)
+      : document_(document), input_(document->json_) {}
+
+  bool ParseDocument(JsonValue::Kind kind) {
+    if (input_.size() >= JsonDocument::kUnescapedBit) return false;
+    // A rough estimate that avoids reallocations for typical JWTs.
+    document_->nodes_.reserve(input_.size() / 8 + 1);
+    SkipWhitespace();
+    if (pos_ >= input_.size()) return false;
+    if ((kind == JsonValue::Kind::kObject && input_[pos_] != '{') ||
+        (kind == JsonValue::Kind::kArray && input_[pos_] != '[')) {
+      return false;
+    }
+    if (!ParseValue(/*depth=*/0)) return false;
+    SkipWhitespace();
+    return pos_ == input_.size();
+  }
+
+  void SkipWhitespace() {
+    while (pos_ < input_.size() && IsWhitespace(input_[pos_])) ++pos_;
+  }
+
+  bool Consume(char c) {
+    SkipWhitespace();
+    if (pos_ >= input_.size() || input_[pos_] != c) return false;
+    ++pos_;
+    return true;
+  }
+
+  bool ConsumeLiteral(absl::string_view literal) {
+    if (input_.substr(pos_, literal.size()) != literal) return false;
+    pos_ += literal.size();
+    return true;
+  }
+
+  uint32_t AddNode(JsonValue::Kind kind) {
+    document_->nodes_.emplace_back();
+    document_->nodes_.back().kind = kind;
+    return document_->nodes_.size() - 1;
+  }
+
+  JsonDocument::Node& node(uint32_t index) {
+    return document_->nodes_[index];
+  }
+
+  // Parses the value at the current position, after skipping whitespace.
+  bool ParseValue(int depth) {
+    SkipWhitespace();
+    if (pos_ >= input_.size()) return false;
+    switch (input_[pos_]) {
+      case '{':
+        return ParseObject(depth + 1);
+      case '[':
+        return ParseArray(depth + 1);
+      case '"': {
+        JsonDocument::StringRef value;
+        if (!ParseString(&value)) return false;
+        node(AddNode(JsonValue::Kind::kString)).string_value = value;
+        return true;
+      }
+      case 't':
+        if (!ConsumeLiteral("true")) return false;
+        node(AddNode(JsonValue::Kind::kBool)).bool_value = true;
+        return true;
+      case 'f':
+        if (!ConsumeLiteral("false")) return false;
+        AddNode(JsonValue::Kind::kBool);
+        return true;
+      case 'n':
+        if (!ConsumeLiteral("null")) return false;
+        AddNode(JsonValue::Kind::kNull);
+        return true;
+      default:
+        return ParseNumber();
+    }
+  }
+
+  bool ParseObject(int depth) {
+    if (depth > kMaxDepth) return false;
+    ++pos_;  // '{'
+    uint32_t object = AddNode(JsonValue::Kind::kObject);
+    if (Consume('}')) return true;
+    uint32_t previous = 0;
+    do {
+      SkipWhitespace();
+      JsonDocument::StringRef name;
+      if (!ParseName(&name) || !Consume(':')) return false;
+      uint32_t member = document_->nodes_.size();
+      if (!ParseValue(depth)) return false;
+      node(member).name = name;
+      if (previous != 0) node(previous).next = member;
+      previous = member;
+      ++node(object).size;
+    } while (Consume(','));
+    return Consume('}');
+  }
+
+  bool ParseArray(int depth) {
+    if (depth > kMaxDepth) return false;
+    ++pos_;  // '['
+    uint32_t array = AddNode(JsonValue::Kind::kArray);
+    if (Consume(']')) return true;
+    uint32_t previous = 0;
+    do {
+      uint32_t element = document_->nodes_.size();
+      if (!ParseValue(depth)) return false;
+      if (previous != 0) node(previous).next = element;
+      previous = element;
+      ++node(array).size;
+    } while (Consume(','));
+    return Consume(']');
+  }
+
+  // Member names are strings or, like in the protobuf JSON parser, unquoted
+  // identifiers.
+  bool ParseName(JsonDocument::StringRef* name) {
+    if (pos_ >= input_.size()) return false;
+    if (input_[pos_] == '"') return ParseString(name);
+    if (!IsIdentifierStart(input_[pos_])) return false;
+    size_t start = pos_;
+    while (pos_ < input_.size() && IsIdentifierChar(input_[pos_])) ++pos_;
+    name->offset = start;
+    name->length = pos_ - start;
+    return true;
+  }
+
+  // Parses a string starting at the opening quote. Strings without escape
+  // sequences refer to the input; the others are unescaped into unescaped_.
+  bool ParseString(JsonDocument::StringRef* value) {
+    ++pos_;  // '"'
+    size_t start = pos_;
+    std::string* unescaped = nullptr;
+    size_t unescaped_start = 0;
+    while (true) {
+      if (pos_ >= input_.size()) return false;
+      const char c = input_[pos_];
+      if (c == '"') break;
+      if (static_cast<unsigned char>(c) < 0x20) return false;
+      if (c == '\\') {
+        if (unescaped == nullptr) {
+          unescaped = &document_->unescaped_;
+          unescaped_start = unescaped->size();
+          unescaped->append(input_.data() + start, pos_ - start);
+        }
+        if (!ParseEscape(unescaped)) return false;
+        continue;
+      }
+      size_t length = Utf8SequenceLength(input_.substr(pos_));
+      if (length == 0) return false;
+      if (unescaped != nullptr) unescaped->append(input_.data() + pos_, length);
+      pos_ += length;
+    }
+    if (unescaped == nullptr) {
+      value->offset = start;
+      value->length = pos_ - start;
+    } else {
+      value->offset = unescaped_start | JsonDocument::kUnescapedBit;
+      value->length = unescaped->size() - unescaped_start;
+    }
+    ++pos_;  // '"'
+    return true;
+  }
+
+  bool ParseEscape(std::string* output) {
+    ++pos_;  // '\\'
+    if (pos_ >= input_.size()) return false;
+    const char c = input_[pos_++];
+    switch (c) {
+      case '"':
+      case '\\':
+      case '/':
+        output->push_back(c);
+        return true;
+      case 'b':
+        output->push_back('\b');
+        return true;
+      case 'f':
+        output->push_back('\f');
+        return true;
+      case 'n':
+        output->push_back('\n');
+        return true;
+      case 'r':
+        output->push_back('\r');
+        return true;
+      case 't':
+        output->push_back('\t');
+        return true;
+      case 'u':
+        break;
+      default:
+        return false;
+    }
+    uint32_t code_point;
+    if (!ParseHex4(&code_point)) return false;
+    if (code_point >= 0xDC00 && code_point <= 0xDFFF) return false;
+    if (code_point >= 0xD800 && code_point <= 0xDBFF) {
+      uint32_t low;
+      if (!ConsumeLiteral("\\u") || !ParseHex4(&low) || low < 0xDC00 ||
+          low > 0xDFFF) {
+        return false;
+      }
+      code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+    }
+    AppendUtf8(code_point, output);
+    return true;
+  }
+
+  bool ParseHex4(uint32_t* value) {
+    if (input_.size() - pos_ < 4) return false;
+    *value = 0;
+    for (int i = 0; i < 4; ++i) {
+      int digit = HexValue(input_[pos_++]);
+      if (digit < 0) return false;
+      *value = (*value << 4) | digit;
+    }
+    return true;
+  }
+
+  // Parses -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+  bool ParseNumber() {
+    size_t start = pos_;
+    if (pos_ < input_.size() && input_[pos_] == '-') ++pos_;
+    if (pos_ >= input_.size() || !IsDigit(input_[pos_])) return false;
+    if (input_[pos_] == '0') {
+      ++pos_;
+    } else {
+      SkipDigits();
+    }
+    if (pos_ < input_.size() && input_[pos_] == '.') {
+      ++pos_;
+      if (!SkipDigits()) return false;
+    }
+    if (pos_ < input_.size() && (input_[pos_] == 'e' || input_[pos_] == 'E')) {
+      ++pos_;
+      if (pos_ < input_.size() &&
+          (input_[pos_] == '+' || input_[pos_] == '-')) {
+        ++pos_;
+      }
+      if (!SkipDigits()) return false;
+    }
+    double value;
+    if (!absl::SimpleAtod(input_.substr(start, pos_ - start), &value) ||
+        !std::isfinite(value)) {
+      return false;
+    }
+    node(AddNode(JsonValue::Kind::kNumber)).number_value = value;
+    return true;
+  }
+
+  // Skips digits and returns true if there was at least one.
+  bool SkipDigits() {
+    size_t start = pos_;
+    while (pos_ < input_.size() && IsDigit(input_[pos_])) ++pos_;
+    return pos_ > start;
+  }
+
+  JsonDocument* document_;
+  absl::string_view input_;
+  size_t pos_ = 0;
+};
+
+util::StatusOr<JsonDocument> JsonDocument::ParseObject(std::string json) {
+  return JsonParser::Parse(std::move(json), JsonValue::Kind::kObject);
+}
+
+util::StatusOr<JsonDocument> JsonDocument::ParseArray(std::string json) {
+  return JsonParser::Parse(std::move(json), JsonValue::Kind::kArray);
+}
+
+JsonDocument::JsonDocument() : json_("{}"), nodes_(1) {
+  nodes_[0].kind = JsonValue::Kind::kObject;
+}
+
+absl::string_view JsonDocument::GetString(StringRef ref) const {
+  if (ref.offset & kUnescapedBit) {
+    return absl::string_view(unescaped_)
+        .substr(ref.offset & ~kUnescapedBit, ref.length);
+  }
+  return absl::string_view(json_).substr(ref.offset, ref.length);
+}
+
+JsonValue::Kind JsonValue::kind() const {
+  return document_->nodes_[index_].kind;
+}
+
+bool JsonValue::bool_value() const {
+  return document_->nodes_[index_].bool_value;
+}
+
+double JsonValue::number_value() const {
+  return document_->nodes_[index_].number_value;
+}
+
+absl::string_view JsonValue::string_value() const {
+  return document_->GetString(document_->nodes_[index_].string_value);
+}
+
+int JsonValue::size() const { return document_->nodes_[index_].size; }
+
+absl::optional<JsonValue> JsonValue::Find(absl::string_view name) const {
+  if (kind() != Kind::kObject) return absl::nullopt;
+  absl::optional<JsonValue> result;
+  for (absl::optional<JsonValue> member = first_child(); member.has_value();
+       member = member->next_sibling()) {
+    if (member->name() == name) result = member;
+  }
+  return result;
+}
+
+absl::optional<JsonValue> JsonValue::first_child() const {
+  if (size() == 0) return absl::nullopt;
+  return JsonValue(document_, index_ + 1);
+}
+
+absl::optional<JsonValue> JsonValue::next_sibling() const {
+  uint32_t next = document_->nodes_[index_].next;
+  if (next == 0) return absl::nullopt;
+  return JsonValue(document_, next);
+}
+
+absl::string_view JsonValue::name() const {
+  return document_->GetString(document_->nodes_[index_].name);
+}
+
+void JsonValue::AppendJson(std::string* output) const {
+  switch (kind()) {
+    case Kind::kNull:
+      output->append("null");
+      return;
+    case Kind::kBool:
+      output->append(bool_value() ? "true" : "false");
+      return;
+    case Kind::kNumber:
+      AppendJsonNumber(number_value(), output);
+      return;
+    case Kind::kString:
+      AppendJsonString(string_value(), output);
+      return;
+    case Kind::kArray: {
+      output->push_back('[');
+      for (absl::optional<JsonValue> element = first_child();
+           element.has_value(); element = element->next_sibling()) {
+        if (element->index_ != index_ + 1) output->push_back(',');
+        element->AppendJson(output);
+      }
+      output->push_back(']');
+      return;
+    }
+    case Kind::kObject: {
+      // Only the last member with a given name is written.
+      absl::flat_hash_map<absl::string_view, uint32_t> last_members;
+      last_members.reserve(size());
+      for (absl::optional<JsonValue> member = first_child();
+           member.has_value(); member = member->next_sibling()) {
+        last_members[member->name()] = member->index_;
+      }
+      output->push_back('{');
+      bool first = true;
+      for (absl::optional<JsonValue> member = first_child();
+           member.has_value(); member = member->next_sibling()) {
+        if (last_members[member->name()] != member->index_) continue;
+        if (!first) output->push_back(',');
+        first = false;
+        AppendJsonString(member->name(), output);
+        output->push_back(':');
+        member->AppendJson(output);
+      }
+      output->push_back('}');
+      return;
+    }
+  }
+}
+
+std::string JsonValue::ToJson() const {
+  std::string output;
+  AppendJson(&output);
+  return output;
+}
+
+}  // namespace jwt_internal
+}  // namespace tink
+}  // namespace crypto
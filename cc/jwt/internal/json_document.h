@@ -0,0 +1,146 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_JWT_INTERNAL_JSON_DOCUMENT_H_
+#define TINK_JWT_INTERNAL_JSON_DOCUMENT_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace jwt_internal {
+
+class JsonDocument;
+
+// A value inside a JsonDocument. JsonValue objects are small handles that are
+// cheap to copy; they are only valid as long as the document is alive.
+class JsonValue {
+ public:
+  enum class Kind { kNull, kBool, kNumber, kString, kObject, kArray };
+
+  Kind kind() const;
+  // Each of these requires that kind() is the corresponding kind.
+  bool bool_value() const;
+  double number_value() const;
+  absl::string_view string_value() const;
+
+  // Number of members of an object or elements of an array. For objects,
+  // members with duplicate names are counted each time they occur.
+  int size() const;
+
+  // For objects, returns the value of the member called `name`. If several
+  // members have that name, the last one is returned, which is how
+  // google::protobuf::Struct treats duplicate names.
+  absl::optional<JsonValue> Find(absl::string_view name) const;
+
+  // Returns the first member of an object or element of an array.
+  absl::optional<JsonValue> first_child() const;
+  // Returns the member or element that follows this one in its parent.
+  absl::optional<JsonValue> next_sibling() const;
+  // For members of an object, returns their name.
+  absl::string_view name() const;
+
+  // Appends the compact JSON serialization of this value to `output`. For
+  // objects with duplicate member names, only the last member is written.
+  void AppendJson(std::string* output) const;
+  std::string ToJson() const;
+
+ private:
+  friend class JsonDocument;
+  JsonValue(const JsonDocument* document, uint32_t index)
+      : document_(document), index_(index) {}
+
+  const JsonDocument* document_;
+  uint32_t index_;
+};
+
+// A parsed JSON document, used to parse JWT headers and payloads.
+//
+// Parsing is done in a single pass over the JSON text, which is owned by the
+// document. All values are stored in one flat array, and strings that contain
+// no escape sequences are not copied but refer to the text. This avoids the
+// many small allocations of google::protobuf::Struct.
+//
+// The accepted syntax is the same as the one of JsonStringToProtoStruct():
+// standard JSON, except that object member names may also be unquoted
+// identifiers. Strings must be valid UTF-8 and numbers must be finite doubles.
+class JsonDocument {
+ public:
+  // Parses `json`, which must contain a JSON object.
+  static util::StatusOr<JsonDocument> ParseObject(std::string json);
+  // Parses `json`, which must contain a JSON array.
+  static util::StatusOr<JsonDocument> ParseArray(std::string json);
+
+  // Creates a document that contains an empty object.
+  JsonDocument();
+
+  // Returns the top-level object or array.
+  JsonValue root() const { return JsonValue(this, 0); }
+
+  // JsonDocument objects are copiable and movable.
+  JsonDocument(const JsonDocument&) = default;
+  JsonDocument& operator=(const JsonDocument&) = default;
+  JsonDocument(JsonDocument&& other) = default;
+  JsonDocument& operator=(JsonDocument&& other) = default;
+
+ private:
+  friend class JsonValue;
+  friend class JsonParser;
+
+  // Strings are referenced by offset, so that copying or moving the document
+  // does not invalidate them. Offsets with kUnescapedBit set point into
+  // unescaped_, the others into json_.
+  static constexpr uint32_t kUnescapedBit = uint32_t{1} << 31;
+  struct StringRef {
+    uint32_t offset = 0;
+    uint32_t length = 0;
+  };
+
+  // Values are stored in pre-order, so the first child of a value is the
+  // value that directly follows it.
+  struct Node {
+    JsonValue::Kind kind = JsonValue::Kind::kNull;
+    bool bool_value = false;
+    // Number of children of objects and arrays.
+    uint32_t size = 0;
+    // Index of the next sibling, or 0 if this is the last child.
+    uint32_t next = 0;
+    double number_value = 0;
+    StringRef string_value;
+    StringRef name;
+  };
+
+  explicit JsonDocument(std::string json) : json_(std::move(json)) {}
+
+  absl::string_view GetString(StringRef ref) const;
+
+  std::string json_;
+  std::string unescaped_;
+  std::vector<Node> nodes_;
+};
+
+}  // namespace jwt_internal
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_JWT_INTERNAL_JSON_DOCUMENT_H_
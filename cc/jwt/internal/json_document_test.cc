@@ -0,0 +1,185 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/jwt/internal/json_document.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "tink/util/test_matchers.h"
+
+using ::crypto::tink::test::IsOk;
+using ::testing::ElementsAre;
+using ::testing::Eq;
+
+namespace crypto {
+namespace tink {
+namespace jwt_internal {
+
+TEST(JsonDocument, ParseThenSerializeObjectOk) {
+  util::StatusOr<JsonDocument> document = JsonDocument::ParseObject(
+      R"({"some_key":["hello","world","!"], "n" : -12345, "b":false,
+          "null":null, "obj":{"x":1.5}})");
+  ASSERT_THAT(document, IsOk());
+  EXPECT_THAT(
+      document->root().ToJson(),
+      Eq(R"({"some_key":["hello","world","!"],"n":-12345,"b":false,)"
+         R"("null":null,"obj":{"x":1.5}})"));
+}
+
+TEST(JsonDocument, ParseThenSerializeArrayOk) {
+  util::StatusOr<JsonDocument> document =
+      JsonDocument::ParseArray(R"(["hello", "world", 42, true])");
+  ASSERT_THAT(document, IsOk());
+  EXPECT_THAT(document->root().ToJson(), Eq(R"(["hello","world",42,true])"));
+}
+
+TEST(JsonDocument, DefaultIsEmptyObject) {
+  JsonDocument document;
+  EXPECT_THAT(document.root().kind(), Eq(JsonValue::Kind::kObject));
+  EXPECT_THAT(document.root().size(), Eq(0));
+  EXPECT_THAT(document.root().ToJson(), Eq("{}"));
+}
+
+TEST(JsonDocument, GetValues) {
+  util::StatusOr<JsonDocument> document = JsonDocument::ParseObject(
+      R"({"s":"abc","n":2218027244,"t":true,"f":false,"z":null,)"
+      R"("a":[1,[],{}],"o":{"p":"q"}})");
+  ASSERT_THAT(document, IsOk());
+  JsonValue root = document->root();
+  EXPECT_THAT(root.size(), Eq(7));
+  EXPECT_THAT(root.Find("s")->string_value(), Eq("abc"));
+  EXPECT_THAT(root.Find("n")->number_value(), Eq(2218027244));
+  EXPECT_TRUE(root.Find("t")->bool_value());
+  EXPECT_FALSE(root.Find("f")->bool_value());
+  EXPECT_THAT(root.Find("z")->kind(), Eq(JsonValue::Kind::kNull));
+  EXPECT_THAT(root.Find("a")->kind(), Eq(JsonValue::Kind::kArray));
+  EXPECT_THAT(root.Find("a")->size(), Eq(3));
+  EXPECT_THAT(root.Find("o")->Find("p")->string_value(), Eq("q"));
+  EXPECT_FALSE(root.Find("p").has_value());
+  EXPECT_FALSE(root.Find("s")->Find("s").has_value());
+
+  std::vector<std::string> names;
+  for (absl::optional<JsonValue> member = root.first_child();
+       member.has_value(); member = member->next_sibling()) {
+    names.push_back(std::string(member->name()));
+  }
+  EXPECT_THAT(names, ElementsAre("s", "n", "t", "f", "z", "a", "o"));
+}
+
+TEST(JsonDocument, DuplicateNamesUseLastValue) {
+  util::StatusOr<JsonDocument> document =
+      JsonDocument::ParseObject(R"({"a":1,"b":2,"a":3})");
+  ASSERT_THAT(document, IsOk());
+  EXPECT_THAT(document->root().Find("a")->number_value(), Eq(3));
+  EXPECT_THAT(document->root().ToJson(), Eq(R"({"b":2,"a":3})"));
+}
+
+TEST(JsonDocument, UnescapesStrings) {
+  util::StatusOr<JsonDocument> document = JsonDocument::ParseObject(
+      R"({"key":"a\"b\\c\/d\b\f\n\r\té😀","x":"é"})");
+  ASSERT_THAT(document, IsOk());
+  EXPECT_THAT(document->root().Find("key")->string_value(),
+              Eq("a\"b\\c/d\b\f\n\r\t\xC3\xA9\xF0\x9F\x98\x80"));
+  EXPECT_THAT(document->root().Find("x")->string_value(), Eq("\xC3\xA9"));
+}
+
+TEST(JsonDocument, SerializeEscapesStrings) {
+  util::StatusOr<JsonDocument> document = JsonDocument::ParseObject(
+      "{\"a\":\"\\\"\\\\\\n\\u0001<>\xE2\x80\xA8\xC3\xA9\"}");
+  ASSERT_THAT(document, IsOk());
+  EXPECT_THAT(document->root().ToJson(),
+              Eq(R"({"a":"\"\\\n\u0001\u003c\u003e\u2028)"
+                 "\xC3\xA9\"}"));
+}
+
+TEST(JsonDocument, SerializeNumbers) {
+  util::StatusOr<JsonDocument> document =
+      JsonDocument::ParseArray(R"([1e10, 1e30, 123.456, 0.1, -0, 1E-2])");
+  ASSERT_THAT(document, IsOk());
+  EXPECT_THAT(document->root().ToJson(),
+              Eq(R"([10000000000,1e+30,123.456,0.1,-0,0.01])"));
+}
+
+TEST(JsonDocument, CopyAndMoveKeepStrings) {
+  util::StatusOr<JsonDocument> document =
+      JsonDocument::ParseObject(R"({"a":"b","c":"d"})");
+  ASSERT_THAT(document, IsOk());
+  JsonDocument copy = *document;
+  JsonDocument moved = *std::move(document);
+  EXPECT_THAT(copy.root().Find("a")->string_value(), Eq("b"));
+  EXPECT_THAT(copy.root().Find("c")->string_value(), Eq("d"));
+  EXPECT_THAT(moved.root().Find("a")->string_value(), Eq("b"));
+  EXPECT_THAT(moved.root().Find("c")->string_value(), Eq("d"));
+}
+
+TEST(JsonDocument, ParseObjectWithoutQuotesOk) {
+  // Accepted for compatibility with JsonStringToProtoStruct().
+  util::StatusOr<JsonDocument> document =
+      JsonDocument::ParseObject(R"({some_key:false})");
+  ASSERT_THAT(document, IsOk());
+  EXPECT_THAT(document->root().ToJson(), Eq(R"({"some_key":false})"));
+}
+
+TEST(JsonDocument, ParseInvalidJsonFails) {
+  for (const std::string& json : std::vector<std::string>{
+           "", "{", "[]", R"({"some_key":false)", R"({"a":1,})", R"({"a" 1})",
+           R"({"a":1}})", R"({"a":1} x)", R"({"a":tru})", R"({"a":nul})",
+           R"({"a":01})", R"({"a":1.})", R"({"a":.1})", R"({"a":1e})",
+           R"({"a":+1})", R"({"a":1e400})", R"({"a":NaN})", R"({"a":"b)",
+           R"({"a":"\x"})", R"({"a":"\u00"})", R"({"a":"\ud83d"})",
+           R"({"a":"\ude00"})", "{\"a\":\"\n\"}", "{\"a\":\"\xC3\"}",
+           "{\"a\":\"\xC0\xA0\"}", "{\"a\":\"\xED\xA0\x80\"}",
+           R"({"a":'b'})", R"({1:2})", R"({"a":false /* comment */})"}) {
+    EXPECT_FALSE(JsonDocument::ParseObject(json).ok()) << json;
+  }
+  for (const std::string& json : std::vector<std::string>{
+           "", "{}", R"(["one", )", "[one,two]", "[1,]", "[1]]",
+           R"(["hello", "world" /* comment */])"}) {
+    EXPECT_FALSE(JsonDocument::ParseArray(json).ok()) << json;
+  }
+}
+
+TEST(JsonDocument, ParseRecursiveJsonFails) {
+  std::string recursive_json;
+  for (int i = 0; i < 10000; i++) {
+    recursive_json.append("{\"a\":");
+  }
+  recursive_json.append("1");
+  for (int i = 0; i < 10000; i++) {
+    recursive_json.append("}");
+  }
+  EXPECT_FALSE(JsonDocument::ParseObject(recursive_json).ok());
+}
+
+TEST(JsonDocument, ParseNestedJsonUpToLimitOk) {
+  std::string nested_json;
+  for (int i = 0; i < 100; i++) {
+    nested_json.append("[");
+  }
+  for (int i = 0; i < 100; i++) {
+    nested_json.append("]");
+  }
+  EXPECT_THAT(JsonDocument::ParseArray(nested_json), IsOk());
+  EXPECT_FALSE(JsonDocument::ParseArray("[" + nested_json + "]").ok());
+}
+
+}  // namespace jwt_internal
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,65 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/jwt/internal/jwt_batch.h"
+
+#include <algorithm>
+
+#include "absl/synchronization/blocking_counter.h"
+
+namespace crypto {
+namespace tink {
+namespace jwt_internal {
+
+void RunInTasks(std::size_t size, JwtBatchExecutor* executor,
+                const std::function<void(std::size_t, std::size_t)>& task) {
+  if (executor == nullptr || size <= kMaxTokensPerBatchTask) {
+    for (std::size_t begin = 0; begin < size;
+         begin += kMaxTokensPerBatchTask) {
+      task(begin, std::min(size, begin + kMaxTokensPerBatchTask));
+    }
+    return;
+  }
+  std::size_t num_tasks =
+      (size + kMaxTokensPerBatchTask - 1) / kMaxTokensPerBatchTask;
+  absl::BlockingCounter done(num_tasks);
+  for (std::size_t begin = 0; begin < size; begin += kMaxTokensPerBatchTask) {
+    std::size_t end = std::min(size, begin + kMaxTokensPerBatchTask);
+    executor->Schedule([&task, &done, begin, end]() {
+      task(begin, end);
+      done.DecrementCount();
+    });
+  }
+  done.Wait();
+}
+
+std::vector<util::StatusOr<VerifiedJwt>> VerifyBatch(
+    absl::Span<const absl::string_view> compacts, JwtBatchExecutor* executor,
+    const std::function<util::StatusOr<VerifiedJwt>(absl::string_view)>&
+        verify) {
+  std::vector<util::StatusOr<VerifiedJwt>> results(compacts.size());
+  RunInTasks(compacts.size(), executor,
+             [&](std::size_t begin, std::size_t end) {
+               for (std::size_t i = begin; i < end; ++i) {
+                 results[i] = verify(compacts[i]);
+               }
+             });
+  return results;
+}
+
+}  // namespace jwt_internal
+}  // namespace tink
+}  // namespace crypto
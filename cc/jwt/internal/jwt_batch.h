@@ -0,0 +1,56 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_JWT_INTERNAL_JWT_BATCH_H_
+#define TINK_JWT_INTERNAL_JWT_BATCH_H_
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tink/jwt/jwt_batch_executor.h"
+#include "tink/jwt/verified_jwt.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace jwt_internal {
+
+// Maximum number of tokens verified by one task of a batch.
+constexpr std::size_t kMaxTokensPerBatchTask = 16;
+
+// Calls `task(begin, end)` for consecutive ranges that cover [0, size), with
+// at most kMaxTokensPerBatchTask elements each. If `executor` is not null and
+// there is more than one range, the calls are scheduled on `executor` and
+// RunInTasks returns once all of them have returned. Otherwise, the calls are
+// made on the calling thread.
+void RunInTasks(std::size_t size, JwtBatchExecutor* executor,
+                const std::function<void(std::size_t, std::size_t)>& task);
+
+// Returns verify(compact) for each of `compacts`, in the same order. The calls
+// to `verify` are made with RunInTasks.
+std::vector<util::StatusOr<VerifiedJwt>> VerifyBatch(
+    absl::Span<const absl::string_view> compacts, JwtBatchExecutor* executor,
+    const std::function<util::StatusOr<VerifiedJwt>(absl::string_view)>&
+        verify);
+
+}  // namespace jwt_internal
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_JWT_INTERNAL_JWT_BATCH_H_
@@ -0,0 +1,129 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/jwt/internal/jwt_batch.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "tink/jwt/jwt_batch_executor.h"
+#include "tink/jwt/verified_jwt.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::IsEmpty;
+
+namespace crypto {
+namespace tink {
+namespace jwt_internal {
+namespace {
+
+// Runs each task on a new thread. The threads are joined on destruction.
+class ThreadExecutor : public JwtBatchExecutor {
+ public:
+  void Schedule(std::function<void()> task) override {
+    absl::MutexLock lock(&mutex_);
+    threads_.emplace_back(std::move(task));
+  }
+
+  int num_tasks() {
+    absl::MutexLock lock(&mutex_);
+    return threads_.size();
+  }
+
+  ~ThreadExecutor() override {
+    for (std::thread& thread : threads_) {
+      thread.join();
+    }
+  }
+
+ private:
+  absl::Mutex mutex_;
+  std::vector<std::thread> threads_ ABSL_GUARDED_BY(mutex_);
+};
+
+using Range = std::pair<std::size_t, std::size_t>;
+
+// Returns the ranges passed to the task by RunInTasks, in increasing order.
+std::vector<Range> GetRanges(std::size_t size, JwtBatchExecutor* executor) {
+  absl::Mutex mutex;
+  std::vector<Range> ranges;
+  RunInTasks(size, executor, [&](std::size_t begin, std::size_t end) {
+    absl::MutexLock lock(&mutex);
+    ranges.emplace_back(begin, end);
+  });
+  std::sort(ranges.begin(), ranges.end());
+  return ranges;
+}
+
+TEST(JwtBatchTest, RunInTasksWithoutExecutor) {
+  EXPECT_THAT(GetRanges(0, nullptr), IsEmpty());
+  EXPECT_THAT(GetRanges(1, nullptr), ElementsAre(Range(0, 1)));
+  EXPECT_THAT(GetRanges(16, nullptr), ElementsAre(Range(0, 16)));
+  EXPECT_THAT(GetRanges(40, nullptr),
+              ElementsAre(Range(0, 16), Range(16, 32), Range(32, 40)));
+}
+
+TEST(JwtBatchTest, RunInTasksWithExecutor) {
+  ThreadExecutor executor;
+  EXPECT_THAT(GetRanges(40, &executor),
+              ElementsAre(Range(0, 16), Range(16, 32), Range(32, 40)));
+  EXPECT_THAT(executor.num_tasks(), Eq(3));
+}
+
+TEST(JwtBatchTest, RunInTasksRunsSingleTaskOnCallingThread) {
+  ThreadExecutor executor;
+  EXPECT_THAT(GetRanges(16, &executor), ElementsAre(Range(0, 16)));
+  EXPECT_THAT(executor.num_tasks(), Eq(0));
+}
+
+TEST(JwtBatchTest, VerifyBatchReturnsResultsInOrder) {
+  std::vector<std::string> tokens;
+  for (int i = 0; i < 100; ++i) {
+    tokens.push_back(absl::StrCat("token", i));
+  }
+  std::vector<absl::string_view> compacts(tokens.begin(), tokens.end());
+  ThreadExecutor executor;
+  for (JwtBatchExecutor* e : {static_cast<JwtBatchExecutor*>(nullptr),
+                              static_cast<JwtBatchExecutor*>(&executor)}) {
+    std::vector<util::StatusOr<VerifiedJwt>> results =
+        VerifyBatch(compacts, e, [](absl::string_view compact) {
+          return util::StatusOr<VerifiedJwt>(util::Status(
+              absl::StatusCode::kInvalidArgument, std::string(compact)));
+        });
+    ASSERT_THAT(results.size(), Eq(tokens.size()));
+    for (std::size_t i = 0; i < tokens.size(); ++i) {
+      EXPECT_THAT(results[i].status().message(), Eq(tokens[i]));
+    }
+  }
+}
+
+}  // namespace
+}  // namespace jwt_internal
+}  // namespace tink
+}  // namespace crypto
@@ -17,11 +17,14 @@
 #include "tink/jwt/internal/jwt_format.h"
 
 #include <string>
+#include <utility>
 
+#include "absl/base/internal/endian.h"
 #include "absl/status/status.h"
-#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
 #include "tink/crypto_format.h"
+#include "tink/jwt/internal/base64_url.h"
 #include "tink/jwt/internal/json_util.h"
 #include "proto/tink.pb.h"
 
@@ -33,23 +36,23 @@ using ::google::crypto::tink::OutputPrefixType;
 
 namespace {
 
-bool isValidUrlsafeBase64Char(char c) {
-  return (((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z')) ||
-          ((c >= '0') && (c <= '9')) || ((c == '-') || (c == '_')));
-}
-
-bool StrictWebSafeBase64Unescape(absl::string_view src, std::string* dest) {
-  for (char c : src) {
-    if (!isValidUrlsafeBase64Char(c)) {
-      return false;
+// Returns a unique key for a combination of type header and kid.
+std::string HeaderCacheKey(absl::optional<absl::string_view> type_header,
+                           absl::optional<absl::string_view> kid) {
+  std::string key;
+  for (absl::optional<absl::string_view> value : {type_header, kid}) {
+    if (value.has_value()) {
+      absl::StrAppend(&key, value->size(), ":", *value);
+    } else {
+      key.push_back('-');
     }
   }
-  return absl::WebSafeBase64Unescape(src, dest);
+  return key;
 }
 
-util::Status ValidateKidInHeader(const google::protobuf::Value& kid_in_header,
+util::Status ValidateKidInHeader(const JsonValue& kid_in_header,
                                  absl::string_view kid) {
-  if (kid_in_header.kind_case() != google::protobuf::Value::kStringValue) {
+  if (kid_in_header.kind() != JsonValue::Kind::kString) {
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "kid header is not a string");
   }
@@ -63,11 +66,11 @@ util::Status ValidateKidInHeader(const google::protobuf::Value& kid_in_header,
 }  // namespace
 
 std::string EncodeHeader(absl::string_view json_header) {
-  return absl::WebSafeBase64Escape(json_header);
+  return Base64UrlEncode(json_header);
 }
 
 bool DecodeHeader(absl::string_view header, std::string* json_header) {
-  return StrictWebSafeBase64Unescape(header, json_header);
+  return Base64UrlDecode(header, json_header);
 }
 
 absl::optional<std::string> GetKid(uint32_t key_id,
@@ -77,12 +80,12 @@ absl::optional<std::string> GetKid(uint32_t key_id,
   }
   char buffer[4];
   absl::big_endian::Store32(buffer, key_id);
-  return absl::WebSafeBase64Escape(absl::string_view(buffer, 4));
+  return Base64UrlEncode(absl::string_view(buffer, 4));
 }
 
 absl::optional<uint32_t> GetKeyId(absl::string_view kid) {
   std::string decoded_kid;
-  if (!StrictWebSafeBase64Unescape(kid, &decoded_kid)) {
+  if (!Base64UrlDecode(kid, &decoded_kid)) {
     return absl::nullopt;
   }
   if (decoded_kid.size() != 4) {
@@ -113,25 +116,23 @@ util::StatusOr<std::string> CreateHeader(
   return EncodeHeader(*json_header);
 }
 
-util::Status ValidateHeader(const google::protobuf::Struct& header,
+util::Status ValidateHeader(const JsonValue& header,
                             absl::string_view algorithm,
                             absl::optional<absl::string_view> tink_kid,
                             absl::optional<absl::string_view> custom_kid) {
-  auto fields = header.fields();
-  auto it = fields.find("alg");
-  if (it == fields.end()) {
+  absl::optional<JsonValue> alg = header.Find("alg");
+  if (!alg.has_value()) {
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "header is missing alg");
   }
-  const google::protobuf::Value& alg = it->second;
-  if (alg.kind_case() != google::protobuf::Value::kStringValue) {
+  if (alg->kind() != JsonValue::Kind::kString) {
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "alg is not a string");
   }
-  if (alg.string_value() != algorithm) {
+  if (alg->string_value() != algorithm) {
     return util::Status(absl::StatusCode::kInvalidArgument, "invalid alg");
   }
-  if (fields.find("crit") != fields.end()) {
+  if (header.Find("crit").has_value()) {
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "all tokens with crit headers are rejected");
   }
@@ -140,21 +141,21 @@ util::Status ValidateHeader(const google::protobuf::Struct& header,
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "custom_kid can only be set for RAW keys");
   }
-  auto kid_it = fields.find("kid");
-  bool header_has_kid = (kid_it != fields.end());
+  absl::optional<JsonValue> kid_in_header = header.Find("kid");
+  bool header_has_kid = kid_in_header.has_value();
   if (tink_kid.has_value()) {
     if (!header_has_kid) {
       // for output prefix type TINK, the kid header is required.
       return util::Status(absl::StatusCode::kInvalidArgument,
                           "missing kid in header");
     }
-    util::Status status = ValidateKidInHeader(kid_it->second, *tink_kid);
+    util::Status status = ValidateKidInHeader(*kid_in_header, *tink_kid);
     if (!status.ok()) {
       return status;
     }
   }
   if (custom_kid.has_value() && header_has_kid) {
-    util::Status status = ValidateKidInHeader(kid_it->second, *custom_kid);
+    util::Status status = ValidateKidInHeader(*kid_in_header, *custom_kid);
     if (!status.ok()) {
       return status;
     }
@@ -162,39 +163,129 @@ util::Status ValidateHeader(const google::protobuf::Struct& header,
   return util::OkStatus();
 }
 
-absl::optional<std::string> GetTypeHeader(
-    const google::protobuf::Struct& header) {
-  auto it = header.fields().find("typ");
-  if (it == header.fields().end()) {
+absl::optional<std::string> GetTypeHeader(const JsonValue& header) {
+  absl::optional<JsonValue> value = header.Find("typ");
+  if (!value.has_value() || value->kind() != JsonValue::Kind::kString) {
+    return absl::nullopt;
+  }
+  return std::string(value->string_value());
+}
+
+absl::optional<UnverifiedHeader> ReadUnverifiedHeader(
+    absl::string_view compact) {
+  std::string json_header;
+  if (!DecodeHeader(compact.substr(0, compact.find('.')), &json_header)) {
+    return absl::nullopt;
+  }
+  util::StatusOr<JsonDocument> header =
+      JsonDocument::ParseObject(std::move(json_header));
+  if (!header.ok()) {
     return absl::nullopt;
   }
-  const auto& value = it->second;
-  if (value.kind_case() != google::protobuf::Value::kStringValue) {
+  absl::optional<JsonValue> alg = header->root().Find("alg");
+  if (!alg.has_value() || alg->kind() != JsonValue::Kind::kString) {
     return absl::nullopt;
   }
-  return value.string_value();
+  UnverifiedHeader result;
+  result.algorithm = std::string(alg->string_value());
+  absl::optional<JsonValue> kid = header->root().Find("kid");
+  if (kid.has_value()) {
+    if (kid->kind() != JsonValue::Kind::kString) {
+      return absl::nullopt;
+    }
+    result.kid = std::string(kid->string_value());
+  }
+  return result;
+}
+
+util::Status EncodedHeaderCache::AppendHeader(
+    absl::optional<absl::string_view> type_header,
+    absl::optional<absl::string_view> kid, std::string* output) const {
+  std::string key = HeaderCacheKey(type_header, kid);
+  {
+    absl::ReaderMutexLock lock(&mutex_);
+    auto it = headers_.find(key);
+    if (it != headers_.end()) {
+      output->append(it->second);
+      return util::OkStatus();
+    }
+  }
+  util::StatusOr<std::string> header =
+      CreateHeader(algorithm_, type_header, kid);
+  if (!header.ok()) {
+    return header.status();
+  }
+  output->append(*header);
+  absl::MutexLock lock(&mutex_);
+  if (headers_.size() < kMaxHeaders) {
+    headers_.emplace(std::move(key), *std::move(header));
+  }
+  return util::OkStatus();
+}
+
+util::StatusOr<std::string> CreateUnsignedCompact(
+    const EncodedHeaderCache& header_cache, const RawJwt& token,
+    absl::optional<absl::string_view> kid, std::size_t max_signature_size) {
+  absl::optional<std::string> type_header;
+  if (token.HasTypeHeader()) {
+    util::StatusOr<std::string> type = token.GetTypeHeader();
+    if (!type.ok()) {
+      return type.status();
+    }
+    type_header = *std::move(type);
+  }
+  util::StatusOr<std::string> payload = token.GetJsonPayload();
+  if (!payload.ok()) {
+    return payload.status();
+  }
+  std::string compact;
+  util::Status status = header_cache.AppendHeader(type_header, kid, &compact);
+  if (!status.ok()) {
+    return status;
+  }
+  compact.reserve(compact.size() + Base64UrlEncodedSize(payload->size()) +
+                  Base64UrlEncodedSize(max_signature_size) + 2);
+  compact.push_back('.');
+  AppendBase64UrlEncoded(*payload, &compact);
+  return compact;
+}
+
+void AppendSignature(absl::string_view signature,
+                     std::string* unsigned_compact) {
+  unsigned_compact->push_back('.');
+  AppendBase64UrlEncoded(signature, unsigned_compact);
+}
+
+std::size_t MaxSignatureSize(absl::string_view algorithm) {
+  if (algorithm == "HS256") return 32;
+  if (algorithm == "HS384") return 48;
+  if (algorithm == "HS512" || algorithm == "ES256") return 64;
+  if (algorithm == "ES384") return 96;
+  if (algorithm == "ES512") return 132;
+  // RSA signatures are as long as the modulus, which has at most 4096 bits.
+  return 512;
 }
 
 std::string EncodePayload(absl::string_view json_payload) {
-  return absl::WebSafeBase64Escape(json_payload);
+  return Base64UrlEncode(json_payload);
 }
 
 bool DecodePayload(absl::string_view payload, std::string* json_payload) {
-  return StrictWebSafeBase64Unescape(payload, json_payload);
+  return Base64UrlDecode(payload, json_payload);
 }
 
 std::string EncodeSignature(absl::string_view signature) {
-  return absl::WebSafeBase64Escape(signature);
+  return Base64UrlEncode(signature);
 }
 
 bool DecodeSignature(absl::string_view encoded_signature,
                      std::string* signature) {
-  return StrictWebSafeBase64Unescape(encoded_signature, signature);
+  return Base64UrlDecode(encoded_signature, signature);
 }
 
 util::StatusOr<RawJwt> RawJwtParser::FromJson(
-    absl::optional<std::string> type_header, absl::string_view json_payload) {
-  return RawJwt::FromJson(type_header, json_payload);
+    absl::optional<std::string> type_header, std::string json_payload) {
+  return RawJwt::FromJson(std::move(type_header), std::move(json_payload));
 }
 
 }  // namespace jwt_internal
@@ -17,9 +17,15 @@
 #ifndef TINK_JWT_INTERNAL_JWT_FORMAT_H_
 #define TINK_JWT_INTERNAL_JWT_FORMAT_H_
 
+#include <cstddef>
 #include <string>
 
-#include "google/protobuf/struct.pb.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
+#include "tink/jwt/internal/json_document.h"
 #include "tink/jwt/raw_jwt.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
@@ -40,12 +46,58 @@ absl::optional<uint32_t> GetKeyId(absl::string_view kid);
 util::StatusOr<std::string> CreateHeader(absl::string_view algorithm,
                          absl::optional<absl::string_view> type_header,
                          absl::optional<absl::string_view> kid);
-util::Status ValidateHeader(const google::protobuf::Struct& header,
+util::Status ValidateHeader(const JsonValue& header,
                             absl::string_view algorithm,
                             absl::optional<absl::string_view> tink_kid,
                             absl::optional<absl::string_view> custom_kid);
-absl::optional<std::string> GetTypeHeader(
-    const google::protobuf::Struct& header);
+absl::optional<std::string> GetTypeHeader(const JsonValue& header);
+
+// The alg and kid headers of a token, read before its MAC or signature is
+// verified. They may only be used to select the keys that can verify it.
+struct UnverifiedHeader {
+  std::string algorithm;
+  absl::optional<std::string> kid;
+};
+// Returns nullopt if the header of `compact` cannot be decoded, if it has no
+// alg, or if alg or kid are not strings.
+absl::optional<UnverifiedHeader> ReadUnverifiedHeader(
+    absl::string_view compact);
+
+// Caches the encoded headers returned by CreateHeader() for one algorithm, so
+// that primitives do not serialize and encode the same header for every
+// token. Only the first kMaxHeaders combinations of type header and kid are
+// cached; the others are created every time.
+class EncodedHeaderCache {
+ public:
+  explicit EncodedHeaderCache(absl::string_view algorithm)
+      : algorithm_(algorithm) {}
+
+  // Appends CreateHeader(algorithm, type_header, kid) to `output`.
+  util::Status AppendHeader(absl::optional<absl::string_view> type_header,
+                            absl::optional<absl::string_view> kid,
+                            std::string* output) const;
+
+ private:
+  static constexpr int kMaxHeaders = 8;
+
+  const std::string algorithm_;
+  mutable absl::Mutex mutex_;
+  mutable absl::flat_hash_map<std::string, std::string> headers_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+// Returns the encoded header and payload of `token`, separated by a dot. The
+// returned string has room for a dot and an encoded signature of up to
+// `max_signature_size` bytes, to be added with AppendSignature().
+util::StatusOr<std::string> CreateUnsignedCompact(
+    const EncodedHeaderCache& header_cache, const RawJwt& token,
+    absl::optional<absl::string_view> kid, std::size_t max_signature_size);
+// Appends a dot and the encoded `signature` to `unsigned_compact`.
+void AppendSignature(absl::string_view signature,
+                     std::string* unsigned_compact);
+// Returns the size of the signatures or MACs of `algorithm`, or an upper
+// bound for algorithms whose signature size depends on the key.
+std::size_t MaxSignatureSize(absl::string_view algorithm);
 
 std::string EncodePayload(absl::string_view json_payload);
 bool DecodePayload(absl::string_view payload, std::string* json_payload);
@@ -56,8 +108,10 @@ bool DecodeSignature(absl::string_view encoded_signature,
 
 class RawJwtParser {
  public:
+  // Parses the payload without copying `json_payload`, which is typically the
+  // output of DecodePayload().
   static util::StatusOr<RawJwt> FromJson(
-      absl::optional<std::string> type_header, absl::string_view json_payload);
+      absl::optional<std::string> type_header, std::string json_payload);
 };
 
 }  // namespace jwt_internal
@@ -21,7 +21,11 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
-#include "tink/jwt/internal/json_util.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/types/optional.h"
+#include "tink/jwt/internal/json_document.h"
+#include "tink/jwt/raw_jwt.h"
 #include "tink/util/test_matchers.h"
 #include "tink/util/test_util.h"
 
@@ -89,14 +93,15 @@ TEST(JwtFormat, DecodeAndValidateFixedHeaderHS256) {
   ASSERT_TRUE(DecodeHeader(encoded_header, &json_header));
   EXPECT_THAT(json_header, Eq("{\"typ\":\"JWT\",\r\n \"alg\":\"HS256\"}"));
 
-  util::StatusOr<google::protobuf::Struct> header =
-      JsonStringToProtoStruct(json_header);
+  util::StatusOr<JsonDocument> header = JsonDocument::ParseObject(json_header);
   EXPECT_THAT(header, IsOk());
 
-  EXPECT_THAT(ValidateHeader(*header, "HS256", absl::nullopt, absl::nullopt),
-              IsOk());
+  EXPECT_THAT(
+      ValidateHeader(header->root(), "HS256", absl::nullopt, absl::nullopt),
+      IsOk());
   EXPECT_FALSE(
-      ValidateHeader(*header, "RS256", absl::nullopt, absl::nullopt).ok());
+      ValidateHeader(header->root(), "RS256", absl::nullopt, absl::nullopt)
+          .ok());
 }
 
 TEST(JwtFormat, DecodeAndValidateFixedHeaderRS256) {
@@ -107,14 +112,15 @@ TEST(JwtFormat, DecodeAndValidateFixedHeaderRS256) {
   ASSERT_TRUE(DecodeHeader(encoded_header, &json_header));
   EXPECT_THAT(json_header, Eq(R"({"alg":"RS256"})"));
 
-  util::StatusOr<google::protobuf::Struct> header =
-      JsonStringToProtoStruct(json_header);
+  util::StatusOr<JsonDocument> header = JsonDocument::ParseObject(json_header);
   EXPECT_THAT(header, IsOk());
 
-  EXPECT_THAT(ValidateHeader(*header, "RS256", absl::nullopt, absl::nullopt),
-              IsOk());
+  EXPECT_THAT(
+      ValidateHeader(header->root(), "RS256", absl::nullopt, absl::nullopt),
+      IsOk());
   EXPECT_FALSE(
-      ValidateHeader(*header, "HS256", absl::nullopt, absl::nullopt).ok());
+      ValidateHeader(header->root(), "HS256", absl::nullopt, absl::nullopt)
+          .ok());
 }
 
 TEST(JwtFormat, CreateValidateHeader) {
@@ -125,14 +131,15 @@ TEST(JwtFormat, CreateValidateHeader) {
   std::string json_header;
   ASSERT_TRUE(DecodeHeader(*encoded_header, &json_header));
 
-  util::StatusOr<google::protobuf::Struct> header =
-      JsonStringToProtoStruct(json_header);
+  util::StatusOr<JsonDocument> header = JsonDocument::ParseObject(json_header);
   EXPECT_THAT(header, IsOk());
 
-  EXPECT_THAT(ValidateHeader(*header, "PS384", absl::nullopt, absl::nullopt),
-              IsOk());
+  EXPECT_THAT(
+      ValidateHeader(header->root(), "PS384", absl::nullopt, absl::nullopt),
+      IsOk());
   EXPECT_FALSE(
-      ValidateHeader(*header, "HS256", absl::nullopt, absl::nullopt).ok());
+      ValidateHeader(header->root(), "HS256", absl::nullopt, absl::nullopt)
+          .ok());
 }
 
 TEST(JwtFormat, CreateValidateHeaderWithTypeAndKid) {
@@ -143,116 +150,220 @@ TEST(JwtFormat, CreateValidateHeaderWithTypeAndKid) {
   std::string json_header;
   ASSERT_TRUE(DecodeHeader(*encoded_header, &json_header));
 
-  util::StatusOr<google::protobuf::Struct> header =
-      JsonStringToProtoStruct(json_header);
+  util::StatusOr<JsonDocument> header = JsonDocument::ParseObject(json_header);
   EXPECT_THAT(header, IsOk());
 
-  EXPECT_THAT(GetTypeHeader(*header), Eq("JWT"));
-  EXPECT_THAT(ValidateHeader(*header, "PS384", absl::nullopt, absl::nullopt),
-              IsOk());
+  EXPECT_THAT(GetTypeHeader(header->root()), Eq("JWT"));
+  EXPECT_THAT(
+      ValidateHeader(header->root(), "PS384", absl::nullopt, absl::nullopt),
+      IsOk());
   EXPECT_FALSE(
-      ValidateHeader(*header, "HS256", absl::nullopt, absl::nullopt).ok());
+      ValidateHeader(header->root(), "HS256", absl::nullopt, absl::nullopt)
+          .ok());
 
-  auto it = header->fields().find("kid");
-  EXPECT_FALSE(it == header->fields().end());
-  const google::protobuf::Value& value = it->second;
-  EXPECT_THAT(value.kind_case(), Eq(google::protobuf::Value::kStringValue));
-  EXPECT_THAT(value.string_value(), Eq("kid-1234"));
+  absl::optional<JsonValue> value = header->root().Find("kid");
+  ASSERT_TRUE(value.has_value());
+  EXPECT_THAT(value->kind(), Eq(JsonValue::Kind::kString));
+  EXPECT_THAT(value->string_value(), Eq("kid-1234"));
 }
 
 TEST(JwtFormat, ValidateEmptyHeaderFails) {
-  google::protobuf::Struct empty_header;
+  JsonDocument empty_header;
   EXPECT_FALSE(
-      ValidateHeader(empty_header, "HS256", absl::nullopt, absl::nullopt).ok());
+      ValidateHeader(empty_header.root(), "HS256", absl::nullopt, absl::nullopt)
+          .ok());
 }
 
 TEST(JwtFormat, ValidateHeaderWithUnknownTypeOk) {
   std::string json_header = R"({"alg":"HS256","typ":"unknown"})";
-  util::StatusOr<google::protobuf::Struct> header =
-      JsonStringToProtoStruct(json_header);
+  util::StatusOr<JsonDocument> header = JsonDocument::ParseObject(json_header);
   EXPECT_THAT(header, IsOk());
 
-  EXPECT_THAT(ValidateHeader(*header, "HS256", absl::nullopt, absl::nullopt),
-              IsOk());
+  EXPECT_THAT(
+      ValidateHeader(header->root(), "HS256", absl::nullopt, absl::nullopt),
+      IsOk());
 }
 
 TEST(JwtFormat, ValidateHeaderRejectsCrit) {
   std::string json_header =
       R"({"alg":"HS256","crit":["http://example.invalid/UNDEFINED"],)"
       R"("http://example.invalid/UNDEFINED":true})";
-  util::StatusOr<google::protobuf::Struct> header =
-      JsonStringToProtoStruct(json_header);
+  util::StatusOr<JsonDocument> header = JsonDocument::ParseObject(json_header);
   EXPECT_THAT(header, IsOk());
   EXPECT_FALSE(
-      ValidateHeader(*header, "HS256", absl::nullopt, absl::nullopt).ok());
+      ValidateHeader(header->root(), "HS256", absl::nullopt, absl::nullopt)
+          .ok());
 }
 
 TEST(JwtFormat, ValidateHeaderWithUnknownEntry) {
   std::string json_header = R"({"alg":"HS256","unknown":"header"})";
-  util::StatusOr<google::protobuf::Struct> header =
-      JsonStringToProtoStruct(json_header);
+  util::StatusOr<JsonDocument> header = JsonDocument::ParseObject(json_header);
   EXPECT_THAT(header, IsOk());
-  EXPECT_THAT(ValidateHeader(*header, "HS256", absl::nullopt, absl::nullopt),
-              IsOk());
+  EXPECT_THAT(
+      ValidateHeader(header->root(), "HS256", absl::nullopt, absl::nullopt),
+      IsOk());
 }
 
 TEST(JwtFormat, ValidateHeaderWithInvalidAlgTypFails) {
   std::string json_header = R"({"alg":true})";
-  util::StatusOr<google::protobuf::Struct> header =
-      JsonStringToProtoStruct(json_header);
+  util::StatusOr<JsonDocument> header = JsonDocument::ParseObject(json_header);
   EXPECT_THAT(header, IsOk());
   EXPECT_FALSE(
-      ValidateHeader(*header, "HS256", absl::nullopt, absl::nullopt).ok());
+      ValidateHeader(header->root(), "HS256", absl::nullopt, absl::nullopt)
+          .ok());
 }
 
 TEST(JwtFormat, ValidateHeaderWithTinkKid) {
   std::string json_header = R"({"alg":"HS256","kid":"tink_kid"})";
-  util::StatusOr<google::protobuf::Struct> header =
-      JsonStringToProtoStruct(json_header);
+  util::StatusOr<JsonDocument> header = JsonDocument::ParseObject(json_header);
   EXPECT_THAT(header, IsOk());
-  EXPECT_THAT(ValidateHeader(*header, "HS256", "tink_kid", absl::nullopt),
-              IsOk());
+  EXPECT_THAT(
+      ValidateHeader(header->root(), "HS256", "tink_kid", absl::nullopt),
+      IsOk());
   EXPECT_FALSE(
-      ValidateHeader(*header, "HS256", "other_tink_kid", absl::nullopt).ok());
+      ValidateHeader(header->root(), "HS256", "other_tink_kid", absl::nullopt)
+          .ok());
 }
 
 TEST(JwtFormat, ValidateHeaderWithTinkKidMissingFails) {
   std::string json_header = R"({"alg":"HS256"})";
-  util::StatusOr<google::protobuf::Struct> header =
-      JsonStringToProtoStruct(json_header);
+  util::StatusOr<JsonDocument> header = JsonDocument::ParseObject(json_header);
   EXPECT_THAT(header, IsOk());
   // If tink_kid is set, then the kid is required in the header.
   EXPECT_FALSE(
-      ValidateHeader(*header, "HS256", "tink_kid", absl::nullopt).ok());
+      ValidateHeader(header->root(), "HS256", "tink_kid", absl::nullopt).ok());
 }
 
 TEST(JwtFormat, ValidateHeaderWithCustomKid) {
   std::string json_header = R"({"alg":"HS256","kid":"custom_kid"})";
-  util::StatusOr<google::protobuf::Struct> header =
-      JsonStringToProtoStruct(json_header);
+  util::StatusOr<JsonDocument> header = JsonDocument::ParseObject(json_header);
   EXPECT_THAT(header, IsOk());
-  EXPECT_THAT(ValidateHeader(*header, "HS256", absl::nullopt, "custom_kid"),
-              IsOk());
+  EXPECT_THAT(
+      ValidateHeader(header->root(), "HS256", absl::nullopt, "custom_kid"),
+      IsOk());
   EXPECT_FALSE(
-      ValidateHeader(*header, "HS256", absl::nullopt, "other_custom_kid").ok());
+      ValidateHeader(header->root(), "HS256", absl::nullopt, "other_custom_kid")
+          .ok());
 }
 
 TEST(JwtFormat, ValidateHeaderWithCustomKidMissingFails) {
   std::string json_header = R"({"alg":"HS256"})";
-  util::StatusOr<google::protobuf::Struct> header =
-      JsonStringToProtoStruct(json_header);
+  util::StatusOr<JsonDocument> header = JsonDocument::ParseObject(json_header);
   EXPECT_THAT(header, IsOk());
   // If custom_kid is set, then the kid is not required in the header.
-  EXPECT_THAT(ValidateHeader(*header, "HS256", absl::nullopt, "custom_kid"),
-              IsOk());
+  EXPECT_THAT(
+      ValidateHeader(header->root(), "HS256", absl::nullopt, "custom_kid"),
+      IsOk());
 }
 
 TEST(JwtFormat, ValidateHeaderWithTinkAndCustomKidFails) {
   std::string json_header = R"({"alg":"HS256","kid":"tink_kid"})";
-  util::StatusOr<google::protobuf::Struct> header =
-      JsonStringToProtoStruct(json_header);
+  util::StatusOr<JsonDocument> header = JsonDocument::ParseObject(json_header);
   EXPECT_THAT(header, IsOk());
-  EXPECT_FALSE(ValidateHeader(*header, "HS256", "kid", "kid").ok());
+  EXPECT_FALSE(ValidateHeader(header->root(), "HS256", "kid", "kid").ok());
+}
+
+TEST(JwtFormat, ReadUnverifiedHeader) {
+  std::string compact = absl::StrCat(
+      EncodeHeader(R"({"kid":"kid-1234","alg":"HS256"})"), ".payload.mac");
+  absl::optional<UnverifiedHeader> header = ReadUnverifiedHeader(compact);
+  ASSERT_TRUE(header.has_value());
+  EXPECT_THAT(header->algorithm, Eq("HS256"));
+  EXPECT_THAT(header->kid, Eq("kid-1234"));
+
+  header = ReadUnverifiedHeader(EncodeHeader(R"({"alg":"ES256"})"));
+  ASSERT_TRUE(header.has_value());
+  EXPECT_THAT(header->algorithm, Eq("ES256"));
+  EXPECT_FALSE(header->kid.has_value());
+}
+
+TEST(JwtFormat, ReadUnverifiedHeaderWithInvalidHeaderFails) {
+  for (const std::string& json_header : std::vector<std::string>{
+           "{}", R"({"alg":"HS256")", R"({"alg":256})",
+           R"({"alg":"HS256","kid":1234})"}) {
+    EXPECT_FALSE(
+        ReadUnverifiedHeader(absl::StrCat(EncodeHeader(json_header), ".e30."))
+            .has_value())
+        << json_header;
+  }
+  EXPECT_FALSE(ReadUnverifiedHeader("?.e30.").has_value());
+}
+
+TEST(JwtFormat, EncodedHeaderCacheAppendsHeader) {
+  EncodedHeaderCache header_cache("HS256");
+  std::vector<absl::optional<std::string>> type_headers = {
+      absl::nullopt, "JWT", "", "at+jwt"};
+  std::vector<absl::optional<std::string>> kids = {absl::nullopt, "kid-1234",
+                                                    "", "AZxkcg"};
+  // There are more combinations than the 8 headers the cache holds. The
+  // second time, the headers of the first 8 combinations come from the cache.
+  std::vector<std::string> first_headers;
+  for (int i = 0; i < 2; ++i) {
+    int n = 0;
+    for (const absl::optional<std::string>& type_header : type_headers) {
+      for (const absl::optional<std::string>& kid : kids) {
+        std::string output = "prefix.";
+        ASSERT_THAT(header_cache.AppendHeader(type_header, kid, &output),
+                    IsOk());
+        std::vector<std::string> parts = absl::StrSplit(output, '.');
+        ASSERT_THAT(parts.size(), Eq(2));
+        EXPECT_THAT(parts[0], Eq("prefix"));
+        if (i == 0) {
+          first_headers.push_back(parts[1]);
+        } else if (n < 8) {
+          EXPECT_THAT(parts[1], Eq(first_headers[n]));
+        }
+        ++n;
+
+        std::string json_header;
+        ASSERT_TRUE(DecodeHeader(parts[1], &json_header));
+        util::StatusOr<JsonDocument> header =
+            JsonDocument::ParseObject(json_header);
+        ASSERT_THAT(header, IsOk());
+        EXPECT_THAT(ValidateHeader(header->root(), "HS256", absl::nullopt,
+                                   absl::nullopt),
+                    IsOk());
+        EXPECT_THAT(GetTypeHeader(header->root()), Eq(type_header));
+        absl::optional<JsonValue> kid_value = header->root().Find("kid");
+        ASSERT_THAT(kid_value.has_value(), Eq(kid.has_value()));
+        if (kid.has_value()) {
+          EXPECT_THAT(kid_value->string_value(), Eq(*kid));
+        }
+      }
+    }
+  }
+}
+
+TEST(JwtFormat, CreateUnsignedCompactAndAppendSignature) {
+  EncodedHeaderCache header_cache("ES256");
+  util::StatusOr<RawJwt> raw_jwt = RawJwtBuilder()
+                                       .SetTypeHeader("JWT")
+                                       .SetIssuer("issuer")
+                                       .WithoutExpiration()
+                                       .Build();
+  ASSERT_THAT(raw_jwt, IsOk());
+  util::StatusOr<std::string> compact = CreateUnsignedCompact(
+      header_cache, *raw_jwt, "kid-1234", MaxSignatureSize("ES256"));
+  ASSERT_THAT(compact, IsOk());
+  std::string signature(64, 's');
+  std::size_t capacity = compact->capacity();
+  AppendSignature(signature, &compact.value());
+  EXPECT_THAT(compact->capacity(), Eq(capacity));
+
+  std::vector<std::string> parts = absl::StrSplit(*compact, '.');
+  ASSERT_THAT(parts.size(), Eq(3));
+  std::string json_header;
+  ASSERT_TRUE(DecodeHeader(parts[0], &json_header));
+  util::StatusOr<JsonDocument> header = JsonDocument::ParseObject(json_header);
+  ASSERT_THAT(header, IsOk());
+  EXPECT_THAT(
+      ValidateHeader(header->root(), "ES256", absl::nullopt, "kid-1234"),
+      IsOk());
+  EXPECT_THAT(GetTypeHeader(header->root()), Eq("JWT"));
+  util::StatusOr<std::string> payload = raw_jwt->GetJsonPayload();
+  ASSERT_THAT(payload, IsOk());
+  EXPECT_THAT(parts[1], Eq(EncodePayload(*payload)));
+  EXPECT_THAT(parts[2], Eq(EncodeSignature(signature)));
 }
 
 TEST(JwtFormat, GetKidWithTinkOutputPrefixType) {
@@ -408,6 +519,17 @@ TEST(RawJwt, FromJsonWithBadRegisteredTypes) {
   EXPECT_FALSE(RawJwtParser::FromJson(absl::nullopt, R"({"iat":"abc"})").ok());
 }
 
+TEST(RawJwt, FromJsonWithDuplicateClaimsUsesLastValue) {
+  util::StatusOr<RawJwt> jwt = RawJwtParser::FromJson(
+      absl::nullopt, R"({"iss":123,"claim":"a","iss":"issuer","claim":"b"})");
+  ASSERT_THAT(jwt, IsOk());
+  EXPECT_THAT(jwt->GetIssuer(), IsOkAndHolds("issuer"));
+  EXPECT_THAT(jwt->GetStringClaim("claim"), IsOkAndHolds("b"));
+  EXPECT_THAT(jwt->CustomClaimNames(), testing::ElementsAre("claim"));
+  EXPECT_THAT(jwt->GetJsonPayload(),
+              IsOkAndHolds(R"({"iss":"issuer","claim":"b"})"));
+}
+
 }  // namespace jwt_internal
 }  // namespace tink
 }  // namespace crypto
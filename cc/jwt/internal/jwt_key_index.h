@@ -0,0 +1,141 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_JWT_INTERNAL_JWT_KEY_INDEX_H_
+#define TINK_JWT_INTERNAL_JWT_KEY_INDEX_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "tink/jwt/internal/jwt_format.h"
+#include "tink/primitive_set.h"
+
+namespace crypto {
+namespace tink {
+namespace jwt_internal {
+
+// Selects the keys of a JWT primitive set that can verify a token, using the
+// kid and alg headers of the token. P is JwtMacInternal or
+// JwtPublicKeyVerifyInternal.
+//
+// A key can only verify a token if the alg header matches its algorithm, and:
+// - for TINK keys, if the kid header is the kid derived from the key id,
+// - for RAW keys with a custom kid, if the kid header is missing or is the
+//   custom kid,
+// - for RAW keys without a custom kid, whatever the kid header is.
+// The primitives check this again after verification; the index only avoids
+// computing MACs and verifying signatures with keys that cannot succeed.
+template <class P>
+class JwtKeyIndex {
+ public:
+  using Entry = typename PrimitiveSet<P>::template Entry<P>;
+  using Entries = absl::InlinedVector<Entry*, 4>;
+
+  // `primitive_set` must contain only RAW and TINK keys, and must outlive the
+  // index.
+  explicit JwtKeyIndex(const PrimitiveSet<P>& primitive_set)
+      : entries_(primitive_set.get_all()) {
+    for (std::size_t i = 0; i < entries_.size(); ++i) {
+      Entry* entry = entries_[i];
+      algorithms_.push_back(std::string(entry->get_primitive().GetAlgorithm()));
+      absl::optional<std::string> kid =
+          GetKid(entry->get_key_id(), entry->get_output_prefix_type());
+      if (kid.has_value()) {
+        by_kid_[*kid].push_back(i);
+        continue;
+      }
+      absl::optional<absl::string_view> custom_kid =
+          entry->get_primitive().GetCustomKid();
+      if (custom_kid.has_value()) {
+        by_kid_[std::string(*custom_kid)].push_back(i);
+        with_custom_kid_.push_back(i);
+      } else {
+        without_kid_.push_back(i);
+      }
+    }
+  }
+
+  // Returns the entries that can verify `compact`, in keyset order. If the
+  // header of `compact` cannot be read, returns all entries, so that
+  // verification fails with the same error as without the index.
+  Entries GetCandidates(absl::string_view compact) const {
+    absl::optional<UnverifiedHeader> header = ReadUnverifiedHeader(compact);
+    if (!header.has_value()) {
+      return Entries(entries_.begin(), entries_.end());
+    }
+    const std::vector<std::size_t>* with_kid = &with_custom_kid_;
+    if (header->kid.has_value()) {
+      auto it = by_kid_.find(*header->kid);
+      with_kid = it == by_kid_.end() ? nullptr : &it->second;
+    }
+    absl::InlinedVector<std::size_t, 4> indices;
+    if (with_kid != nullptr) {
+      std::merge(with_kid->begin(), with_kid->end(), without_kid_.begin(),
+                 without_kid_.end(), std::back_inserter(indices));
+    } else {
+      indices.assign(without_kid_.begin(), without_kid_.end());
+    }
+    Entries candidates;
+    for (std::size_t i : indices) {
+      if (algorithms_[i] == header->algorithm) {
+        candidates.push_back(entries_[i]);
+      }
+    }
+    return candidates;
+  }
+
+  // Sets (*candidates)[(*groups)[i]] to GetCandidates(compacts[i]) for each
+  // of `compacts`. Tokens of the same issuer usually have identical headers,
+  // so the candidates are only looked up once per distinct header.
+  void GetBatchCandidates(absl::Span<const absl::string_view> compacts,
+                          std::vector<Entries>* candidates,
+                          std::vector<std::size_t>* groups) const {
+    absl::flat_hash_map<absl::string_view, std::size_t> group_of_header;
+    candidates->clear();
+    groups->resize(compacts.size());
+    for (std::size_t i = 0; i < compacts.size(); ++i) {
+      absl::string_view header = compacts[i].substr(0, compacts[i].find('.'));
+      auto inserted = group_of_header.emplace(header, candidates->size());
+      if (inserted.second) {
+        candidates->push_back(GetCandidates(compacts[i]));
+      }
+      (*groups)[i] = inserted.first->second;
+    }
+  }
+
+ private:
+  std::vector<Entry*> entries_;
+  // The algorithm of each entry.
+  std::vector<std::string> algorithms_;
+  // Indices into entries_, all in increasing order.
+  absl::flat_hash_map<std::string, std::vector<std::size_t>> by_kid_;
+  std::vector<std::size_t> with_custom_kid_;
+  std::vector<std::size_t> without_kid_;
+};
+
+}  // namespace jwt_internal
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_JWT_INTERNAL_JWT_KEY_INDEX_H_
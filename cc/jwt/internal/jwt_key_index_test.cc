@@ -0,0 +1,152 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/jwt/internal/jwt_key_index.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "tink/jwt/internal/jwt_format.h"
+#include "tink/jwt/internal/jwt_mac_impl.h"
+#include "tink/jwt/internal/jwt_mac_internal.h"
+#include "tink/primitive_set.h"
+#include "tink/util/test_matchers.h"
+#include "proto/tink.pb.h"
+
+using ::crypto::tink::test::IsOk;
+using ::google::crypto::tink::KeysetInfo;
+using ::google::crypto::tink::KeyStatusType;
+using ::google::crypto::tink::OutputPrefixType;
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAre;
+
+namespace crypto {
+namespace tink {
+namespace jwt_internal {
+namespace {
+
+KeysetInfo::KeyInfo CreateKeyInfo(uint32_t key_id,
+                                  OutputPrefixType output_prefix_type) {
+  KeysetInfo::KeyInfo key_info;
+  key_info.set_key_id(key_id);
+  key_info.set_output_prefix_type(output_prefix_type);
+  key_info.set_status(KeyStatusType::ENABLED);
+  key_info.set_type_url("type.googleapis.com/google.crypto.tink.JwtHmacKey");
+  return key_info;
+}
+
+// The index never computes or verifies MACs, so the primitives need no key.
+std::unique_ptr<JwtMacInternal> CreateJwtMac(
+    absl::string_view algorithm, absl::optional<absl::string_view> custom_kid) {
+  return absl::make_unique<JwtMacImpl>(nullptr, algorithm, custom_kid);
+}
+
+std::string CreateToken(absl::string_view json_header) {
+  return absl::StrCat(EncodeHeader(json_header), ".e30.mac");
+}
+
+std::vector<uint32_t> CandidateKeyIds(const JwtKeyIndex<JwtMacInternal>& index,
+                                      absl::string_view compact) {
+  std::vector<uint32_t> key_ids;
+  for (const auto* entry : index.GetCandidates(compact)) {
+    key_ids.push_back(entry->get_key_id());
+  }
+  return key_ids;
+}
+
+class JwtKeyIndexTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    util::StatusOr<PrimitiveSet<JwtMacInternal>> primitive_set =
+        PrimitiveSet<JwtMacInternal>::Builder()
+            .AddPrimaryPrimitive(CreateJwtMac("HS256", absl::nullopt),
+                                 CreateKeyInfo(1, OutputPrefixType::TINK))
+            .AddPrimitive(CreateJwtMac("HS512", absl::nullopt),
+                          CreateKeyInfo(2, OutputPrefixType::TINK))
+            .AddPrimitive(CreateJwtMac("HS256", absl::nullopt),
+                          CreateKeyInfo(3, OutputPrefixType::RAW))
+            .AddPrimitive(CreateJwtMac("HS256", "custom-kid"),
+                          CreateKeyInfo(4, OutputPrefixType::RAW))
+            .AddPrimitive(CreateJwtMac("HS512", absl::nullopt),
+                          CreateKeyInfo(5, OutputPrefixType::RAW))
+            .Build();
+    ASSERT_THAT(primitive_set, IsOk());
+    primitive_set_ = absl::make_unique<PrimitiveSet<JwtMacInternal>>(
+        *std::move(primitive_set));
+    index_ = absl::make_unique<JwtKeyIndex<JwtMacInternal>>(*primitive_set_);
+  }
+
+  std::unique_ptr<PrimitiveSet<JwtMacInternal>> primitive_set_;
+  std::unique_ptr<JwtKeyIndex<JwtMacInternal>> index_;
+};
+
+TEST_F(JwtKeyIndexTest, TinkKidSelectsTinkKeyAndRawKeysWithoutKid) {
+  std::string kid = *GetKid(1, OutputPrefixType::TINK);
+  EXPECT_THAT(
+      CandidateKeyIds(*index_, CreateToken(absl::StrCat(
+                                   R"({"alg":"HS256","kid":")", kid, R"("})"))),
+      UnorderedElementsAre(1, 3));
+  kid = *GetKid(2, OutputPrefixType::TINK);
+  EXPECT_THAT(
+      CandidateKeyIds(*index_, CreateToken(absl::StrCat(
+                                   R"({"alg":"HS512","kid":")", kid, R"("})"))),
+      UnorderedElementsAre(2, 5));
+}
+
+TEST_F(JwtKeyIndexTest, CustomKidSelectsKeyWithCustomKid) {
+  EXPECT_THAT(CandidateKeyIds(*index_, CreateToken(
+                                           R"({"alg":"HS256",)"
+                                           R"("kid":"custom-kid"})")),
+              UnorderedElementsAre(3, 4));
+}
+
+TEST_F(JwtKeyIndexTest, UnknownKidSelectsRawKeysWithoutKid) {
+  EXPECT_THAT(CandidateKeyIds(*index_, CreateToken(
+                                           R"({"alg":"HS256","kid":"other"})")),
+              ElementsAre(3));
+  EXPECT_THAT(CandidateKeyIds(*index_, CreateToken(
+                                           R"({"alg":"HS384","kid":"other"})")),
+              IsEmpty());
+}
+
+TEST_F(JwtKeyIndexTest, MissingKidSelectsRawKeys) {
+  EXPECT_THAT(CandidateKeyIds(*index_, CreateToken(R"({"alg":"HS256"})")),
+              UnorderedElementsAre(3, 4));
+  EXPECT_THAT(CandidateKeyIds(*index_, CreateToken(R"({"alg":"HS512"})")),
+              ElementsAre(5));
+}
+
+TEST_F(JwtKeyIndexTest, InvalidHeaderSelectsAllKeys) {
+  for (const std::string& compact : std::vector<std::string>{
+           "invalid", "?.e30.mac", CreateToken("{}"),
+           CreateToken(R"({"alg":"HS256","kid":42})")}) {
+    EXPECT_THAT(CandidateKeyIds(*index_, compact),
+                UnorderedElementsAre(1, 2, 3, 4, 5))
+        << compact;
+  }
+}
+
+}  // namespace
+}  // namespace jwt_internal
+}  // namespace tink
+}  // namespace crypto
@@ -21,9 +21,8 @@
 #include <vector>
 
 #include "absl/status/status.h"
-#include "absl/strings/escaping.h"
 #include "absl/strings/str_split.h"
-#include "tink/jwt/internal/json_util.h"
+#include "tink/jwt/internal/json_document.h"
 #include "tink/jwt/internal/jwt_format.h"
 
 namespace crypto {
@@ -32,14 +31,6 @@ namespace jwt_internal {
 
 util::StatusOr<std::string> JwtMacImpl::ComputeMacAndEncodeWithKid(
     const RawJwt& token, absl::optional<absl::string_view> kid) const {
-  absl::optional<std::string> type_header;
-  if (token.HasTypeHeader()) {
-    util::StatusOr<std::string> type = token.GetTypeHeader();
-    if (!type.ok()) {
-      return type.status();
-    }
-    type_header = *type;
-  }
   if (custom_kid_.has_value()) {
     if (kid.has_value()) {
       return util::Status(absl::StatusCode::kInvalidArgument,
@@ -47,24 +38,17 @@ util::StatusOr<std::string> JwtMacImpl::ComputeMacAndEncodeWithKid(
     }
     kid = *custom_kid_;
   }
-  util::StatusOr<std::string> encoded_header =
-      CreateHeader(algorithm_, type_header, kid);
-  if (!encoded_header.ok()) {
-    return encoded_header.status();
-  }
-  util::StatusOr<std::string> payload = token.GetJsonPayload();
-  if (!payload.ok()) {
-    return payload.status();
+  util::StatusOr<std::string> compact = CreateUnsignedCompact(
+      header_cache_, token, kid, MaxSignatureSize(algorithm_));
+  if (!compact.ok()) {
+    return compact.status();
   }
-  std::string encoded_payload = EncodePayload(*payload);
-  std::string unsigned_token =
-      absl::StrCat(*encoded_header, ".", encoded_payload);
-  util::StatusOr<std::string> tag = mac_->ComputeMac(unsigned_token);
+  util::StatusOr<std::string> tag = mac_->ComputeMac(*compact);
   if (!tag.ok()) {
     return tag.status();
   }
-  std::string encoded_tag = EncodeSignature(*tag);
-  return absl::StrCat(unsigned_token, ".", encoded_tag);
+  AppendSignature(*tag, &compact.value());
+  return compact;
 }
 
 util::StatusOr<VerifiedJwt> JwtMacImpl::VerifyMacAndDecodeWithKid(
@@ -95,13 +79,13 @@ util::StatusOr<VerifiedJwt> JwtMacImpl::VerifyMacAndDecodeWithKid(
   if (!DecodeHeader(parts[0], &json_header)) {
     return util::Status(absl::StatusCode::kInvalidArgument, "invalid header");
   }
-  util::StatusOr<google::protobuf::Struct> header =
-      JsonStringToProtoStruct(json_header);
+  util::StatusOr<JsonDocument> header =
+      JsonDocument::ParseObject(std::move(json_header));
   if (!header.ok()) {
     return header.status();
   }
   util::Status validate_header_result =
-      ValidateHeader(*header, algorithm_, kid, custom_kid_);
+      ValidateHeader(header->root(), algorithm_, kid, custom_kid_);
   if (!validate_header_result.ok()) {
     return validate_header_result;
   }
@@ -110,8 +94,8 @@ util::StatusOr<VerifiedJwt> JwtMacImpl::VerifyMacAndDecodeWithKid(
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "invalid JWT payload");
   }
-  util::StatusOr<RawJwt> raw_jwt =
-      RawJwtParser::FromJson(GetTypeHeader(*header), json_payload);
+  util::StatusOr<RawJwt> raw_jwt = RawJwtParser::FromJson(
+      GetTypeHeader(header->root()), std::move(json_payload));
   if (!raw_jwt.ok()) {
     return raw_jwt.status();
   }
@@ -22,6 +22,7 @@
 #include <utility>
 
 #include "absl/strings/string_view.h"
+#include "tink/jwt/internal/jwt_format.h"
 #include "tink/jwt/internal/jwt_mac_internal.h"
 #include "tink/jwt/jwt_mac.h"
 #include "tink/jwt/jwt_validator.h"
@@ -39,7 +40,8 @@ class JwtMacImpl : public JwtMacInternal {
  public:
   explicit JwtMacImpl(std::unique_ptr<crypto::tink::Mac> mac,
                       absl::string_view algorithm,
-                      absl::optional<absl::string_view> custom_kid) {
+                      absl::optional<absl::string_view> custom_kid)
+      : header_cache_(algorithm) {
     mac_ = std::move(mac);
     algorithm_ = std::string(algorithm);
     if (custom_kid.has_value()) {
@@ -56,9 +58,19 @@ class JwtMacImpl : public JwtMacInternal {
       absl::string_view compact, const crypto::tink::JwtValidator& validator,
       absl::optional<absl::string_view> kid) const override;
 
+  absl::string_view GetAlgorithm() const override { return algorithm_; }
+
+  absl::optional<absl::string_view> GetCustomKid() const override {
+    if (!custom_kid_.has_value()) {
+      return absl::nullopt;
+    }
+    return absl::string_view(*custom_kid_);
+  }
+
  private:
   std::unique_ptr<crypto::tink::Mac> mac_;
   std::string algorithm_;
+  EncodedHeaderCache header_cache_;
   absl::optional<std::string> custom_kid_;
 };
 
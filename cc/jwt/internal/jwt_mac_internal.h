@@ -20,6 +20,7 @@
 #include <string>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 #include "tink/jwt/jwt_validator.h"
 #include "tink/jwt/raw_jwt.h"
 #include "tink/jwt/verified_jwt.h"
@@ -65,6 +66,13 @@ class JwtMacInternal {
       absl::string_view compact, const JwtValidator& validator,
       absl::optional<absl::string_view> kid) const = 0;
 
+  // Returns the alg header of the tokens this primitive computes and accepts.
+  virtual absl::string_view GetAlgorithm() const = 0;
+
+  // Returns the kid that was set for a RAW key when it was converted from
+  // another format, for example JWK.
+  virtual absl::optional<absl::string_view> GetCustomKid() const = 0;
+
   virtual ~JwtMacInternal() = default;
 };
 
@@ -16,12 +16,17 @@
 
 #include "tink/jwt/internal/jwt_mac_wrapper.h"
 
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "tink/jwt/internal/jwt_batch.h"
 #include "tink/jwt/internal/jwt_format.h"
+#include "tink/jwt/internal/jwt_key_index.h"
 #include "tink/jwt/internal/jwt_mac_internal.h"
 #include "tink/jwt/jwt_mac.h"
 #include "tink/primitive_set.h"
@@ -40,7 +45,7 @@ class JwtMacSetWrapper : public JwtMac {
  public:
   explicit JwtMacSetWrapper(
       std::unique_ptr<PrimitiveSet<JwtMacInternal>> jwt_mac_set)
-      : jwt_mac_set_(std::move(jwt_mac_set)) {}
+      : jwt_mac_set_(std::move(jwt_mac_set)), key_index_(*jwt_mac_set_) {}
 
   crypto::tink::util::StatusOr<std::string> ComputeMacAndEncode(
       const crypto::tink::RawJwt& token) const override;
@@ -49,10 +54,23 @@ class JwtMacSetWrapper : public JwtMac {
       absl::string_view compact,
       const crypto::tink::JwtValidator& validator) const override;
 
+  std::vector<crypto::tink::util::StatusOr<crypto::tink::VerifiedJwt>>
+  VerifyMacAndDecodeBatch(absl::Span<const absl::string_view> compacts,
+                          const crypto::tink::JwtValidator& validator,
+                          JwtBatchExecutor* executor) const override;
+
   ~JwtMacSetWrapper() override = default;
 
  private:
+  using Entries = JwtKeyIndex<JwtMacInternal>::Entries;
+
+  // Verifies `compact` with the keys in `candidates`.
+  util::StatusOr<VerifiedJwt> VerifyWithCandidates(
+      const Entries& candidates, absl::string_view compact,
+      const JwtValidator& validator) const;
+
   std::unique_ptr<PrimitiveSet<JwtMacInternal>> jwt_mac_set_;
+  JwtKeyIndex<JwtMacInternal> key_index_;
 };
 
 util::Status Validate(PrimitiveSet<JwtMacInternal>* jwt_mac_set) {
@@ -85,8 +103,34 @@ util::StatusOr<std::string> JwtMacSetWrapper::ComputeMacAndEncode(
 util::StatusOr<crypto::tink::VerifiedJwt> JwtMacSetWrapper::VerifyMacAndDecode(
     absl::string_view compact,
     const crypto::tink::JwtValidator& validator) const {
+  return VerifyWithCandidates(key_index_.GetCandidates(compact), compact,
+                              validator);
+}
+
+std::vector<util::StatusOr<VerifiedJwt>>
+JwtMacSetWrapper::VerifyMacAndDecodeBatch(
+    absl::Span<const absl::string_view> compacts,
+    const crypto::tink::JwtValidator& validator,
+    JwtBatchExecutor* executor) const {
+  std::vector<Entries> candidates;
+  std::vector<std::size_t> groups;
+  key_index_.GetBatchCandidates(compacts, &candidates, &groups);
+  std::vector<util::StatusOr<VerifiedJwt>> results(compacts.size());
+  RunInTasks(compacts.size(), executor,
+             [&](std::size_t begin, std::size_t end) {
+               for (std::size_t i = begin; i < end; ++i) {
+                 results[i] = VerifyWithCandidates(candidates[groups[i]],
+                                                   compacts[i], validator);
+               }
+             });
+  return results;
+}
+
+util::StatusOr<VerifiedJwt> JwtMacSetWrapper::VerifyWithCandidates(
+    const Entries& candidates, absl::string_view compact,
+    const JwtValidator& validator) const {
   absl::optional<util::Status> interesting_status;
-  for (const auto* mac_entry : jwt_mac_set_->get_all()) {
+  for (const auto* mac_entry : candidates) {
     JwtMacInternal& jwt_mac = mac_entry->get_primitive();
     absl::optional<std::string> kid =
         GetKid(mac_entry->get_key_id(), mac_entry->get_output_prefix_type());
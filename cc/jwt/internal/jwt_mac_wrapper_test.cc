@@ -16,17 +16,21 @@
 
 #include "tink/jwt/internal/jwt_mac_wrapper.h"
 
+#include <cstddef>
+#include <functional>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
 #include "tink/cleartext_keyset_handle.h"
 #include "tink/jwt/internal/json_util.h"
 #include "tink/jwt/internal/jwt_format.h"
 #include "tink/jwt/internal/jwt_hmac_key_manager.h"
+#include "tink/jwt/jwt_batch_executor.h"
 #include "tink/keyset_manager.h"
 #include "tink/primitive_set.h"
 #include "tink/util/status.h"
@@ -80,6 +84,19 @@ std::unique_ptr<KeysetHandle> KeysetHandleWithTinkPrefix(
   return CleartextKeysetHandle::GetKeysetHandle(keyset);
 }
 
+// Runs tasks on the calling thread and counts them.
+class CountingExecutor : public JwtBatchExecutor {
+ public:
+  void Schedule(std::function<void()> task) override {
+    ++num_tasks_;
+    task();
+  }
+  int num_tasks() const { return num_tasks_; }
+
+ private:
+  int num_tasks_ = 0;
+};
+
 class JwtMacWrapperTest : public ::testing::Test {
  protected:
   void SetUp() override {
@@ -315,6 +332,78 @@ TEST_F(JwtMacWrapperTest, KeyRotation) {
   }
 }
 
+TEST_F(JwtMacWrapperTest, VerifyBatch) {
+  std::vector<OutputPrefixType> prefixes = {OutputPrefixType::RAW,
+                                            OutputPrefixType::TINK};
+  for (OutputPrefixType prefix : prefixes) {
+    SCOPED_TRACE(absl::StrCat("Testing with prefix ", prefix));
+    KeyTemplate key_template = createTemplate(prefix);
+    KeysetManager manager;
+    util::StatusOr<uint32_t> old_id = manager.Add(key_template);
+    ASSERT_THAT(old_id, IsOk());
+    ASSERT_THAT(manager.SetPrimary(*old_id), IsOk());
+    util::StatusOr<std::unique_ptr<JwtMac>> old_jwt_mac =
+        manager.GetKeysetHandle()->GetPrimitive<JwtMac>();
+    ASSERT_THAT(old_jwt_mac, IsOk());
+    util::StatusOr<uint32_t> new_id = manager.Add(key_template);
+    ASSERT_THAT(new_id, IsOk());
+    ASSERT_THAT(manager.SetPrimary(*new_id), IsOk());
+    util::StatusOr<std::unique_ptr<JwtMac>> jwt_mac =
+        manager.GetKeysetHandle()->GetPrimitive<JwtMac>();
+    ASSERT_THAT(jwt_mac, IsOk());
+    util::StatusOr<std::unique_ptr<JwtMac>> other_jwt_mac =
+        KeysetHandle::GenerateNew(key_template)
+            .value()
+            ->GetPrimitive<JwtMac>();
+    ASSERT_THAT(other_jwt_mac, IsOk());
+
+    util::StatusOr<RawJwt> raw_jwt =
+        RawJwtBuilder().SetIssuer("issuer").WithoutExpiration().Build();
+    ASSERT_THAT(raw_jwt, IsOk());
+    util::StatusOr<RawJwt> other_raw_jwt =
+        RawJwtBuilder().SetIssuer("other").WithoutExpiration().Build();
+    ASSERT_THAT(other_raw_jwt, IsOk());
+    util::StatusOr<JwtValidator> validator = JwtValidatorBuilder()
+                                                 .ExpectIssuer("issuer")
+                                                 .AllowMissingExpiration()
+                                                 .Build();
+    ASSERT_THAT(validator, IsOk());
+
+    std::vector<std::string> tokens = {
+        (*old_jwt_mac)->ComputeMacAndEncode(*raw_jwt).value(),
+        (*jwt_mac)->ComputeMacAndEncode(*raw_jwt).value(),
+        (*jwt_mac)->ComputeMacAndEncode(*other_raw_jwt).value(),
+        (*other_jwt_mac)->ComputeMacAndEncode(*raw_jwt).value(),
+        "invalid"};
+    std::vector<absl::string_view> compacts;
+    for (int i = 0; i < 10; ++i) {
+      compacts.insert(compacts.end(), tokens.begin(), tokens.end());
+    }
+
+    CountingExecutor executor;
+    for (JwtBatchExecutor* e : {static_cast<JwtBatchExecutor*>(nullptr),
+                                static_cast<JwtBatchExecutor*>(&executor)}) {
+      std::vector<util::StatusOr<VerifiedJwt>> results =
+          (*jwt_mac)->VerifyMacAndDecodeBatch(compacts, *validator, e);
+      ASSERT_THAT(results.size(), Eq(compacts.size()));
+      for (std::size_t i = 0; i < compacts.size(); ++i) {
+        util::StatusOr<VerifiedJwt> expected =
+            (*jwt_mac)->VerifyMacAndDecode(compacts[i], *validator);
+        EXPECT_THAT(results[i].status(), Eq(expected.status()));
+        if (expected.ok()) {
+          EXPECT_THAT(results[i]->GetIssuer(), IsOkAndHolds("issuer"));
+        }
+      }
+      EXPECT_THAT(results[0].status(), IsOk());
+      EXPECT_THAT(results[1].status(), IsOk());
+      EXPECT_THAT(results[2].status().message(), Eq("wrong issuer"));
+      EXPECT_THAT(results[3].status(), Not(IsOk()));
+      EXPECT_THAT(results[4].status(), Not(IsOk()));
+    }
+    EXPECT_THAT(executor.num_tasks(), Eq(4));
+  }
+}
+
 }  // namespace
 }  // namespace jwt_internal
 }  // namespace tink
@@ -19,8 +19,6 @@
 #include <string>
 
 #include "absl/status/status.h"
-#include "absl/strings/escaping.h"
-#include "absl/strings/str_split.h"
 #include "tink/jwt/internal/jwt_format.h"
 
 namespace crypto {
@@ -29,14 +27,6 @@ namespace jwt_internal {
 
 util::StatusOr<std::string> JwtPublicKeySignImpl::SignAndEncodeWithKid(
     const RawJwt& token, absl::optional<absl::string_view> kid) const {
-  absl::optional<std::string> type_header;
-  if (token.HasTypeHeader()) {
-    util::StatusOr<std::string> type = token.GetTypeHeader();
-    if (!type.ok()) {
-      return type.status();
-    }
-    type_header = *type;
-  }
   if (custom_kid_.has_value()) {
     if (kid.has_value()) {
       return util::Status(absl::StatusCode::kInvalidArgument,
@@ -44,24 +34,17 @@ util::StatusOr<std::string> JwtPublicKeySignImpl::SignAndEncodeWithKid(
     }
     kid = *custom_kid_;
   }
-  util::StatusOr<std::string> encoded_header =
-      CreateHeader(algorithm_, type_header, kid);
-  if (!encoded_header.ok()) {
-    return encoded_header.status();
-  }
-  util::StatusOr<std::string> payload = token.GetJsonPayload();
-  if (!payload.ok()) {
-    return payload.status();
+  util::StatusOr<std::string> compact = CreateUnsignedCompact(
+      header_cache_, token, kid, MaxSignatureSize(algorithm_));
+  if (!compact.ok()) {
+    return compact.status();
   }
-  std::string encoded_payload = EncodePayload(*payload);
-  std::string unsigned_token =
-      absl::StrCat(*encoded_header, ".", encoded_payload);
-  util::StatusOr<std::string> tag = sign_->Sign(unsigned_token);
+  util::StatusOr<std::string> tag = sign_->Sign(*compact);
   if (!tag.ok()) {
     return tag.status();
   }
-  std::string encoded_tag = EncodeSignature(*tag);
-  return absl::StrCat(unsigned_token, ".", encoded_tag);
+  AppendSignature(*tag, &compact.value());
+  return compact;
 }
 
 }  // namespace jwt_internal
@@ -22,6 +22,7 @@
 #include <utility>
 
 #include "absl/strings/string_view.h"
+#include "tink/jwt/internal/jwt_format.h"
 #include "tink/jwt/internal/jwt_public_key_sign_internal.h"
 #include "tink/jwt/raw_jwt.h"
 #include "tink/public_key_sign.h"
@@ -37,7 +38,8 @@ class JwtPublicKeySignImpl : public JwtPublicKeySignInternal {
   explicit JwtPublicKeySignImpl(
       std::unique_ptr<crypto::tink::PublicKeySign> sign,
       absl::string_view algorithm,
-      absl::optional<absl::string_view> custom_kid) {
+      absl::optional<absl::string_view> custom_kid)
+      : header_cache_(algorithm) {
     sign_ = std::move(sign);
     algorithm_ = std::string(algorithm);
     if (custom_kid.has_value()) {
@@ -51,6 +53,7 @@ class JwtPublicKeySignImpl : public JwtPublicKeySignInternal {
  private:
   std::unique_ptr<crypto::tink::PublicKeySign> sign_;
   std::string algorithm_;
+  EncodedHeaderCache header_cache_;
   // custom_kid may be set when a key is converted from another format, for
   // example JWK. It does not have any relation to the key id. It can only be
   // set for keys with output prefix RAW.
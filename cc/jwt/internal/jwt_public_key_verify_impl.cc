@@ -23,7 +23,7 @@
 #include "absl/status/status.h"
 #include "absl/strings/escaping.h"
 #include "absl/strings/str_split.h"
-#include "tink/jwt/internal/json_util.h"
+#include "tink/jwt/internal/json_document.h"
 #include "tink/jwt/internal/jwt_format.h"
 
 namespace crypto {
@@ -60,13 +60,13 @@ util::StatusOr<VerifiedJwt> JwtPublicKeyVerifyImpl::VerifyAndDecodeWithKid(
   if (!DecodeHeader(parts[0], &json_header)) {
     return util::Status(absl::StatusCode::kInvalidArgument, "invalid header");
   }
-  util::StatusOr<google::protobuf::Struct> header =
-      JsonStringToProtoStruct(json_header);
+  util::StatusOr<JsonDocument> header =
+      JsonDocument::ParseObject(std::move(json_header));
   if (!header.ok()) {
     return header.status();
   }
   util::Status validate_header_result =
-      ValidateHeader(*header, algorithm_, kid, custom_kid_);
+      ValidateHeader(header->root(), algorithm_, kid, custom_kid_);
   if (!validate_header_result.ok()) {
     return validate_header_result;
   }
@@ -76,7 +76,7 @@ util::StatusOr<VerifiedJwt> JwtPublicKeyVerifyImpl::VerifyAndDecodeWithKid(
                         "invalid JWT payload");
   }
   util::StatusOr<RawJwt> raw_jwt = RawJwtParser::FromJson(
-      GetTypeHeader(*header), json_payload);
+      GetTypeHeader(header->root()), std::move(json_payload));
   if (!raw_jwt.ok()) {
     return raw_jwt.status();
   }
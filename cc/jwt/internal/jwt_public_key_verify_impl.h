@@ -51,6 +51,15 @@ class JwtPublicKeyVerifyImpl : public JwtPublicKeyVerifyInternal {
       absl::string_view compact, const JwtValidator& validator,
       absl::optional<absl::string_view> kid) const override;
 
+  absl::string_view GetAlgorithm() const override { return algorithm_; }
+
+  absl::optional<absl::string_view> GetCustomKid() const override {
+    if (!custom_kid_.has_value()) {
+      return absl::nullopt;
+    }
+    return absl::string_view(*custom_kid_);
+  }
+
  private:
   std::unique_ptr<crypto::tink::PublicKeyVerify> verify_;
   std::string algorithm_;
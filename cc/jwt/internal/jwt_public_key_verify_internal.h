@@ -18,6 +18,7 @@
 #define TINK_JWT_INTERNAL_JWT_PUBLIC_KEY_VERIFY_INTERNAL_H_
 
 #include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
 #include "tink/jwt/verified_jwt.h"
@@ -54,6 +55,13 @@ class JwtPublicKeyVerifyInternal {
       absl::string_view compact, const JwtValidator& validator,
       absl::optional<absl::string_view> kid) const = 0;
 
+  // Returns the alg header of the tokens this primitive accepts.
+  virtual absl::string_view GetAlgorithm() const = 0;
+
+  // Returns the kid that was set for a RAW key when it was converted from
+  // another format, for example JWK.
+  virtual absl::optional<absl::string_view> GetCustomKid() const = 0;
+
   virtual ~JwtPublicKeyVerifyInternal() = default;
 };
 
@@ -16,12 +16,17 @@
 
 #include "tink/jwt/internal/jwt_public_key_verify_wrapper.h"
 
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "tink/jwt/internal/jwt_batch.h"
 #include "tink/jwt/internal/jwt_format.h"
+#include "tink/jwt/internal/jwt_key_index.h"
 #include "tink/jwt/internal/jwt_public_key_verify_internal.h"
 #include "tink/jwt/jwt_public_key_verify.h"
 #include "tink/primitive_set.h"
@@ -40,16 +45,30 @@ class JwtPublicKeyVerifySetWrapper : public JwtPublicKeyVerify {
  public:
   explicit JwtPublicKeyVerifySetWrapper(
       std::unique_ptr<PrimitiveSet<JwtPublicKeyVerifyInternal>> jwt_verify_set)
-      : jwt_verify_set_(std::move(jwt_verify_set)) {}
+      : jwt_verify_set_(std::move(jwt_verify_set)),
+        key_index_(*jwt_verify_set_) {}
 
   crypto::tink::util::StatusOr<crypto::tink::VerifiedJwt> VerifyAndDecode(
       absl::string_view compact,
       const crypto::tink::JwtValidator& validator) const override;
 
+  std::vector<crypto::tink::util::StatusOr<crypto::tink::VerifiedJwt>>
+  VerifyAndDecodeBatch(absl::Span<const absl::string_view> compacts,
+                       const crypto::tink::JwtValidator& validator,
+                       JwtBatchExecutor* executor) const override;
+
   ~JwtPublicKeyVerifySetWrapper() override = default;
 
  private:
+  using Entries = JwtKeyIndex<JwtPublicKeyVerifyInternal>::Entries;
+
+  // Verifies `compact` with the keys in `candidates`.
+  util::StatusOr<VerifiedJwt> VerifyWithCandidates(
+      const Entries& candidates, absl::string_view compact,
+      const JwtValidator& validator) const;
+
   std::unique_ptr<PrimitiveSet<JwtPublicKeyVerifyInternal>> jwt_verify_set_;
+  JwtKeyIndex<JwtPublicKeyVerifyInternal> key_index_;
 };
 
 util::Status Validate(
@@ -72,8 +91,34 @@ util::StatusOr<crypto::tink::VerifiedJwt>
 JwtPublicKeyVerifySetWrapper::VerifyAndDecode(
     absl::string_view compact,
     const crypto::tink::JwtValidator& validator) const {
+  return VerifyWithCandidates(key_index_.GetCandidates(compact), compact,
+                              validator);
+}
+
+std::vector<util::StatusOr<VerifiedJwt>>
+JwtPublicKeyVerifySetWrapper::VerifyAndDecodeBatch(
+    absl::Span<const absl::string_view> compacts,
+    const crypto::tink::JwtValidator& validator,
+    JwtBatchExecutor* executor) const {
+  std::vector<Entries> candidates;
+  std::vector<std::size_t> groups;
+  key_index_.GetBatchCandidates(compacts, &candidates, &groups);
+  std::vector<util::StatusOr<VerifiedJwt>> results(compacts.size());
+  RunInTasks(compacts.size(), executor,
+             [&](std::size_t begin, std::size_t end) {
+               for (std::size_t i = begin; i < end; ++i) {
+                 results[i] = VerifyWithCandidates(candidates[groups[i]],
+                                                   compacts[i], validator);
+               }
+             });
+  return results;
+}
+
+util::StatusOr<VerifiedJwt> JwtPublicKeyVerifySetWrapper::VerifyWithCandidates(
+    const Entries& candidates, absl::string_view compact,
+    const JwtValidator& validator) const {
   absl::optional<util::Status> interesting_status;
-  for (const auto* entry : jwt_verify_set_->get_all()) {
+  for (const auto* entry : candidates) {
     JwtPublicKeyVerifyInternal& jwt_verify = entry->get_primitive();
     absl::optional<std::string> kid =
         GetKid(entry->get_key_id(), entry->get_output_prefix_type());
@@ -14,12 +14,15 @@
 //
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <cstddef>
+#include <functional>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
 #include "tink/cleartext_keyset_handle.h"
 #include "tink/jwt/internal/json_util.h"
@@ -28,6 +31,7 @@
 #include "tink/jwt/internal/jwt_format.h"
 #include "tink/jwt/internal/jwt_public_key_sign_wrapper.h"
 #include "tink/jwt/internal/jwt_public_key_verify_wrapper.h"
+#include "tink/jwt/jwt_batch_executor.h"
 #include "tink/keyset_manager.h"
 #include "tink/primitive_set.h"
 #include "tink/util/status.h"
@@ -86,6 +90,19 @@ std::unique_ptr<KeysetHandle> KeysetHandleWithTinkPrefix(
   return CleartextKeysetHandle::GetKeysetHandle(keyset);
 }
 
+// Runs tasks on the calling thread and counts them.
+class CountingExecutor : public JwtBatchExecutor {
+ public:
+  void Schedule(std::function<void()> task) override {
+    ++num_tasks_;
+    task();
+  }
+  int num_tasks() const { return num_tasks_; }
+
+ private:
+  int num_tasks_ = 0;
+};
+
 class JwtPublicKeyWrappersTest : public ::testing::Test {
  protected:
   void SetUp() override {
@@ -364,6 +381,82 @@ TEST_F(JwtPublicKeyWrappersTest, KeyRotation) {
   }
 }
 
+TEST_F(JwtPublicKeyWrappersTest, VerifyBatch) {
+  std::vector<OutputPrefixType> prefixes = {OutputPrefixType::RAW,
+                                            OutputPrefixType::TINK};
+  for (OutputPrefixType prefix : prefixes) {
+    SCOPED_TRACE(absl::StrCat("Testing with prefix ", prefix));
+    KeyTemplate key_template = CreateTemplate(prefix);
+    KeysetManager manager;
+    util::StatusOr<uint32_t> old_id = manager.Add(key_template);
+    ASSERT_THAT(old_id, IsOk());
+    ASSERT_THAT(manager.SetPrimary(*old_id), IsOk());
+    util::StatusOr<std::unique_ptr<JwtPublicKeySign>> old_jwt_sign =
+        manager.GetKeysetHandle()->GetPrimitive<JwtPublicKeySign>();
+    ASSERT_THAT(old_jwt_sign, IsOk());
+    util::StatusOr<uint32_t> new_id = manager.Add(key_template);
+    ASSERT_THAT(new_id, IsOk());
+    ASSERT_THAT(manager.SetPrimary(*new_id), IsOk());
+    std::unique_ptr<KeysetHandle> handle = manager.GetKeysetHandle();
+    util::StatusOr<std::unique_ptr<JwtPublicKeySign>> jwt_sign =
+        handle->GetPrimitive<JwtPublicKeySign>();
+    ASSERT_THAT(jwt_sign, IsOk());
+    util::StatusOr<std::unique_ptr<KeysetHandle>> public_handle =
+        handle->GetPublicKeysetHandle();
+    ASSERT_THAT(public_handle, IsOk());
+    util::StatusOr<std::unique_ptr<JwtPublicKeyVerify>> jwt_verify =
+        (*public_handle)->GetPrimitive<JwtPublicKeyVerify>();
+    ASSERT_THAT(jwt_verify, IsOk());
+    util::StatusOr<std::unique_ptr<JwtPublicKeySign>> other_jwt_sign =
+        KeysetHandle::GenerateNew(key_template)
+            .value()
+            ->GetPrimitive<JwtPublicKeySign>();
+    ASSERT_THAT(other_jwt_sign, IsOk());
+
+    util::StatusOr<RawJwt> raw_jwt =
+        RawJwtBuilder().SetIssuer("issuer").WithoutExpiration().Build();
+    ASSERT_THAT(raw_jwt, IsOk());
+    util::StatusOr<RawJwt> other_raw_jwt =
+        RawJwtBuilder().SetIssuer("other").WithoutExpiration().Build();
+    ASSERT_THAT(other_raw_jwt, IsOk());
+    util::StatusOr<JwtValidator> validator = JwtValidatorBuilder()
+                                                 .ExpectIssuer("issuer")
+                                                 .AllowMissingExpiration()
+                                                 .Build();
+    ASSERT_THAT(validator, IsOk());
+
+    std::vector<std::string> tokens = {
+        (*old_jwt_sign)->SignAndEncode(*raw_jwt).value(),
+        (*jwt_sign)->SignAndEncode(*raw_jwt).value(),
+        (*jwt_sign)->SignAndEncode(*other_raw_jwt).value(),
+        (*other_jwt_sign)->SignAndEncode(*raw_jwt).value(),
+        "invalid"};
+    std::vector<absl::string_view> compacts;
+    for (int i = 0; i < 10; ++i) {
+      compacts.insert(compacts.end(), tokens.begin(), tokens.end());
+    }
+
+    CountingExecutor executor;
+    for (JwtBatchExecutor* e : {static_cast<JwtBatchExecutor*>(nullptr),
+                                static_cast<JwtBatchExecutor*>(&executor)}) {
+      std::vector<util::StatusOr<VerifiedJwt>> results =
+          (*jwt_verify)->VerifyAndDecodeBatch(compacts, *validator, e);
+      ASSERT_THAT(results, SizeIs(compacts.size()));
+      for (std::size_t i = 0; i < compacts.size(); ++i) {
+        util::StatusOr<VerifiedJwt> expected =
+            (*jwt_verify)->VerifyAndDecode(compacts[i], *validator);
+        EXPECT_THAT(results[i].status(), Eq(expected.status()));
+      }
+      EXPECT_THAT(results[0].status(), IsOk());
+      EXPECT_THAT(results[1].status(), IsOk());
+      EXPECT_THAT(results[2].status().message(), Eq("wrong issuer"));
+      EXPECT_THAT(results[3].status(), Not(IsOk()));
+      EXPECT_THAT(results[4].status(), Not(IsOk()));
+    }
+    EXPECT_THAT(executor.num_tasks(), Eq(4));
+  }
+}
+
 }  // namespace
 }  // namespace jwt_internal
 }  // namespace tink
@@ -23,6 +23,7 @@
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
 #include "tink/internal/bn_util.h"
+#include "tink/internal/rsa_key_pool.h"
 #include "tink/internal/rsa_util.h"
 #include "tink/internal/ssl_unique_ptr.h"
 #include "tink/jwt/internal/raw_jwt_rsa_ssa_pkcs1_verify_key_manager.h"
@@ -94,7 +95,7 @@ StatusOr<JwtRsaSsaPkcs1PrivateKey> RawJwtRsaSsaPkcs1SignKeyManager::CreateKey(
 
   internal::RsaPrivateKey private_key;
   internal::RsaPublicKey public_key;
-  Status status = internal::NewRsaKeyPair(
+  Status status = internal::NewRsaKeyPairFromPool(
       jwt_rsa_ssa_pkcs1_key_format.modulus_size_in_bits(), e->get(),
       &private_key, &public_key);
   if (!status.ok()) {
@@ -0,0 +1,115 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/jwt/internal/verified_jwt_cache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "openssl/evp.h"
+#include "tink/internal/md_util.h"
+#include "tink/util/status.h"
+
+namespace crypto {
+namespace tink {
+namespace jwt_internal {
+
+VerifiedJwtCache::VerifiedJwtCache(int max_entries, int num_shards,
+                                   absl::Duration max_lifetime)
+    : num_shards_(num_shards),
+      max_entries_per_shard_(
+          std::max(1, (max_entries + num_shards - 1) / num_shards)),
+      max_lifetime_(max_lifetime),
+      shards_(absl::make_unique<Shard[]>(num_shards)) {}
+
+util::StatusOr<std::string> VerifiedJwtCache::ComputeKey(
+    absl::string_view compact) {
+  return internal::ComputeHash(compact, *EVP_sha256());
+}
+
+VerifiedJwtCache::Shard& VerifiedJwtCache::GetShard(absl::string_view key) {
+  // Keys are hashes, so any of their bytes are uniformly distributed.
+  uint32_t prefix = 0;
+  std::memcpy(&prefix, key.data(), std::min(key.size(), sizeof(prefix)));
+  return shards_[prefix % num_shards_];
+}
+
+absl::optional<util::StatusOr<VerifiedJwt>> VerifiedJwtCache::Lookup(
+    absl::string_view key, const JwtValidator& validator, absl::Time now) {
+  Shard& shard = GetShard(key);
+  absl::optional<RawJwt> raw_jwt;
+  {
+    absl::MutexLock lock(&shard.mutex);
+    auto it = shard.entries.find(key);
+    if (it == shard.entries.end()) {
+      return absl::nullopt;
+    }
+    if (it->second.expiry <= now) {
+      shard.expiries.erase({it->second.expiry, it->first});
+      shard.entries.erase(it);
+      return absl::nullopt;
+    }
+    raw_jwt = it->second.raw_jwt;
+  }
+  util::Status validate_result = validator.Validate(*raw_jwt);
+  if (!validate_result.ok()) {
+    return util::StatusOr<VerifiedJwt>(validate_result);
+  }
+  return util::StatusOr<VerifiedJwt>(VerifiedJwt(*raw_jwt));
+}
+
+void VerifiedJwtCache::Insert(std::string key, const VerifiedJwt& verified_jwt,
+                              absl::Time now) {
+  absl::Time expiry = now + max_lifetime_;
+  if (verified_jwt.raw_jwt_.HasExpiration()) {
+    util::StatusOr<absl::Time> expiration =
+        verified_jwt.raw_jwt_.GetExpiration();
+    if (!expiration.ok()) {
+      return;
+    }
+    expiry = std::min(expiry, *expiration);
+  }
+  if (expiry <= now) {
+    return;
+  }
+  Shard& shard = GetShard(key);
+  absl::MutexLock lock(&shard.mutex);
+  auto it = shard.entries.find(key);
+  if (it != shard.entries.end()) {
+    shard.expiries.erase({it->second.expiry, it->first});
+    shard.entries.erase(it);
+  }
+  // Evict expired entries, and the entries that expire first if the shard is
+  // still full.
+  while (!shard.expiries.empty()) {
+    auto first = shard.expiries.begin();
+    if (first->first > now && shard.entries.size() < max_entries_per_shard_) {
+      break;
+    }
+    shard.entries.erase(first->second);
+    shard.expiries.erase(first);
+  }
+  shard.expiries.emplace(expiry, key);
+  shard.entries.emplace(std::move(key), Entry{verified_jwt.raw_jwt_, expiry});
+}
+
+}  // namespace jwt_internal
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,92 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_JWT_INTERNAL_VERIFIED_JWT_CACHE_H_
+#define TINK_JWT_INTERNAL_VERIFIED_JWT_CACHE_H_
+
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
+#include "tink/jwt/jwt_validator.h"
+#include "tink/jwt/raw_jwt.h"
+#include "tink/jwt/verified_jwt.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace jwt_internal {
+
+// A bounded cache of verified JWTs, keyed by the SHA-256 hash of their compact
+// serialization, so that the cache does not keep the tokens themselves.
+//
+// Entries are removed when the token expires, or `max_lifetime` after they
+// were added if that is earlier. When a shard is full, the entry that expires
+// first is evicted. Only the result of the MAC or signature verification is
+// cached: the claims are validated again on every lookup.
+class VerifiedJwtCache {
+ public:
+  // `max_entries` and `num_shards` must be positive.
+  VerifiedJwtCache(int max_entries, int num_shards,
+                   absl::Duration max_lifetime);
+
+  // Returns the key of `compact` in the cache.
+  static util::StatusOr<std::string> ComputeKey(absl::string_view compact);
+
+  // If a token with `key` is cached at time `now`, validates it with
+  // `validator` and returns the result. Otherwise returns nullopt.
+  absl::optional<util::StatusOr<VerifiedJwt>> Lookup(
+      absl::string_view key, const JwtValidator& validator, absl::Time now);
+
+  // Caches `verified_jwt`, whose MAC or signature has been verified, under
+  // `key`.
+  void Insert(std::string key, const VerifiedJwt& verified_jwt,
+              absl::Time now);
+
+ private:
+  struct Entry {
+    RawJwt raw_jwt;
+    absl::Time expiry;
+  };
+
+  struct Shard {
+    absl::Mutex mutex;
+    absl::flat_hash_map<std::string, Entry> entries ABSL_GUARDED_BY(mutex);
+    // The keys of entries, ordered by expiry.
+    std::set<std::pair<absl::Time, std::string>> expiries
+        ABSL_GUARDED_BY(mutex);
+  };
+
+  Shard& GetShard(absl::string_view key);
+
+  const int num_shards_;
+  const std::size_t max_entries_per_shard_;
+  const absl::Duration max_lifetime_;
+  std::unique_ptr<Shard[]> shards_;
+};
+
+}  // namespace jwt_internal
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_JWT_INTERNAL_VERIFIED_JWT_CACHE_H_
@@ -0,0 +1,203 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/jwt/internal/verified_jwt_cache.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+#include "tink/jwt/internal/jwt_mac_impl.h"
+#include "tink/jwt/jwt_validator.h"
+#include "tink/jwt/raw_jwt.h"
+#include "tink/jwt/verified_jwt.h"
+#include "tink/subtle/common_enums.h"
+#include "tink/subtle/hmac_boringssl.h"
+#include "tink/util/secret_data.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "tink/util/test_matchers.h"
+
+using ::crypto::tink::test::IsOk;
+using ::crypto::tink::test::IsOkAndHolds;
+using ::testing::Eq;
+using ::testing::Not;
+using ::testing::SizeIs;
+
+namespace crypto {
+namespace tink {
+namespace jwt_internal {
+namespace {
+
+const absl::Time kNow = absl::FromUnixSeconds(1500000000);
+
+JwtValidator CreateValidator(absl::Time now) {
+  util::StatusOr<JwtValidator> validator = JwtValidatorBuilder()
+                                               .ExpectIssuer("issuer")
+                                               .AllowMissingExpiration()
+                                               .SetFixedNow(now)
+                                               .Build();
+  return *validator;
+}
+
+// Returns a token with the given expiration that was verified at kNow.
+util::StatusOr<VerifiedJwt> CreateVerifiedJwt(
+    absl::optional<absl::Time> expiration) {
+  util::StatusOr<std::unique_ptr<Mac>> mac = subtle::HmacBoringSsl::New(
+      subtle::HashType::SHA256, 32,
+      util::SecretDataFromStringView(std::string(32, 'k')));
+  if (!mac.ok()) {
+    return mac.status();
+  }
+  JwtMacImpl jwt_mac(*std::move(mac), "HS256", /*custom_kid=*/absl::nullopt);
+  RawJwtBuilder builder = RawJwtBuilder().SetIssuer("issuer");
+  if (expiration.has_value()) {
+    builder.SetExpiration(*expiration);
+  } else {
+    builder.WithoutExpiration();
+  }
+  util::StatusOr<RawJwt> raw_jwt = builder.Build();
+  if (!raw_jwt.ok()) {
+    return raw_jwt.status();
+  }
+  util::StatusOr<std::string> compact =
+      jwt_mac.ComputeMacAndEncodeWithKid(*raw_jwt, /*kid=*/absl::nullopt);
+  if (!compact.ok()) {
+    return compact.status();
+  }
+  return jwt_mac.VerifyMacAndDecodeWithKid(*compact, CreateValidator(kNow),
+                                           /*kid=*/absl::nullopt);
+}
+
+TEST(VerifiedJwtCacheTest, ComputeKey) {
+  util::StatusOr<std::string> key = VerifiedJwtCache::ComputeKey("a.b.c");
+  ASSERT_THAT(key, IsOk());
+  EXPECT_THAT(*key, SizeIs(32));
+  EXPECT_THAT(VerifiedJwtCache::ComputeKey("a.b.c"), IsOkAndHolds(*key));
+  EXPECT_THAT(VerifiedJwtCache::ComputeKey("a.b.d"), IsOkAndHolds(Not(*key)));
+}
+
+TEST(VerifiedJwtCacheTest, LookupReturnsValidatedToken) {
+  VerifiedJwtCache cache(/*max_entries=*/10, /*num_shards=*/2,
+                         /*max_lifetime=*/absl::Hours(1));
+  util::StatusOr<VerifiedJwt> verified_jwt =
+      CreateVerifiedJwt(kNow + absl::Minutes(10));
+  ASSERT_THAT(verified_jwt, IsOk());
+
+  EXPECT_FALSE(cache.Lookup("key", CreateValidator(kNow), kNow).has_value());
+  cache.Insert("key", *verified_jwt, kNow);
+
+  absl::optional<util::StatusOr<VerifiedJwt>> cached =
+      cache.Lookup("key", CreateValidator(kNow), kNow);
+  ASSERT_TRUE(cached.has_value());
+  ASSERT_THAT(*cached, IsOk());
+  EXPECT_THAT((*cached)->GetIssuer(), IsOkAndHolds("issuer"));
+  EXPECT_FALSE(
+      cache.Lookup("other key", CreateValidator(kNow), kNow).has_value());
+}
+
+TEST(VerifiedJwtCacheTest, LookupValidatesClaimsAgain) {
+  VerifiedJwtCache cache(/*max_entries=*/10, /*num_shards=*/2,
+                         /*max_lifetime=*/absl::Hours(1));
+  util::StatusOr<VerifiedJwt> verified_jwt =
+      CreateVerifiedJwt(kNow + absl::Minutes(10));
+  ASSERT_THAT(verified_jwt, IsOk());
+  cache.Insert("key", *verified_jwt, kNow);
+
+  util::StatusOr<JwtValidator> other_issuer = JwtValidatorBuilder()
+                                                  .ExpectIssuer("other")
+                                                  .SetFixedNow(kNow)
+                                                  .Build();
+  ASSERT_THAT(other_issuer, IsOk());
+  absl::optional<util::StatusOr<VerifiedJwt>> cached =
+      cache.Lookup("key", *other_issuer, kNow);
+  ASSERT_TRUE(cached.has_value());
+  EXPECT_THAT(cached->status().message(), Eq("wrong issuer"));
+
+  // The validator uses its own clock to check the expiration.
+  cached = cache.Lookup("key", CreateValidator(kNow + absl::Minutes(20)), kNow);
+  ASSERT_TRUE(cached.has_value());
+  EXPECT_THAT(cached->status().message(), Eq("token has expired"));
+}
+
+TEST(VerifiedJwtCacheTest, EntriesAreRemovedWhenTokenExpires) {
+  VerifiedJwtCache cache(/*max_entries=*/10, /*num_shards=*/2,
+                         /*max_lifetime=*/absl::Hours(1));
+  util::StatusOr<VerifiedJwt> verified_jwt =
+      CreateVerifiedJwt(kNow + absl::Minutes(10));
+  ASSERT_THAT(verified_jwt, IsOk());
+  cache.Insert("key", *verified_jwt, kNow);
+
+  absl::Time later = kNow + absl::Minutes(9);
+  EXPECT_TRUE(cache.Lookup("key", CreateValidator(later), later).has_value());
+  later = kNow + absl::Minutes(10);
+  EXPECT_FALSE(cache.Lookup("key", CreateValidator(later), later).has_value());
+}
+
+TEST(VerifiedJwtCacheTest, EntriesAreRemovedAfterMaxLifetime) {
+  VerifiedJwtCache cache(/*max_entries=*/10, /*num_shards=*/2,
+                         /*max_lifetime=*/absl::Minutes(1));
+  util::StatusOr<VerifiedJwt> verified_jwt = CreateVerifiedJwt(absl::nullopt);
+  ASSERT_THAT(verified_jwt, IsOk());
+  cache.Insert("key", *verified_jwt, kNow);
+
+  absl::Time later = kNow + absl::Seconds(59);
+  EXPECT_TRUE(cache.Lookup("key", CreateValidator(later), later).has_value());
+  later = kNow + absl::Minutes(1);
+  EXPECT_FALSE(cache.Lookup("key", CreateValidator(later), later).has_value());
+}
+
+TEST(VerifiedJwtCacheTest, ExpiredTokenIsNotInserted) {
+  VerifiedJwtCache cache(/*max_entries=*/10, /*num_shards=*/2,
+                         /*max_lifetime=*/absl::Hours(1));
+  util::StatusOr<VerifiedJwt> verified_jwt =
+      CreateVerifiedJwt(kNow + absl::Minutes(10));
+  ASSERT_THAT(verified_jwt, IsOk());
+  absl::Time later = kNow + absl::Minutes(10);
+  cache.Insert("key", *verified_jwt, later);
+  EXPECT_FALSE(cache.Lookup("key", CreateValidator(kNow), kNow).has_value());
+}
+
+TEST(VerifiedJwtCacheTest, FullCacheEvictsTokenThatExpiresFirst) {
+  VerifiedJwtCache cache(/*max_entries=*/2, /*num_shards=*/1,
+                         /*max_lifetime=*/absl::Hours(1));
+  util::StatusOr<VerifiedJwt> expires_in_1 =
+      CreateVerifiedJwt(kNow + absl::Minutes(1));
+  util::StatusOr<VerifiedJwt> expires_in_2 =
+      CreateVerifiedJwt(kNow + absl::Minutes(2));
+  util::StatusOr<VerifiedJwt> expires_in_3 =
+      CreateVerifiedJwt(kNow + absl::Minutes(3));
+  ASSERT_THAT(expires_in_1, IsOk());
+  ASSERT_THAT(expires_in_2, IsOk());
+  ASSERT_THAT(expires_in_3, IsOk());
+
+  cache.Insert("3", *expires_in_3, kNow);
+  cache.Insert("1", *expires_in_1, kNow);
+  cache.Insert("2", *expires_in_2, kNow);
+
+  JwtValidator validator = CreateValidator(kNow);
+  EXPECT_FALSE(cache.Lookup("1", validator, kNow).has_value());
+  EXPECT_TRUE(cache.Lookup("2", validator, kNow).has_value());
+  EXPECT_TRUE(cache.Lookup("3", validator, kNow).has_value());
+}
+
+}  // namespace
+}  // namespace jwt_internal
+}  // namespace tink
+}  // namespace crypto
@@ -16,18 +16,29 @@
 
 #include "tink/jwt/jwk_set_converter.h"
 
+#include <cstdint>
 #include <memory>
 #include <ostream>
 #include <sstream>
 #include <string>
+#include <utility>
 
-#include "absl/strings/escaping.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
 #include "tink/binary_keyset_writer.h"
+#include "tink/jwt/internal/base64_url.h"
 #include "tink/jwt/internal/json_util.h"
 #include "tink/jwt/internal/jwt_format.h"
+#include "tink/jwt/internal/jwt_public_key_verify_internal.h"
+#include "tink/jwt/internal/jwt_public_key_verify_wrapper.h"
 #include "tink/jwt/jwt_public_key_sign.h"
 #include "tink/jwt/raw_jwt.h"
 #include "tink/keyset_handle.h"
+#include "tink/primitive_set.h"
+#include "tink/registry.h"
+#include "tink/subtle/random.h"
 #include "tink/util/keyset_util.h"
 #include "tink/util/statusor.h"
 #include "proto/common.pb.h"
@@ -39,6 +50,8 @@
 namespace crypto {
 namespace tink {
 
+using ::crypto::tink::jwt_internal::Base64UrlDecode;
+using ::crypto::tink::jwt_internal::Base64UrlEncode;
 using ::google::crypto::tink::JwtRsaSsaPkcs1Algorithm;
 using ::google::crypto::tink::JwtRsaSsaPkcs1PublicKey;
 using ::google::crypto::tink::JwtRsaSsaPssAlgorithm;
@@ -47,6 +60,7 @@ using ::google::crypto::tink::JwtEcdsaAlgorithm;
 using ::google::crypto::tink::JwtEcdsaPublicKey;
 using ::google::crypto::tink::KeyData;
 using ::google::crypto::tink::Keyset;
+using ::google::crypto::tink::KeysetInfo;
 using ::google::crypto::tink::Keyset_Key;
 using ::google::crypto::tink::KeyStatusType;
 using ::google::crypto::tink::OutputPrefixType;
@@ -163,23 +177,19 @@ util::StatusOr<KeyData> RsPublicKeyDataFromKeyStruct(const Struct& key_struct) {
   if (!e.ok()) {
     return e.status();
   }
-  std::string decoded_e;
-  if (!absl::WebSafeBase64Unescape(*e, &decoded_e)) {
+  if (!Base64UrlDecode(*e, public_key_proto.mutable_e())) {
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "failed to decode e");
   }
-  public_key_proto.set_e(decoded_e);
 
   util::StatusOr<std::string> n = GetStringItem(key_struct, "n");
   if (!n.ok()) {
     return n.status();
   }
-  std::string decoded_n;
-  if (!absl::WebSafeBase64Unescape(*n, &decoded_n)) {
+  if (!Base64UrlDecode(*n, public_key_proto.mutable_n())) {
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "failed to decode n");
   }
-  public_key_proto.set_n(decoded_n);
 
   if (HasItem(key_struct, "kid")) {
     util::StatusOr<std::string> kid = GetStringItem(key_struct, "kid");
@@ -237,23 +247,19 @@ util::StatusOr<KeyData> PsPublicKeyDataFromKeyStruct(const Struct& key_struct) {
   if (!e.ok()) {
     return e.status();
   }
-  std::string decoded_e;
-  if (!absl::WebSafeBase64Unescape(*e, &decoded_e)) {
+  if (!Base64UrlDecode(*e, public_key_proto.mutable_e())) {
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "failed to decode e");
   }
-  public_key_proto.set_e(decoded_e);
 
   util::StatusOr<std::string> n = GetStringItem(key_struct, "n");
   if (!n.ok()) {
     return n.status();
   }
-  std::string decoded_n;
-  if (!absl::WebSafeBase64Unescape(*n, &decoded_n)) {
+  if (!Base64UrlDecode(*n, public_key_proto.mutable_n())) {
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "failed to decode n");
   }
-  public_key_proto.set_n(decoded_n);
 
   if (HasItem(key_struct, "kid")) {
     util::StatusOr<std::string> kid = GetStringItem(key_struct, "kid");
@@ -325,23 +331,19 @@ util::StatusOr<KeyData> EsPublicKeyDataFromKeyStruct(const Struct& key_struct) {
   if (!x.ok()) {
     return x.status();
   }
-  std::string decoded_x;
-  if (!absl::WebSafeBase64Unescape(*x, &decoded_x)) {
+  if (!Base64UrlDecode(*x, public_key_proto.mutable_x())) {
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "failed to decode x");
   }
-  public_key_proto.set_x(decoded_x);
 
   util::StatusOr<std::string> y = GetStringItem(key_struct, "y");
   if (!y.ok()) {
     return y.status();
   }
-  std::string decoded_y;
-  if (!absl::WebSafeBase64Unescape(*y, &decoded_y)) {
+  if (!Base64UrlDecode(*y, public_key_proto.mutable_y())) {
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "failed to decode y");
   }
-  public_key_proto.set_y(decoded_y);
 
   if (HasItem(key_struct, "kid")) {
     util::StatusOr<std::string> kid = GetStringItem(key_struct, "kid");
@@ -358,17 +360,15 @@ util::StatusOr<KeyData> EsPublicKeyDataFromKeyStruct(const Struct& key_struct) {
   return key_data_proto;
 }
 
-}  // namespace
-
-util::StatusOr<std::unique_ptr<KeysetHandle>> JwkSetToPublicKeysetHandle(
-    absl::string_view jwk_set) {
+// Returns the list of keys of `jwk_set`.
+util::StatusOr<ListValue> ParseJwkSet(absl::string_view jwk_set) {
   util::StatusOr<Struct> jwk_set_struct =
       jwt_internal::JsonStringToProtoStruct(jwk_set);
   if (!jwk_set_struct.ok()) {
     return jwk_set_struct.status();
   }
-  auto it = jwk_set_struct->fields().find("keys");
-  if (it == jwk_set_struct->fields().end()) {
+  auto it = jwk_set_struct->mutable_fields()->find("keys");
+  if (it == jwk_set_struct->mutable_fields()->end()) {
     return util::Status(absl::StatusCode::kInvalidArgument, "keys not found");
   }
   if (it->second.kind_case() != Value::kListValue) {
@@ -379,20 +379,89 @@ util::StatusOr<std::unique_ptr<KeysetHandle>> JwkSetToPublicKeysetHandle(
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "keys list is empty");
   }
+  return std::move(*it->second.mutable_list_value());
+}
+
+util::StatusOr<KeyData> PublicKeyDataFromJwk(const Value& value) {
+  if (value.kind_case() != Value::kStructValue) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "key is not a JSON object");
+  }
+  const Struct& key_struct = value.struct_value();
+
+  util::StatusOr<std::string> alg = GetStringItem(key_struct, "alg");
+  if (!alg.ok()) {
+    return alg.status();
+  }
+  absl::string_view alg_prefix = absl::string_view(*alg).substr(0, 2);
+  if (alg_prefix == "RS") {
+    return RsPublicKeyDataFromKeyStruct(key_struct);
+  }
+  if (alg_prefix == "PS") {
+    return PsPublicKeyDataFromKeyStruct(key_struct);
+  }
+  if (alg_prefix == "ES") {
+    return EsPublicKeyDataFromKeyStruct(key_struct);
+  }
+  return util::Status(absl::StatusCode::kInvalidArgument,
+                      "invalid alg prefix");
+}
+
+// Returns a deterministic serialization of `jwk`. Two JWKs have the same
+// fingerprint if they have the same members with the same values, regardless
+// of their order and formatting in the JSON text.
+std::string Fingerprint(const Value& jwk) {
+  std::string fingerprint;
+  {
+    google::protobuf::io::StringOutputStream stream(&fingerprint);
+    google::protobuf::io::CodedOutputStream coded_stream(&stream);
+    coded_stream.SetSerializationDeterministic(true);
+    jwk.SerializeToCodedStream(&coded_stream);
+  }
+  return fingerprint;
+}
+
+// Forwards to a verify primitive that is shared with the primitives returned
+// by earlier conversions.
+class SharedJwtPublicKeyVerify : public JwtPublicKeyVerifyInternal {
+ public:
+  explicit SharedJwtPublicKeyVerify(
+      std::shared_ptr<const JwtPublicKeyVerifyInternal> verify)
+      : verify_(std::move(verify)) {}
+
+  util::StatusOr<VerifiedJwt> VerifyAndDecodeWithKid(
+      absl::string_view compact, const JwtValidator& validator,
+      absl::optional<absl::string_view> kid) const override {
+    return verify_->VerifyAndDecodeWithKid(compact, validator, kid);
+  }
+
+  absl::string_view GetAlgorithm() const override {
+    return verify_->GetAlgorithm();
+  }
+
+  absl::optional<absl::string_view> GetCustomKid() const override {
+    return verify_->GetCustomKid();
+  }
+
+ private:
+  const std::shared_ptr<const JwtPublicKeyVerifyInternal> verify_;
+};
+
+}  // namespace
+
+util::StatusOr<std::unique_ptr<KeysetHandle>> JwkSetToPublicKeysetHandle(
+    absl::string_view jwk_set) {
+  util::StatusOr<ListValue> keys = ParseJwkSet(jwk_set);
+  if (!keys.ok()) {
+    return keys.status();
+  }
   uint32_t last_key_id = 0;
   Keyset keyset;
-  for (const Value& value : it->second.list_value().values()) {
-    if (value.kind_case() != Value::kStructValue) {
-      return util::Status(absl::StatusCode::kInvalidArgument,
-                          "key is not a JSON object");
-    }
-    const Struct& key_struct = value.struct_value();
-
-    util::StatusOr<std::string> alg = GetStringItem(key_struct, "alg");
-    if (!alg.ok()) {
-      return alg.status();
+  for (const Value& value : keys->values()) {
+    util::StatusOr<KeyData> key_data = PublicKeyDataFromJwk(value);
+    if (!key_data.ok()) {
+      return key_data.status();
     }
-    absl::string_view alg_prefix = absl::string_view(*alg).substr(0, 2);
 
     // Add to keyset
     Keyset_Key* key = keyset.add_key();
@@ -400,36 +469,90 @@ util::StatusOr<std::unique_ptr<KeysetHandle>> JwkSetToPublicKeysetHandle(
     key->set_key_id(key_id);
     key->set_status(KeyStatusType::ENABLED);
     key->set_output_prefix_type(OutputPrefixType::RAW);
+    *key->mutable_key_data() = *std::move(key_data);
+    last_key_id = key_id;
+  }
+  keyset.set_primary_key_id(last_key_id);
+  return KeysetHandle::ReadNoSecret(keyset.SerializeAsString());
+}
 
-    if (alg_prefix == "RS") {
-      util::StatusOr<KeyData> key_data =
-          RsPublicKeyDataFromKeyStruct(key_struct);
-      if (!key_data.ok()) {
-        return key_data.status();
-      }
-      *key->mutable_key_data() = *key_data;
-    } else if (alg_prefix == "PS") {
-      util::StatusOr<KeyData> key_data =
-          PsPublicKeyDataFromKeyStruct(key_struct);
+struct IncrementalJwkSetConverter::CachedKey {
+  KeysetInfo::KeyInfo key_info;
+  std::shared_ptr<const JwtPublicKeyVerifyInternal> verify;
+};
+
+util::StatusOr<std::unique_ptr<JwtPublicKeyVerify>>
+IncrementalJwkSetConverter::ToPublicKeyVerify(absl::string_view jwk_set) {
+  util::StatusOr<ListValue> keys = ParseJwkSet(jwk_set);
+  if (!keys.ok()) {
+    return keys.status();
+  }
+  absl::MutexLock lock(&mutex_);
+  absl::flat_hash_set<uint32_t> key_ids;
+  for (const auto& cached : keys_) {
+    key_ids.insert(cached.second->key_info.key_id());
+  }
+  absl::flat_hash_map<std::string, std::shared_ptr<const CachedKey>> new_keys;
+  PrimitiveSet<JwtPublicKeyVerifyInternal>::Builder builder;
+  for (const Value& value : keys->values()) {
+    std::string fingerprint = Fingerprint(value);
+    if (new_keys.contains(fingerprint)) {
+      // A duplicate key verifies the same tokens.
+      continue;
+    }
+    std::shared_ptr<const CachedKey> key;
+    auto it = keys_.find(fingerprint);
+    if (it != keys_.end()) {
+      key = it->second;
+    } else {
+      util::StatusOr<KeyData> key_data = PublicKeyDataFromJwk(value);
       if (!key_data.ok()) {
         return key_data.status();
       }
-      *key->mutable_key_data() = *key_data;
-    } else if (alg_prefix == "ES") {
-      util::StatusOr<KeyData> key_data =
-          EsPublicKeyDataFromKeyStruct(key_struct);
-      if (!key_data.ok()) {
-        return key_data.status();
+      util::StatusOr<std::unique_ptr<JwtPublicKeyVerifyInternal>> verify =
+          Registry::GetPrimitive<JwtPublicKeyVerifyInternal>(*key_data);
+      if (!verify.ok()) {
+        return verify.status();
       }
-      *key->mutable_key_data() = *key_data;
-    } else {
-      return util::Status(absl::StatusCode::kInvalidArgument,
-                          "invalid alg prefix");
+      ++num_instantiated_keys_;
+      auto new_key = std::make_shared<CachedKey>();
+      uint32_t key_id;
+      do {
+        key_id = subtle::Random::GetRandomUInt32();
+      } while (!key_ids.insert(key_id).second);
+      new_key->key_info.set_type_url(key_data->type_url());
+      new_key->key_info.set_status(KeyStatusType::ENABLED);
+      new_key->key_info.set_key_id(key_id);
+      new_key->key_info.set_output_prefix_type(OutputPrefixType::RAW);
+      new_key->verify = *std::move(verify);
+      key = std::move(new_key);
     }
-    last_key_id = key_id;
-  }
-  keyset.set_primary_key_id(last_key_id);
-  return KeysetHandle::ReadNoSecret(keyset.SerializeAsString());
+    builder.AddPrimitive(
+        absl::make_unique<SharedJwtPublicKeyVerify>(key->verify),
+        key->key_info);
+    new_keys.emplace(std::move(fingerprint), std::move(key));
+  }
+  util::StatusOr<PrimitiveSet<JwtPublicKeyVerifyInternal>> primitive_set =
+      std::move(builder).Build();
+  if (!primitive_set.ok()) {
+    return primitive_set.status();
+  }
+  util::StatusOr<std::unique_ptr<JwtPublicKeyVerify>> jwt_verify =
+      jwt_internal::JwtPublicKeyVerifyWrapper().Wrap(
+          absl::make_unique<PrimitiveSet<JwtPublicKeyVerifyInternal>>(
+              *std::move(primitive_set)));
+  if (!jwt_verify.ok()) {
+    return jwt_verify.status();
+  }
+  // Keys that are no longer in the set are released once the primitives
+  // returned by earlier conversions are destroyed.
+  keys_ = std::move(new_keys);
+  return jwt_verify;
+}
+
+int64_t IncrementalJwkSetConverter::num_instantiated_keys() const {
+  absl::MutexLock lock(&mutex_);
+  return num_instantiated_keys_;
 }
 
 void AddStringEntry(Struct* key, absl::string_view name,
@@ -473,8 +596,8 @@ util::StatusOr<Struct> EsPublicKeyToKeyStruct(const Keyset_Key& key) {
   }
 
   AddStringEntry(&output_key, "kty", "EC");
-  AddStringEntry(&output_key, "x", absl::WebSafeBase64Escape(public_key.x()));
-  AddStringEntry(&output_key, "y", absl::WebSafeBase64Escape(public_key.y()));
+  AddStringEntry(&output_key, "x", Base64UrlEncode(public_key.x()));
+  AddStringEntry(&output_key, "y", Base64UrlEncode(public_key.y()));
   AddStringEntry(&output_key, "use", "sig");
   AddKeyOpsVerifyEntry(&output_key);
 
@@ -513,8 +636,8 @@ util::StatusOr<Struct> RsPublicKeyToKeyStruct(const Keyset_Key& key) {
   }
 
   AddStringEntry(&output_key, "kty", "RSA");
-  AddStringEntry(&output_key, "e", absl::WebSafeBase64Escape(public_key.e()));
-  AddStringEntry(&output_key, "n", absl::WebSafeBase64Escape(public_key.n()));
+  AddStringEntry(&output_key, "e", Base64UrlEncode(public_key.e()));
+  AddStringEntry(&output_key, "n", Base64UrlEncode(public_key.n()));
   AddStringEntry(&output_key, "use", "sig");
   AddKeyOpsVerifyEntry(&output_key);
 
@@ -553,8 +676,8 @@ util::StatusOr<Struct> PsPublicKeyToKeyStruct(const Keyset_Key& key) {
   }
 
   AddStringEntry(&output_key, "kty", "RSA");
-  AddStringEntry(&output_key, "e", absl::WebSafeBase64Escape(public_key.e()));
-  AddStringEntry(&output_key, "n", absl::WebSafeBase64Escape(public_key.n()));
+  AddStringEntry(&output_key, "e", Base64UrlEncode(public_key.e()));
+  AddStringEntry(&output_key, "n", Base64UrlEncode(public_key.n()));
   AddStringEntry(&output_key, "use", "sig");
   AddKeyOpsVerifyEntry(&output_key);
 
@@ -17,10 +17,15 @@
 #ifndef TINK_JWT_JWK_SET_CONVERTER_H_
 #define TINK_JWT_JWK_SET_CONVERTER_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "tink/jwt/jwt_public_key_verify.h"
 #include "tink/keyset_handle.h"
 #include "tink/util/statusor.h"
 
@@ -37,6 +42,47 @@ namespace tink {
 util::StatusOr<std::unique_ptr<KeysetHandle>> JwkSetToPublicKeysetHandle(
     absl::string_view jwk_set);
 
+// Converts successive versions of a JWK set into JwtPublicKeyVerify
+// primitives, with the same result as JwkSetToPublicKeysetHandle followed by
+// GetPrimitive<JwtPublicKeyVerify>().
+//
+// JWK sets are usually fetched periodically from an identity provider, and
+// most of their keys are the same as in the previous version. The converter
+// therefore keeps the keys of the last set it converted, identified by their
+// JSON members, and only parses and instantiates the keys that are new. The
+// primitives of unchanged keys are shared between the returned primitives.
+//
+// The JWT signature key managers must be registered, for example with
+// JwtSignatureRegister(). This class is thread-safe.
+class IncrementalJwkSetConverter {
+ public:
+  IncrementalJwkSetConverter() = default;
+
+  // Not copyable or movable.
+  IncrementalJwkSetConverter(const IncrementalJwkSetConverter&) = delete;
+  IncrementalJwkSetConverter& operator=(const IncrementalJwkSetConverter&) =
+      delete;
+
+  // Returns a primitive that verifies tokens with the keys in `jwk_set`. If
+  // `jwk_set` is invalid, returns an error and keeps the keys of the last
+  // successful conversion.
+  util::StatusOr<std::unique_ptr<JwtPublicKeyVerify>> ToPublicKeyVerify(
+      absl::string_view jwk_set);
+
+  // Returns the number of keys that were instantiated so far. Keys that were
+  // reused from the previous set are not counted again.
+  int64_t num_instantiated_keys() const;
+
+ private:
+  struct CachedKey;
+
+  mutable absl::Mutex mutex_;
+  // The keys of the last converted set, by fingerprint.
+  absl::flat_hash_map<std::string, std::shared_ptr<const CachedKey>> keys_
+      ABSL_GUARDED_BY(mutex_);
+  int64_t num_instantiated_keys_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
 // Converts a Tink KeysetHandle with JWT keys into a Json Web Key (JWK) set.
 //
 // Currently only public keys for algorithms ES256, ES384 and ES512 are
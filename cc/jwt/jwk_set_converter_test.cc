@@ -29,12 +29,14 @@
 #include "tink/json_keyset_reader.h"
 #include "tink/json_keyset_writer.h"
 #include "tink/jwt/internal/json_util.h"
+#include "tink/jwt/jwt_key_templates.h"
 #include "tink/jwt/jwt_public_key_sign.h"
 #include "tink/jwt/jwt_public_key_verify.h"
 #include "tink/jwt/jwt_signature_config.h"
 #include "tink/jwt/jwt_validator.h"
 #include "tink/jwt/verified_jwt.h"
 #include "tink/keyset_handle.h"
+#include "tink/keyset_manager.h"
 #include "tink/util/test_matchers.h"
 #include "proto/jwt_ecdsa.pb.h"
 #include "proto/jwt_rsa_ssa_pkcs1.pb.h"
@@ -1151,6 +1153,129 @@ TEST(JwkSetFromPublicKeysetHandleTest,
   EXPECT_THAT(jwk_set, Not(IsOk()));
 }
 
+class IncrementalJwkSetConverterTest : public testing::Test {
+  void SetUp() override { ASSERT_THAT(JwtSignatureRegister(), IsOk()); }
+};
+
+// Returns the public JWK set of the keys in `manager`.
+util::StatusOr<std::string> GetPublicJwkSet(KeysetManager& manager) {
+  util::StatusOr<std::unique_ptr<KeysetHandle>> public_handle =
+      manager.GetKeysetHandle()->GetPublicKeysetHandle();
+  if (!public_handle.ok()) {
+    return public_handle.status();
+  }
+  return JwkSetFromPublicKeysetHandle(**public_handle);
+}
+
+// Returns a token signed with the primary key of `manager`.
+util::StatusOr<std::string> SignWithPrimary(KeysetManager& manager) {
+  util::StatusOr<std::unique_ptr<JwtPublicKeySign>> sign =
+      manager.GetKeysetHandle()->GetPrimitive<JwtPublicKeySign>();
+  if (!sign.ok()) {
+    return sign.status();
+  }
+  util::StatusOr<RawJwt> raw_jwt =
+      RawJwtBuilder().SetIssuer("issuer").WithoutExpiration().Build();
+  if (!raw_jwt.ok()) {
+    return raw_jwt.status();
+  }
+  return (*sign)->SignAndEncode(*raw_jwt);
+}
+
+TEST_F(IncrementalJwkSetConverterTest, ReusesUnchangedKeys) {
+  util::StatusOr<JwtValidator> validator = JwtValidatorBuilder()
+                                               .ExpectIssuer("issuer")
+                                               .AllowMissingExpiration()
+                                               .Build();
+  ASSERT_THAT(validator, IsOk());
+  KeysetManager manager;
+  util::StatusOr<uint32_t> first_id = manager.Rotate(JwtEs256Template());
+  ASSERT_THAT(first_id, IsOk());
+  util::StatusOr<std::string> first_token = SignWithPrimary(manager);
+  ASSERT_THAT(first_token, IsOk());
+  ASSERT_THAT(manager.Rotate(JwtEs256Template()), IsOk());
+  util::StatusOr<std::string> second_token = SignWithPrimary(manager);
+  ASSERT_THAT(second_token, IsOk());
+  util::StatusOr<std::string> first_jwk_set = GetPublicJwkSet(manager);
+  ASSERT_THAT(first_jwk_set, IsOk());
+
+  IncrementalJwkSetConverter converter;
+  util::StatusOr<std::unique_ptr<JwtPublicKeyVerify>> first_verify =
+      converter.ToPublicKeyVerify(*first_jwk_set);
+  ASSERT_THAT(first_verify, IsOk());
+  EXPECT_THAT(converter.num_instantiated_keys(), Eq(2));
+  EXPECT_THAT((*first_verify)->VerifyAndDecode(*first_token, *validator),
+              IsOk());
+  EXPECT_THAT((*first_verify)->VerifyAndDecode(*second_token, *validator),
+              IsOk());
+
+  // Rotate to a third key, and remove the first one.
+  ASSERT_THAT(manager.Rotate(JwtEs256Template()), IsOk());
+  ASSERT_THAT(manager.Delete(*first_id), IsOk());
+  util::StatusOr<std::string> third_token = SignWithPrimary(manager);
+  ASSERT_THAT(third_token, IsOk());
+  util::StatusOr<std::string> second_jwk_set = GetPublicJwkSet(manager);
+  ASSERT_THAT(second_jwk_set, IsOk());
+
+  util::StatusOr<std::unique_ptr<JwtPublicKeyVerify>> second_verify =
+      converter.ToPublicKeyVerify(*second_jwk_set);
+  ASSERT_THAT(second_verify, IsOk());
+  EXPECT_THAT(converter.num_instantiated_keys(), Eq(3));
+  EXPECT_THAT((*second_verify)->VerifyAndDecode(*first_token, *validator),
+              Not(IsOk()));
+  EXPECT_THAT((*second_verify)->VerifyAndDecode(*second_token, *validator),
+              IsOk());
+  EXPECT_THAT((*second_verify)->VerifyAndDecode(*third_token, *validator),
+              IsOk());
+
+  // Primitives returned earlier are not affected.
+  EXPECT_THAT((*first_verify)->VerifyAndDecode(*first_token, *validator),
+              IsOk());
+  EXPECT_THAT((*first_verify)->VerifyAndDecode(*third_token, *validator),
+              Not(IsOk()));
+
+  // Converting the same set again does not instantiate any key.
+  ASSERT_THAT(converter.ToPublicKeyVerify(*second_jwk_set), IsOk());
+  EXPECT_THAT(converter.num_instantiated_keys(), Eq(3));
+}
+
+TEST_F(IncrementalJwkSetConverterTest, KeysAreIdentifiedByTheirMembers) {
+  IncrementalJwkSetConverter converter;
+  ASSERT_THAT(converter.ToPublicKeyVerify(kEs256JwkPublicKey), IsOk());
+  EXPECT_THAT(converter.num_instantiated_keys(), Eq(1));
+
+  util::StatusOr<Struct> jwk_set =
+      jwt_internal::JsonStringToProtoStruct(kEs256JwkPublicKey);
+  ASSERT_THAT(jwk_set, IsOk());
+  util::StatusOr<std::string> reformatted =
+      jwt_internal::ProtoStructToJsonString(*jwk_set);
+  ASSERT_THAT(reformatted, IsOk());
+  ASSERT_THAT(converter.ToPublicKeyVerify(*reformatted), IsOk());
+  EXPECT_THAT(converter.num_instantiated_keys(), Eq(1));
+
+  (*(*jwk_set->mutable_fields())["keys"]
+        .mutable_list_value()
+        ->mutable_values(0)
+        ->mutable_struct_value()
+        ->mutable_fields())["kid"]
+      .set_string_value("other kid");
+  util::StatusOr<std::string> other_kid =
+      jwt_internal::ProtoStructToJsonString(*jwk_set);
+  ASSERT_THAT(other_kid, IsOk());
+  ASSERT_THAT(converter.ToPublicKeyVerify(*other_kid), IsOk());
+  EXPECT_THAT(converter.num_instantiated_keys(), Eq(2));
+}
+
+TEST_F(IncrementalJwkSetConverterTest, InvalidSetKeepsPreviousKeys) {
+  IncrementalJwkSetConverter converter;
+  ASSERT_THAT(converter.ToPublicKeyVerify(kEs256JwkPublicKey), IsOk());
+  EXPECT_THAT(converter.ToPublicKeyVerify(R"({[}])"), Not(IsOk()));
+  EXPECT_THAT(converter.ToPublicKeyVerify(R"({"keys":[{"alg":"XS256"}]})"),
+              Not(IsOk()));
+  ASSERT_THAT(converter.ToPublicKeyVerify(kEs256JwkPublicKey), IsOk());
+  EXPECT_THAT(converter.num_instantiated_keys(), Eq(1));
+}
+
 }  // namespace
 }  // namespace tink
 }  // namespace crypto
@@ -0,0 +1,41 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_JWT_JWT_BATCH_EXECUTOR_H_
+#define TINK_JWT_JWT_BATCH_EXECUTOR_H_
+
+#include <functional>
+
+namespace crypto {
+namespace tink {
+
+///////////////////////////////////////////////////////////////////////////////
+// Interface for running the tasks into which JwtMac::VerifyMacAndDecodeBatch
+// and JwtPublicKeyVerify::VerifyAndDecodeBatch split their work, typically on
+// a thread pool owned by the caller.
+class JwtBatchExecutor {
+ public:
+  // Runs `task`, either on another thread or before returning. Tasks of the
+  // same batch may run concurrently.
+  virtual void Schedule(std::function<void()> task) = 0;
+
+  virtual ~JwtBatchExecutor() = default;
+};
+
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_JWT_JWT_BATCH_EXECUTOR_H_
@@ -18,8 +18,12 @@
 #define TINK_JWT_JWT_MAC_H_
 
 #include <string>
+#include <vector>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tink/jwt/internal/jwt_batch.h"
+#include "tink/jwt/jwt_batch_executor.h"
 #include "tink/jwt/jwt_validator.h"
 #include "tink/jwt/raw_jwt.h"
 #include "tink/jwt/verified_jwt.h"
@@ -56,6 +60,22 @@ class JwtMac {
   virtual crypto::tink::util::StatusOr<VerifiedJwt> VerifyMacAndDecode(
       absl::string_view compact, const JwtValidator& validator) const = 0;
 
+  // Verifies and decodes each of `compacts` as VerifyMacAndDecode does, and
+  // returns one result per token, in the same order. A token that fails
+  // verification does not affect the other tokens.
+  //
+  // If `executor` is not null, the work is split into tasks that are
+  // scheduled on it, and the method returns once all of them are done.
+  virtual std::vector<crypto::tink::util::StatusOr<VerifiedJwt>>
+  VerifyMacAndDecodeBatch(absl::Span<const absl::string_view> compacts,
+                          const JwtValidator& validator,
+                          JwtBatchExecutor* executor) const {
+    return jwt_internal::VerifyBatch(
+        compacts, executor, [&](absl::string_view compact) {
+          return VerifyMacAndDecode(compact, validator);
+        });
+  }
+
   virtual ~JwtMac() = default;
 };
 
@@ -17,9 +17,14 @@
 #ifndef TINK_JWT_JWT_PUBLIC_KEY_VERIFY_H_
 #define TINK_JWT_JWT_PUBLIC_KEY_VERIFY_H_
 
+#include <vector>
+
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
+#include "tink/jwt/internal/jwt_batch.h"
+#include "tink/jwt/jwt_batch_executor.h"
 #include "tink/jwt/verified_jwt.h"
 #include "tink/jwt/jwt_validator.h"
 
@@ -48,6 +53,22 @@ class JwtPublicKeyVerify {
   virtual crypto::tink::util::StatusOr<VerifiedJwt> VerifyAndDecode(
       absl::string_view compact, const JwtValidator& validator) const = 0;
 
+  // Verifies and decodes each of `compacts` as VerifyAndDecode does, and
+  // returns one result per token, in the same order. A token that fails
+  // verification does not affect the other tokens.
+  //
+  // If `executor` is not null, the work is split into tasks that are
+  // scheduled on it, and the method returns once all of them are done.
+  virtual std::vector<crypto::tink::util::StatusOr<VerifiedJwt>>
+  VerifyAndDecodeBatch(absl::Span<const absl::string_view> compacts,
+                       const JwtValidator& validator,
+                       JwtBatchExecutor* executor) const {
+    return jwt_internal::VerifyBatch(
+        compacts, executor, [&](absl::string_view compact) {
+          return VerifyAndDecode(compact, validator);
+        });
+  }
+
   virtual ~JwtPublicKeyVerify() = default;
 };
 
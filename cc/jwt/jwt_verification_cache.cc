@@ -0,0 +1,150 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/jwt/jwt_verification_cache.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/time/clock.h"
+#include "tink/jwt/internal/verified_jwt_cache.h"
+#include "tink/util/status.h"
+
+namespace crypto {
+namespace tink {
+
+namespace {
+
+using ::crypto::tink::jwt_internal::VerifiedJwtCache;
+
+// Verifies `compact` with `verify` unless it is in `cache`.
+template <class VerifyFunction>
+util::StatusOr<VerifiedJwt> VerifyWithCache(VerifiedJwtCache* cache,
+                                            absl::string_view compact,
+                                            const JwtValidator& validator,
+                                            VerifyFunction verify) {
+  util::StatusOr<std::string> key = VerifiedJwtCache::ComputeKey(compact);
+  if (!key.ok()) {
+    return verify();
+  }
+  absl::optional<util::StatusOr<VerifiedJwt>> cached =
+      cache->Lookup(*key, validator, absl::Now());
+  if (cached.has_value()) {
+    return *std::move(cached);
+  }
+  util::StatusOr<VerifiedJwt> verified_jwt = verify();
+  if (verified_jwt.ok()) {
+    cache->Insert(*std::move(key), *verified_jwt, absl::Now());
+  }
+  return verified_jwt;
+}
+
+class CachingJwtPublicKeyVerify : public JwtPublicKeyVerify {
+ public:
+  CachingJwtPublicKeyVerify(std::unique_ptr<JwtPublicKeyVerify> verify,
+                            const JwtVerificationCacheOptions& options)
+      : verify_(std::move(verify)),
+        cache_(absl::make_unique<VerifiedJwtCache>(
+            options.max_entries, options.num_shards, options.max_lifetime)) {}
+
+  util::StatusOr<VerifiedJwt> VerifyAndDecode(
+      absl::string_view compact, const JwtValidator& validator) const override {
+    return VerifyWithCache(cache_.get(), compact, validator, [&]() {
+      return verify_->VerifyAndDecode(compact, validator);
+    });
+  }
+
+ private:
+  std::unique_ptr<JwtPublicKeyVerify> verify_;
+  std::unique_ptr<VerifiedJwtCache> cache_;
+};
+
+class CachingJwtMac : public JwtMac {
+ public:
+  CachingJwtMac(std::unique_ptr<JwtMac> jwt_mac,
+                const JwtVerificationCacheOptions& options)
+      : jwt_mac_(std::move(jwt_mac)),
+        cache_(absl::make_unique<VerifiedJwtCache>(
+            options.max_entries, options.num_shards, options.max_lifetime)) {}
+
+  util::StatusOr<std::string> ComputeMacAndEncode(
+      const RawJwt& token) const override {
+    return jwt_mac_->ComputeMacAndEncode(token);
+  }
+
+  util::StatusOr<VerifiedJwt> VerifyMacAndDecode(
+      absl::string_view compact, const JwtValidator& validator) const override {
+    return VerifyWithCache(cache_.get(), compact, validator, [&]() {
+      return jwt_mac_->VerifyMacAndDecode(compact, validator);
+    });
+  }
+
+ private:
+  std::unique_ptr<JwtMac> jwt_mac_;
+  std::unique_ptr<VerifiedJwtCache> cache_;
+};
+
+util::Status ValidateOptions(const JwtVerificationCacheOptions& options) {
+  if (options.max_entries <= 0) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "max_entries must be positive");
+  }
+  if (options.num_shards <= 0) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "num_shards must be positive");
+  }
+  return util::OkStatus();
+}
+
+}  // namespace
+
+util::StatusOr<std::unique_ptr<JwtPublicKeyVerify>>
+NewCachingJwtPublicKeyVerify(std::unique_ptr<JwtPublicKeyVerify> verify,
+                             const JwtVerificationCacheOptions& options) {
+  if (verify == nullptr) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "verify must be non-null");
+  }
+  util::Status status = ValidateOptions(options);
+  if (!status.ok()) {
+    return status;
+  }
+  std::unique_ptr<JwtPublicKeyVerify> caching_verify =
+      absl::make_unique<CachingJwtPublicKeyVerify>(std::move(verify), options);
+  return std::move(caching_verify);
+}
+
+util::StatusOr<std::unique_ptr<JwtMac>> NewCachingJwtMac(
+    std::unique_ptr<JwtMac> jwt_mac,
+    const JwtVerificationCacheOptions& options) {
+  if (jwt_mac == nullptr) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "jwt_mac must be non-null");
+  }
+  util::Status status = ValidateOptions(options);
+  if (!status.ok()) {
+    return status;
+  }
+  std::unique_ptr<JwtMac> caching_jwt_mac =
+      absl::make_unique<CachingJwtMac>(std::move(jwt_mac), options);
+  return std::move(caching_jwt_mac);
+}
+
+}  // namespace tink
+}  // namespace crypto
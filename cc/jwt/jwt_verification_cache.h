@@ -0,0 +1,66 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_JWT_JWT_VERIFICATION_CACHE_H_
+#define TINK_JWT_JWT_VERIFICATION_CACHE_H_
+
+#include <memory>
+
+#include "absl/time/time.h"
+#include "tink/jwt/jwt_mac.h"
+#include "tink/jwt/jwt_public_key_verify.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+
+struct JwtVerificationCacheOptions {
+  // Maximum number of tokens kept in the cache.
+  int max_entries = 10000;
+  // Number of independently locked parts of the cache.
+  int num_shards = 16;
+  // Tokens are kept until they expire, but at most this long. This also
+  // bounds how long a token is accepted after its key was removed from the
+  // keyset, if the primitive is replaced.
+  absl::Duration max_lifetime = absl::Minutes(5);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Caches the tokens successfully verified by a JwtPublicKeyVerify or a JwtMac,
+// for services that verify the same tokens many times during their lifetime.
+//
+// When a token is verified again, its signature or MAC is not verified again
+// and its payload is not parsed again. It is only validated again with the
+// given validator, so expiration, not-before and issued-at claims are always
+// checked against the current time.
+//
+// Tokens are identified by the SHA-256 hash of their compact serialization,
+// and tokens that fail verification are never cached. Note that the time it
+// takes to verify a token reveals whether it was verified before.
+util::StatusOr<std::unique_ptr<JwtPublicKeyVerify>>
+NewCachingJwtPublicKeyVerify(std::unique_ptr<JwtPublicKeyVerify> verify,
+                             const JwtVerificationCacheOptions& options);
+
+// Same as NewCachingJwtPublicKeyVerify, for JwtMac. ComputeMacAndEncode() is
+// not affected by the cache.
+util::StatusOr<std::unique_ptr<JwtMac>> NewCachingJwtMac(
+    std::unique_ptr<JwtMac> jwt_mac,
+    const JwtVerificationCacheOptions& options);
+
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_JWT_JWT_VERIFICATION_CACHE_H_
@@ -0,0 +1,267 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/jwt/jwt_verification_cache.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tink/jwt/jwt_key_templates.h"
+#include "tink/jwt/jwt_mac.h"
+#include "tink/jwt/jwt_mac_config.h"
+#include "tink/jwt/jwt_public_key_sign.h"
+#include "tink/jwt/jwt_public_key_verify.h"
+#include "tink/jwt/jwt_signature_config.h"
+#include "tink/jwt/jwt_validator.h"
+#include "tink/jwt/raw_jwt.h"
+#include "tink/jwt/verified_jwt.h"
+#include "tink/keyset_handle.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "tink/util/test_matchers.h"
+
+using ::crypto::tink::test::IsOk;
+using ::crypto::tink::test::IsOkAndHolds;
+using ::testing::Eq;
+
+namespace crypto {
+namespace tink {
+namespace {
+
+// Forwards to another JwtMac and counts the verifications.
+class CountingJwtMac : public JwtMac {
+ public:
+  CountingJwtMac(std::unique_ptr<JwtMac> jwt_mac, int* num_verifications)
+      : jwt_mac_(std::move(jwt_mac)), num_verifications_(num_verifications) {}
+
+  util::StatusOr<std::string> ComputeMacAndEncode(
+      const RawJwt& token) const override {
+    return jwt_mac_->ComputeMacAndEncode(token);
+  }
+
+  util::StatusOr<VerifiedJwt> VerifyMacAndDecode(
+      absl::string_view compact, const JwtValidator& validator) const override {
+    ++*num_verifications_;
+    return jwt_mac_->VerifyMacAndDecode(compact, validator);
+  }
+
+ private:
+  std::unique_ptr<JwtMac> jwt_mac_;
+  int* num_verifications_;
+};
+
+// Forwards to another JwtPublicKeyVerify and counts the verifications.
+class CountingJwtPublicKeyVerify : public JwtPublicKeyVerify {
+ public:
+  CountingJwtPublicKeyVerify(std::unique_ptr<JwtPublicKeyVerify> verify,
+                             int* num_verifications)
+      : verify_(std::move(verify)), num_verifications_(num_verifications) {}
+
+  util::StatusOr<VerifiedJwt> VerifyAndDecode(
+      absl::string_view compact, const JwtValidator& validator) const override {
+    ++*num_verifications_;
+    return verify_->VerifyAndDecode(compact, validator);
+  }
+
+ private:
+  std::unique_ptr<JwtPublicKeyVerify> verify_;
+  int* num_verifications_;
+};
+
+class JwtVerificationCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_THAT(JwtMacRegister(), IsOk());
+    ASSERT_THAT(JwtSignatureRegister(), IsOk());
+    util::StatusOr<RawJwt> raw_jwt =
+        RawJwtBuilder()
+            .SetIssuer("issuer")
+            .SetExpiration(absl::Now() + absl::Minutes(10))
+            .Build();
+    ASSERT_THAT(raw_jwt, IsOk());
+    raw_jwt_ = *std::move(raw_jwt);
+    util::StatusOr<JwtValidator> validator =
+        JwtValidatorBuilder().ExpectIssuer("issuer").Build();
+    ASSERT_THAT(validator, IsOk());
+    validator_ = absl::make_unique<JwtValidator>(*validator);
+  }
+
+  RawJwt raw_jwt_;
+  std::unique_ptr<JwtValidator> validator_;
+};
+
+TEST_F(JwtVerificationCacheTest, JwtMacVerifiesTokenOnce) {
+  util::StatusOr<std::unique_ptr<KeysetHandle>> keyset_handle =
+      KeysetHandle::GenerateNew(JwtHs256Template());
+  ASSERT_THAT(keyset_handle, IsOk());
+  util::StatusOr<std::unique_ptr<JwtMac>> jwt_mac =
+      (*keyset_handle)->GetPrimitive<JwtMac>();
+  ASSERT_THAT(jwt_mac, IsOk());
+  int num_verifications = 0;
+  util::StatusOr<std::unique_ptr<JwtMac>> caching_jwt_mac = NewCachingJwtMac(
+      absl::make_unique<CountingJwtMac>(*std::move(jwt_mac),
+                                        &num_verifications),
+      JwtVerificationCacheOptions());
+  ASSERT_THAT(caching_jwt_mac, IsOk());
+
+  util::StatusOr<std::string> compact =
+      (*caching_jwt_mac)->ComputeMacAndEncode(raw_jwt_);
+  ASSERT_THAT(compact, IsOk());
+  for (int i = 0; i < 3; ++i) {
+    util::StatusOr<VerifiedJwt> verified_jwt =
+        (*caching_jwt_mac)->VerifyMacAndDecode(*compact, *validator_);
+    ASSERT_THAT(verified_jwt, IsOk());
+    EXPECT_THAT(verified_jwt->GetIssuer(), IsOkAndHolds("issuer"));
+  }
+  EXPECT_THAT(num_verifications, Eq(1));
+}
+
+TEST_F(JwtVerificationCacheTest, PublicKeyVerifyVerifiesTokenOnce) {
+  util::StatusOr<std::unique_ptr<KeysetHandle>> private_handle =
+      KeysetHandle::GenerateNew(JwtEs256Template());
+  ASSERT_THAT(private_handle, IsOk());
+  util::StatusOr<std::unique_ptr<JwtPublicKeySign>> sign =
+      (*private_handle)->GetPrimitive<JwtPublicKeySign>();
+  ASSERT_THAT(sign, IsOk());
+  util::StatusOr<std::unique_ptr<KeysetHandle>> public_handle =
+      (*private_handle)->GetPublicKeysetHandle();
+  ASSERT_THAT(public_handle, IsOk());
+  util::StatusOr<std::unique_ptr<JwtPublicKeyVerify>> verify =
+      (*public_handle)->GetPrimitive<JwtPublicKeyVerify>();
+  ASSERT_THAT(verify, IsOk());
+  int num_verifications = 0;
+  util::StatusOr<std::unique_ptr<JwtPublicKeyVerify>> caching_verify =
+      NewCachingJwtPublicKeyVerify(
+          absl::make_unique<CountingJwtPublicKeyVerify>(*std::move(verify),
+                                                        &num_verifications),
+          JwtVerificationCacheOptions());
+  ASSERT_THAT(caching_verify, IsOk());
+
+  util::StatusOr<std::string> compact = (*sign)->SignAndEncode(raw_jwt_);
+  ASSERT_THAT(compact, IsOk());
+  for (int i = 0; i < 3; ++i) {
+    util::StatusOr<VerifiedJwt> verified_jwt =
+        (*caching_verify)->VerifyAndDecode(*compact, *validator_);
+    ASSERT_THAT(verified_jwt, IsOk());
+    EXPECT_THAT(verified_jwt->GetIssuer(), IsOkAndHolds("issuer"));
+  }
+  EXPECT_THAT(num_verifications, Eq(1));
+}
+
+TEST_F(JwtVerificationCacheTest, CachedTokenIsValidatedAgain) {
+  util::StatusOr<std::unique_ptr<KeysetHandle>> keyset_handle =
+      KeysetHandle::GenerateNew(JwtHs256Template());
+  ASSERT_THAT(keyset_handle, IsOk());
+  util::StatusOr<std::unique_ptr<JwtMac>> jwt_mac =
+      (*keyset_handle)->GetPrimitive<JwtMac>();
+  ASSERT_THAT(jwt_mac, IsOk());
+  int num_verifications = 0;
+  util::StatusOr<std::unique_ptr<JwtMac>> caching_jwt_mac = NewCachingJwtMac(
+      absl::make_unique<CountingJwtMac>(*std::move(jwt_mac),
+                                        &num_verifications),
+      JwtVerificationCacheOptions());
+  ASSERT_THAT(caching_jwt_mac, IsOk());
+  util::StatusOr<std::string> compact =
+      (*caching_jwt_mac)->ComputeMacAndEncode(raw_jwt_);
+  ASSERT_THAT(compact, IsOk());
+  ASSERT_THAT((*caching_jwt_mac)->VerifyMacAndDecode(*compact, *validator_),
+              IsOk());
+
+  util::StatusOr<JwtValidator> other_issuer =
+      JwtValidatorBuilder().ExpectIssuer("other").Build();
+  ASSERT_THAT(other_issuer, IsOk());
+  EXPECT_THAT(
+      (*caching_jwt_mac)->VerifyMacAndDecode(*compact, *other_issuer).status(),
+      test::StatusIs(absl::StatusCode::kInvalidArgument));
+
+  util::StatusOr<JwtValidator> expired =
+      JwtValidatorBuilder()
+          .ExpectIssuer("issuer")
+          .SetFixedNow(absl::Now() + absl::Hours(1))
+          .Build();
+  ASSERT_THAT(expired, IsOk());
+  EXPECT_FALSE((*caching_jwt_mac)->VerifyMacAndDecode(*compact, *expired).ok());
+  EXPECT_THAT(num_verifications, Eq(1));
+}
+
+TEST_F(JwtVerificationCacheTest, InvalidTokensAreNotCached) {
+  util::StatusOr<std::unique_ptr<KeysetHandle>> keyset_handle =
+      KeysetHandle::GenerateNew(JwtHs256Template());
+  ASSERT_THAT(keyset_handle, IsOk());
+  util::StatusOr<std::unique_ptr<JwtMac>> jwt_mac =
+      (*keyset_handle)->GetPrimitive<JwtMac>();
+  ASSERT_THAT(jwt_mac, IsOk());
+  int num_verifications = 0;
+  util::StatusOr<std::unique_ptr<JwtMac>> caching_jwt_mac = NewCachingJwtMac(
+      absl::make_unique<CountingJwtMac>(*std::move(jwt_mac),
+                                        &num_verifications),
+      JwtVerificationCacheOptions());
+  ASSERT_THAT(caching_jwt_mac, IsOk());
+  util::StatusOr<std::string> compact =
+      (*caching_jwt_mac)->ComputeMacAndEncode(raw_jwt_);
+  ASSERT_THAT(compact, IsOk());
+
+  std::string modified = *compact;
+  modified.back() = modified.back() == 'A' ? 'B' : 'A';
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_FALSE(
+        (*caching_jwt_mac)->VerifyMacAndDecode(modified, *validator_).ok());
+  }
+  EXPECT_THAT(num_verifications, Eq(2));
+
+  // Tokens that fail validation are not cached either.
+  util::StatusOr<JwtValidator> other_issuer =
+      JwtValidatorBuilder().ExpectIssuer("other").Build();
+  ASSERT_THAT(other_issuer, IsOk());
+  EXPECT_FALSE(
+      (*caching_jwt_mac)->VerifyMacAndDecode(*compact, *other_issuer).ok());
+  EXPECT_THAT(
+      (*caching_jwt_mac)->VerifyMacAndDecode(*compact, *validator_).status(),
+      IsOk());
+  EXPECT_THAT(num_verifications, Eq(4));
+}
+
+TEST_F(JwtVerificationCacheTest, InvalidArguments) {
+  EXPECT_FALSE(NewCachingJwtMac(nullptr, JwtVerificationCacheOptions()).ok());
+  EXPECT_FALSE(
+      NewCachingJwtPublicKeyVerify(nullptr, JwtVerificationCacheOptions())
+          .ok());
+
+  util::StatusOr<std::unique_ptr<KeysetHandle>> keyset_handle =
+      KeysetHandle::GenerateNew(JwtHs256Template());
+  ASSERT_THAT(keyset_handle, IsOk());
+  JwtVerificationCacheOptions options;
+  options.num_shards = 0;
+  EXPECT_FALSE(NewCachingJwtMac(*(*keyset_handle)->GetPrimitive<JwtMac>(),
+                                options)
+                   .ok());
+  options = JwtVerificationCacheOptions();
+  options.max_entries = 0;
+  EXPECT_FALSE(NewCachingJwtMac(*(*keyset_handle)->GetPrimitive<JwtMac>(),
+                                options)
+                   .ok());
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
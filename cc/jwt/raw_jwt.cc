@@ -20,11 +20,14 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/substitute.h"
 #include "absl/time/time.h"
+#include "absl/types/optional.h"
+#include "tink/jwt/internal/json_document.h"
 #include "tink/jwt/internal/json_util.h"
 
 namespace crypto {
@@ -32,6 +35,8 @@ namespace tink {
 
 namespace {
 
+using ::crypto::tink::jwt_internal::JsonDocument;
+using ::crypto::tink::jwt_internal::JsonValue;
 using ::google::protobuf::Struct;
 using ::google::protobuf::Value;
 
@@ -64,18 +69,19 @@ util::Status ValidatePayloadName(absl::string_view name) {
   return util::OkStatus();
 }
 
-bool HasClaimOfKind(const google::protobuf::Struct& json_proto,
-                    absl::string_view name, Value::KindCase kind) {
+bool HasClaimOfKind(const JsonValue& payload, absl::string_view name,
+                    JsonValue::Kind kind) {
   if (IsRegisteredClaimName(name)) {
     return false;
   }
-  const auto& fields = json_proto.fields();
-  auto it = fields.find(std::string(name));
-  if (it == fields.end()) {
-    return false;
-  }
-  const Value& value = it->second;
-  return value.kind_case() == kind;
+  absl::optional<JsonValue> value = payload.Find(name);
+  return value.has_value() && value->kind() == kind;
+}
+
+// Returns true if the claim is present but not a string.
+bool ClaimIsNotAString(const JsonValue& payload, absl::string_view name) {
+  absl::optional<JsonValue> value = payload.Find(name);
+  return value.has_value() && value->kind() != JsonValue::Kind::kString;
 }
 
 // Returns true if the claim is present but not a string.
@@ -103,18 +109,15 @@ bool ClaimIsNotAList(google::protobuf::Struct& json_proto,
 }
 
 // Returns true if the claim is present but not a timestamp.
-bool ClaimIsNotATimestamp(const google::protobuf::Struct& json_proto,
-                          absl::string_view name) {
-  const auto& fields = json_proto.fields();
-  auto it = fields.find(std::string(name));
-  if (it == fields.end()) {
+bool ClaimIsNotATimestamp(const JsonValue& payload, absl::string_view name) {
+  absl::optional<JsonValue> value = payload.Find(name);
+  if (!value.has_value()) {
     return false;
   }
-  const Value& value = it->second;
-  if (value.kind_case() != Value::kNumberValue) {
+  if (value->kind() != JsonValue::Kind::kNumber) {
     return true;
   }
-  double timestamp = value.number_value();
+  double timestamp = value->number_value();
   return (timestamp > kJwtTimestampMax) || (timestamp < 0);
 }
 
@@ -130,26 +133,25 @@ absl::Time TimestampToTime(double timestamp) {
   return absl::FromUnixSeconds(timestamp);
 }
 
-util::Status ValidateAudienceClaim(const google::protobuf::Struct& json_proto) {
-  const auto& fields = json_proto.fields();
-  auto it = fields.find(std::string(kJwtClaimAudience));
-  if (it == fields.end()) {
+util::Status ValidateAudienceClaim(const JsonValue& payload) {
+  absl::optional<JsonValue> value = payload.Find(kJwtClaimAudience);
+  if (!value.has_value()) {
     return util::OkStatus();
   }
-  const Value& value = it->second;
-  if (value.kind_case() == Value::kStringValue) {
+  if (value->kind() == JsonValue::Kind::kString) {
     return util::OkStatus();
   }
-  if (value.kind_case() != Value::kListValue) {
+  if (value->kind() != JsonValue::Kind::kArray) {
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "aud claim is not a list");
   }
-  if (value.list_value().values_size() < 1) {
+  if (value->size() < 1) {
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "aud claim is present but empty");
   }
-  for (const Value& v : value.list_value().values()) {
-    if (v.kind_case() != Value::kStringValue) {
+  for (absl::optional<JsonValue> v = value->first_child(); v.has_value();
+       v = v->next_sibling()) {
+    if (v->kind() != JsonValue::Kind::kString) {
       return util::Status(absl::StatusCode::kInvalidArgument,
                           "aud claim is not a list of strings");
     }
@@ -160,39 +162,38 @@ util::Status ValidateAudienceClaim(const google::protobuf::Struct& json_proto) {
 }  // namespace
 
 util::StatusOr<RawJwt> RawJwt::FromJson(absl::optional<std::string> type_header,
-                                        absl::string_view json_payload) {
-  util::StatusOr<google::protobuf::Struct> proto =
-      jwt_internal::JsonStringToProtoStruct(json_payload);
-  if (!proto.ok()) {
-    return proto.status();
-  }
-  if (ClaimIsNotAString(*proto, kJwtClaimIssuer) ||
-      ClaimIsNotAString(*proto, kJwtClaimSubject) ||
-      ClaimIsNotATimestamp(*proto, kJwtClaimExpiration) ||
-      ClaimIsNotATimestamp(*proto, kJwtClaimNotBefore) ||
-      ClaimIsNotATimestamp(*proto, kJwtClaimIssuedAt)) {
+                                        std::string json_payload) {
+  util::StatusOr<JsonDocument> payload =
+      JsonDocument::ParseObject(std::move(json_payload));
+  if (!payload.ok()) {
+    return payload.status();
+  }
+  JsonValue root = payload->root();
+  if (ClaimIsNotAString(root, kJwtClaimIssuer) ||
+      ClaimIsNotAString(root, kJwtClaimSubject) ||
+      ClaimIsNotATimestamp(root, kJwtClaimExpiration) ||
+      ClaimIsNotATimestamp(root, kJwtClaimNotBefore) ||
+      ClaimIsNotATimestamp(root, kJwtClaimIssuedAt)) {
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "contains an invalid registered claim");
   }
-  util::Status aud_status = ValidateAudienceClaim(*proto);
+  util::Status aud_status = ValidateAudienceClaim(root);
   if (!aud_status.ok()) {
     return aud_status;
   }
-  RawJwt token(type_header, *std::move(proto));
+  RawJwt token(std::move(type_header), *std::move(payload));
   return token;
 }
 
 util::StatusOr<std::string> RawJwt::GetJsonPayload() const {
-  return jwt_internal::ProtoStructToJsonString(json_proto_);
+  return payload_.root().ToJson();
 }
 
 RawJwt::RawJwt() = default;
 
 RawJwt::RawJwt(absl::optional<std::string> type_header,
-               google::protobuf::Struct json_proto) {
-  type_header_ = type_header;
-  json_proto_ = json_proto;
-}
+               jwt_internal::JsonDocument payload)
+    : type_header_(std::move(type_header)), payload_(std::move(payload)) {}
 
 bool RawJwt::HasTypeHeader() const { return type_header_.has_value(); }
 
@@ -205,150 +206,138 @@ util::StatusOr<std::string> RawJwt::GetTypeHeader() const {
 }
 
 bool RawJwt::HasIssuer() const {
-  return json_proto_.fields().contains(std::string(kJwtClaimIssuer));
+  return payload_.root().Find(kJwtClaimIssuer).has_value();
 }
 
 util::StatusOr<std::string> RawJwt::GetIssuer() const {
-  const auto& fields = json_proto_.fields();
-  auto it = fields.find(std::string(kJwtClaimIssuer));
-  if (it == fields.end()) {
+  absl::optional<JsonValue> value = payload_.root().Find(kJwtClaimIssuer);
+  if (!value.has_value()) {
     return util::Status(absl::StatusCode::kInvalidArgument, "No Issuer found");
   }
-  const Value& value = it->second;
-  if (value.kind_case() != Value::kStringValue) {
+  if (value->kind() != JsonValue::Kind::kString) {
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "Issuer is not a string");
   }
-  return value.string_value();
+  return std::string(value->string_value());
 }
 
 bool RawJwt::HasSubject() const {
-  return json_proto_.fields().contains(std::string(kJwtClaimSubject));
+  return payload_.root().Find(kJwtClaimSubject).has_value();
 }
 
 util::StatusOr<std::string> RawJwt::GetSubject() const {
-  const auto& fields = json_proto_.fields();
-  auto it = fields.find(std::string(kJwtClaimSubject));
-  if (it == fields.end()) {
+  absl::optional<JsonValue> value = payload_.root().Find(kJwtClaimSubject);
+  if (!value.has_value()) {
     return util::Status(absl::StatusCode::kInvalidArgument, "No Subject found");
   }
-  const Value& value = it->second;
-  if (value.kind_case() != Value::kStringValue) {
+  if (value->kind() != JsonValue::Kind::kString) {
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "Subject is not a string");
   }
-  return value.string_value();
+  return std::string(value->string_value());
 }
 
 bool RawJwt::HasAudiences() const {
-  return json_proto_.fields().contains(std::string(kJwtClaimAudience));
+  return payload_.root().Find(kJwtClaimAudience).has_value();
 }
 
 util::StatusOr<std::vector<std::string>> RawJwt::GetAudiences() const {
-  const auto& fields = json_proto_.fields();
-  auto it = fields.find(std::string(kJwtClaimAudience));
-  if (it == fields.end()) {
+  absl::optional<JsonValue> list = payload_.root().Find(kJwtClaimAudience);
+  if (!list.has_value()) {
     return util::Status(absl::StatusCode::kNotFound, "No Audiences found");
   }
-  Value list = it->second;
-  if (list.kind_case() != Value::kListValue) {
+  if (list->kind() == JsonValue::Kind::kString) {
     std::vector<std::string> audiences;
-    audiences.push_back(list.string_value());
+    audiences.push_back(std::string(list->string_value()));
     return audiences;
   }
-  if (list.kind_case() != Value::kListValue) {
+  if (list->kind() != JsonValue::Kind::kArray) {
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "Audiences is not a list");
   }
   std::vector<std::string> audiences;
-  for (const auto& value : list.list_value().values()) {
-    if (value.kind_case() != Value::kStringValue) {
+  audiences.reserve(list->size());
+  for (absl::optional<JsonValue> value = list->first_child(); value.has_value();
+       value = value->next_sibling()) {
+    if (value->kind() != JsonValue::Kind::kString) {
       return util::Status(absl::StatusCode::kInvalidArgument,
                           "Audiences is not a list of strings");
     }
-    audiences.push_back(value.string_value());
+    audiences.push_back(std::string(value->string_value()));
   }
   return audiences;
 }
 
 bool RawJwt::HasJwtId() const {
-  return json_proto_.fields().contains(std::string(kJwtClaimJwtId));
+  return payload_.root().Find(kJwtClaimJwtId).has_value();
 }
 
 util::StatusOr<std::string> RawJwt::GetJwtId() const {
-  const auto& fields = json_proto_.fields();
-  auto it = fields.find(std::string(kJwtClaimJwtId));
-  if (it == fields.end()) {
+  absl::optional<JsonValue> value = payload_.root().Find(kJwtClaimJwtId);
+  if (!value.has_value()) {
     return util::Status(absl::StatusCode::kNotFound, "No JwtId found");
   }
-  const Value& value = it->second;
-  if (value.kind_case() != Value::kStringValue) {
+  if (value->kind() != JsonValue::Kind::kString) {
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "JwtId is not a string");
   }
-  return value.string_value();
+  return std::string(value->string_value());
 }
 
 bool RawJwt::HasExpiration() const {
-  return json_proto_.fields().contains(std::string(kJwtClaimExpiration));
+  return payload_.root().Find(kJwtClaimExpiration).has_value();
 }
 
 util::StatusOr<absl::Time> RawJwt::GetExpiration() const {
-  const auto& fields = json_proto_.fields();
-  auto it = fields.find(std::string(kJwtClaimExpiration));
-  if (it == fields.end()) {
+  absl::optional<JsonValue> value = payload_.root().Find(kJwtClaimExpiration);
+  if (!value.has_value()) {
     return util::Status(absl::StatusCode::kNotFound, "No Expiration found");
   }
-  const Value& value = it->second;
-  if (value.kind_case() != Value::kNumberValue) {
+  if (value->kind() != JsonValue::Kind::kNumber) {
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "Expiration is not a number");
   }
-  return TimestampToTime(value.number_value());
+  return TimestampToTime(value->number_value());
 }
 
 bool RawJwt::HasNotBefore() const {
-  return json_proto_.fields().contains(std::string(kJwtClaimNotBefore));
+  return payload_.root().Find(kJwtClaimNotBefore).has_value();
 }
 
 util::StatusOr<absl::Time> RawJwt::GetNotBefore() const {
-  const auto& fields = json_proto_.fields();
-  auto it = fields.find(std::string(kJwtClaimNotBefore));
-  if (it == fields.end()) {
+  absl::optional<JsonValue> value = payload_.root().Find(kJwtClaimNotBefore);
+  if (!value.has_value()) {
     return util::Status(absl::StatusCode::kNotFound, "No NotBefore found");
   }
-  const Value& value = it->second;
-  if (value.kind_case() != Value::kNumberValue) {
+  if (value->kind() != JsonValue::Kind::kNumber) {
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "NotBefore is not a number");
   }
-  return TimestampToTime(value.number_value());
+  return TimestampToTime(value->number_value());
 }
 
 bool RawJwt::HasIssuedAt() const {
-  return json_proto_.fields().contains(std::string(kJwtClaimIssuedAt));
+  return payload_.root().Find(kJwtClaimIssuedAt).has_value();
 }
 
 util::StatusOr<absl::Time> RawJwt::GetIssuedAt() const {
-  const auto& fields = json_proto_.fields();
-  auto it = fields.find(std::string(kJwtClaimIssuedAt));
-  if (it == fields.end()) {
+  absl::optional<JsonValue> value = payload_.root().Find(kJwtClaimIssuedAt);
+  if (!value.has_value()) {
     return util::Status(absl::StatusCode::kNotFound, "No IssuedAt found");
   }
-  const Value& value = it->second;
-  if (value.kind_case() != Value::kNumberValue) {
+  if (value->kind() != JsonValue::Kind::kNumber) {
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "IssuedAt is not a number");
   }
-  return TimestampToTime(value.number_value());
+  return TimestampToTime(value->number_value());
 }
 
 bool RawJwt::IsNullClaim(absl::string_view name) const {
-  return HasClaimOfKind(json_proto_, name, Value::kNullValue);
+  return HasClaimOfKind(payload_.root(), name, JsonValue::Kind::kNull);
 }
 
 bool RawJwt::HasBooleanClaim(absl::string_view name) const {
-  return HasClaimOfKind(json_proto_, name, Value::kBoolValue);
+  return HasClaimOfKind(payload_.root(), name, JsonValue::Kind::kBool);
 }
 
 util::StatusOr<bool> RawJwt::GetBooleanClaim(
@@ -357,22 +346,20 @@ util::StatusOr<bool> RawJwt::GetBooleanClaim(
   if (!status.ok()) {
     return status;
   }
-  const auto& fields = json_proto_.fields();
-  auto it = fields.find(std::string(name));
-  if (it == fields.end()) {
+  absl::optional<JsonValue> value = payload_.root().Find(name);
+  if (!value.has_value()) {
     return util::Status(absl::StatusCode::kNotFound,
                         absl::Substitute("claim '$0' not found", name));
   }
-  const Value& value = it->second;
-  if (value.kind_case() != Value::kBoolValue) {
+  if (value->kind() != JsonValue::Kind::kBool) {
     return util::Status(absl::StatusCode::kInvalidArgument,
                         absl::Substitute("claim '$0' is not a bool", name));
   }
-  return value.bool_value();
+  return value->bool_value();
 }
 
 bool RawJwt::HasStringClaim(absl::string_view name) const {
-  return HasClaimOfKind(json_proto_, name, Value::kStringValue);
+  return HasClaimOfKind(payload_.root(), name, JsonValue::Kind::kString);
 }
 
 util::StatusOr<std::string> RawJwt::GetStringClaim(
@@ -381,22 +368,20 @@ util::StatusOr<std::string> RawJwt::GetStringClaim(
   if (!status.ok()) {
     return status;
   }
-  const auto& fields = json_proto_.fields();
-  auto it = fields.find(std::string(name));
-  if (it == fields.end()) {
+  absl::optional<JsonValue> value = payload_.root().Find(name);
+  if (!value.has_value()) {
     return util::Status(absl::StatusCode::kNotFound,
                         absl::Substitute("claim '$0' not found", name));
   }
-  const Value& value = it->second;
-  if (value.kind_case() != Value::kStringValue) {
+  if (value->kind() != JsonValue::Kind::kString) {
     return util::Status(absl::StatusCode::kInvalidArgument,
                         absl::Substitute("claim '$0' is not a string", name));
   }
-  return value.string_value();
+  return std::string(value->string_value());
 }
 
 bool RawJwt::HasNumberClaim(absl::string_view name) const {
-  return HasClaimOfKind(json_proto_, name, Value::kNumberValue);
+  return HasClaimOfKind(payload_.root(), name, JsonValue::Kind::kNumber);
 }
 
 util::StatusOr<double> RawJwt::GetNumberClaim(absl::string_view name) const {
@@ -404,22 +389,20 @@ util::StatusOr<double> RawJwt::GetNumberClaim(absl::string_view name) const {
   if (!status.ok()) {
     return status;
   }
-  const auto& fields = json_proto_.fields();
-  auto it = fields.find(std::string(name));
-  if (it == fields.end()) {
+  absl::optional<JsonValue> value = payload_.root().Find(name);
+  if (!value.has_value()) {
     return util::Status(absl::StatusCode::kNotFound,
                         absl::Substitute("claim '$0' not found", name));
   }
-  const Value& value = it->second;
-  if (value.kind_case() != Value::kNumberValue) {
+  if (value->kind() != JsonValue::Kind::kNumber) {
     return util::Status(absl::StatusCode::kInvalidArgument,
                         absl::Substitute("claim '$0' is not a number", name));
   }
-  return value.number_value();
+  return value->number_value();
 }
 
 bool RawJwt::HasJsonObjectClaim(absl::string_view name) const {
-  return HasClaimOfKind(json_proto_, name, Value::kStructValue);
+  return HasClaimOfKind(payload_.root(), name, JsonValue::Kind::kObject);
 }
 
 util::StatusOr<std::string> RawJwt::GetJsonObjectClaim(
@@ -428,23 +411,21 @@ util::StatusOr<std::string> RawJwt::GetJsonObjectClaim(
   if (!status.ok()) {
     return status;
   }
-  const auto& fields = json_proto_.fields();
-  auto it = fields.find(std::string(name));
-  if (it == fields.end()) {
+  absl::optional<JsonValue> value = payload_.root().Find(name);
+  if (!value.has_value()) {
     return util::Status(absl::StatusCode::kNotFound,
                         absl::Substitute("claim '$0' not found", name));
   }
-  const Value& value = it->second;
-  if (value.kind_case() != Value::kStructValue) {
+  if (value->kind() != JsonValue::Kind::kObject) {
     return util::Status(
         absl::StatusCode::kInvalidArgument,
         absl::Substitute("claim '$0' is not a JSON object", name));
   }
-  return jwt_internal::ProtoStructToJsonString(value.struct_value());
+  return value->ToJson();
 }
 
 bool RawJwt::HasJsonArrayClaim(absl::string_view name) const {
-  return HasClaimOfKind(json_proto_, name, Value::kListValue);
+  return HasClaimOfKind(payload_.root(), name, JsonValue::Kind::kArray);
 }
 
 util::StatusOr<std::string> RawJwt::GetJsonArrayClaim(
@@ -453,27 +434,27 @@ util::StatusOr<std::string> RawJwt::GetJsonArrayClaim(
   if (!status.ok()) {
     return status;
   }
-  const auto& fields = json_proto_.fields();
-  auto it = fields.find(std::string(name));
-  if (it == fields.end()) {
+  absl::optional<JsonValue> value = payload_.root().Find(name);
+  if (!value.has_value()) {
     return util::Status(absl::StatusCode::kNotFound,
                         absl::Substitute("claim '$0' not found", name));
   }
-  const Value& value = it->second;
-  if (value.kind_case() != Value::kListValue) {
+  if (value->kind() != JsonValue::Kind::kArray) {
     return util::Status(
         absl::StatusCode::kInvalidArgument,
         absl::Substitute("claim '$0' is not a JSON array", name));
   }
-  return jwt_internal::ProtoListToJsonString(value.list_value());
+  return value->ToJson();
 }
 
 std::vector<std::string> RawJwt::CustomClaimNames() const {
-  const auto& fields = json_proto_.fields();
   std::vector<std::string> values;
-  for (auto it = fields.begin(); it != fields.end(); it++) {
-    if (!IsRegisteredClaimName(it->first)) {
-      values.push_back(it->first);
+  absl::flat_hash_set<absl::string_view> seen;
+  for (absl::optional<JsonValue> member = payload_.root().first_child();
+       member.has_value(); member = member->next_sibling()) {
+    absl::string_view name = member->name();
+    if (!IsRegisteredClaimName(name) && seen.insert(name).second) {
+      values.push_back(std::string(name));
     }
   }
   return values;
@@ -740,7 +721,17 @@ util::StatusOr<RawJwt> RawJwtBuilder::Build() {
         absl::StatusCode::kInvalidArgument,
         "SetExpiration() and WithoutExpiration() must not be called together");
   }
-  RawJwt token(type_header_, json_proto_);
+  util::StatusOr<std::string> json_payload =
+      jwt_internal::ProtoStructToJsonString(json_proto_);
+  if (!json_payload.ok()) {
+    return json_payload.status();
+  }
+  util::StatusOr<JsonDocument> payload =
+      JsonDocument::ParseObject(*std::move(json_payload));
+  if (!payload.ok()) {
+    return payload.status();
+  }
+  RawJwt token(type_header_, *std::move(payload));
   return token;
 }
 
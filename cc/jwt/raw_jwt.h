@@ -24,6 +24,8 @@
 #include "absl/strings/string_view.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "absl/types/optional.h"
+#include "tink/jwt/internal/json_document.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
 
@@ -88,13 +90,13 @@ class RawJwt {
 
  private:
   static util::StatusOr<RawJwt> FromJson(
-      absl::optional<std::string> type_header, absl::string_view json_payload);
+      absl::optional<std::string> type_header, std::string json_payload);
   explicit RawJwt(absl::optional<std::string> type_header,
-                  google::protobuf::Struct json_proto);
+                  jwt_internal::JsonDocument payload);
   friend class RawJwtBuilder;
   friend class jwt_internal::RawJwtParser;
   absl::optional<std::string> type_header_;
-  google::protobuf::Struct json_proto_;
+  jwt_internal::JsonDocument payload_;
 };
 
 class RawJwtBuilder {
@@ -36,6 +36,7 @@ namespace jwt_internal {
 // For friend declaration
 class JwtMacImpl;
 class JwtPublicKeyVerifyImpl;
+class VerifiedJwtCache;
 
 }
 
@@ -93,6 +94,7 @@ class VerifiedJwt {
   explicit VerifiedJwt(const RawJwt& raw_jwt);
   friend class jwt_internal::JwtMacImpl;
   friend class jwt_internal::JwtPublicKeyVerifyImpl;
+  friend class jwt_internal::VerifiedJwtCache;
   RawJwt raw_jwt_;
 };
 
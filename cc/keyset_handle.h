@@ -172,6 +172,37 @@ class KeysetHandle {
   template <class P>
   crypto::tink::util::StatusOr<std::unique_ptr<P>> GetPrimitive() const;
 
+  // Same as GetPrimitive(), but only the primitive for the primary key is
+  // created right away. The primitives for the other keys are created the
+  // first time they are needed (e.g., to decrypt a ciphertext with their
+  // prefix), so that memory and setup time scale with the keys in use.
+  // Consequently, invalid non-primary keys are not reported here, but are
+  // treated as non-matching keys when used. Primitives whose wrapper does not
+  // support lazy creation are created eagerly, as with GetPrimitive().
+  template <class P>
+  crypto::tink::util::StatusOr<std::unique_ptr<P>> GetPrimitiveWithLazyKeys()
+      const;
+
+  // Options for GetPrimitive(const PrimitiveOptions&).
+  struct PrimitiveOptions {
+    // Create the primitives for non-primary keys on first use, as done by
+    // GetPrimitiveWithLazyKeys().
+    bool lazy_keys = false;
+    // When decrypting or verifying, try the keys with RAW output prefix
+    // starting with the one that most recently succeeded, followed by the
+    // others in decreasing order of how often they succeeded, instead of in
+    // keyset order. This reduces the number of failed attempts for keysets
+    // with many RAW keys of which few are in use, and never changes results.
+    // Used by the Aead, DeterministicAead, Mac, HybridDecrypt and
+    // PublicKeyVerify wrappers.
+    bool adaptive_raw_key_order = false;
+  };
+
+  // Same as GetPrimitive(), but creates the primitive according to `options`.
+  template <class P>
+  crypto::tink::util::StatusOr<std::unique_ptr<P>> GetPrimitive(
+      const PrimitiveOptions& options) const;
+
   // Creates a wrapped primitive corresponding to this keyset. Uses the given
   // KeyManager, as well as the KeyManager and PrimitiveWrapper objects in the
   // global registry to create the primitive. The given KeyManager is used for
@@ -279,6 +310,24 @@ crypto::tink::util::StatusOr<std::unique_ptr<P>> KeysetHandle::GetPrimitive()
       keyset_, monitoring_annotations_);
 }
 
+template <class P>
+crypto::tink::util::StatusOr<std::unique_ptr<P>>
+KeysetHandle::GetPrimitiveWithLazyKeys() const {
+  PrimitiveOptions options;
+  options.lazy_keys = true;
+  return GetPrimitive<P>(options);
+}
+
+template <class P>
+crypto::tink::util::StatusOr<std::unique_ptr<P>> KeysetHandle::GetPrimitive(
+    const PrimitiveOptions& options) const {
+  internal::KeysetWrapOptions wrap_options;
+  wrap_options.lazy_primitives = options.lazy_keys;
+  wrap_options.adaptive_raw_order = options.adaptive_raw_key_order;
+  return internal::RegistryImpl::GlobalInstance().WrapKeysetWithOptions<P>(
+      keyset_, monitoring_annotations_, wrap_options);
+}
+
 template <class P>
 crypto::tink::util::StatusOr<std::unique_ptr<P>> KeysetHandle::GetPrimitive(
     const KeyManager<P>* custom_manager) const {
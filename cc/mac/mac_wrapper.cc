@@ -21,10 +21,10 @@
 #include <utility>
 
 #include "absl/status/status.h"
-#include "absl/strings/str_cat.h"
 #include "tink/crypto_format.h"
 #include "tink/internal/monitoring_util.h"
 #include "tink/internal/registry_impl.h"
+#include "tink/internal/trial_decryption.h"
 #include "tink/internal/util.h"
 #include "tink/mac.h"
 #include "tink/monitoring/monitoring.h"
@@ -52,7 +52,11 @@ class MacSetWrapper : public Mac {
       std::unique_ptr<MonitoringClient> monitoring_verify_client = nullptr)
       : mac_set_(std::move(mac_set)),
         monitoring_compute_client_(std::move(monitoring_compute_client)),
-        monitoring_verify_client_(std::move(monitoring_verify_client)) {}
+        monitoring_verify_client_(std::move(monitoring_verify_client)),
+        timed_compute_client_(internal::AsTimedMonitoringClient(
+            monitoring_compute_client_.get())),
+        timed_verify_client_(internal::AsTimedMonitoringClient(
+            monitoring_verify_client_.get())) {}
 
   crypto::tink::util::StatusOr<std::string> ComputeMac(
       absl::string_view data) const override;
@@ -66,6 +70,9 @@ class MacSetWrapper : public Mac {
   std::unique_ptr<PrimitiveSet<Mac>> mac_set_;
   std::unique_ptr<MonitoringClient> monitoring_compute_client_;
   std::unique_ptr<MonitoringClient> monitoring_verify_client_;
+  // Set if the corresponding monitoring client also records latencies.
+  TimedMonitoringClient* const timed_compute_client_;
+  TimedMonitoringClient* const timed_verify_client_;
 };
 
 util::Status Validate(PrimitiveSet<Mac>* mac_set) {
@@ -82,6 +89,7 @@ util::Status Validate(PrimitiveSet<Mac>* mac_set) {
 
 util::StatusOr<std::string> MacSetWrapper::ComputeMac(
     absl::string_view data) const {
+  internal::MonitoringLatencyTimer timer(timed_compute_client_);
   // BoringSSL expects a non-null pointer for data,
   // regardless of whether the size is 0.
   data = internal::EnsureStringNonNull(data);
@@ -104,6 +112,7 @@ util::StatusOr<std::string> MacSetWrapper::ComputeMac(
   if (monitoring_compute_client_ != nullptr) {
     monitoring_compute_client_->Log(mac_set_->get_primary()->get_key_id(),
                                     data.size());
+    timer.LogLatency(mac_set_->get_primary()->get_key_id(), data.size());
   }
   const std::string& key_id = primary->get_identifier();
   return key_id + compute_mac_result.value();
@@ -112,6 +121,7 @@ util::StatusOr<std::string> MacSetWrapper::ComputeMac(
 util::Status MacSetWrapper::VerifyMac(
     absl::string_view mac_value,
     absl::string_view data) const {
+  internal::MonitoringLatencyTimer timer(timed_verify_client_);
   data = internal::EnsureStringNonNull(data);
   mac_value = internal::EnsureStringNonNull(mac_value);
 
@@ -122,22 +132,29 @@ util::Status MacSetWrapper::VerifyMac(
     if (primitives_result.ok()) {
       absl::string_view raw_mac_value =
           mac_value.substr(CryptoFormat::kNonRawPrefixSize);
+      // LEGACY keys authenticate `data` followed by a zero byte; built at most
+      // once, for the first LEGACY candidate.
+      std::string legacy_data;
       for (auto& mac_entry : *(primitives_result.value())) {
-        std::string legacy_data;
+        util::StatusOr<Mac*> mac = mac_entry->get_or_create_primitive();
+        if (!mac.ok()) continue;
         absl::string_view view_on_data_or_legacy_data = data;
         if (mac_entry->get_output_prefix_type() == OutputPrefixType::LEGACY) {
-          legacy_data = absl::StrCat(data, std::string("\x00", 1));
+          if (legacy_data.empty()) {
+            legacy_data.reserve(data.size() + 1);
+            legacy_data.append(data.data(), data.size());
+            legacy_data.push_back('\0');
+          }
           view_on_data_or_legacy_data = legacy_data;
         }
-        Mac& mac = mac_entry->get_primitive();
-        util::Status status =
-            mac.VerifyMac(raw_mac_value, view_on_data_or_legacy_data);
-        if (status.ok()) {
+        if (internal::TryVerifyMac(**mac, raw_mac_value,
+                                   view_on_data_or_legacy_data)) {
           if (monitoring_verify_client_ != nullptr) {
             monitoring_verify_client_->Log(mac_entry->get_key_id(),
                                            data.size());
+            timer.LogLatency(mac_entry->get_key_id(), data.size());
           }
-          return status;
+          return util::OkStatus();
         } else {
           // TODO(przydatek): LOG that a matching key didn't verify the MAC.
         }
@@ -146,17 +163,16 @@ util::Status MacSetWrapper::VerifyMac(
   }
 
   // No matching key succeeded with verification, try all RAW keys.
-  auto raw_primitives_result = mac_set_->get_raw_primitives();
-  if (raw_primitives_result.ok()) {
-    for (auto& mac_entry : *(raw_primitives_result.value())) {
-      Mac& mac = mac_entry->get_primitive();
-      util::Status status = mac.VerifyMac(mac_value, data);
-      if (status.ok()) {
-        if (monitoring_verify_client_ != nullptr) {
-          monitoring_verify_client_->Log(mac_entry->get_key_id(), data.size());
-        }
-        return status;
+  for (auto* mac_entry : mac_set_->get_raw_primitives_in_trial_order()) {
+    util::StatusOr<Mac*> mac = mac_entry->get_or_create_primitive();
+    if (!mac.ok()) continue;
+    if (internal::TryVerifyMac(**mac, mac_value, data)) {
+      mac_set_->RecordRawPrimitiveSuccess(mac_entry);
+      if (monitoring_verify_client_ != nullptr) {
+        monitoring_verify_client_->Log(mac_entry->get_key_id(), data.size());
+        timer.LogLatency(mac_entry->get_key_id(), data.size());
       }
+      return util::OkStatus();
     }
   }
   if (monitoring_verify_client_ != nullptr) {
@@ -39,6 +39,9 @@ class MacWrapper : public PrimitiveWrapper<Mac, Mac> {
  public:
   util::StatusOr<std::unique_ptr<Mac>> Wrap(
       std::unique_ptr<PrimitiveSet<Mac>> mac_set) const override;
+
+  // Non-primary entries are only instantiated when they are first used.
+  bool SupportsLazyPrimitives() const override { return true; }
 };
 
 }  // namespace tink
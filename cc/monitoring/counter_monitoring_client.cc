@@ -0,0 +1,300 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+#include "tink/monitoring/counter_monitoring_client.h"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "tink/monitoring/log_linear_histogram.h"
+#include "tink/monitoring/monitoring.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace internal {
+
+namespace {
+
+// Number of shards of every counter. Threads are assigned to shards in a
+// round-robin fashion, so up to kNumShards threads update disjoint counters.
+constexpr int kNumShards = 16;
+
+// Size of a cache line; each shard is aligned to it to avoid false sharing.
+constexpr int kCacheLineSize = 64;
+
+int CurrentThreadShard() {
+  static std::atomic<int> next_shard{0};
+  thread_local const int shard =
+      next_shard.fetch_add(1, std::memory_order_relaxed) % kNumShards;
+  return shard;
+}
+
+struct alignas(kCacheLineSize) KeyShard {
+  std::atomic<int64_t> num_operations{0};
+  std::atomic<int64_t> num_bytes{0};
+};
+
+struct alignas(kCacheLineSize) FailureShard {
+  std::atomic<int64_t> num_failures{0};
+};
+
+constexpr int kNumInputSizeBuckets =
+    sizeof(CounterMonitoringClientFactory::kInputSizeBuckets) /
+    sizeof(CounterMonitoringClientFactory::kInputSizeBuckets[0]);
+
+int InputSizeBucket(int64_t num_bytes) {
+  int bucket = 0;
+  while (bucket + 1 < kNumInputSizeBuckets &&
+         num_bytes >=
+             CounterMonitoringClientFactory::kInputSizeBuckets[bucket + 1]) {
+    ++bucket;
+  }
+  return bucket;
+}
+
+}  // namespace
+
+class ShardedMonitoringCounters {
+ public:
+  ShardedMonitoringCounters(const MonitoringContext& context,
+                            bool record_latencies)
+      : primitive_(context.GetPrimitive()), api_(context.GetApi()) {
+    absl::flat_hash_map<std::string, int> key_type_index;
+    for (const MonitoringKeySetInfo::Entry& entry :
+         context.GetKeySetInfo().GetEntries()) {
+      if (!key_index_.emplace(entry.GetKeyId(), key_ids_.size()).second) {
+        continue;
+      }
+      key_ids_.push_back(entry.GetKeyId());
+      auto inserted =
+          key_type_index.emplace(entry.GetKeyType(), key_types_.size());
+      if (inserted.second) key_types_.push_back(entry.GetKeyType());
+      key_type_of_key_.push_back(inserted.first->second);
+    }
+    key_shards_ = absl::make_unique<KeyShard[]>(key_ids_.size() * kNumShards);
+    if (record_latencies) {
+      latencies_ = absl::make_unique<LogLinearHistogram[]>(
+          key_types_.size() * kNumInputSizeBuckets);
+    }
+  }
+
+  void Log(uint32_t key_id, int64_t num_bytes) {
+    auto it = key_index_.find(key_id);
+    if (it == key_index_.end()) return;
+    KeyShard& shard =
+        key_shards_[CurrentThreadShard() * key_ids_.size() + it->second];
+    shard.num_operations.fetch_add(1, std::memory_order_relaxed);
+    shard.num_bytes.fetch_add(num_bytes, std::memory_order_relaxed);
+  }
+
+  void LogFailure() {
+    failure_shards_[CurrentThreadShard()].num_failures.fetch_add(
+        1, std::memory_order_relaxed);
+  }
+
+  void LogLatency(uint32_t key_id, int64_t num_bytes, absl::Duration latency) {
+    auto it = key_index_.find(key_id);
+    if (it == key_index_.end() || latencies_ == nullptr) return;
+    latencies_[key_type_of_key_[it->second] * kNumInputSizeBuckets +
+               InputSizeBucket(num_bytes)]
+        .Record(absl::ToInt64Nanoseconds(latency));
+  }
+
+  const std::string& primitive() const { return primitive_; }
+  const std::string& api() const { return api_; }
+  const std::vector<uint32_t>& key_ids() const { return key_ids_; }
+  const std::vector<std::string>& key_types() const { return key_types_; }
+  bool records_latencies() const { return latencies_ != nullptr; }
+
+  // Returns the latencies of operations with keys of type key_types()[index]
+  // and inputs in size bucket `input_size_bucket`.
+  LogLinearHistogram::Snapshot GetLatencies(int index,
+                                            int input_size_bucket) const {
+    return latencies_[index * kNumInputSizeBuckets + input_size_bucket]
+        .GetSnapshot();
+  }
+
+  // Returns the number of operations and bytes of the key at `index` in
+  // key_ids(), summed over all shards.
+  std::pair<int64_t, int64_t> SumKeyShards(int index) const {
+    int64_t num_operations = 0;
+    int64_t num_bytes = 0;
+    for (int shard = 0; shard < kNumShards; ++shard) {
+      const KeyShard& key_shard = key_shards_[shard * key_ids_.size() + index];
+      num_operations +=
+          key_shard.num_operations.load(std::memory_order_relaxed);
+      num_bytes += key_shard.num_bytes.load(std::memory_order_relaxed);
+    }
+    return {num_operations, num_bytes};
+  }
+
+  int64_t SumFailureShards() const {
+    int64_t num_failures = 0;
+    for (const FailureShard& shard : failure_shards_) {
+      num_failures += shard.num_failures.load(std::memory_order_relaxed);
+    }
+    return num_failures;
+  }
+
+ private:
+  const std::string primitive_;
+  const std::string api_;
+  // Maps key IDs to their index in key_ids_; immutable after construction.
+  absl::flat_hash_map<uint32_t, int> key_index_;
+  std::vector<uint32_t> key_ids_;
+  // kNumShards rows of key_ids_.size() counters each.
+  std::unique_ptr<KeyShard[]> key_shards_;
+  FailureShard failure_shards_[kNumShards];
+  // Distinct key types, and the index in key_types_ of each key in key_ids_.
+  std::vector<std::string> key_types_;
+  std::vector<int> key_type_of_key_;
+  // If latencies are recorded, key_types_.size() rows of kNumInputSizeBuckets
+  // histograms each; nullptr otherwise.
+  std::unique_ptr<LogLinearHistogram[]> latencies_;
+};
+
+}  // namespace internal
+
+namespace {
+
+class CounterMonitoringClient : public MonitoringClient {
+ public:
+  explicit CounterMonitoringClient(
+      std::shared_ptr<internal::ShardedMonitoringCounters> counters)
+      : counters_(std::move(counters)) {}
+
+  void Log(uint32_t key_id, int64_t num_bytes_as_input) override {
+    counters_->Log(key_id, num_bytes_as_input);
+  }
+
+  void LogFailure() override { counters_->LogFailure(); }
+
+ private:
+  const std::shared_ptr<internal::ShardedMonitoringCounters> counters_;
+};
+
+class TimedCounterMonitoringClient : public TimedMonitoringClient {
+ public:
+  explicit TimedCounterMonitoringClient(
+      std::shared_ptr<internal::ShardedMonitoringCounters> counters)
+      : counters_(std::move(counters)) {}
+
+  void Log(uint32_t key_id, int64_t num_bytes_as_input) override {
+    counters_->Log(key_id, num_bytes_as_input);
+  }
+
+  void LogFailure() override { counters_->LogFailure(); }
+
+  void LogLatency(uint32_t key_id, int64_t num_bytes_as_input,
+                  absl::Duration latency) override {
+    counters_->LogLatency(key_id, num_bytes_as_input, latency);
+  }
+
+ private:
+  const std::shared_ptr<internal::ShardedMonitoringCounters> counters_;
+};
+
+}  // namespace
+
+constexpr int64_t CounterMonitoringClientFactory::kInputSizeBuckets[];
+
+CounterMonitoringClientFactory::~CounterMonitoringClientFactory() = default;
+
+util::StatusOr<std::unique_ptr<MonitoringClient>>
+CounterMonitoringClientFactory::New(const MonitoringContext& context) {
+  auto counters = std::make_shared<internal::ShardedMonitoringCounters>(
+      context, record_latencies_);
+  {
+    absl::MutexLock lock(&mutex_);
+    counters_.push_back(counters);
+  }
+  if (record_latencies_) {
+    return {absl::make_unique<TimedCounterMonitoringClient>(
+        std::move(counters))};
+  }
+  return {absl::make_unique<CounterMonitoringClient>(std::move(counters))};
+}
+
+CounterMonitoringClientFactory::Snapshot
+CounterMonitoringClientFactory::GetSnapshot() const {
+  std::vector<std::shared_ptr<const internal::ShardedMonitoringCounters>>
+      all_counters;
+  {
+    absl::MutexLock lock(&mutex_);
+    all_counters = counters_;
+  }
+
+  std::map<std::tuple<std::string, std::string, uint32_t>,
+           std::pair<int64_t, int64_t>>
+      key_counts;
+  std::map<std::pair<std::string, std::string>, int64_t> failure_counts;
+  std::map<std::tuple<std::string, std::string, std::string, int>,
+           LogLinearHistogram::Snapshot>
+      latencies;
+  for (const auto& counters : all_counters) {
+    for (int i = 0; i < counters->key_ids().size(); ++i) {
+      std::pair<int64_t, int64_t> sums = counters->SumKeyShards(i);
+      std::pair<int64_t, int64_t>& total = key_counts[std::make_tuple(
+          counters->primitive(), counters->api(), counters->key_ids()[i])];
+      total.first += sums.first;
+      total.second += sums.second;
+    }
+    failure_counts[{counters->primitive(), counters->api()}] +=
+        counters->SumFailureShards();
+    if (!counters->records_latencies()) continue;
+    for (int i = 0; i < counters->key_types().size(); ++i) {
+      for (int bucket = 0; bucket < internal::kNumInputSizeBuckets; ++bucket) {
+        LogLinearHistogram::Snapshot histogram =
+            counters->GetLatencies(i, bucket);
+        if (histogram.count() == 0) continue;
+        latencies[std::make_tuple(counters->primitive(), counters->api(),
+                                  counters->key_types()[i], bucket)]
+            .Merge(histogram);
+      }
+    }
+  }
+
+  Snapshot snapshot;
+  for (const auto& entry : key_counts) {
+    snapshot.key_counts.push_back(
+        {std::get<0>(entry.first), std::get<1>(entry.first),
+         std::get<2>(entry.first), entry.second.first, entry.second.second});
+  }
+  for (const auto& entry : failure_counts) {
+    snapshot.failure_counts.push_back(
+        {entry.first.first, entry.first.second, entry.second});
+  }
+  for (const auto& entry : latencies) {
+    snapshot.latency_distributions.push_back(
+        {std::get<0>(entry.first), std::get<1>(entry.first),
+         std::get<2>(entry.first), kInputSizeBuckets[std::get<3>(entry.first)],
+         entry.second});
+  }
+  return snapshot;
+}
+
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,127 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+#ifndef TINK_MONITORING_COUNTER_MONITORING_CLIENT_H_
+#define TINK_MONITORING_COUNTER_MONITORING_CLIENT_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "tink/monitoring/log_linear_histogram.h"
+#include "tink/monitoring/monitoring.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+
+namespace internal {
+// Counters of all the clients created for a single MonitoringContext.
+class ShardedMonitoringCounters;
+}  // namespace internal
+
+// MonitoringClientFactory whose clients count, for each primitive, API
+// function and key ID, the number of successful operations and the number of
+// bytes they processed, as well as the number of failures for each primitive
+// and API function.
+//
+// The clients are meant to be called on every cryptographic operation from
+// many threads concurrently: counters are sharded across threads and updated
+// with relaxed atomic additions, so that logging takes neither locks nor
+// allocations. GetSnapshot() sums up the shards and is comparatively
+// expensive, so it should be called periodically, e.g., by an exporter.
+//
+// Optionally, clients also record the latency of every successful operation
+// in a LogLinearHistogram for each primitive, API function, key type and input
+// size bucket. Only then are clients TimedMonitoringClients, so that wrappers
+// do not measure time otherwise.
+//
+// Typical usage is to keep a pointer to the factory before handing it over to
+// the registry, and to export its snapshots from there.
+class CounterMonitoringClientFactory : public MonitoringClientFactory {
+ public:
+  // Number of successful operations and bytes processed by one key.
+  struct KeyCounts {
+    std::string primitive;
+    std::string api;
+    uint32_t key_id;
+    int64_t num_operations;
+    int64_t num_bytes;
+  };
+
+  // Number of failed operations of a primitive and API function.
+  struct FailureCounts {
+    std::string primitive;
+    std::string api;
+    int64_t num_failures;
+  };
+
+  // Latencies, in nanoseconds, of the successful operations of a primitive and
+  // API function with keys of type `key_type` on inputs of at least
+  // `min_input_size` bytes, and less than the next size bucket.
+  struct LatencyDistribution {
+    std::string primitive;
+    std::string api;
+    std::string key_type;
+    int64_t min_input_size;
+    LogLinearHistogram::Snapshot latency_nanos;
+  };
+
+  // Point-in-time view of all counters, aggregated over all clients created
+  // by this factory and sorted by primitive, API function and key ID (or key
+  // type and size bucket). `latency_distributions` only contains size buckets
+  // with at least one operation.
+  struct Snapshot {
+    std::vector<KeyCounts> key_counts;
+    std::vector<FailureCounts> failure_counts;
+    std::vector<LatencyDistribution> latency_distributions;
+  };
+
+  // Lower bounds of the input size buckets used for latency distributions.
+  static constexpr int64_t kInputSizeBuckets[] = {0, 64, 1024, 16 * 1024,
+                                                  256 * 1024};
+
+  // Creates a factory whose clients only count operations.
+  CounterMonitoringClientFactory() = default;
+  // Creates a factory whose clients also record latency distributions if
+  // `record_latencies` is true.
+  explicit CounterMonitoringClientFactory(bool record_latencies)
+      : record_latencies_(record_latencies) {}
+  ~CounterMonitoringClientFactory() override;
+
+  // Creates a client counting operations with the keys in `context`. Calls to
+  // MonitoringClient::Log() with a key ID which is not part of the keyset info
+  // of `context` are ignored.
+  crypto::tink::util::StatusOr<std::unique_ptr<MonitoringClient>> New(
+      const MonitoringContext& context) override;
+
+  // Returns the current values of all counters. Updates which happen
+  // concurrently with this call may only be partially reflected.
+  Snapshot GetSnapshot() const;
+
+ private:
+  const bool record_latencies_ = false;
+  mutable absl::Mutex mutex_;
+  std::vector<std::shared_ptr<const internal::ShardedMonitoringCounters>>
+      counters_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_MONITORING_COUNTER_MONITORING_CLIENT_H_
@@ -0,0 +1,234 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+#include "tink/monitoring/counter_monitoring_client.h"
+
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+#include "tink/key_status.h"
+#include "tink/monitoring/log_linear_histogram.h"
+#include "tink/monitoring/monitoring.h"
+#include "tink/util/statusor.h"
+#include "tink/util/test_matchers.h"
+
+namespace crypto {
+namespace tink {
+namespace {
+
+using ::crypto::tink::test::IsOk;
+using ::testing::AllOf;
+using ::testing::ElementsAre;
+using ::testing::Field;
+using ::testing::IsEmpty;
+using ::testing::IsNull;
+using ::testing::NotNull;
+using ::testing::SizeIs;
+
+MonitoringKeySetInfo KeySetInfoWithKeys(const std::vector<uint32_t>& key_ids) {
+  std::vector<MonitoringKeySetInfo::Entry> entries;
+  for (uint32_t key_id : key_ids) {
+    entries.push_back(MonitoringKeySetInfo::Entry(
+        KeyStatus::kEnabled, key_id, "tink.AesGcmKey", "TINK"));
+  }
+  return MonitoringKeySetInfo(/*keyset_annotations=*/{}, entries,
+                              /*primary_key_id=*/key_ids.front());
+}
+
+testing::Matcher<CounterMonitoringClientFactory::KeyCounts> KeyCountsAre(
+    absl::string_view primitive, absl::string_view api, uint32_t key_id,
+    int64_t num_operations, int64_t num_bytes) {
+  return AllOf(
+      Field(&CounterMonitoringClientFactory::KeyCounts::primitive, primitive),
+      Field(&CounterMonitoringClientFactory::KeyCounts::api, api),
+      Field(&CounterMonitoringClientFactory::KeyCounts::key_id, key_id),
+      Field(&CounterMonitoringClientFactory::KeyCounts::num_operations,
+            num_operations),
+      Field(&CounterMonitoringClientFactory::KeyCounts::num_bytes, num_bytes));
+}
+
+testing::Matcher<CounterMonitoringClientFactory::FailureCounts>
+FailureCountsAre(absl::string_view primitive, absl::string_view api,
+                 int64_t num_failures) {
+  return AllOf(
+      Field(&CounterMonitoringClientFactory::FailureCounts::primitive,
+            primitive),
+      Field(&CounterMonitoringClientFactory::FailureCounts::api, api),
+      Field(&CounterMonitoringClientFactory::FailureCounts::num_failures,
+            num_failures));
+}
+
+TEST(CounterMonitoringClientTest, EmptySnapshot) {
+  CounterMonitoringClientFactory factory;
+  CounterMonitoringClientFactory::Snapshot snapshot = factory.GetSnapshot();
+  EXPECT_THAT(snapshot.key_counts, IsEmpty());
+  EXPECT_THAT(snapshot.failure_counts, IsEmpty());
+}
+
+TEST(CounterMonitoringClientTest, CountsOperationsBytesAndFailures) {
+  CounterMonitoringClientFactory factory;
+  util::StatusOr<std::unique_ptr<MonitoringClient>> client = factory.New(
+      MonitoringContext("aead", "encrypt", KeySetInfoWithKeys({1, 2})));
+  ASSERT_THAT(client, IsOk());
+
+  (*client)->Log(1, 10);
+  (*client)->Log(1, 20);
+  (*client)->Log(2, 5);
+  (*client)->LogFailure();
+
+  CounterMonitoringClientFactory::Snapshot snapshot = factory.GetSnapshot();
+  EXPECT_THAT(snapshot.key_counts,
+              ElementsAre(KeyCountsAre("aead", "encrypt", 1, 2, 30),
+                          KeyCountsAre("aead", "encrypt", 2, 1, 5)));
+  EXPECT_THAT(snapshot.failure_counts,
+              ElementsAre(FailureCountsAre("aead", "encrypt", 1)));
+}
+
+TEST(CounterMonitoringClientTest, IgnoresUnknownKeyIds) {
+  CounterMonitoringClientFactory factory;
+  util::StatusOr<std::unique_ptr<MonitoringClient>> client = factory.New(
+      MonitoringContext("mac", "compute", KeySetInfoWithKeys({1})));
+  ASSERT_THAT(client, IsOk());
+
+  (*client)->Log(42, 10);
+
+  EXPECT_THAT(factory.GetSnapshot().key_counts,
+              ElementsAre(KeyCountsAre("mac", "compute", 1, 0, 0)));
+}
+
+TEST(CounterMonitoringClientTest, AggregatesClientsWithSameContext) {
+  CounterMonitoringClientFactory factory;
+  util::StatusOr<std::unique_ptr<MonitoringClient>> encrypt_client =
+      factory.New(
+          MonitoringContext("aead", "encrypt", KeySetInfoWithKeys({1})));
+  ASSERT_THAT(encrypt_client, IsOk());
+  util::StatusOr<std::unique_ptr<MonitoringClient>> other_encrypt_client =
+      factory.New(
+          MonitoringContext("aead", "encrypt", KeySetInfoWithKeys({1, 2})));
+  ASSERT_THAT(other_encrypt_client, IsOk());
+  util::StatusOr<std::unique_ptr<MonitoringClient>> decrypt_client =
+      factory.New(
+          MonitoringContext("aead", "decrypt", KeySetInfoWithKeys({1})));
+  ASSERT_THAT(decrypt_client, IsOk());
+
+  (*encrypt_client)->Log(1, 1);
+  (*other_encrypt_client)->Log(1, 2);
+  (*other_encrypt_client)->Log(2, 3);
+  (*decrypt_client)->Log(1, 4);
+  (*decrypt_client)->LogFailure();
+  (*other_encrypt_client)->LogFailure();
+  // Counters outlive the clients.
+  encrypt_client->reset();
+
+  CounterMonitoringClientFactory::Snapshot snapshot = factory.GetSnapshot();
+  EXPECT_THAT(snapshot.key_counts,
+              ElementsAre(KeyCountsAre("aead", "decrypt", 1, 1, 4),
+                          KeyCountsAre("aead", "encrypt", 1, 2, 3),
+                          KeyCountsAre("aead", "encrypt", 2, 1, 3)));
+  EXPECT_THAT(snapshot.failure_counts,
+              ElementsAre(FailureCountsAre("aead", "decrypt", 1),
+                          FailureCountsAre("aead", "encrypt", 1)));
+}
+
+TEST(CounterMonitoringClientTest, ConcurrentLogging) {
+  constexpr int kNumThreads = 32;
+  constexpr int kNumOperations = 1000;
+  CounterMonitoringClientFactory factory;
+  util::StatusOr<std::unique_ptr<MonitoringClient>> client = factory.New(
+      MonitoringContext("aead", "decrypt", KeySetInfoWithKeys({1, 2})));
+  ASSERT_THAT(client, IsOk());
+  MonitoringClient* monitoring_client = client->get();
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([monitoring_client, i]() {
+      for (int j = 0; j < kNumOperations; ++j) {
+        monitoring_client->Log(/*key_id=*/1 + i % 2, /*num_bytes=*/3);
+        monitoring_client->LogFailure();
+      }
+    });
+  }
+  // Snapshots can be taken concurrently with logging.
+  factory.GetSnapshot();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  constexpr int64_t kOperationsPerKey = kNumThreads / 2 * kNumOperations;
+  CounterMonitoringClientFactory::Snapshot snapshot = factory.GetSnapshot();
+  EXPECT_THAT(snapshot.key_counts,
+              ElementsAre(KeyCountsAre("aead", "decrypt", 1, kOperationsPerKey,
+                                       3 * kOperationsPerKey),
+                          KeyCountsAre("aead", "decrypt", 2, kOperationsPerKey,
+                                       3 * kOperationsPerKey)));
+  EXPECT_THAT(snapshot.failure_counts,
+              ElementsAre(FailureCountsAre("aead", "decrypt",
+                                           kNumThreads * kNumOperations)));
+}
+
+TEST(CounterMonitoringClientTest, NoLatenciesByDefault) {
+  CounterMonitoringClientFactory factory;
+  util::StatusOr<std::unique_ptr<MonitoringClient>> client = factory.New(
+      MonitoringContext("aead", "encrypt", KeySetInfoWithKeys({1})));
+  ASSERT_THAT(client, IsOk());
+
+  EXPECT_THAT(dynamic_cast<TimedMonitoringClient*>(client->get()), IsNull());
+  (*client)->Log(1, 10);
+  EXPECT_THAT(factory.GetSnapshot().latency_distributions, IsEmpty());
+}
+
+TEST(CounterMonitoringClientTest, RecordsLatenciesBySizeBucket) {
+  CounterMonitoringClientFactory factory(/*record_latencies=*/true);
+  util::StatusOr<std::unique_ptr<MonitoringClient>> client = factory.New(
+      MonitoringContext("aead", "encrypt", KeySetInfoWithKeys({1, 2})));
+  ASSERT_THAT(client, IsOk());
+  auto* timed_client = dynamic_cast<TimedMonitoringClient*>(client->get());
+  ASSERT_THAT(timed_client, NotNull());
+
+  timed_client->LogLatency(1, 10, absl::Nanoseconds(100));
+  timed_client->LogLatency(2, 20, absl::Nanoseconds(100));
+  timed_client->LogLatency(1, 2000, absl::Nanoseconds(5000));
+  // Unknown key IDs are ignored.
+  timed_client->LogLatency(42, 10, absl::Nanoseconds(100));
+
+  CounterMonitoringClientFactory::Snapshot snapshot = factory.GetSnapshot();
+  ASSERT_THAT(snapshot.latency_distributions, SizeIs(2));
+  const CounterMonitoringClientFactory::LatencyDistribution& small =
+      snapshot.latency_distributions[0];
+  EXPECT_EQ(small.primitive, "aead");
+  EXPECT_EQ(small.api, "encrypt");
+  EXPECT_EQ(small.key_type, "tink.AesGcmKey");
+  EXPECT_EQ(small.min_input_size, 0);
+  EXPECT_EQ(small.latency_nanos.count(), 2);
+  EXPECT_EQ(small.latency_nanos.Percentile(50),
+            LogLinearHistogram::BucketLowerBound(
+                LogLinearHistogram::BucketIndex(100)));
+  const CounterMonitoringClientFactory::LatencyDistribution& large =
+      snapshot.latency_distributions[1];
+  EXPECT_EQ(large.min_input_size, 1024);
+  EXPECT_EQ(large.latency_nanos.count(), 1);
+  EXPECT_EQ(large.latency_nanos.Percentile(50),
+            LogLinearHistogram::BucketLowerBound(
+                LogLinearHistogram::BucketIndex(5000)));
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,80 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+#include "tink/monitoring/log_linear_histogram.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+#include "absl/numeric/bits.h"
+
+namespace crypto {
+namespace tink {
+
+constexpr int LogLinearHistogram::kSubBucketBits;
+constexpr int LogLinearHistogram::kSubBuckets;
+constexpr int LogLinearHistogram::kNumBuckets;
+
+int LogLinearHistogram::BucketIndex(int64_t value) {
+  if (value < kSubBuckets) return value < 0 ? 0 : static_cast<int>(value);
+  uint64_t unsigned_value = static_cast<uint64_t>(value);
+  // Position of the most significant bit; at least kSubBucketBits.
+  int exponent = 63 - absl::countl_zero(unsigned_value);
+  int sub_bucket = static_cast<int>((unsigned_value >>
+                                     (exponent - kSubBucketBits)) &
+                                    (kSubBuckets - 1));
+  return (exponent - kSubBucketBits + 1) * kSubBuckets + sub_bucket;
+}
+
+int64_t LogLinearHistogram::BucketLowerBound(int index) {
+  if (index < kSubBuckets) return index;
+  int exponent = index / kSubBuckets + kSubBucketBits - 1;
+  int64_t sub_bucket = index % kSubBuckets;
+  return (kSubBuckets + sub_bucket) << (exponent - kSubBucketBits);
+}
+
+LogLinearHistogram::Snapshot LogLinearHistogram::GetSnapshot() const {
+  Snapshot snapshot;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    int64_t count = buckets_[i].load(std::memory_order_relaxed);
+    snapshot.bucket_counts_[i] = count;
+    snapshot.count_ += count;
+  }
+  return snapshot;
+}
+
+void LogLinearHistogram::Snapshot::Merge(const Snapshot& other) {
+  for (int i = 0; i < kNumBuckets; ++i) {
+    bucket_counts_[i] += other.bucket_counts_[i];
+  }
+  count_ += other.count_;
+}
+
+int64_t LogLinearHistogram::Snapshot::Percentile(double percentile) const {
+  if (count_ == 0) return 0;
+  // Number of values which must be at or below the returned bucket.
+  int64_t rank = static_cast<int64_t>(std::ceil(percentile / 100 * count_));
+  if (rank < 1) rank = 1;
+  int64_t cumulative_count = 0;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    cumulative_count += bucket_counts_[i];
+    if (cumulative_count >= rank) return BucketLowerBound(i);
+  }
+  return BucketLowerBound(kNumBuckets - 1);
+}
+
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,94 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+#ifndef TINK_MONITORING_LOG_LINEAR_HISTOGRAM_H_
+#define TINK_MONITORING_LOG_LINEAR_HISTOGRAM_H_
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace crypto {
+namespace tink {
+
+// Lock-free histogram of non-negative integer values (e.g., latencies in
+// nanoseconds) with log-linear buckets: every power of two is split into
+// kSubBuckets buckets of equal width, so that the relative error of any
+// reported value is below 1 / kSubBuckets, independently of its magnitude.
+//
+// Record() is a single relaxed atomic increment and can be called
+// concurrently from any number of threads.
+class LogLinearHistogram {
+ public:
+  static constexpr int kSubBucketBits = 3;
+  static constexpr int kSubBuckets = 1 << kSubBucketBits;
+  // Values 0 to kSubBuckets - 1 have a bucket each; every power of two from
+  // 2^kSubBucketBits up to 2^62 is split into kSubBuckets buckets.
+  static constexpr int kNumBuckets = (63 - kSubBucketBits + 1) * kSubBuckets;
+
+  // Immutable copy of the bucket counts of a histogram.
+  class Snapshot {
+   public:
+    Snapshot() : bucket_counts_(kNumBuckets, 0) {}
+
+    // Adds the counts of `other` to this snapshot.
+    void Merge(const Snapshot& other);
+
+    // Returns the total number of recorded values.
+    int64_t count() const { return count_; }
+
+    // Returns the number of recorded values in bucket `index`.
+    int64_t bucket_count(int index) const { return bucket_counts_[index]; }
+
+    // Returns the lower bound of the bucket containing the `percentile`
+    // (in [0, 100]) of the recorded values, or 0 if the snapshot is empty.
+    int64_t Percentile(double percentile) const;
+
+   private:
+    friend class LogLinearHistogram;
+
+    int64_t count_ = 0;
+    std::vector<int64_t> bucket_counts_;
+  };
+
+  LogLinearHistogram() = default;
+
+  // Not copyable or movable.
+  LogLinearHistogram(const LogLinearHistogram&) = delete;
+  LogLinearHistogram& operator=(const LogLinearHistogram&) = delete;
+
+  // Records `value`. Negative values are recorded as 0.
+  void Record(int64_t value) {
+    buckets_[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Returns the current counts. Concurrent calls to Record() may or may not be
+  // reflected.
+  Snapshot GetSnapshot() const;
+
+  // Returns the index of the bucket containing `value`.
+  static int BucketIndex(int64_t value);
+
+  // Returns the smallest value in bucket `index`.
+  static int64_t BucketLowerBound(int index);
+
+ private:
+  std::atomic<int64_t> buckets_[kNumBuckets] = {};
+};
+
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_MONITORING_LOG_LINEAR_HISTOGRAM_H_
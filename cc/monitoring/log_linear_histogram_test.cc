@@ -0,0 +1,113 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+#include "tink/monitoring/log_linear_histogram.h"
+
+#include <cstdint>
+#include <limits>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace crypto {
+namespace tink {
+namespace {
+
+TEST(LogLinearHistogramTest, SmallValuesHaveOwnBuckets) {
+  for (int64_t value = 0; value < LogLinearHistogram::kSubBuckets; ++value) {
+    int index = LogLinearHistogram::BucketIndex(value);
+    EXPECT_EQ(index, value);
+    EXPECT_EQ(LogLinearHistogram::BucketLowerBound(index), value);
+  }
+  EXPECT_EQ(LogLinearHistogram::BucketIndex(-5), 0);
+}
+
+TEST(LogLinearHistogramTest, BucketBoundsAreConsistent) {
+  for (int index = 0; index < LogLinearHistogram::kNumBuckets; ++index) {
+    int64_t lower_bound = LogLinearHistogram::BucketLowerBound(index);
+    EXPECT_EQ(LogLinearHistogram::BucketIndex(lower_bound), index);
+    if (index > 0) {
+      EXPECT_EQ(LogLinearHistogram::BucketIndex(lower_bound - 1), index - 1);
+    }
+  }
+  EXPECT_EQ(
+      LogLinearHistogram::BucketIndex(std::numeric_limits<int64_t>::max()),
+      LogLinearHistogram::kNumBuckets - 1);
+}
+
+TEST(LogLinearHistogramTest, RelativeErrorIsBounded) {
+  for (int64_t value : {9, 100, 1234, 99999, 123456789}) {
+    int64_t lower_bound = LogLinearHistogram::BucketLowerBound(
+        LogLinearHistogram::BucketIndex(value));
+    EXPECT_LE(lower_bound, value);
+    EXPECT_LT(value - lower_bound,
+              lower_bound / LogLinearHistogram::kSubBuckets + 1);
+  }
+}
+
+TEST(LogLinearHistogramTest, SnapshotAndPercentiles) {
+  LogLinearHistogram histogram;
+  EXPECT_EQ(histogram.GetSnapshot().count(), 0);
+  EXPECT_EQ(histogram.GetSnapshot().Percentile(50), 0);
+
+  for (int i = 0; i < 99; ++i) histogram.Record(5);
+  histogram.Record(1000);
+
+  LogLinearHistogram::Snapshot snapshot = histogram.GetSnapshot();
+  EXPECT_EQ(snapshot.count(), 100);
+  EXPECT_EQ(snapshot.bucket_count(5), 99);
+  EXPECT_EQ(snapshot.Percentile(0), 5);
+  EXPECT_EQ(snapshot.Percentile(50), 5);
+  EXPECT_EQ(snapshot.Percentile(99), 5);
+  EXPECT_EQ(snapshot.Percentile(100),
+            LogLinearHistogram::BucketLowerBound(
+                LogLinearHistogram::BucketIndex(1000)));
+}
+
+TEST(LogLinearHistogramTest, Merge) {
+  LogLinearHistogram first;
+  first.Record(1);
+  first.Record(100);
+  LogLinearHistogram second;
+  second.Record(100);
+
+  LogLinearHistogram::Snapshot snapshot = first.GetSnapshot();
+  snapshot.Merge(second.GetSnapshot());
+  EXPECT_EQ(snapshot.count(), 3);
+  EXPECT_EQ(snapshot.bucket_count(1), 1);
+  EXPECT_EQ(snapshot.bucket_count(LogLinearHistogram::BucketIndex(100)), 2);
+}
+
+TEST(LogLinearHistogramTest, ConcurrentRecords) {
+  constexpr int kNumThreads = 16;
+  constexpr int kNumRecords = 1000;
+  LogLinearHistogram histogram;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([&histogram, i]() {
+      for (int j = 0; j < kNumRecords; ++j) histogram.Record(i);
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(histogram.GetSnapshot().count(), kNumThreads * kNumRecords);
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
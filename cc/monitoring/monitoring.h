@@ -22,6 +22,7 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/time/time.h"
 #include "tink/internal/key_status_util.h"
 #include "tink/key_status.h"
 #include "tink/util/statusor.h"
@@ -137,6 +138,21 @@ class MonitoringClient {
   virtual void LogFailure() = 0;
 };
 
+// Extension of MonitoringClient for clients which also want to know how long
+// cryptographic operations take. For clients implementing this interface, Tink
+// primitive wrappers measure the duration of every successful operation and
+// report it with LogLatency() right after the corresponding call to Log(). For
+// other clients, wrappers do not read the clock at all.
+class TimedMonitoringClient : public MonitoringClient {
+ public:
+  // Logs that a successful operation with `key_id` on an input of
+  // `num_bytes_as_input` took `latency`. The latency is measured by the
+  // wrapper, and hence includes, e.g., trying other keys of the keyset. This is
+  // called on each cryptographic operation, so implementations should be cheap.
+  virtual void LogLatency(uint32_t key_id, int64_t num_bytes_as_input,
+                          absl::Duration latency) = 0;
+};
+
 // Interface for a factory class that creates monitoring clients.
 class MonitoringClientFactory {
  public:
@@ -19,6 +19,7 @@
 #include <cstdint>
 
 #include "gmock/gmock.h"
+#include "absl/time/time.h"
 #include "tink/monitoring/monitoring.h"
 
 namespace crypto {
@@ -39,6 +40,18 @@ class MockMonitoringClient : public MonitoringClient {
   MOCK_METHOD(void, LogFailure, (), (override));
 };
 
+// Mock TimedMonitoringClient class.
+class MockTimedMonitoringClient : public TimedMonitoringClient {
+ public:
+  MOCK_METHOD(void, Log, (uint32_t key_id, int64_t num_bytes_as_input),
+              (override));
+  MOCK_METHOD(void, LogFailure, (), (override));
+  MOCK_METHOD(void, LogLatency,
+              (uint32_t key_id, int64_t num_bytes_as_input,
+               absl::Duration latency),
+              (override));
+};
+
 }  // namespace tink
 }  // namespace crypto
 
@@ -46,7 +46,11 @@ class MonitoredPrf : public Prf {
  public:
   explicit MonitoredPrf(uint32_t key_id, const Prf* prf,
                         MonitoringClient* monitoring_client)
-      : key_id_(key_id), prf_(prf), monitoring_client_(monitoring_client) {}
+      : key_id_(key_id),
+        prf_(prf),
+        monitoring_client_(monitoring_client),
+        timed_monitoring_client_(
+            internal::AsTimedMonitoringClient(monitoring_client)) {}
   ~MonitoredPrf() override = default;
 
   MonitoredPrf(MonitoredPrf&& other) = default;
@@ -57,6 +61,7 @@ class MonitoredPrf : public Prf {
 
   util::StatusOr<std::string> Compute(absl::string_view input,
                                       size_t output_length) const override {
+    internal::MonitoringLatencyTimer timer(timed_monitoring_client_);
     util::StatusOr<std::string> result = prf_->Compute(input, output_length);
     if (!result.ok()) {
       if (monitoring_client_ != nullptr) {
@@ -67,6 +72,7 @@ class MonitoredPrf : public Prf {
 
     if (monitoring_client_ != nullptr) {
       monitoring_client_->Log(key_id_, input.size());
+      timer.LogLatency(key_id_, input.size());
     }
     return result.value();
   }
@@ -75,6 +81,8 @@ class MonitoredPrf : public Prf {
   uint32_t key_id_;
   const Prf* prf_;
   MonitoringClient* monitoring_client_;
+  // Set if monitoring_client_ also records latencies.
+  TimedMonitoringClient* timed_monitoring_client_;
 };
 
 class PrfSetPrimitiveWrapper : public PrfSet {
@@ -18,6 +18,9 @@
 #define TINK_PRIMITIVE_SET_H_
 
 #include <algorithm>
+#include <atomic>
+#include <functional>
+#include <limits>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -26,6 +29,7 @@
 
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/synchronization/mutex.h"
@@ -58,31 +62,90 @@ namespace tink {
 template <class P>
 class PrimitiveSet {
  public:
+  // Function used to instantiate the primitive of a lazily added entry from
+  // the KeyData of its key.
+  typedef std::function<crypto::tink::util::StatusOr<std::unique_ptr<P>>(
+      const google::crypto::tink::KeyData& key_data)>
+      PrimitiveGetter;
+
   // Entry-objects hold individual instances of primitives in the set.
+  //
+  // An entry is either created with an instantiated primitive (see New()), or
+  // lazily (see NewLazy()), in which case it only holds the KeyData of the key
+  // until the primitive is requested for the first time.
   template <class P2>
   class Entry {
    public:
     static crypto::tink::util::StatusOr<std::unique_ptr<Entry<P>>> New(
         std::unique_ptr<P> primitive,
         const google::crypto::tink::KeysetInfo::KeyInfo& key_info) {
-      if (key_info.status() != google::crypto::tink::KeyStatusType::ENABLED) {
-        return util::Status(absl::StatusCode::kInvalidArgument,
-                            "The key must be ENABLED.");
-      }
-      auto identifier_result = CryptoFormat::GetOutputPrefix(key_info);
-      if (!identifier_result.ok()) return identifier_result.status();
+      auto entry = NewImpl(key_info);
+      if (!entry.ok()) return entry.status();
       if (primitive == nullptr) {
         return util::Status(absl::StatusCode::kInvalidArgument,
                             "The primitive must be non-null.");
       }
-      std::string identifier = identifier_result.value();
-      return absl::WrapUnique(new Entry(std::move(primitive), identifier,
-                                        key_info.status(), key_info.key_id(),
-                                        key_info.output_prefix_type(),
-                                        key_info.type_url()));
+      (*entry)->primitive_ = std::move(primitive);
+      (*entry)->primitive_ptr_.store((*entry)->primitive_.get(),
+                                     std::memory_order_release);
+      return entry;
     }
 
-    P2& get_primitive() const { return *primitive_; }
+    // Creates an entry whose primitive is only created from `key_data` using
+    // `primitive_getter` the first time it is requested through
+    // get_or_create_primitive(). The outcome of this (single) attempt is
+    // remembered, and `key_data` is released afterwards.
+    static crypto::tink::util::StatusOr<std::unique_ptr<Entry<P>>> NewLazy(
+        const google::crypto::tink::KeyData& key_data,
+        PrimitiveGetter primitive_getter,
+        const google::crypto::tink::KeysetInfo::KeyInfo& key_info) {
+      auto entry = NewImpl(key_info);
+      if (!entry.ok()) return entry.status();
+      if (primitive_getter == nullptr) {
+        return util::Status(absl::StatusCode::kInvalidArgument,
+                            "The primitive getter must be non-null.");
+      }
+      (*entry)->lazy_state_ = absl::make_unique<LazyState>();
+      (*entry)->lazy_state_->key_data = key_data;
+      (*entry)->lazy_state_->primitive_getter = std::move(primitive_getter);
+      return entry;
+    }
+
+    // Returns the primitive of this entry. For lazily created entries, this
+    // instantiates the primitive if needed, and must only be used if the
+    // instantiation cannot fail; otherwise use get_or_create_primitive().
+    P2& get_primitive() const { return **get_or_create_primitive(); }
+
+    // Returns the primitive of this entry, instantiating it first if the entry
+    // was created lazily. Concurrent callers wait for a single instantiation,
+    // and subsequent calls do not lock.
+    crypto::tink::util::StatusOr<P2*> get_or_create_primitive() const {
+      P2* primitive = primitive_ptr_.load(std::memory_order_acquire);
+      if (primitive != nullptr) return primitive;
+      if (lazy_state_ == nullptr) {
+        return util::Status(absl::StatusCode::kInternal,
+                            "Entry has no primitive.");
+      }
+      absl::MutexLock lock(&lazy_state_->mutex);
+      if (!lazy_state_->instantiated) {
+        lazy_state_->instantiated = true;
+        crypto::tink::util::StatusOr<std::unique_ptr<P>> created =
+            lazy_state_->primitive_getter(lazy_state_->key_data);
+        if (!created.ok()) {
+          lazy_state_->status = created.status();
+        } else if (*created == nullptr) {
+          lazy_state_->status = util::Status(
+              absl::StatusCode::kInternal, "The primitive must be non-null.");
+        } else {
+          primitive_ = *std::move(created);
+          primitive_ptr_.store(primitive_.get(), std::memory_order_release);
+        }
+        lazy_state_->key_data.Clear();
+        lazy_state_->primitive_getter = nullptr;
+      }
+      if (!lazy_state_->status.ok()) return lazy_state_->status;
+      return primitive_.get();
+    }
 
     const std::string& get_identifier() const { return identifier_; }
 
@@ -97,18 +160,46 @@ class PrimitiveSet {
     absl::string_view get_key_type_url() const { return key_type_url_; }
 
    private:
-    Entry(std::unique_ptr<P2> primitive, const std::string& identifier,
+    // State needed to instantiate the primitive of a lazily created entry.
+    struct LazyState {
+      absl::Mutex mutex;
+      bool instantiated ABSL_GUARDED_BY(mutex) = false;
+      google::crypto::tink::KeyData key_data ABSL_GUARDED_BY(mutex);
+      PrimitiveGetter primitive_getter ABSL_GUARDED_BY(mutex);
+      crypto::tink::util::Status status ABSL_GUARDED_BY(mutex);
+    };
+
+    static crypto::tink::util::StatusOr<std::unique_ptr<Entry<P>>> NewImpl(
+        const google::crypto::tink::KeysetInfo::KeyInfo& key_info) {
+      if (key_info.status() != google::crypto::tink::KeyStatusType::ENABLED) {
+        return util::Status(absl::StatusCode::kInvalidArgument,
+                            "The key must be ENABLED.");
+      }
+      auto identifier_result = CryptoFormat::GetOutputPrefix(key_info);
+      if (!identifier_result.ok()) return identifier_result.status();
+      std::string identifier = identifier_result.value();
+      return absl::WrapUnique(new Entry(identifier, key_info.status(),
+                                        key_info.key_id(),
+                                        key_info.output_prefix_type(),
+                                        key_info.type_url()));
+    }
+
+    Entry(const std::string& identifier,
           google::crypto::tink::KeyStatusType status, uint32_t key_id,
           google::crypto::tink::OutputPrefixType output_prefix_type,
           absl::string_view key_type_url)
-        : primitive_(std::move(primitive)),
-          identifier_(identifier),
+        : identifier_(identifier),
           status_(status),
           key_id_(key_id),
           output_prefix_type_(output_prefix_type),
           key_type_url_(key_type_url) {}
 
-    std::unique_ptr<P> primitive_;
+    // Owns the primitive; for lazy entries, only set once instantiated.
+    mutable std::unique_ptr<P> primitive_;
+    // Equal to primitive_.get() once the primitive is available.
+    mutable std::atomic<P2*> primitive_ptr_{nullptr};
+    // Set only for lazily created entries.
+    std::unique_ptr<LazyState> lazy_state_;
     std::string identifier_;
     google::crypto::tink::KeyStatusType status_;
     uint32_t key_id_;
@@ -119,6 +210,8 @@ class PrimitiveSet {
   typedef std::vector<std::unique_ptr<Entry<P>>> Primitives;
   typedef std::unordered_map<std::string, Primitives>
       CiphertextPrefixToPrimitivesMap;
+  // Entries in the order in which they should be tried.
+  typedef absl::InlinedVector<Entry<P>*, 16> OrderedEntries;
 
  private:
   // Helper methods for mutations, used by the Builder and the deprecated
@@ -158,6 +251,20 @@ class PrimitiveSet {
     return primitives[identifier].back().get();
   }
 
+  static crypto::tink::util::StatusOr<Entry<P>*> AddLazyPrimitiveImpl(
+      const google::crypto::tink::KeyData& key_data,
+      PrimitiveGetter primitive_getter,
+      const google::crypto::tink::KeysetInfo::KeyInfo& key_info,
+      CiphertextPrefixToPrimitivesMap& primitives) {
+    auto entry_or =
+        Entry<P>::NewLazy(key_data, std::move(primitive_getter), key_info);
+    if (!entry_or.ok()) return entry_or.status();
+
+    std::string identifier = entry_or.value()->get_identifier();
+    primitives[identifier].push_back(std::move(entry_or.value()));
+    return primitives[identifier].back().get();
+  }
+
  public:
   // Builder is used to construct PrimitiveSet objects. Objects returned by the
   // builder are immutable. Calling any of the non-const methods on them will
@@ -181,6 +288,31 @@ class PrimitiveSet {
       return std::move(AddPrimitive(std::move(primitive), key_info));
     }
 
+    // Adds an entry for the specified 'key' to this set, whose primitive is
+    // only created from 'key_data' using 'primitive_getter' when it is first
+    // needed. Errors creating the primitive are hence not reported here, but
+    // when the entry is used. Wrappers only handle such entries if they
+    // support it (see PrimitiveWrapper::SupportsLazyPrimitives()).
+    Builder& AddLazyPrimitive(
+        const google::crypto::tink::KeyData& key_data,
+        PrimitiveGetter primitive_getter,
+        const google::crypto::tink::KeysetInfo::KeyInfo& key_info) & {
+      absl::MutexLock lock(&mutex_);
+      if (!status_.ok()) return *this;
+      status_ = AddLazyPrimitiveImpl(key_data, std::move(primitive_getter),
+                                     key_info, primitives_)
+                    .status();
+      return *this;
+    }
+
+    Builder&& AddLazyPrimitive(
+        const google::crypto::tink::KeyData& key_data,
+        PrimitiveGetter primitive_getter,
+        const google::crypto::tink::KeysetInfo::KeyInfo& key_info) && {
+      return std::move(
+          AddLazyPrimitive(key_data, std::move(primitive_getter), key_info));
+    }
+
     // Adds 'primitive' to this set for the specified 'key' and marks it
     // primary.
     Builder& AddPrimaryPrimitive(
@@ -217,11 +349,24 @@ class PrimitiveSet {
       return std::move(AddAnnotations(std::move(annotations)));
     }
 
+    // Makes the built set track which entries with RAW output prefix
+    // successfully decrypted or verified data, and return them in an adaptive
+    // order from get_raw_primitives_in_trial_order().
+    Builder& EnableAdaptiveRawOrder() & {
+      absl::MutexLock lock(&mutex_);
+      adaptive_raw_order_ = true;
+      return *this;
+    }
+
+    Builder&& EnableAdaptiveRawOrder() && {
+      return std::move(EnableAdaptiveRawOrder());
+    }
+
     crypto::tink::util::StatusOr<PrimitiveSet<P>> Build() && {
       absl::MutexLock lock(&mutex_);
       if (!status_.ok()) return status_;
       return PrimitiveSet<P>(std::move(primitives_), primary_,
-                             std::move(annotations_));
+                             std::move(annotations_), adaptive_raw_order_);
     }
 
    private:
@@ -230,6 +375,7 @@ class PrimitiveSet {
     CiphertextPrefixToPrimitivesMap primitives_ ABSL_GUARDED_BY(mutex_);
     absl::flat_hash_map<std::string, std::string> annotations_
         ABSL_GUARDED_BY(mutex_);
+    bool adaptive_raw_order_ ABSL_GUARDED_BY(mutex_) = false;
     absl::Mutex mutex_;
     crypto::tink::util::Status status_ ABSL_GUARDED_BY(mutex_);
   };
@@ -287,6 +433,33 @@ class PrimitiveSet {
     return get_primitives(CryptoFormat::kRawPrefix);
   }
 
+  // Returns the entries that use RAW prefix, in the order in which they should
+  // be tried when decrypting or verifying data. This is their insertion order,
+  // unless the set was built with Builder::EnableAdaptiveRawOrder(): then the
+  // entry that most recently succeeded comes first, followed by the others in
+  // decreasing order of their (approximate) number of successes. Callers must
+  // report successes with RecordRawPrimitiveSuccess(). Only the order depends
+  // on these statistics, so the result of trying all entries does not.
+  OrderedEntries get_raw_primitives_in_trial_order() const {
+    OrderedEntries entries;
+    crypto::tink::util::StatusOr<const Primitives*> raw_primitives =
+        get_raw_primitives();
+    if (!raw_primitives.ok()) return entries;
+    for (const std::unique_ptr<Entry<P>>& entry : **raw_primitives) {
+      entries.push_back(entry.get());
+    }
+    if (adaptive_raw_order_ == nullptr || entries.size() < 2) return entries;
+    adaptive_raw_order_->Order(entries);
+    return entries;
+  }
+
+  // Records that `entry`, which uses RAW prefix, successfully decrypted or
+  // verified data. Does nothing unless adaptive RAW order is enabled.
+  void RecordRawPrimitiveSuccess(const Entry<P>* entry) const {
+    if (adaptive_raw_order_ == nullptr) return;
+    adaptive_raw_order_->RecordSuccess(entry);
+  }
+
   // Sets the given 'primary' as the primary primitive of this set.
   ABSL_DEPRECATED(
       "Mutating PrimitiveSets after construction is deprecated. Use "
@@ -328,11 +501,75 @@ class PrimitiveSet {
   // Constructs an empty PrimitiveSet.
   // Note: This is equivalent to PrimitiveSet<P>(/*annotations=*/{}).
   PrimitiveSet(CiphertextPrefixToPrimitivesMap primitives, Entry<P>* primary,
-               absl::flat_hash_map<std::string, std::string> annotations)
+               absl::flat_hash_map<std::string, std::string> annotations,
+               bool adaptive_raw_order)
       : primary_(primary),
         primitives_mutex_(nullptr),
         primitives_(std::move(primitives)),
-        annotations_(std::move(annotations)) {}
+        annotations_(std::move(annotations)) {
+    auto raw_primitives =
+        primitives_.find(std::string(CryptoFormat::kRawPrefix));
+    if (adaptive_raw_order && raw_primitives != primitives_.end()) {
+      adaptive_raw_order_ =
+          absl::make_unique<AdaptiveRawOrder>(raw_primitives->second);
+    }
+  }
+
+  // Lock-free statistics about which RAW entries succeed, used to order them.
+  // Sets with adaptive RAW order are immutable, so the RAW entries are fixed.
+  class AdaptiveRawOrder {
+   public:
+    explicit AdaptiveRawOrder(const Primitives& raw_primitives)
+        : num_successes_(new std::atomic<int64_t>[raw_primitives.size()]) {
+      for (const std::unique_ptr<Entry<P>>& entry : raw_primitives) {
+        num_successes_[raw_entries_.size()].store(0,
+                                                  std::memory_order_relaxed);
+        raw_entries_.push_back(entry.get());
+      }
+    }
+
+    void RecordSuccess(const Entry<P>* entry) {
+      // When the same entry keeps succeeding, it is already tried first, so
+      // this only reads shared state and does not contend between threads.
+      if (last_success_.load(std::memory_order_relaxed) == entry) return;
+      last_success_.store(entry, std::memory_order_relaxed);
+      for (size_t i = 0; i < raw_entries_.size(); ++i) {
+        if (raw_entries_[i] == entry) {
+          num_successes_[i].fetch_add(1, std::memory_order_relaxed);
+          return;
+        }
+      }
+    }
+
+    // Reorders `entries`, which must be the RAW entries in insertion order.
+    void Order(OrderedEntries& entries) const {
+      // Take a snapshot of the statistics, so that concurrent updates do not
+      // affect the comparisons made by the sort.
+      const Entry<P>* last_success =
+          last_success_.load(std::memory_order_relaxed);
+      absl::InlinedVector<int64_t, 16> scores(entries.size());
+      for (size_t i = 0; i < entries.size(); ++i) {
+        scores[i] = entries[i] == last_success
+                        ? std::numeric_limits<int64_t>::max()
+                        : num_successes_[i].load(std::memory_order_relaxed);
+      }
+      absl::InlinedVector<size_t, 16> order(entries.size());
+      for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+      std::stable_sort(order.begin(), order.end(),
+                       [&scores](size_t a, size_t b) {
+                         return scores[a] > scores[b];
+                       });
+      OrderedEntries unordered = entries;
+      for (size_t i = 0; i < order.size(); ++i) {
+        entries[i] = unordered[order[i]];
+      }
+    }
+
+   private:
+    std::vector<const Entry<P>*> raw_entries_;
+    std::unique_ptr<std::atomic<int64_t>[]> num_successes_;
+    std::atomic<const Entry<P>*> last_success_{nullptr};
+  };
 
   // The Entry<P> object is owned by primitives_
   Entry<P>* primary_ ABSL_GUARDED_BY(primitives_mutex_) = nullptr;
@@ -345,6 +582,9 @@ class PrimitiveSet {
 
   // Annotations for the set of primitives.
   absl::flat_hash_map<std::string, std::string> annotations_;
+
+  // Only set if adaptive RAW order is enabled and there are RAW entries.
+  std::unique_ptr<AdaptiveRawOrder> adaptive_raw_order_;
 };
 
 }  // namespace tink
@@ -37,6 +37,12 @@ class PrimitiveWrapper {
   virtual ~PrimitiveWrapper() = default;
   virtual crypto::tink::util::StatusOr<std::unique_ptr<Primitive>> Wrap(
       std::unique_ptr<PrimitiveSet<InputPrimitive>> primitive_set) const = 0;
+
+  // Returns true if Wrap() accepts primitive sets in which the non-primary
+  // entries were added lazily (see PrimitiveSet::Builder::AddLazyPrimitive),
+  // i.e., if the wrapper obtains their primitives through
+  // Entry::get_or_create_primitive() and handles failures.
+  virtual bool SupportsLazyPrimitives() const { return false; }
 };
 
 }  // namespace tink
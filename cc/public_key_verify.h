@@ -17,7 +17,12 @@
 #ifndef TINK_PUBLIC_KEY_VERIFY_H_
 #define TINK_PUBLIC_KEY_VERIFY_H_
 
+#include <cstddef>
+#include <vector>
+
+#include "absl/status/status.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tink/util/status.h"
 
 namespace crypto {
@@ -38,6 +43,31 @@ class PublicKeyVerify {
       absl::string_view signature,
       absl::string_view data) const = 0;
 
+  // Verifies that each of 'signatures' is a digital signature for the element
+  // of 'data' at the same position, and returns one status per signature, in
+  // the same order. An invalid signature does not affect the others. If
+  // 'signatures' and 'data' have different sizes, all statuses are errors.
+  //
+  // The default implementation calls Verify() for each signature;
+  // implementations may share work across the batch.
+  virtual std::vector<crypto::tink::util::Status> VerifyBatch(
+      absl::Span<const absl::string_view> signatures,
+      absl::Span<const absl::string_view> data) const {
+    if (signatures.size() != data.size()) {
+      return std::vector<crypto::tink::util::Status>(
+          signatures.size(),
+          crypto::tink::util::Status(
+              absl::StatusCode::kInvalidArgument,
+              "signatures and data must have the same size"));
+    }
+    std::vector<crypto::tink::util::Status> results;
+    results.reserve(signatures.size());
+    for (std::size_t i = 0; i < signatures.size(); ++i) {
+      results.push_back(Verify(signatures[i], data[i]));
+    }
+    return results;
+  }
+
   virtual ~PublicKeyVerify() = default;
 };
 
@@ -0,0 +1,124 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/signature/internal/ecdsa_nonce_pool.h"
+
+#include <unistd.h>
+
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "openssl/bn.h"
+#include "openssl/ec.h"
+#include "openssl/ecdsa.h"
+#include "tink/internal/err_util.h"
+#include "tink/internal/ssl_unique_ptr.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace internal {
+
+bool EcdsaNoncePool::IsSupported() {
+#ifdef OPENSSL_IS_BORINGSSL
+  return false;
+#else
+  return true;
+#endif
+}
+
+EcdsaNoncePool::EcdsaNoncePool(EC_KEY* key, int capacity)
+    : key_(key), capacity_(capacity), pid_(getpid()) {}
+
+void EcdsaNoncePool::DiscardNoncesAfterFork() {
+  pid_t pid = getpid();
+  if (pid != pid_) {
+    nonces_.clear();
+    pid_ = pid;
+  }
+}
+
+util::StatusOr<int> EcdsaNoncePool::Refill() {
+#ifdef OPENSSL_IS_BORINGSSL
+  return util::Status(absl::StatusCode::kUnimplemented,
+                      "Precomputing ECDSA nonces requires OpenSSL.");
+#else
+  SslUniquePtr<BN_CTX> bn_ctx(BN_CTX_new());
+  if (bn_ctx == nullptr) {
+    return util::Status(absl::StatusCode::kInternal, "BN_CTX_new failed");
+  }
+  int added = 0;
+  while (true) {
+    {
+      absl::MutexLock lock(&mutex_);
+      DiscardNoncesAfterFork();
+      if (nonces_.size() >= capacity_) {
+        return added;
+      }
+    }
+    // The nonce is computed without holding the lock, so that signing is not
+    // blocked while the pool is refilled.
+    BIGNUM* kinv = nullptr;
+    BIGNUM* r = nullptr;
+    if (ECDSA_sign_setup(key_, bn_ctx.get(), &kinv, &r) != 1) {
+      return util::Status(
+          absl::StatusCode::kInternal,
+          absl::StrCat("ECDSA_sign_setup failed: ", GetSslErrors()));
+    }
+    Nonce nonce = {std::unique_ptr<BIGNUM, ClearingBnDeleter>(kinv),
+                   SslUniquePtr<BIGNUM>(r)};
+    absl::MutexLock lock(&mutex_);
+    DiscardNoncesAfterFork();
+    if (nonces_.size() >= capacity_) {
+      return added;
+    }
+    nonces_.push_back(std::move(nonce));
+    ++added;
+  }
+#endif
+}
+
+SslUniquePtr<ECDSA_SIG> EcdsaNoncePool::Sign(absl::string_view digest) {
+#ifdef OPENSSL_IS_BORINGSSL
+  return nullptr;
+#else
+  Nonce nonce;
+  {
+    absl::MutexLock lock(&mutex_);
+    DiscardNoncesAfterFork();
+    if (nonces_.empty()) {
+      return nullptr;
+    }
+    nonce = std::move(nonces_.back());
+    nonces_.pop_back();
+  }
+  return SslUniquePtr<ECDSA_SIG>(
+      ECDSA_do_sign_ex(reinterpret_cast<const uint8_t*>(digest.data()),
+                       digest.size(), nonce.kinv.get(), nonce.r.get(), key_));
+#endif
+}
+
+int EcdsaNoncePool::size() {
+  absl::MutexLock lock(&mutex_);
+  DiscardNoncesAfterFork();
+  return nonces_.size();
+}
+
+}  // namespace internal
+}  // namespace tink
+}  // namespace crypto
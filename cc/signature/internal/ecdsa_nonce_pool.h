@@ -0,0 +1,106 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TINK_SIGNATURE_INTERNAL_ECDSA_NONCE_POOL_H_
+#define TINK_SIGNATURE_INTERNAL_ECDSA_NONCE_POOL_H_
+
+#include <sys/types.h>
+
+#include <memory>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "openssl/bn.h"
+#include "openssl/ec.h"
+#include "openssl/ecdsa.h"
+#include "tink/internal/ssl_unique_ptr.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace internal {
+
+// Pool of precomputed ECDSA signing nonces for one private key.
+//
+// An entry holds r = x(k*G) mod n and k^-1 mod n for a fresh random nonce k,
+// which is the expensive part of a signature that does not depend on the
+// message. Refill() computes entries, and is meant to be called from a
+// background thread while the signer is idle. Each entry is used by at most
+// one call to Sign(), and is removed from the pool before it is used. After
+// a fork(), the child process never uses entries computed by its parent.
+//
+// Precomputation requires ECDSA_sign_setup() and ECDSA_do_sign_ex(), which
+// BoringSSL does not provide. With BoringSSL the pool stays empty and Sign()
+// always returns nullptr.
+//
+// The values of k^-1 are cleared when they are freed. OpenSSL allocates them
+// in its secure heap, so they are kept in locked memory if the application
+// enabled the secure heap with CRYPTO_secure_malloc_init().
+//
+// This class is thread-safe.
+class EcdsaNoncePool {
+ public:
+  // Returns true if nonces can be precomputed with the linked SSL library.
+  static bool IsSupported();
+
+  // Creates a pool of at most `capacity` nonces for `key`, which must hold a
+  // private key and outlive the pool.
+  EcdsaNoncePool(EC_KEY* key, int capacity);
+
+  // Not copyable or movable.
+  EcdsaNoncePool(const EcdsaNoncePool&) = delete;
+  EcdsaNoncePool& operator=(const EcdsaNoncePool&) = delete;
+
+  // Precomputes nonces until the pool is full, and returns the number of
+  // nonces that were added.
+  util::StatusOr<int> Refill();
+
+  // Signs `digest` with a precomputed nonce. Returns nullptr if the pool is
+  // empty or if signing fails, in which case the caller should sign without
+  // a precomputed nonce.
+  SslUniquePtr<ECDSA_SIG> Sign(absl::string_view digest);
+
+  // Returns the number of precomputed nonces in the pool.
+  int size();
+
+ private:
+  struct ClearingBnDeleter {
+    void operator()(BIGNUM* bn) const { BN_clear_free(bn); }
+  };
+
+  struct Nonce {
+    std::unique_ptr<BIGNUM, ClearingBnDeleter> kinv;
+    SslUniquePtr<BIGNUM> r;
+  };
+
+  // Discards the nonces if they were computed by another process.
+  void DiscardNoncesAfterFork() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  EC_KEY* const key_;
+  const int capacity_;
+  absl::Mutex mutex_;
+  // Process that computed `nonces_`.
+  pid_t pid_ ABSL_GUARDED_BY(mutex_);
+  std::vector<Nonce> nonces_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace internal
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_SIGNATURE_INTERNAL_ECDSA_NONCE_POOL_H_
@@ -0,0 +1,125 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "tink/signature/internal/ecdsa_nonce_pool.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "openssl/bn.h"
+#include "openssl/ec.h"
+#include "openssl/ecdsa.h"
+#include "tink/internal/ssl_unique_ptr.h"
+#include "tink/util/test_matchers.h"
+
+namespace crypto {
+namespace tink {
+namespace internal {
+namespace {
+
+using ::crypto::tink::test::IsOkAndHolds;
+using ::crypto::tink::test::StatusIs;
+using ::testing::Eq;
+using ::testing::IsNull;
+using ::testing::Ne;
+using ::testing::NotNull;
+
+constexpr char kDigest[] = "0123456789abcdef0123456789abcdef";
+
+SslUniquePtr<EC_KEY> NewP256Key() {
+  SslUniquePtr<EC_KEY> key(EC_KEY_new_by_curve_name(NID_X9_62_prime256v1));
+  if (key == nullptr || EC_KEY_generate_key(key.get()) != 1) {
+    return nullptr;
+  }
+  return key;
+}
+
+TEST(EcdsaNoncePoolTest, RefillFillsPool) {
+  SslUniquePtr<EC_KEY> key = NewP256Key();
+  ASSERT_THAT(key, NotNull());
+  EcdsaNoncePool pool(key.get(), /*capacity=*/5);
+  if (!EcdsaNoncePool::IsSupported()) {
+    EXPECT_THAT(pool.Refill().status(),
+                StatusIs(absl::StatusCode::kUnimplemented));
+    EXPECT_THAT(pool.Sign(kDigest), IsNull());
+    GTEST_SKIP() << "Nonces cannot be precomputed with this SSL library.";
+  }
+  EXPECT_THAT(pool.size(), Eq(0));
+  EXPECT_THAT(pool.Refill(), IsOkAndHolds(5));
+  EXPECT_THAT(pool.size(), Eq(5));
+  EXPECT_THAT(pool.Refill(), IsOkAndHolds(0));
+}
+
+TEST(EcdsaNoncePoolTest, EachNonceIsUsedOnce) {
+  if (!EcdsaNoncePool::IsSupported()) {
+    GTEST_SKIP() << "Nonces cannot be precomputed with this SSL library.";
+  }
+  SslUniquePtr<EC_KEY> key = NewP256Key();
+  ASSERT_THAT(key, NotNull());
+  EcdsaNoncePool pool(key.get(), /*capacity=*/3);
+  ASSERT_THAT(pool.Refill(), IsOkAndHolds(3));
+
+  SslUniquePtr<BIGNUM> previous_r;
+  for (int i = 0; i < 3; ++i) {
+    SslUniquePtr<ECDSA_SIG> sig = pool.Sign(kDigest);
+    ASSERT_THAT(sig, NotNull());
+    EXPECT_THAT(ECDSA_do_verify(reinterpret_cast<const uint8_t*>(kDigest),
+                                sizeof(kDigest) - 1, sig.get(), key.get()),
+                Eq(1));
+    const BIGNUM* r;
+    const BIGNUM* s;
+    ECDSA_SIG_get0(sig.get(), &r, &s);
+    if (previous_r != nullptr) {
+      EXPECT_THAT(BN_cmp(r, previous_r.get()), Ne(0));
+    }
+    previous_r.reset(BN_dup(r));
+    EXPECT_THAT(pool.size(), Eq(2 - i));
+  }
+  // The pool is empty.
+  EXPECT_THAT(pool.Sign(kDigest), IsNull());
+  EXPECT_THAT(pool.Refill(), IsOkAndHolds(3));
+}
+
+TEST(EcdsaNoncePoolTest, ChildProcessDiscardsNonces) {
+  if (!EcdsaNoncePool::IsSupported()) {
+    GTEST_SKIP() << "Nonces cannot be precomputed with this SSL library.";
+  }
+  SslUniquePtr<EC_KEY> key = NewP256Key();
+  ASSERT_THAT(key, NotNull());
+  EcdsaNoncePool pool(key.get(), /*capacity=*/2);
+  ASSERT_THAT(pool.Refill(), IsOkAndHolds(2));
+
+  pid_t pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    bool discarded = pool.Sign(kDigest) == nullptr && pool.size() == 0;
+    _exit(discarded ? 0 : 1);
+  }
+  int status;
+  ASSERT_THAT(waitpid(pid, &status, 0), Eq(pid));
+  ASSERT_TRUE(WIFEXITED(status));
+  EXPECT_THAT(WEXITSTATUS(status), Eq(0));
+  // The parent still has its nonces.
+  EXPECT_THAT(pool.size(), Eq(2));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace tink
+}  // namespace crypto
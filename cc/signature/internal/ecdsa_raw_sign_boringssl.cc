@@ -33,6 +33,7 @@
 #include "tink/internal/md_util.h"
 #include "tink/internal/ssl_unique_ptr.h"
 #include "tink/internal/util.h"
+#include "tink/signature/internal/ecdsa_nonce_pool.h"
 #include "tink/subtle/common_enums.h"
 #include "tink/subtle/subtle_util_boringssl.h"
 #include "tink/util/errors.h"
@@ -89,6 +90,14 @@ crypto::tink::util::StatusOr<std::string> DerToIeee(absl::string_view der,
 util::StatusOr<std::unique_ptr<EcdsaRawSignBoringSsl>>
 EcdsaRawSignBoringSsl::New(const subtle::SubtleUtilBoringSSL::EcKey& ec_key,
                            subtle::EcdsaSignatureEncoding encoding) {
+  return New(ec_key, encoding, /*nonce_pool_capacity=*/0);
+}
+
+// static
+util::StatusOr<std::unique_ptr<EcdsaRawSignBoringSsl>>
+EcdsaRawSignBoringSsl::New(const subtle::SubtleUtilBoringSSL::EcKey& ec_key,
+                           subtle::EcdsaSignatureEncoding encoding,
+                           int nonce_pool_capacity) {
   auto status = internal::CheckFipsCompatibility<EcdsaRawSignBoringSsl>();
   if (!status.ok()) return status;
 
@@ -122,8 +131,13 @@ EcdsaRawSignBoringSsl::New(const subtle::SubtleUtilBoringSSL::EcKey& ec_key,
         absl::StrCat("Invalid private key: ", internal::GetSslErrors()));
   }
 
-  return {
-      absl::WrapUnique(new EcdsaRawSignBoringSsl(std::move(key), encoding))};
+  if (nonce_pool_capacity < 0) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "Nonce pool capacity must not be negative.");
+  }
+
+  return {absl::WrapUnique(new EcdsaRawSignBoringSsl(std::move(key), encoding,
+                                                     nonce_pool_capacity))};
 }
 
 util::StatusOr<std::string> EcdsaRawSignBoringSsl::Sign(
@@ -132,12 +146,24 @@ util::StatusOr<std::string> EcdsaRawSignBoringSsl::Sign(
   // regardless of whether the size is 0.
   data = internal::EnsureStringNonNull(data);
 
-  // Compute the raw signature.
+  // Compute the raw signature, with a precomputed nonce if there is one.
   std::vector<uint8_t> buffer(ECDSA_size(key_.get()));
   unsigned int sig_length;
-  if (1 != ECDSA_sign(0 /* unused */,
-                      reinterpret_cast<const uint8_t*>(data.data()),
-                      data.size(), buffer.data(), &sig_length, key_.get())) {
+  internal::SslUniquePtr<ECDSA_SIG> sig;
+  if (nonce_pool_ != nullptr) {
+    sig = nonce_pool_->Sign(data);
+  }
+  if (sig != nullptr) {
+    uint8_t* der = buffer.data();
+    int der_length = i2d_ECDSA_SIG(sig.get(), &der);
+    if (der_length <= 0) {
+      return util::Status(absl::StatusCode::kInternal, "Signing failed.");
+    }
+    sig_length = der_length;
+  } else if (1 != ECDSA_sign(0 /* unused */,
+                             reinterpret_cast<const uint8_t*>(data.data()),
+                             data.size(), buffer.data(), &sig_length,
+                             key_.get())) {
     return util::Status(absl::StatusCode::kInternal, "Signing failed.");
   }
 
@@ -154,6 +180,14 @@ util::StatusOr<std::string> EcdsaRawSignBoringSsl::Sign(
   return std::string(reinterpret_cast<char*>(buffer.data()), sig_length);
 }
 
+util::StatusOr<int> EcdsaRawSignBoringSsl::RefillNoncePool() const {
+  if (nonce_pool_ == nullptr) {
+    return util::Status(absl::StatusCode::kFailedPrecondition,
+                        "Signer has no nonce pool.");
+  }
+  return nonce_pool_->Refill();
+}
+
 }  // namespace internal
 }  // namespace tink
 }  // namespace crypto
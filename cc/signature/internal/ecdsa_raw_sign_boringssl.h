@@ -21,12 +21,14 @@
 #include <string>
 #include <utility>
 
+#include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
 #include "openssl/ec.h"
 #include "openssl/evp.h"
 #include "tink/internal/fips_utils.h"
 #include "tink/internal/ssl_unique_ptr.h"
 #include "tink/public_key_sign.h"
+#include "tink/signature/internal/ecdsa_nonce_pool.h"
 #include "tink/subtle/common_enums.h"
 #include "tink/subtle/subtle_util_boringssl.h"
 #include "tink/util/statusor.h"
@@ -42,20 +44,42 @@ class EcdsaRawSignBoringSsl : public PublicKeySign {
   New(const crypto::tink::internal::EcKey& ec_key,
       subtle::EcdsaSignatureEncoding encoding);
 
+  // Same as above, but the signer keeps a pool of up to `nonce_pool_capacity`
+  // precomputed nonces, which is filled by RefillNoncePool(). Signing uses a
+  // nonce from the pool when there is one, and computes a new nonce
+  // otherwise. See EcdsaNoncePool.
+  static crypto::tink::util::StatusOr<std::unique_ptr<EcdsaRawSignBoringSsl>>
+  New(const crypto::tink::internal::EcKey& ec_key,
+      subtle::EcdsaSignatureEncoding encoding, int nonce_pool_capacity);
+
   // Computes the signature for 'data'.
   crypto::tink::util::StatusOr<std::string> Sign(
       absl::string_view data) const override;
 
+  // Precomputes nonces until the nonce pool is full, and returns the number
+  // of nonces that were added. Meant to be called from a background thread
+  // while the signer is idle. Returns an error if the signer has no nonce
+  // pool or if the SSL library cannot precompute nonces.
+  crypto::tink::util::StatusOr<int> RefillNoncePool() const;
+
   static constexpr crypto::tink::internal::FipsCompatibility kFipsStatus =
       crypto::tink::internal::FipsCompatibility::kRequiresBoringCrypto;
 
  private:
   EcdsaRawSignBoringSsl(internal::SslUniquePtr<EC_KEY> key,
-                        subtle::EcdsaSignatureEncoding encoding)
-      : key_(std::move(key)), encoding_(encoding) {}
+                        subtle::EcdsaSignatureEncoding encoding,
+                        int nonce_pool_capacity)
+      : key_(std::move(key)), encoding_(encoding) {
+    if (nonce_pool_capacity > 0) {
+      nonce_pool_ =
+          absl::make_unique<EcdsaNoncePool>(key_.get(), nonce_pool_capacity);
+    }
+  }
 
   internal::SslUniquePtr<EC_KEY> key_;
   subtle::EcdsaSignatureEncoding encoding_;
+  // Null if the signer was created without a nonce pool.
+  std::unique_ptr<EcdsaNoncePool> nonce_pool_;
 };
 
 }  // namespace internal
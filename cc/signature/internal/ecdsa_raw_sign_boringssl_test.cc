@@ -26,6 +26,7 @@
 #include "tink/internal/ec_util.h"
 #include "tink/public_key_sign.h"
 #include "tink/public_key_verify.h"
+#include "tink/signature/internal/ecdsa_nonce_pool.h"
 #include "tink/subtle/common_enums.h"
 #include "tink/subtle/ecdsa_verify_boringssl.h"
 #include "tink/subtle/subtle_util_boringssl.h"
@@ -165,6 +166,70 @@ TEST(EcdsaRawSignBoringSslTest, VerifyFailsWithInvalidMessageOrSignature) {
   }
 }
 
+TEST(EcdsaRawSignBoringSslTest, SignWithNoncePool) {
+  if (IsFipsModeEnabled() && !FIPS_mode()) {
+    GTEST_SKIP()
+        << "Test is skipped if kOnlyUseFips but BoringCrypto is unavailable.";
+  }
+  subtle::EcdsaSignatureEncoding encodings[2] = {
+      subtle::EcdsaSignatureEncoding::DER,
+      subtle::EcdsaSignatureEncoding::IEEE_P1363};
+  for (subtle::EcdsaSignatureEncoding encoding : encodings) {
+    util::StatusOr<EcKey> ec_key = subtle::SubtleUtilBoringSSL::GetNewEcKey(
+        subtle::EllipticCurveType::NIST_P256);
+    ASSERT_THAT(ec_key, IsOk());
+
+    util::StatusOr<std::unique_ptr<EcdsaRawSignBoringSsl>> signer =
+        EcdsaRawSignBoringSsl::New(*ec_key, encoding,
+                                   /*nonce_pool_capacity=*/2);
+    ASSERT_THAT(signer, IsOk());
+    util::StatusOr<int> refilled = (*signer)->RefillNoncePool();
+    if (EcdsaNoncePool::IsSupported()) {
+      EXPECT_THAT(refilled, IsOkAndHolds(2));
+    } else {
+      EXPECT_THAT(refilled.status(),
+                  StatusIs(absl::StatusCode::kUnimplemented));
+    }
+
+    util::StatusOr<std::unique_ptr<subtle::EcdsaVerifyBoringSsl>> verifier =
+        subtle::EcdsaVerifyBoringSsl::New(*ec_key, subtle::HashType::SHA256,
+                                          encoding);
+    ASSERT_THAT(verifier, IsOk());
+
+    // The first two signatures use precomputed nonces, the last one falls
+    // back to computing a nonce.
+    std::string message = "some data to be signed";
+    util::StatusOr<std::string> message_digest =
+        ComputeDigest(subtle::HashType::SHA256, message);
+    ASSERT_THAT(message_digest, IsOk());
+    for (int i = 0; i < 3; ++i) {
+      util::StatusOr<std::string> signature = (*signer)->Sign(*message_digest);
+      ASSERT_THAT(signature, IsOk());
+      EXPECT_THAT((*verifier)->Verify(*signature, message), IsOk());
+    }
+  }
+}
+
+TEST(EcdsaRawSignBoringSslTest, RefillFailsWithoutNoncePool) {
+  if (IsFipsModeEnabled() && !FIPS_mode()) {
+    GTEST_SKIP()
+        << "Test is skipped if kOnlyUseFips but BoringCrypto is unavailable.";
+  }
+  util::StatusOr<EcKey> ec_key = subtle::SubtleUtilBoringSSL::GetNewEcKey(
+      subtle::EllipticCurveType::NIST_P256);
+  ASSERT_THAT(ec_key, IsOk());
+  util::StatusOr<std::unique_ptr<EcdsaRawSignBoringSsl>> signer =
+      EcdsaRawSignBoringSsl::New(*ec_key, subtle::EcdsaSignatureEncoding::DER);
+  ASSERT_THAT(signer, IsOk());
+  EXPECT_THAT((*signer)->RefillNoncePool().status(),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+  EXPECT_THAT(EcdsaRawSignBoringSsl::New(*ec_key,
+                                         subtle::EcdsaSignatureEncoding::DER,
+                                         /*nonce_pool_capacity=*/-1)
+                  .status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
 TEST(EcdsaRawSignBoringSslTest, VerifyFailsWhenEncodingDoesNotMatch) {
   if (IsFipsModeEnabled() && !FIPS_mode()) {
     GTEST_SKIP()
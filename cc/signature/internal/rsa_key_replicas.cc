@@ -0,0 +1,61 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+
+#include "tink/signature/internal/rsa_key_replicas.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "openssl/rsa.h"
+#include "tink/internal/rsa_util.h"
+#include "tink/internal/ssl_unique_ptr.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace internal {
+
+util::StatusOr<std::unique_ptr<RsaKeyReplicas>> RsaKeyReplicas::New(
+    const RsaPrivateKey& private_key, int num_replicas) {
+  if (num_replicas < 1 || num_replicas > kMaxReplicas) {
+    return util::Status(
+        absl::StatusCode::kInvalidArgument,
+        absl::StrCat("The number of RSA key replicas must be between 1 and ",
+                     kMaxReplicas));
+  }
+  std::vector<SslUniquePtr<RSA>> replicas;
+  replicas.reserve(num_replicas);
+  for (int i = 0; i < num_replicas; ++i) {
+    // The RSA modulus and exponent are checked as part of the conversion to
+    // SslUniquePtr<RSA>.
+    util::StatusOr<SslUniquePtr<RSA>> rsa = RsaPrivateKeyToRsa(private_key);
+    if (!rsa.ok()) {
+      return rsa.status();
+    }
+    replicas.push_back(*std::move(rsa));
+  }
+  return {absl::WrapUnique(new RsaKeyReplicas(std::move(replicas)))};
+}
+
+}  // namespace internal
+}  // namespace tink
+}  // namespace crypto
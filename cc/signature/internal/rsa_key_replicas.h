@@ -0,0 +1,78 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef TINK_SIGNATURE_INTERNAL_RSA_KEY_REPLICAS_H_
+#define TINK_SIGNATURE_INTERNAL_RSA_KEY_REPLICAS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "openssl/rsa.h"
+#include "tink/internal/rsa_util.h"
+#include "tink/internal/ssl_unique_ptr.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+namespace internal {
+
+// Independent RSA objects for the same private key, used in turn.
+//
+// Each RSA object keeps blinding values that the SSL library protects with a
+// lock, so threads that sign with a single RSA object contend on it. With
+// several replicas, concurrent signers are spread over as many locks.
+//
+// This class is thread-safe.
+class RsaKeyReplicas {
+ public:
+  static constexpr int kMaxReplicas = 256;
+
+  // Creates `num_replicas` RSA objects for `private_key`, between 1 and
+  // kMaxReplicas.
+  static util::StatusOr<std::unique_ptr<RsaKeyReplicas>> New(
+      const RsaPrivateKey& private_key, int num_replicas);
+
+  // Not copyable or movable.
+  RsaKeyReplicas(const RsaKeyReplicas&) = delete;
+  RsaKeyReplicas& operator=(const RsaKeyReplicas&) = delete;
+
+  // Returns the replica to use for the next operation. The replicas are
+  // returned in round-robin order.
+  RSA* Get() const {
+    if (replicas_.size() == 1) return replicas_[0].get();
+    uint32_t index = next_.fetch_add(1, std::memory_order_relaxed);
+    return replicas_[index % replicas_.size()].get();
+  }
+
+  int size() const { return replicas_.size(); }
+
+ private:
+  explicit RsaKeyReplicas(std::vector<SslUniquePtr<RSA>> replicas)
+      : replicas_(std::move(replicas)) {}
+
+  const std::vector<SslUniquePtr<RSA>> replicas_;
+  mutable std::atomic<uint32_t> next_{0};
+};
+
+}  // namespace internal
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_SIGNATURE_INTERNAL_RSA_KEY_REPLICAS_H_
@@ -0,0 +1,111 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+
+#include "tink/signature/internal/rsa_key_replicas.h"
+
+#include <memory>
+#include <set>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "openssl/bn.h"
+#include "openssl/rsa.h"
+#include "tink/internal/rsa_util.h"
+#include "tink/internal/ssl_unique_ptr.h"
+#include "tink/util/statusor.h"
+#include "tink/util/test_matchers.h"
+
+namespace crypto {
+namespace tink {
+namespace internal {
+namespace {
+
+using ::crypto::tink::test::IsOk;
+using ::crypto::tink::test::StatusIs;
+using ::testing::Eq;
+using ::testing::NotNull;
+
+class RsaKeyReplicasTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    SslUniquePtr<BIGNUM> e(BN_new());
+    ASSERT_THAT(BN_set_word(e.get(), RSA_F4), Eq(1));
+    ASSERT_THAT(NewRsaKeyPair(/*modulus_size_in_bits=*/2048, e.get(),
+                              &private_key_, &public_key_),
+                IsOk());
+  }
+
+  RsaPrivateKey private_key_;
+  RsaPublicKey public_key_;
+};
+
+TEST_F(RsaKeyReplicasTest, SingleReplicaIsAlwaysReturned) {
+  util::StatusOr<std::unique_ptr<RsaKeyReplicas>> replicas =
+      RsaKeyReplicas::New(private_key_, /*num_replicas=*/1);
+  ASSERT_THAT(replicas, IsOk());
+  EXPECT_THAT((*replicas)->size(), Eq(1));
+  RSA* rsa = (*replicas)->Get();
+  EXPECT_THAT(rsa, NotNull());
+  EXPECT_THAT((*replicas)->Get(), Eq(rsa));
+  EXPECT_THAT((*replicas)->Get(), Eq(rsa));
+}
+
+TEST_F(RsaKeyReplicasTest, ReplicasAreReturnedInTurn) {
+  util::StatusOr<std::unique_ptr<RsaKeyReplicas>> replicas =
+      RsaKeyReplicas::New(private_key_, /*num_replicas=*/3);
+  ASSERT_THAT(replicas, IsOk());
+  EXPECT_THAT((*replicas)->size(), Eq(3));
+  RSA* first = (*replicas)->Get();
+  RSA* second = (*replicas)->Get();
+  RSA* third = (*replicas)->Get();
+  EXPECT_THAT(std::set<RSA*>({first, second, third}).size(), Eq(3));
+  EXPECT_THAT((*replicas)->Get(), Eq(first));
+  EXPECT_THAT((*replicas)->Get(), Eq(second));
+  EXPECT_THAT((*replicas)->Get(), Eq(third));
+}
+
+TEST_F(RsaKeyReplicasTest, ReplicasHoldTheSameKey) {
+  util::StatusOr<std::unique_ptr<RsaKeyReplicas>> replicas =
+      RsaKeyReplicas::New(private_key_, /*num_replicas=*/2);
+  ASSERT_THAT(replicas, IsOk());
+  RSA* first = (*replicas)->Get();
+  RSA* second = (*replicas)->Get();
+  EXPECT_THAT(BN_cmp(RSA_get0_n(first), RSA_get0_n(second)), Eq(0));
+  EXPECT_THAT(BN_cmp(RSA_get0_d(first), RSA_get0_d(second)), Eq(0));
+  EXPECT_THAT(RSA_check_key(first), Eq(1));
+  EXPECT_THAT(RSA_check_key(second), Eq(1));
+}
+
+TEST_F(RsaKeyReplicasTest, InvalidNumberOfReplicasFails) {
+  for (int num_replicas : {-1, 0, RsaKeyReplicas::kMaxReplicas + 1}) {
+    EXPECT_THAT(RsaKeyReplicas::New(private_key_, num_replicas).status(),
+                StatusIs(absl::StatusCode::kInvalidArgument));
+  }
+}
+
+TEST_F(RsaKeyReplicasTest, InvalidKeyFails) {
+  RsaPrivateKey private_key = private_key_;
+  private_key.e = "";
+  EXPECT_THAT(RsaKeyReplicas::New(private_key, /*num_replicas=*/2).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,98 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+
+#include "tink/signature/limited_public_key_sign.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "tink/public_key_sign.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+
+// static
+util::StatusOr<std::unique_ptr<LimitedPublicKeySign>> LimitedPublicKeySign::New(
+    std::unique_ptr<PublicKeySign> sign,
+    const LimitedPublicKeySignOptions& options) {
+  if (sign == nullptr) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "sign must be non-null");
+  }
+  if (options.max_concurrent_signatures < 1) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "max_concurrent_signatures must be positive");
+  }
+  if (options.max_waiting_signatures < 0) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "max_waiting_signatures must not be negative");
+  }
+  if (options.max_wait_time < absl::ZeroDuration()) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "max_wait_time must not be negative");
+  }
+  std::unique_ptr<LimitedPublicKeySign> limited_sign(
+      new LimitedPublicKeySign(std::move(sign), options));
+  return std::move(limited_sign);
+}
+
+util::StatusOr<std::string> LimitedPublicKeySign::Sign(
+    absl::string_view data) const {
+  {
+    absl::MutexLock lock(&mutex_);
+    if (!HasSigningSlot()) {
+      if (num_waiting_ >= options_.max_waiting_signatures) {
+        return util::Status(absl::StatusCode::kResourceExhausted,
+                            "too many waiting signatures");
+      }
+      ++num_waiting_;
+      bool has_slot = mutex_.AwaitWithTimeout(
+          absl::Condition(this, &LimitedPublicKeySign::HasSigningSlot),
+          options_.max_wait_time);
+      --num_waiting_;
+      if (!has_slot) {
+        return util::Status(absl::StatusCode::kDeadlineExceeded,
+                            "waited too long for a signing slot");
+      }
+    }
+    ++num_signing_;
+  }
+  util::StatusOr<std::string> signature = sign_->Sign(data);
+  absl::MutexLock lock(&mutex_);
+  --num_signing_;
+  return signature;
+}
+
+int LimitedPublicKeySign::num_signing() const {
+  absl::MutexLock lock(&mutex_);
+  return num_signing_;
+}
+
+int LimitedPublicKeySign::num_waiting() const {
+  absl::MutexLock lock(&mutex_);
+  return num_waiting_;
+}
+
+}  // namespace tink
+}  // namespace crypto
@@ -0,0 +1,88 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef TINK_SIGNATURE_LIMITED_PUBLIC_KEY_SIGN_H_
+#define TINK_SIGNATURE_LIMITED_PUBLIC_KEY_SIGN_H_
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "tink/public_key_sign.h"
+#include "tink/util/statusor.h"
+
+namespace crypto {
+namespace tink {
+
+struct LimitedPublicKeySignOptions {
+  // Maximum number of signatures computed at the same time, typically the
+  // number of cores that may be used for signing.
+  int max_concurrent_signatures = 1;
+  // Maximum number of calls that wait for a signing slot. Further calls fail
+  // with RESOURCE_EXHAUSTED without waiting.
+  int max_waiting_signatures = 1024;
+  // Calls that waited this long for a signing slot fail with
+  // DEADLINE_EXCEEDED.
+  absl::Duration max_wait_time = absl::InfiniteDuration();
+};
+
+// PublicKeySign that limits the number of concurrent calls to Sign() on
+// another PublicKeySign, for CPU-bound signers such as RSA that should not
+// use more threads than cores. Callers beyond the limit wait on their own
+// thread, not necessarily in order, and are rejected once too many wait, so
+// that overload is reported instead of growing latency.
+//
+// This class is thread-safe.
+class LimitedPublicKeySign : public PublicKeySign {
+ public:
+  static crypto::tink::util::StatusOr<std::unique_ptr<LimitedPublicKeySign>>
+  New(std::unique_ptr<PublicKeySign> sign,
+      const LimitedPublicKeySignOptions& options);
+
+  crypto::tink::util::StatusOr<std::string> Sign(
+      absl::string_view data) const override;
+
+  // Number of calls that are signing.
+  int num_signing() const;
+  // Number of calls that wait for a signing slot.
+  int num_waiting() const;
+
+ private:
+  LimitedPublicKeySign(std::unique_ptr<PublicKeySign> sign,
+                       const LimitedPublicKeySignOptions& options)
+      : sign_(std::move(sign)), options_(options) {}
+
+  bool HasSigningSlot() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return num_signing_ < options_.max_concurrent_signatures;
+  }
+
+  const std::unique_ptr<PublicKeySign> sign_;
+  const LimitedPublicKeySignOptions options_;
+
+  mutable absl::Mutex mutex_;
+  mutable int num_signing_ ABSL_GUARDED_BY(mutex_) = 0;
+  mutable int num_waiting_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace tink
+}  // namespace crypto
+
+#endif  // TINK_SIGNATURE_LIMITED_PUBLIC_KEY_SIGN_H_
@@ -0,0 +1,209 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+
+#include "tink/signature/limited_public_key_sign.h"
+
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "tink/public_key_sign.h"
+#include "tink/util/status.h"
+#include "tink/util/statusor.h"
+#include "tink/util/test_matchers.h"
+
+namespace crypto {
+namespace tink {
+namespace {
+
+using ::crypto::tink::test::IsOk;
+using ::crypto::tink::test::IsOkAndHolds;
+using ::crypto::tink::test::StatusIs;
+using ::testing::Eq;
+
+// PublicKeySign that blocks in Sign() until it is released.
+class BlockingSign : public PublicKeySign {
+ public:
+  util::StatusOr<std::string> Sign(absl::string_view data) const override {
+    absl::MutexLock lock(&mutex_);
+    ++num_started_;
+    mutex_.Await(absl::Condition(&released_));
+    return absl::StrCat("signature of ", data);
+  }
+
+  void Release() {
+    absl::MutexLock lock(&mutex_);
+    released_ = true;
+  }
+
+  void AwaitStarted(int num_started) const {
+    absl::MutexLock lock(&mutex_);
+    auto started = [this, num_started]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(
+                       mutex_) { return num_started_ >= num_started; };
+    mutex_.Await(absl::Condition(&started));
+  }
+
+ private:
+  mutable absl::Mutex mutex_;
+  mutable int num_started_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool released_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+// Waits until `sign` has `num_waiting` waiting calls.
+void AwaitWaiting(const LimitedPublicKeySign& sign, int num_waiting) {
+  while (sign.num_waiting() < num_waiting) {
+    absl::SleepFor(absl::Milliseconds(1));
+  }
+}
+
+TEST(LimitedPublicKeySignTest, Sign) {
+  auto blocking_sign = absl::make_unique<BlockingSign>();
+  blocking_sign->Release();
+  util::StatusOr<std::unique_ptr<LimitedPublicKeySign>> sign =
+      LimitedPublicKeySign::New(std::move(blocking_sign),
+                                LimitedPublicKeySignOptions());
+  ASSERT_THAT(sign, IsOk());
+  EXPECT_THAT((*sign)->Sign("data"), IsOkAndHolds("signature of data"));
+  EXPECT_THAT((*sign)->num_signing(), Eq(0));
+  EXPECT_THAT((*sign)->num_waiting(), Eq(0));
+}
+
+TEST(LimitedPublicKeySignTest, InvalidArgumentsFail) {
+  EXPECT_THAT(
+      LimitedPublicKeySign::New(nullptr, LimitedPublicKeySignOptions())
+          .status(),
+      StatusIs(absl::StatusCode::kInvalidArgument));
+
+  LimitedPublicKeySignOptions no_concurrency;
+  no_concurrency.max_concurrent_signatures = 0;
+  EXPECT_THAT(LimitedPublicKeySign::New(absl::make_unique<BlockingSign>(),
+                                        no_concurrency)
+                  .status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+
+  LimitedPublicKeySignOptions negative_waiting;
+  negative_waiting.max_waiting_signatures = -1;
+  EXPECT_THAT(LimitedPublicKeySign::New(absl::make_unique<BlockingSign>(),
+                                        negative_waiting)
+                  .status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+
+  LimitedPublicKeySignOptions negative_wait_time;
+  negative_wait_time.max_wait_time = -absl::Seconds(1);
+  EXPECT_THAT(LimitedPublicKeySign::New(absl::make_unique<BlockingSign>(),
+                                        negative_wait_time)
+                  .status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(LimitedPublicKeySignTest, LimitsConcurrentSignatures) {
+  auto blocking_sign = absl::make_unique<BlockingSign>();
+  BlockingSign* blocking_sign_ptr = blocking_sign.get();
+  LimitedPublicKeySignOptions options;
+  options.max_concurrent_signatures = 2;
+  util::StatusOr<std::unique_ptr<LimitedPublicKeySign>> sign =
+      LimitedPublicKeySign::New(std::move(blocking_sign), options);
+  ASSERT_THAT(sign, IsOk());
+
+  constexpr int kNumThreads = 5;
+  std::vector<util::StatusOr<std::string>> signatures(
+      kNumThreads, util::Status(absl::StatusCode::kUnknown, "not run"));
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back(
+        [&, i]() { signatures[i] = (*sign)->Sign(absl::StrCat(i)); });
+  }
+  blocking_sign_ptr->AwaitStarted(2);
+  AwaitWaiting(**sign, kNumThreads - 2);
+  EXPECT_THAT((*sign)->num_signing(), Eq(2));
+  EXPECT_THAT((*sign)->num_waiting(), Eq(kNumThreads - 2));
+
+  blocking_sign_ptr->Release();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  for (int i = 0; i < kNumThreads; ++i) {
+    EXPECT_THAT(signatures[i],
+                IsOkAndHolds(absl::StrCat("signature of ", i)));
+  }
+  EXPECT_THAT((*sign)->num_signing(), Eq(0));
+  EXPECT_THAT((*sign)->num_waiting(), Eq(0));
+}
+
+TEST(LimitedPublicKeySignTest, TooManyWaitingSignaturesFail) {
+  auto blocking_sign = absl::make_unique<BlockingSign>();
+  BlockingSign* blocking_sign_ptr = blocking_sign.get();
+  LimitedPublicKeySignOptions options;
+  options.max_concurrent_signatures = 1;
+  options.max_waiting_signatures = 1;
+  util::StatusOr<std::unique_ptr<LimitedPublicKeySign>> sign =
+      LimitedPublicKeySign::New(std::move(blocking_sign), options);
+  ASSERT_THAT(sign, IsOk());
+
+  util::StatusOr<std::string> signing;
+  std::thread signing_thread([&]() { signing = (*sign)->Sign("signing"); });
+  blocking_sign_ptr->AwaitStarted(1);
+  util::StatusOr<std::string> waiting;
+  std::thread waiting_thread([&]() { waiting = (*sign)->Sign("waiting"); });
+  AwaitWaiting(**sign, 1);
+
+  EXPECT_THAT((*sign)->Sign("rejected").status(),
+              StatusIs(absl::StatusCode::kResourceExhausted));
+
+  blocking_sign_ptr->Release();
+  signing_thread.join();
+  waiting_thread.join();
+  EXPECT_THAT(signing, IsOkAndHolds("signature of signing"));
+  EXPECT_THAT(waiting, IsOkAndHolds("signature of waiting"));
+}
+
+TEST(LimitedPublicKeySignTest, WaitingTooLongFails) {
+  auto blocking_sign = absl::make_unique<BlockingSign>();
+  BlockingSign* blocking_sign_ptr = blocking_sign.get();
+  LimitedPublicKeySignOptions options;
+  options.max_concurrent_signatures = 1;
+  options.max_wait_time = absl::Milliseconds(10);
+  util::StatusOr<std::unique_ptr<LimitedPublicKeySign>> sign =
+      LimitedPublicKeySign::New(std::move(blocking_sign), options);
+  ASSERT_THAT(sign, IsOk());
+
+  util::StatusOr<std::string> signing;
+  std::thread signing_thread([&]() { signing = (*sign)->Sign("signing"); });
+  blocking_sign_ptr->AwaitStarted(1);
+
+  EXPECT_THAT((*sign)->Sign("timed out").status(),
+              StatusIs(absl::StatusCode::kDeadlineExceeded));
+  EXPECT_THAT((*sign)->num_waiting(), Eq(0));
+
+  blocking_sign_ptr->Release();
+  signing_thread.join();
+  EXPECT_THAT(signing, IsOkAndHolds("signature of signing"));
+}
+
+}  // namespace
+}  // namespace tink
+}  // namespace crypto
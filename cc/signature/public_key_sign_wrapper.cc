@@ -59,7 +59,9 @@ class PublicKeySignSetWrapper : public PublicKeySign {
       std::unique_ptr<PrimitiveSet<PublicKeySign>> public_key_sign_set,
       std::unique_ptr<MonitoringClient> monitoring_sign_client = nullptr)
       : public_key_sign_set_(std::move(public_key_sign_set)),
-        monitoring_sign_client_(std::move(monitoring_sign_client)) {}
+        monitoring_sign_client_(std::move(monitoring_sign_client)),
+        timed_sign_client_(internal::AsTimedMonitoringClient(
+            monitoring_sign_client_.get())) {}
 
   crypto::tink::util::StatusOr<std::string> Sign(
       absl::string_view data) const override;
@@ -69,10 +71,13 @@ class PublicKeySignSetWrapper : public PublicKeySign {
  private:
   std::unique_ptr<PrimitiveSet<PublicKeySign>> public_key_sign_set_;
   std::unique_ptr<MonitoringClient> monitoring_sign_client_;
+  // Set if monitoring_sign_client_ also records latencies.
+  TimedMonitoringClient* const timed_sign_client_;
 };
 
 util::StatusOr<std::string> PublicKeySignSetWrapper::Sign(
     absl::string_view data) const {
+  internal::MonitoringLatencyTimer timer(timed_sign_client_);
   // BoringSSL expects a non-null pointer for data,
   // regardless of whether the size is 0.
   data = internal::EnsureStringNonNull(data);
@@ -94,6 +99,8 @@ util::StatusOr<std::string> PublicKeySignSetWrapper::Sign(
   if (monitoring_sign_client_ != nullptr) {
     monitoring_sign_client_->Log(
         public_key_sign_set_->get_primary()->get_key_id(), data.size());
+    timer.LogLatency(public_key_sign_set_->get_primary()->get_key_id(),
+                     data.size());
   }
   const std::string& key_id = primary->get_identifier();
   return key_id + sign_result.value();
@@ -16,12 +16,16 @@
 
 #include "tink/signature/public_key_verify_wrapper.h"
 
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "tink/crypto_format.h"
 #include "tink/internal/monitoring_util.h"
 #include "tink/internal/registry_impl.h"
@@ -61,20 +65,42 @@ class PublicKeyVerifySetWrapper : public PublicKeyVerify {
       std::unique_ptr<PrimitiveSet<PublicKeyVerify>> public_key_verify_set,
       std::unique_ptr<MonitoringClient> monitoring_verify_client = nullptr)
       : public_key_verify_set_(std::move(public_key_verify_set)),
-      monitoring_verify_client_(std::move(monitoring_verify_client)) {}
+      monitoring_verify_client_(std::move(monitoring_verify_client)),
+      timed_verify_client_(internal::AsTimedMonitoringClient(
+          monitoring_verify_client_.get())) {}
 
   crypto::tink::util::Status Verify(absl::string_view signature,
                                     absl::string_view data) const override;
 
+  std::vector<crypto::tink::util::Status> VerifyBatch(
+      absl::Span<const absl::string_view> signatures,
+      absl::Span<const absl::string_view> data) const override;
+
   ~PublicKeyVerifySetWrapper() override = default;
 
  private:
+  using Entry = PrimitiveSet<PublicKeyVerify>::Entry<PublicKeyVerify>;
+
+  // Verifies the signatures at `indices` with the primitive of `entry` in a
+  // single batch, after removing `prefix_size` bytes from each of them. Sets
+  // the results of the valid signatures to OK, and returns the indices of
+  // the others.
+  std::vector<std::size_t> VerifyBatchWithEntry(
+      const Entry& entry, std::size_t prefix_size,
+      absl::Span<const absl::string_view> signatures,
+      absl::Span<const absl::string_view> data,
+      const std::vector<std::size_t>& indices,
+      std::vector<util::Status>* results) const;
+
   std::unique_ptr<PrimitiveSet<PublicKeyVerify>> public_key_verify_set_;
   std::unique_ptr<MonitoringClient> monitoring_verify_client_;
+  // Set if monitoring_verify_client_ also records latencies.
+  TimedMonitoringClient* const timed_verify_client_;
 };
 
 util::Status PublicKeyVerifySetWrapper::Verify(absl::string_view signature,
                                                absl::string_view data) const {
+  internal::MonitoringLatencyTimer timer(timed_verify_client_);
   // BoringSSL expects a non-null pointer for data,
   // regardless of whether the size is 0.
   data = internal::EnsureStringNonNull(data);
@@ -93,18 +119,22 @@ util::Status PublicKeyVerifySetWrapper::Verify(absl::string_view signature,
     absl::string_view raw_signature =
         signature.substr(CryptoFormat::kNonRawPrefixSize);
     for (auto& entry : *(primitives_result.value())) {
+      util::StatusOr<PublicKeyVerify*> public_key_verify =
+          entry->get_or_create_primitive();
+      if (!public_key_verify.ok()) continue;
       std::string legacy_data;
       absl::string_view view_on_data_or_legacy_data = data;
       if (entry->get_output_prefix_type() == OutputPrefixType::LEGACY) {
         legacy_data = absl::StrCat(data, std::string("\x00", 1));
         view_on_data_or_legacy_data = legacy_data;
       }
-      auto& public_key_verify = entry->get_primitive();
-      auto verify_result =
-          public_key_verify.Verify(raw_signature, view_on_data_or_legacy_data);
+      auto verify_result = (*public_key_verify)
+                               ->Verify(raw_signature,
+                                        view_on_data_or_legacy_data);
       if (verify_result.ok()) {
         if (monitoring_verify_client_ != nullptr) {
           monitoring_verify_client_->Log(entry->get_key_id(), data.size());
+          timer.LogLatency(entry->get_key_id(), data.size());
         }
         return util::OkStatus();
       } else {
@@ -114,18 +144,21 @@ util::Status PublicKeyVerifySetWrapper::Verify(absl::string_view signature,
   }
 
   // No matching key succeeded with verification, try all RAW keys.
-  auto raw_primitives_result = public_key_verify_set_->get_raw_primitives();
-  if (raw_primitives_result.ok()) {
-    for (auto& public_key_verify_entry : *(raw_primitives_result.value())) {
-      auto& public_key_verify = public_key_verify_entry->get_primitive();
-      auto verify_result = public_key_verify.Verify(signature, data);
-      if (verify_result.ok()) {
-        if (monitoring_verify_client_ != nullptr) {
-          monitoring_verify_client_->Log(public_key_verify_entry->get_key_id(),
-                                         data.size());
-        }
-        return util::OkStatus();
+  for (auto* public_key_verify_entry :
+       public_key_verify_set_->get_raw_primitives_in_trial_order()) {
+    util::StatusOr<PublicKeyVerify*> public_key_verify =
+        public_key_verify_entry->get_or_create_primitive();
+    if (!public_key_verify.ok()) continue;
+    auto verify_result = (*public_key_verify)->Verify(signature, data);
+    if (verify_result.ok()) {
+      public_key_verify_set_->RecordRawPrimitiveSuccess(
+          public_key_verify_entry);
+      if (monitoring_verify_client_ != nullptr) {
+        monitoring_verify_client_->Log(public_key_verify_entry->get_key_id(),
+                                       data.size());
+        timer.LogLatency(public_key_verify_entry->get_key_id(), data.size());
       }
+      return util::OkStatus();
     }
   }
   if (monitoring_verify_client_ != nullptr) {
@@ -134,6 +167,111 @@ util::Status PublicKeyVerifySetWrapper::Verify(absl::string_view signature,
   return util::Status(absl::StatusCode::kInvalidArgument, "Invalid signature.");
 }
 
+std::vector<util::Status> PublicKeyVerifySetWrapper::VerifyBatch(
+    absl::Span<const absl::string_view> signatures,
+    absl::Span<const absl::string_view> data) const {
+  if (signatures.size() != data.size()) {
+    return PublicKeyVerify::VerifyBatch(signatures, data);
+  }
+  std::vector<util::Status> results(
+      signatures.size(),
+      util::Status(absl::StatusCode::kInvalidArgument, "Invalid signature."));
+
+  // Signatures are grouped by their key id, so that each group is verified
+  // with one batch per matching key.
+  absl::flat_hash_map<absl::string_view, std::vector<std::size_t>> by_key_id;
+  for (std::size_t i = 0; i < signatures.size(); ++i) {
+    absl::string_view signature = signatures[i];
+    if (signature.length() <= CryptoFormat::kNonRawPrefixSize) {
+      // This also rejects raw signatures with size of 4 bytes or fewer.
+      results[i] = util::Status(absl::StatusCode::kInvalidArgument,
+                                "Signature too short.");
+      continue;
+    }
+    by_key_id[signature.substr(0, CryptoFormat::kNonRawPrefixSize)].push_back(
+        i);
+  }
+
+  std::vector<std::size_t> unverified;
+  for (auto& group : by_key_id) {
+    std::vector<std::size_t> pending = std::move(group.second);
+    auto primitives_result =
+        public_key_verify_set_->get_primitives(group.first);
+    if (primitives_result.ok()) {
+      for (auto& entry : *(primitives_result.value())) {
+        if (pending.empty()) break;
+        pending =
+            VerifyBatchWithEntry(*entry, CryptoFormat::kNonRawPrefixSize,
+                                 signatures, data, pending, &results);
+      }
+    }
+    unverified.insert(unverified.end(), pending.begin(), pending.end());
+  }
+
+  // Signatures that no matching key verified are tried with all RAW keys.
+  for (auto* public_key_verify_entry :
+       public_key_verify_set_->get_raw_primitives_in_trial_order()) {
+    if (unverified.empty()) break;
+    std::size_t num_unverified = unverified.size();
+    unverified = VerifyBatchWithEntry(*public_key_verify_entry,
+                                      /*prefix_size=*/0, signatures, data,
+                                      unverified, &results);
+    if (unverified.size() < num_unverified) {
+      public_key_verify_set_->RecordRawPrimitiveSuccess(
+          public_key_verify_entry);
+    }
+  }
+  if (monitoring_verify_client_ != nullptr) {
+    for (std::size_t i = 0; i < unverified.size(); ++i) {
+      monitoring_verify_client_->LogFailure();
+    }
+  }
+  return results;
+}
+
+std::vector<std::size_t> PublicKeyVerifySetWrapper::VerifyBatchWithEntry(
+    const Entry& entry, std::size_t prefix_size,
+    absl::Span<const absl::string_view> signatures,
+    absl::Span<const absl::string_view> data,
+    const std::vector<std::size_t>& indices,
+    std::vector<util::Status>* results) const {
+  util::StatusOr<PublicKeyVerify*> public_key_verify =
+      entry.get_or_create_primitive();
+  if (!public_key_verify.ok()) return indices;
+  bool is_legacy = entry.get_output_prefix_type() == OutputPrefixType::LEGACY;
+  std::vector<absl::string_view> batch_signatures;
+  // Reserved upfront, since `batch_data` points into its elements.
+  std::vector<std::string> legacy_data;
+  std::vector<absl::string_view> batch_data;
+  batch_signatures.reserve(indices.size());
+  batch_data.reserve(indices.size());
+  if (is_legacy) legacy_data.reserve(indices.size());
+  for (std::size_t i : indices) {
+    batch_signatures.push_back(signatures[i].substr(prefix_size));
+    if (is_legacy) {
+      legacy_data.push_back(absl::StrCat(data[i], std::string("\x00", 1)));
+      batch_data.push_back(legacy_data.back());
+    } else {
+      batch_data.push_back(internal::EnsureStringNonNull(data[i]));
+    }
+  }
+  std::vector<util::Status> batch_results =
+      (*public_key_verify)->VerifyBatch(batch_signatures, batch_data);
+  std::vector<std::size_t> failed;
+  for (std::size_t k = 0; k < indices.size(); ++k) {
+    if (!batch_results[k].ok()) {
+      failed.push_back(indices[k]);
+      continue;
+    }
+    (*results)[indices[k]] = util::OkStatus();
+    if (monitoring_verify_client_ != nullptr) {
+      monitoring_verify_client_->Log(entry.get_key_id(),
+                                     data[indices[k]].size());
+    }
+  }
+  return failed;
+}
+
 }  // anonymous namespace
 
 util::StatusOr<std::unique_ptr<PublicKeyVerify>> PublicKeyVerifyWrapper::Wrap(
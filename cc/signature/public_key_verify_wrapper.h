@@ -43,6 +43,9 @@ class PublicKeyVerifyWrapper
   crypto::tink::util::StatusOr<std::unique_ptr<PublicKeyVerify>> Wrap(
       std::unique_ptr<PrimitiveSet<PublicKeyVerify>> public_key_verify_set)
       const override;
+
+  // Non-primary entries are only instantiated when they are first used.
+  bool SupportsLazyPrimitives() const override { return true; }
 };
 
 }  // namespace tink
@@ -19,8 +19,11 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "tink/primitive_set.h"
 #include "tink/public_key_verify.h"
 #include "tink/internal/registry_impl.h"
@@ -142,6 +145,77 @@ TEST_F(PublicKeyVerifySetWrapperTest, testBasic) {
   }
 }
 
+TEST_F(PublicKeyVerifySetWrapperTest, VerifyBatch) {
+  KeysetInfo keyset_info;
+  KeysetInfo::KeyInfo* key_info = keyset_info.add_key_info();
+  key_info->set_output_prefix_type(OutputPrefixType::RAW);
+  key_info->set_key_id(1234543);
+  key_info->set_status(KeyStatusType::ENABLED);
+  key_info = keyset_info.add_key_info();
+  key_info->set_output_prefix_type(OutputPrefixType::LEGACY);
+  key_info->set_key_id(726329);
+  key_info->set_status(KeyStatusType::ENABLED);
+  key_info = keyset_info.add_key_info();
+  key_info->set_output_prefix_type(OutputPrefixType::TINK);
+  key_info->set_key_id(7213743);
+  key_info->set_status(KeyStatusType::ENABLED);
+
+  auto pk_verify_set = absl::make_unique<PrimitiveSet<PublicKeyVerify>>();
+  std::vector<std::string> prefixes;
+  for (int i = 0; i < 3; ++i) {
+    util::StatusOr<PrimitiveSet<PublicKeyVerify>::Entry<PublicKeyVerify>*>
+        entry = pk_verify_set->AddPrimitive(
+            absl::make_unique<DummyPublicKeyVerify>(absl::StrCat("sign", i)),
+            keyset_info.key_info(i));
+    ASSERT_THAT(entry, IsOk());
+    prefixes.push_back((*entry)->get_identifier());
+    ASSERT_THAT(pk_verify_set->set_primary(*entry), IsOk());
+  }
+  util::StatusOr<std::unique_ptr<PublicKeyVerify>> pk_verify =
+      PublicKeyVerifyWrapper().Wrap(std::move(pk_verify_set));
+  ASSERT_THAT(pk_verify, IsOk());
+
+  std::string data = "some data to sign";
+  std::string other_data = "other data";
+  std::vector<std::string> signatures = {
+      DummyPublicKeySign("sign0").Sign(data).value(),
+      absl::StrCat(prefixes[1], DummyPublicKeySign("sign1")
+                                    .Sign(absl::StrCat(data, std::string(1, 0)))
+                                    .value()),
+      absl::StrCat(prefixes[2], DummyPublicKeySign("sign2").Sign(data).value()),
+      absl::StrCat(prefixes[2], DummyPublicKeySign("sign2").Sign(data).value()),
+      absl::StrCat(prefixes[2], DummyPublicKeySign("sign0").Sign(data).value()),
+      DummyPublicKeySign("sign2").Sign(data).value(),
+      "abc"};
+  std::vector<absl::string_view> signature_views(signatures.begin(),
+                                                 signatures.end());
+  std::vector<absl::string_view> data_views(signatures.size(), data);
+  data_views[3] = other_data;
+
+  std::vector<util::Status> results =
+      (*pk_verify)->VerifyBatch(signature_views, data_views);
+  ASSERT_EQ(results.size(), signatures.size());
+  for (int i = 0; i < signatures.size(); ++i) {
+    SCOPED_TRACE(i);
+    util::Status expected = (*pk_verify)->Verify(signatures[i], data_views[i]);
+    EXPECT_EQ(results[i], expected);
+  }
+  EXPECT_THAT(results[0], IsOk());
+  EXPECT_THAT(results[1], IsOk());
+  EXPECT_THAT(results[2], IsOk());
+  EXPECT_THAT(results[3], Not(IsOk()));
+  EXPECT_THAT(results[4], Not(IsOk()));
+  EXPECT_THAT(results[5], Not(IsOk()));
+  EXPECT_THAT(results[6], StatusIs(absl::StatusCode::kInvalidArgument));
+
+  results = (*pk_verify)->VerifyBatch(signature_views,
+                                      absl::MakeSpan(data_views).subspan(1));
+  ASSERT_EQ(results.size(), signatures.size());
+  for (const util::Status& status : results) {
+    EXPECT_THAT(status, StatusIs(absl::StatusCode::kInvalidArgument));
+  }
+}
+
 KeysetInfo::KeyInfo PopulateKeyInfo(uint32_t key_id,
                                     OutputPrefixType out_prefix_type,
                                     KeyStatusType status) {
@@ -16,13 +16,17 @@
 
 #include "tink/signature/rsa_ssa_pkcs1_sign_key_manager.h"
 
+#include <memory>
 #include <string>
+#include <utility>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_set.h"
+#include "openssl/bn.h"
 #include "openssl/rsa.h"
 #include "tink/internal/bn_util.h"
+#include "tink/internal/rsa_key_pool.h"
 #include "tink/internal/ssl_unique_ptr.h"
 #include "tink/public_key_sign.h"
 #include "tink/signature/rsa_ssa_pkcs1_verify_key_manager.h"
@@ -39,6 +43,7 @@ namespace tink {
 namespace {
 
 using ::crypto::tink::test::IsOk;
+using ::crypto::tink::test::IsOkAndHolds;
 using ::crypto::tink::util::StatusOr;
 using ::google::crypto::tink::HashType;
 using ::google::crypto::tink::KeyData;
@@ -208,6 +213,27 @@ TEST(RsaSsaPkcs1SignKeyManagerTest, CreateKeyValid) {
   EXPECT_THAT(RsaSsaPkcs1SignKeyManager().ValidateKey(key_or.value()), IsOk());
 }
 
+TEST(RsaSsaPkcs1SignKeyManagerTest, CreateKeyTakesKeyFromRegisteredPool) {
+  RsaSsaPkcs1KeyFormat key_format =
+      CreateKeyFormat(HashType::SHA256, 2048, RSA_F4);
+  internal::SslUniquePtr<BIGNUM> e(BN_new());
+  BN_set_word(e.get(), RSA_F4);
+  StatusOr<std::unique_ptr<internal::RsaKeyPool>> pool =
+      internal::RsaKeyPool::New(/*modulus_size_in_bits=*/2048, e.get(),
+                                /*capacity=*/1);
+  ASSERT_THAT(pool, IsOk());
+  ASSERT_THAT((*pool)->Refill(), IsOkAndHolds(1));
+  std::shared_ptr<internal::RsaKeyPool> registered_pool = *std::move(pool);
+  internal::RegisterRsaKeyPool(registered_pool);
+
+  StatusOr<RsaSsaPkcs1PrivateKey> private_key =
+      RsaSsaPkcs1SignKeyManager().CreateKey(key_format);
+  internal::UnregisterRsaKeyPools();
+  ASSERT_THAT(private_key, IsOk());
+  EXPECT_THAT(registered_pool->size(), Eq(0));
+  CheckNewKey(*private_key, key_format);
+}
+
 // Check that in a bunch of CreateKey calls all generated primes are distinct.
 TEST(RsaSsaPkcs1SignKeyManagerTest, CreateKeyAlwaysNewRsaPair) {
   absl::flat_hash_set<std::string> keys;
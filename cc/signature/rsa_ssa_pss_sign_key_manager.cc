@@ -24,6 +24,7 @@
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
 #include "tink/internal/bn_util.h"
+#include "tink/internal/rsa_key_pool.h"
 #include "tink/internal/rsa_util.h"
 #include "tink/internal/ssl_unique_ptr.h"
 #include "tink/public_key_sign.h"
@@ -95,7 +96,7 @@ StatusOr<RsaSsaPssPrivateKey> RsaSsaPssSignKeyManager::CreateKey(
 
   internal::RsaPrivateKey private_key;
   internal::RsaPublicKey public_key;
-  util::Status status = internal::NewRsaKeyPair(
+  util::Status status = internal::NewRsaKeyPairFromPool(
       key_format.modulus_size_in_bits(), e->get(), &private_key, &public_key);
   if (!status.ok()) {
     return status;
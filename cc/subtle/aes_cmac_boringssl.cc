@@ -24,6 +24,7 @@
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "openssl/cmac.h"
+#include "openssl/crypto.h"
 #include "openssl/evp.h"
 #include "tink/internal/aes_util.h"
 #include "tink/internal/ssl_unique_ptr.h"
@@ -64,32 +65,33 @@ util::StatusOr<std::unique_ptr<Mac>> AesCmacBoringSsl::New(util::SecretData key,
   return {absl::WrapUnique(new AesCmacBoringSsl(std::move(key), tag_size))};
 }
 
-util::StatusOr<std::string> AesCmacBoringSsl::ComputeMac(
-    absl::string_view data) const {
+bool AesCmacBoringSsl::ComputeUntruncatedMac(absl::string_view data,
+                                             uint8_t* mac) const {
   // BoringSSL expects a non-null pointer for data,
   // regardless of whether the size is 0.
   data = internal::EnsureStringNonNull(data);
 
-  std::string result;
-  ResizeStringUninitialized(&result, kMaxTagSize);
   internal::SslUniquePtr<CMAC_CTX> context(CMAC_CTX_new());
   util::StatusOr<const EVP_CIPHER*> cipher =
       internal::GetAesCbcCipherForKeySize(key_.size());
   if (!cipher.ok()) {
-    return cipher.status();
+    return false;
   }
   size_t len = 0;
   const uint8_t* key_ptr = reinterpret_cast<const uint8_t*>(&key_[0]);
   const uint8_t* data_ptr = reinterpret_cast<const uint8_t*>(data.data());
-  uint8_t* result_ptr = reinterpret_cast<uint8_t*>(&result[0]);
-  if (CMAC_Init(context.get(), key_ptr, key_.size(), *cipher, nullptr) <= 0 ||
-      CMAC_Update(context.get(), data_ptr, data.size()) <= 0 ||
-      CMAC_Final(context.get(), result_ptr, &len) == 0) {
+  return CMAC_Init(context.get(), key_ptr, key_.size(), *cipher, nullptr) > 0 &&
+         CMAC_Update(context.get(), data_ptr, data.size()) > 0 &&
+         CMAC_Final(context.get(), mac, &len) != 0;
+}
+
+util::StatusOr<std::string> AesCmacBoringSsl::ComputeMac(
+    absl::string_view data) const {
+  uint8_t mac[kMaxTagSize];
+  if (!ComputeUntruncatedMac(data, mac)) {
     return util::Status(absl::StatusCode::kInternal, "Failed to compute CMAC");
   }
-
-  result.resize(tag_size_);
-  return result;
+  return std::string(reinterpret_cast<char*>(mac), tag_size_);
 }
 
 util::Status AesCmacBoringSsl::VerifyMac(absl::string_view mac,
@@ -99,15 +101,24 @@ util::Status AesCmacBoringSsl::VerifyMac(absl::string_view mac,
                      "Incorrect tag size: expected %d, found %d", tag_size_,
                      mac.size());
   }
-  util::StatusOr<std::string> computed_mac = ComputeMac(data);
-  if (!computed_mac.ok()) return computed_mac.status();
-  if (CRYPTO_memcmp(computed_mac->data(), mac.data(), tag_size_) != 0) {
+  uint8_t computed_mac[kMaxTagSize];
+  if (!ComputeUntruncatedMac(data, computed_mac)) {
+    return util::Status(absl::StatusCode::kInternal, "Failed to compute CMAC");
+  }
+  if (CRYPTO_memcmp(computed_mac, mac.data(), tag_size_) != 0) {
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "CMAC verification failed");
   }
   return util::OkStatus();
 }
 
+bool AesCmacBoringSsl::TryVerifyMac(absl::string_view mac,
+                                    absl::string_view data) const {
+  uint8_t computed_mac[kMaxTagSize];
+  return mac.size() == tag_size_ && ComputeUntruncatedMac(data, computed_mac) &&
+         CRYPTO_memcmp(computed_mac, mac.data(), tag_size_) == 0;
+}
+
 }  // namespace subtle
 }  // namespace tink
 }  // namespace crypto
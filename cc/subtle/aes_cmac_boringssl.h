@@ -22,6 +22,7 @@
 #include <utility>
 
 #include "tink/internal/fips_utils.h"
+#include "tink/internal/trial_decryption.h"
 #include "tink/mac.h"
 #include "tink/util/secret_data.h"
 #include "tink/util/statusor.h"
@@ -30,7 +31,7 @@ namespace crypto {
 namespace tink {
 namespace subtle {
 
-class AesCmacBoringSsl : public Mac {
+class AesCmacBoringSsl : public Mac, public internal::TrialVerificationMac {
  public:
   static crypto::tink::util::StatusOr<std::unique_ptr<Mac>> New(
       util::SecretData key, uint32_t tag_size);
@@ -44,6 +45,9 @@ class AesCmacBoringSsl : public Mac {
   crypto::tink::util::Status VerifyMac(absl::string_view mac,
                                        absl::string_view data) const override;
 
+  bool TryVerifyMac(absl::string_view mac,
+                    absl::string_view data) const override;
+
   static constexpr crypto::tink::internal::FipsCompatibility kFipsStatus =
       crypto::tink::internal::FipsCompatibility::kNotFips;
 
@@ -51,6 +55,10 @@ class AesCmacBoringSsl : public Mac {
   AesCmacBoringSsl(util::SecretData key, uint32_t tag_size)
       : key_(std::move(key)), tag_size_(tag_size) {}
 
+  // Computes the CMAC of `data`, before truncation to tag_size_, into `mac`,
+  // which must hold 16 bytes. Returns false on failure.
+  bool ComputeUntruncatedMac(absl::string_view data, uint8_t* mac) const;
+
   const util::SecretData key_;
   const uint32_t tag_size_;
 };
@@ -98,6 +98,24 @@ util::StatusOr<std::string> AesGcmSivBoringSsl::Decrypt(
   return plaintext;
 }
 
+bool AesGcmSivBoringSsl::TryDecrypt(absl::string_view ciphertext,
+                                    absl::string_view associated_data,
+                                    std::string* plaintext) const {
+  if (ciphertext.size() < kIvSizeInBytes + kTagSizeInBytes) {
+    return false;
+  }
+  ResizeStringUninitialized(
+      plaintext, aead_->PlaintextSize(ciphertext.size() - kIvSizeInBytes));
+  int64_t written_bytes = 0;
+  if (!aead_->TryDecrypt(ciphertext.substr(kIvSizeInBytes), associated_data,
+                         ciphertext.substr(0, kIvSizeInBytes),
+                         absl::MakeSpan(*plaintext), &written_bytes)) {
+    return false;
+  }
+  plaintext->resize(written_bytes);
+  return true;
+}
+
 }  // namespace subtle
 }  // namespace tink
 }  // namespace crypto
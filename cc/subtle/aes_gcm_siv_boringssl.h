@@ -25,6 +25,7 @@
 #include "tink/aead.h"
 #include "tink/aead/internal/ssl_aead.h"
 #include "tink/internal/fips_utils.h"
+#include "tink/internal/trial_decryption.h"
 #include "tink/util/secret_data.h"
 #include "tink/util/statusor.h"
 
@@ -49,7 +50,8 @@ namespace subtle {
 // https://cyber.biu.ac.il/aes-gcm-siv/
 // or Section 6.3 of this paper:
 // https://eprint.iacr.org/2017/702.pdf
-class AesGcmSivBoringSsl : public Aead {
+class AesGcmSivBoringSsl : public Aead,
+                           public internal::TrialDecryptionAead {
  public:
   static crypto::tink::util::StatusOr<std::unique_ptr<Aead>> New(
       const util::SecretData& key);
@@ -62,6 +64,10 @@ class AesGcmSivBoringSsl : public Aead {
       absl::string_view ciphertext,
       absl::string_view associated_data) const override;
 
+  bool TryDecrypt(absl::string_view ciphertext,
+                  absl::string_view associated_data,
+                  std::string* plaintext) const override;
+
   static constexpr crypto::tink::internal::FipsCompatibility kFipsStatus =
       crypto::tink::internal::FipsCompatibility::kNotFips;
 
@@ -234,27 +234,36 @@ util::StatusOr<std::string> AesSivBoringSsl::DecryptDeterministically(
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "ciphertext too short");
   }
-  size_t plaintext_size = ciphertext.size() - kBlockSize;
   std::string plaintext;
-  ResizeStringUninitialized(&plaintext, plaintext_size);
+  if (!TryDecryptDeterministically(ciphertext, associated_data, &plaintext)) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "invalid ciphertext");
+  }
+  return plaintext;
+}
+
+bool AesSivBoringSsl::TryDecryptDeterministically(
+    absl::string_view ciphertext, absl::string_view associated_data,
+    std::string* plaintext) const {
+  if (ciphertext.size() < kBlockSize) {
+    return false;
+  }
+  size_t plaintext_size = ciphertext.size() - kBlockSize;
+  ResizeStringUninitialized(plaintext, plaintext_size);
   const uint8_t* siv = reinterpret_cast<const uint8_t*>(&ciphertext[0]);
-  util::Status res = AesCtrCrypt(ciphertext.substr(kBlockSize), siv, k2_.get(),
-                                 absl::MakeSpan(plaintext));
-  if (!res.ok()) {
-    return res;
+  if (!AesCtrCrypt(ciphertext.substr(kBlockSize), siv, k2_.get(),
+                   absl::MakeSpan(*plaintext))
+           .ok()) {
+    return false;
   }
 
   uint8_t s2v[kBlockSize];
   S2v(absl::MakeSpan(reinterpret_cast<const uint8_t*>(associated_data.data()),
                      associated_data.size()),
-      absl::MakeSpan(reinterpret_cast<const uint8_t*>(plaintext.data()),
+      absl::MakeSpan(reinterpret_cast<const uint8_t*>(plaintext->data()),
                      plaintext_size),
       s2v);
-  if (CRYPTO_memcmp(siv, s2v, kBlockSize) != 0) {
-    return util::Status(absl::StatusCode::kInvalidArgument,
-                        "invalid ciphertext");
-  }
-  return plaintext;
+  return CRYPTO_memcmp(siv, s2v, kBlockSize) == 0;
 }
 
 }  // namespace subtle
@@ -27,6 +27,7 @@
 #include "tink/deterministic_aead.h"
 #include "tink/internal/aes_util.h"
 #include "tink/internal/fips_utils.h"
+#include "tink/internal/trial_decryption.h"
 #include "tink/util/secret_data.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
@@ -57,7 +58,9 @@ namespace subtle {
 // Since 192-bit AES keys are not supported by tink for voodoo reasons
 // and RFC 5297 only supports same size encryption and MAC keys this
 // implies that keys must be 64 bytes (2*256 bits) long.
-class AesSivBoringSsl : public DeterministicAead {
+class AesSivBoringSsl
+    : public DeterministicAead,
+      public internal::TrialDecryptionDeterministicAead {
  public:
   static crypto::tink::util::StatusOr<std::unique_ptr<DeterministicAead>> New(
       const util::SecretData& key);
@@ -70,6 +73,10 @@ class AesSivBoringSsl : public DeterministicAead {
       absl::string_view ciphertext,
       absl::string_view associated_data) const override;
 
+  bool TryDecryptDeterministically(absl::string_view ciphertext,
+                                   absl::string_view associated_data,
+                                   std::string* plaintext) const override;
+
   static bool IsValidKeySizeInBytes(size_t size) { return size == 64; }
 
   static constexpr crypto::tink::internal::FipsCompatibility kFipsStatus =
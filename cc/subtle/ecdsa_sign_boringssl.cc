@@ -37,6 +37,12 @@ namespace subtle {
 util::StatusOr<std::unique_ptr<EcdsaSignBoringSsl>> EcdsaSignBoringSsl::New(
     const SubtleUtilBoringSSL::EcKey& ec_key, HashType hash_type,
     EcdsaSignatureEncoding encoding) {
+  return New(ec_key, hash_type, encoding, /*nonce_pool_capacity=*/0);
+}
+
+util::StatusOr<std::unique_ptr<EcdsaSignBoringSsl>> EcdsaSignBoringSsl::New(
+    const SubtleUtilBoringSSL::EcKey& ec_key, HashType hash_type,
+    EcdsaSignatureEncoding encoding, int nonce_pool_capacity) {
   auto status = internal::CheckFipsCompatibility<EcdsaSignBoringSsl>();
   if (!status.ok()) return status;
 
@@ -51,7 +57,8 @@ util::StatusOr<std::unique_ptr<EcdsaSignBoringSsl>> EcdsaSignBoringSsl::New(
   }
 
   util::StatusOr<std::unique_ptr<internal::EcdsaRawSignBoringSsl>> raw_sign =
-      internal::EcdsaRawSignBoringSsl::New(ec_key, encoding);
+      internal::EcdsaRawSignBoringSsl::New(ec_key, encoding,
+                                           nonce_pool_capacity);
   if (!raw_sign.ok()) return raw_sign.status();
 
   return {
@@ -67,8 +74,11 @@ util::StatusOr<std::string> EcdsaSignBoringSsl::Sign(
   // Compute the digest.
   unsigned int digest_size;
   uint8_t digest[EVP_MAX_MD_SIZE];
-  if (1 != EVP_Digest(data.data(), data.size(), digest, &digest_size, hash_,
-                      nullptr)) {
+  internal::EvpMdCtxPool::ScopedCtx md_ctx = md_ctx_pool_.Get();
+  if (md_ctx.get() == nullptr ||
+      1 != EVP_DigestInit_ex(md_ctx.get(), hash_, /*impl=*/nullptr) ||
+      1 != EVP_DigestUpdate(md_ctx.get(), data.data(), data.size()) ||
+      1 != EVP_DigestFinal_ex(md_ctx.get(), digest, &digest_size)) {
     return util::Status(absl::StatusCode::kInternal,
                         "Could not compute digest.");
   }
@@ -23,6 +23,7 @@
 
 #include "absl/strings/string_view.h"
 #include "openssl/evp.h"
+#include "tink/internal/evp_md_ctx_pool.h"
 #include "tink/internal/fips_utils.h"
 #include "tink/public_key_sign.h"
 #include "tink/signature/internal/ecdsa_raw_sign_boringssl.h"
@@ -41,10 +42,25 @@ class EcdsaSignBoringSsl : public PublicKeySign {
       const SubtleUtilBoringSSL::EcKey& ec_key, HashType hash_type,
       EcdsaSignatureEncoding encoding);
 
+  // Same as above, but the signer keeps a pool of up to `nonce_pool_capacity`
+  // precomputed signing nonces, filled by RefillNoncePool(). Signing then
+  // only does scalar arithmetic while the pool is not empty, and computes a
+  // new nonce otherwise. Nonces can only be precomputed with OpenSSL.
+  static crypto::tink::util::StatusOr<std::unique_ptr<EcdsaSignBoringSsl>> New(
+      const SubtleUtilBoringSSL::EcKey& ec_key, HashType hash_type,
+      EcdsaSignatureEncoding encoding, int nonce_pool_capacity);
+
   // Computes the signature for 'data'.
   crypto::tink::util::StatusOr<std::string> Sign(
       absl::string_view data) const override;
 
+  // Precomputes nonces until the nonce pool is full, and returns the number
+  // of nonces that were added. Meant to be called from a background thread
+  // while the signer is idle; each nonce is used for at most one signature.
+  crypto::tink::util::StatusOr<int> RefillNoncePool() const {
+    return raw_signer_->RefillNoncePool();
+  }
+
   static constexpr crypto::tink::internal::FipsCompatibility kFipsStatus =
       crypto::tink::internal::FipsCompatibility::kRequiresBoringCrypto;
 
@@ -55,6 +71,8 @@ class EcdsaSignBoringSsl : public PublicKeySign {
       : hash_(hash), raw_signer_(std::move(raw_signer)) {}
 
   const EVP_MD* hash_;  // Owned by BoringSSL.
+  // Contexts for computing the digest of the data.
+  mutable internal::EvpMdCtxPool md_ctx_pool_;
   std::unique_ptr<internal::EcdsaRawSignBoringSsl> raw_signer_;
 };
 
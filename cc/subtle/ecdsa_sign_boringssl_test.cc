@@ -16,11 +16,14 @@
 
 #include "tink/subtle/ecdsa_sign_boringssl.h"
 
+#include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
+#include "absl/strings/string_view.h"
 #include "tink/config/tink_fips.h"
 #include "tink/internal/ec_util.h"
 #include "tink/public_key_sign.h"
@@ -83,6 +86,51 @@ TEST_F(EcdsaSignBoringSslTest, testBasicSigning) {
   }
 }
 
+TEST_F(EcdsaSignBoringSslTest, VerifyBatch) {
+  if (IsFipsModeEnabled() && !FIPS_mode()) {
+    GTEST_SKIP()
+        << "Test is skipped if kOnlyUseFips but BoringCrypto is unavailable.";
+  }
+  for (EcdsaSignatureEncoding encoding :
+       {EcdsaSignatureEncoding::DER, EcdsaSignatureEncoding::IEEE_P1363}) {
+    util::StatusOr<SubtleUtilBoringSSL::EcKey> ec_key =
+        SubtleUtilBoringSSL::GetNewEcKey(EllipticCurveType::NIST_P256);
+    ASSERT_THAT(ec_key, IsOk());
+    util::StatusOr<std::unique_ptr<EcdsaSignBoringSsl>> signer =
+        EcdsaSignBoringSsl::New(*ec_key, HashType::SHA256, encoding);
+    ASSERT_THAT(signer, IsOk());
+    util::StatusOr<std::unique_ptr<EcdsaVerifyBoringSsl>> verifier =
+        EcdsaVerifyBoringSsl::New(*ec_key, HashType::SHA256, encoding);
+    ASSERT_THAT(verifier, IsOk());
+
+    std::vector<std::string> messages;
+    std::vector<std::string> signatures;
+    for (int i = 0; i < 10; ++i) {
+      messages.push_back(std::string(i, 'm'));
+      util::StatusOr<std::string> signature = (*signer)->Sign(messages.back());
+      ASSERT_THAT(signature, IsOk());
+      signatures.push_back(*signature);
+    }
+    signatures[3] = "some bad signature";
+    messages[8] = "some bad message";
+
+    std::vector<absl::string_view> signature_views(signatures.begin(),
+                                                   signatures.end());
+    std::vector<absl::string_view> message_views(messages.begin(),
+                                                 messages.end());
+    std::vector<util::Status> results =
+        (*verifier)->VerifyBatch(signature_views, message_views);
+    ASSERT_EQ(results.size(), signatures.size());
+    for (int i = 0; i < results.size(); ++i) {
+      if (i == 3 || i == 8) {
+        EXPECT_THAT(results[i], StatusIs(absl::StatusCode::kInvalidArgument));
+      } else {
+        EXPECT_THAT(results[i], IsOk());
+      }
+    }
+  }
+}
+
 TEST_F(EcdsaSignBoringSslTest, testEncodingsMismatch) {
   if (IsFipsModeEnabled() && !FIPS_mode()) {
     GTEST_SKIP()
@@ -19,6 +19,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
@@ -26,6 +27,7 @@
 #include "openssl/ec.h"
 #include "openssl/ecdsa.h"
 #include "openssl/evp.h"
+#include "tink/internal/bn_util.h"
 #include "tink/internal/ec_util.h"
 #include "tink/internal/err_util.h"
 #include "tink/internal/md_util.h"
@@ -39,6 +41,40 @@ namespace crypto {
 namespace tink {
 namespace subtle {
 
+namespace {
+
+// Returns the (r, s) pair of an IEEE P1363 signature, which is the
+// concatenation of r and s, each encoded with the field size of `group`.
+util::StatusOr<internal::SslUniquePtr<ECDSA_SIG>> IeeeSignatureToEcdsaSig(
+    const EC_GROUP* group, absl::string_view ieee_sig) {
+  const size_t field_size_in_bytes = (EC_GROUP_get_degree(group) + 7) / 8;
+  if (ieee_sig.size() != field_size_in_bytes * 2) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "Signature is not valid.");
+  }
+  util::StatusOr<internal::SslUniquePtr<BIGNUM>> r =
+      internal::StringToBignum(ieee_sig.substr(0, field_size_in_bytes));
+  if (!r.ok()) {
+    return r.status();
+  }
+  util::StatusOr<internal::SslUniquePtr<BIGNUM>> s =
+      internal::StringToBignum(ieee_sig.substr(field_size_in_bytes));
+  if (!s.ok()) {
+    return s.status();
+  }
+  internal::SslUniquePtr<ECDSA_SIG> ecdsa_sig(ECDSA_SIG_new());
+  if (ecdsa_sig == nullptr ||
+      ECDSA_SIG_set0(ecdsa_sig.get(), r->get(), s->get()) != 1) {
+    return util::Status(absl::StatusCode::kInternal, "ECDSA_SIG_set0 failed");
+  }
+  // ECDSA_SIG_set0 takes ownership of r and s.
+  r->release();
+  s->release();
+  return std::move(ecdsa_sig);
+}
+
+}  // namespace
+
 util::StatusOr<std::unique_ptr<EcdsaVerifyBoringSsl>> EcdsaVerifyBoringSsl::New(
     const SubtleUtilBoringSSL::EcKey& ec_key, HashType hash_type,
     EcdsaSignatureEncoding encoding) {
@@ -87,6 +123,28 @@ util::StatusOr<std::unique_ptr<EcdsaVerifyBoringSsl>> EcdsaVerifyBoringSsl::New(
 
 util::Status EcdsaVerifyBoringSsl::Verify(absl::string_view signature,
                                           absl::string_view data) const {
+  internal::EvpMdCtxPool::ScopedCtx md_ctx = md_ctx_pool_.Get();
+  return VerifyWithContext(md_ctx.get(), signature, data);
+}
+
+std::vector<util::Status> EcdsaVerifyBoringSsl::VerifyBatch(
+    absl::Span<const absl::string_view> signatures,
+    absl::Span<const absl::string_view> data) const {
+  if (signatures.size() != data.size()) {
+    return PublicKeyVerify::VerifyBatch(signatures, data);
+  }
+  internal::EvpMdCtxPool::ScopedCtx md_ctx = md_ctx_pool_.Get();
+  std::vector<util::Status> results;
+  results.reserve(signatures.size());
+  for (size_t i = 0; i < signatures.size(); ++i) {
+    results.push_back(VerifyWithContext(md_ctx.get(), signatures[i], data[i]));
+  }
+  return results;
+}
+
+util::Status EcdsaVerifyBoringSsl::VerifyWithContext(
+    EVP_MD_CTX* md_ctx, absl::string_view signature,
+    absl::string_view data) const {
   // BoringSSL expects a non-null pointer for data,
   // regardless of whether the size is 0.
   data = internal::EnsureStringNonNull(data);
@@ -94,27 +152,32 @@ util::Status EcdsaVerifyBoringSsl::Verify(absl::string_view signature,
   // Compute the digest.
   unsigned int digest_size;
   uint8_t digest[EVP_MAX_MD_SIZE];
-  if (1 != EVP_Digest(data.data(), data.size(), digest, &digest_size, hash_,
-                      nullptr)) {
+  if (md_ctx == nullptr ||
+      1 != EVP_DigestInit_ex(md_ctx, hash_, /*impl=*/nullptr) ||
+      1 != EVP_DigestUpdate(md_ctx, data.data(), data.size()) ||
+      1 != EVP_DigestFinal_ex(md_ctx, digest, &digest_size)) {
     return util::Status(absl::StatusCode::kInternal,
                         "Could not compute digest.");
   }
 
-  std::string derSig(signature);
+  // Verify the signature. IEEE P1363 signatures are verified directly on
+  // (r, s), without converting them to DER first.
+  int verified;
   if (encoding_ == subtle::EcdsaSignatureEncoding::IEEE_P1363) {
-    const EC_GROUP* group = EC_KEY_get0_group(key_.get());
-    auto status_or_der = internal::EcSignatureIeeeToDer(group, signature);
-
-    if (!status_or_der.ok()) {
-      return status_or_der.status();
+    util::StatusOr<internal::SslUniquePtr<ECDSA_SIG>> ecdsa_sig =
+        IeeeSignatureToEcdsaSig(EC_KEY_get0_group(key_.get()), signature);
+    if (!ecdsa_sig.ok()) {
+      return ecdsa_sig.status();
     }
-    derSig = status_or_der.value();
+    verified =
+        ECDSA_do_verify(digest, digest_size, ecdsa_sig->get(), key_.get());
+  } else {
+    signature = internal::EnsureStringNonNull(signature);
+    verified = ECDSA_verify(0 /* unused */, digest, digest_size,
+                            reinterpret_cast<const uint8_t*>(signature.data()),
+                            signature.size(), key_.get());
   }
-
-  // Verify the signature.
-  if (1 != ECDSA_verify(0 /* unused */, digest, digest_size,
-                        reinterpret_cast<const uint8_t*>(derSig.data()),
-                        derSig.size(), key_.get())) {
+  if (verified != 1) {
     // signature is invalid
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "Signature is not valid.");
@@ -19,10 +19,13 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "openssl/ec.h"
 #include "openssl/evp.h"
+#include "tink/internal/evp_md_ctx_pool.h"
 #include "tink/internal/fips_utils.h"
 #include "tink/internal/ssl_unique_ptr.h"
 #include "tink/public_key_verify.h"
@@ -50,16 +53,30 @@ class EcdsaVerifyBoringSsl : public PublicKeyVerify {
       absl::string_view signature,
       absl::string_view data) const override;
 
+  // Verifies the signatures of the batch one after the other, with a single
+  // context.
+  std::vector<crypto::tink::util::Status> VerifyBatch(
+      absl::Span<const absl::string_view> signatures,
+      absl::Span<const absl::string_view> data) const override;
+
   static constexpr crypto::tink::internal::FipsCompatibility kFipsStatus =
       crypto::tink::internal::FipsCompatibility::kRequiresBoringCrypto;
 
  private:
+  // Verifies 'signature', hashing 'data' with 'md_ctx', which may be nullptr
+  // if it could not be allocated.
+  crypto::tink::util::Status VerifyWithContext(EVP_MD_CTX* md_ctx,
+                                               absl::string_view signature,
+                                               absl::string_view data) const;
+
   EcdsaVerifyBoringSsl(internal::SslUniquePtr<EC_KEY> key, const EVP_MD* hash,
                        EcdsaSignatureEncoding encoding)
       : key_(std::move(key)), hash_(hash), encoding_(encoding) {}
 
   internal::SslUniquePtr<EC_KEY> key_;
   const EVP_MD* hash_;  // Owned by BoringSSL.
+  // Contexts for computing the digest of the data.
+  mutable internal::EvpMdCtxPool md_ctx_pool_;
   EcdsaSignatureEncoding encoding_;
 };
 
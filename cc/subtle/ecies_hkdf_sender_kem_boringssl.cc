@@ -25,6 +25,7 @@
 #include "absl/strings/string_view.h"
 #include "openssl/bn.h"
 #include "openssl/evp.h"
+#include "tink/internal/ec_ephemeral_key_pool.h"
 #include "tink/internal/ec_util.h"
 #include "tink/internal/ssl_unique_ptr.h"
 #include "tink/subtle/common_enums.h"
@@ -35,6 +36,18 @@ namespace crypto {
 namespace tink {
 namespace subtle {
 
+namespace {
+
+util::Status ValidateEphemeralKeyPoolCapacity(int capacity) {
+  if (capacity < 0) {
+    return util::Status(absl::StatusCode::kInvalidArgument,
+                        "Ephemeral key pool capacity must not be negative.");
+  }
+  return util::OkStatus();
+}
+
+}  // namespace
+
 // static
 util::StatusOr<std::unique_ptr<const EciesHkdfSenderKemBoringSsl>>
 EciesHkdfSenderKemBoringSsl::New(subtle::EllipticCurveType curve,
@@ -53,6 +66,52 @@ EciesHkdfSenderKemBoringSsl::New(subtle::EllipticCurveType curve,
   }
 }
 
+// static
+util::StatusOr<std::unique_ptr<const EciesHkdfSenderKemBoringSsl>>
+EciesHkdfSenderKemBoringSsl::New(subtle::EllipticCurveType curve,
+                                 const std::string& pubx,
+                                 const std::string& puby,
+                                 int ephemeral_key_pool_capacity) {
+  switch (curve) {
+    case EllipticCurveType::NIST_P256:
+    case EllipticCurveType::NIST_P384:
+    case EllipticCurveType::NIST_P521:
+      return EciesHkdfNistPCurveSendKemBoringSsl::New(
+          curve, pubx, puby, ephemeral_key_pool_capacity);
+    case EllipticCurveType::CURVE25519:
+      return EciesHkdfX25519SendKemBoringSsl::New(curve, pubx, puby,
+                                                  ephemeral_key_pool_capacity);
+    default:
+      return util::Status(absl::StatusCode::kUnimplemented,
+                          "Unsupported elliptic curve");
+  }
+}
+
+util::StatusOr<int> EciesHkdfSenderKemBoringSsl::RefillEphemeralKeyPool()
+    const {
+  if (ephemeral_key_pool_ == nullptr) {
+    return util::Status(absl::StatusCode::kFailedPrecondition,
+                        "The KEM has no ephemeral key pool.");
+  }
+  return ephemeral_key_pool_->Refill();
+}
+
+void EciesHkdfSenderKemBoringSsl::InitEphemeralKeyPool(
+    subtle::EllipticCurveType curve, int capacity) {
+  if (capacity > 0) {
+    ephemeral_key_pool_ =
+        absl::make_unique<internal::EcEphemeralKeyPool>(curve, capacity);
+  }
+}
+
+internal::EcEphemeralKey EciesHkdfSenderKemBoringSsl::TakeEphemeralKey()
+    const {
+  if (ephemeral_key_pool_ == nullptr) {
+    return internal::EcEphemeralKey();
+  }
+  return ephemeral_key_pool_->Take();
+}
+
 EciesHkdfNistPCurveSendKemBoringSsl::EciesHkdfNistPCurveSendKemBoringSsl(
     subtle::EllipticCurveType curve, const std::string& pubx,
     const std::string& puby, internal::SslUniquePtr<EC_POINT> peer_pub_key)
@@ -66,16 +125,28 @@ util::StatusOr<std::unique_ptr<const EciesHkdfSenderKemBoringSsl>>
 EciesHkdfNistPCurveSendKemBoringSsl::New(subtle::EllipticCurveType curve,
                                          const std::string& pubx,
                                          const std::string& puby) {
+  return New(curve, pubx, puby, /*ephemeral_key_pool_capacity=*/0);
+}
+
+// static
+util::StatusOr<std::unique_ptr<const EciesHkdfSenderKemBoringSsl>>
+EciesHkdfNistPCurveSendKemBoringSsl::New(subtle::EllipticCurveType curve,
+                                         const std::string& pubx,
+                                         const std::string& puby,
+                                         int ephemeral_key_pool_capacity) {
   auto status =
       internal::CheckFipsCompatibility<EciesHkdfNistPCurveSendKemBoringSsl>();
   if (!status.ok()) return status;
+  status = ValidateEphemeralKeyPoolCapacity(ephemeral_key_pool_capacity);
+  if (!status.ok()) return status;
 
   auto status_or_ec_point = internal::GetEcPoint(curve, pubx, puby);
   if (!status_or_ec_point.ok()) return status_or_ec_point.status();
-  std::unique_ptr<const EciesHkdfSenderKemBoringSsl> sender_kem(
+  std::unique_ptr<EciesHkdfNistPCurveSendKemBoringSsl> sender_kem(
       new EciesHkdfNistPCurveSendKemBoringSsl(
           curve, pubx, puby, std::move(status_or_ec_point.value())));
-  return std::move(sender_kem);
+  sender_kem->InitEphemeralKeyPool(curve, ephemeral_key_pool_capacity);
+  return {std::move(sender_kem)};
 }
 
 util::StatusOr<std::unique_ptr<const EciesHkdfSenderKemBoringSsl::KemKey>>
@@ -94,13 +165,18 @@ EciesHkdfNistPCurveSendKemBoringSsl::GenerateKey(
   }
   internal::SslUniquePtr<EC_GROUP> group =
       std::move(status_or_ec_group.value());
-  internal::SslUniquePtr<EC_KEY> ephemeral_key(EC_KEY_new());
-  if (1 != EC_KEY_set_group(ephemeral_key.get(), group.get())) {
-    return util::Status(absl::StatusCode::kInternal, "EC_KEY_set_group failed");
-  }
-  if (1 != EC_KEY_generate_key(ephemeral_key.get())) {
-    return util::Status(absl::StatusCode::kInternal,
-                        "EC_KEY_generate_key failed");
+  internal::SslUniquePtr<EC_KEY> ephemeral_key =
+      std::move(TakeEphemeralKey().ec_key);
+  if (ephemeral_key == nullptr) {
+    ephemeral_key.reset(EC_KEY_new());
+    if (1 != EC_KEY_set_group(ephemeral_key.get(), group.get())) {
+      return util::Status(absl::StatusCode::kInternal,
+                          "EC_KEY_set_group failed");
+    }
+    if (1 != EC_KEY_generate_key(ephemeral_key.get())) {
+      return util::Status(absl::StatusCode::kInternal,
+                          "EC_KEY_generate_key failed");
+    }
   }
   const BIGNUM* ephemeral_priv = EC_KEY_get0_private_key(ephemeral_key.get());
   const EC_POINT* ephemeral_pub = EC_KEY_get0_public_key(ephemeral_key.get());
@@ -135,9 +211,20 @@ util::StatusOr<std::unique_ptr<const EciesHkdfSenderKemBoringSsl>>
 EciesHkdfX25519SendKemBoringSsl::New(subtle::EllipticCurveType curve,
                                      const std::string& pubx,
                                      const std::string& puby) {
+  return New(curve, pubx, puby, /*ephemeral_key_pool_capacity=*/0);
+}
+
+// static
+util::StatusOr<std::unique_ptr<const EciesHkdfSenderKemBoringSsl>>
+EciesHkdfX25519SendKemBoringSsl::New(subtle::EllipticCurveType curve,
+                                     const std::string& pubx,
+                                     const std::string& puby,
+                                     int ephemeral_key_pool_capacity) {
   auto status =
       internal::CheckFipsCompatibility<EciesHkdfX25519SendKemBoringSsl>();
   if (!status.ok()) return status;
+  status = ValidateEphemeralKeyPoolCapacity(ephemeral_key_pool_capacity);
+  if (!status.ok()) return status;
 
   if (curve != CURVE25519) {
     return util::Status(absl::StatusCode::kInvalidArgument,
@@ -160,9 +247,10 @@ EciesHkdfX25519SendKemBoringSsl::New(subtle::EllipticCurveType curve,
     return util::Status(absl::StatusCode::kInternal,
                         "EVP_PKEY_new_raw_public_key failed");
   }
-  std::unique_ptr<const EciesHkdfSenderKemBoringSsl> sender_kem(
+  std::unique_ptr<EciesHkdfX25519SendKemBoringSsl> sender_kem(
       new EciesHkdfX25519SendKemBoringSsl(std::move(peer_public_key)));
-  return std::move(sender_kem);
+  sender_kem->InitEphemeralKeyPool(curve, ephemeral_key_pool_capacity);
+  return {std::move(sender_kem)};
 }
 
 util::StatusOr<std::unique_ptr<const EciesHkdfSenderKemBoringSsl::KemKey>>
@@ -176,13 +264,22 @@ EciesHkdfX25519SendKemBoringSsl::GenerateKey(
         "X25519 only supports compressed elliptic curve points");
   }
 
-  // Generate an ephemeral key pair; the public key is the KEM key to use.
-  util::StatusOr<std::unique_ptr<internal::X25519Key>> ephemeral_key =
-      internal::NewX25519Key();
+  // Generate an ephemeral key pair, unless one was precomputed; the public
+  // key is the KEM key to use.
+  util::SecretUniquePtr<internal::X25519Key> ephemeral_key =
+      std::move(TakeEphemeralKey().x25519_key);
+  if (!ephemeral_key) {
+    util::StatusOr<std::unique_ptr<internal::X25519Key>> new_key =
+        internal::NewX25519Key();
+    if (!new_key.ok()) return new_key.status();
+    ephemeral_key = util::MakeSecretUniquePtr<internal::X25519Key>(**new_key);
+    util::SafeZeroMemory((*new_key)->private_key,
+                         sizeof((*new_key)->private_key));
+  }
 
   internal::SslUniquePtr<EVP_PKEY> ssl_priv_key(EVP_PKEY_new_raw_private_key(
       /*type=*/EVP_PKEY_X25519, /*unused=*/nullptr,
-      /*in=*/(*ephemeral_key)->private_key,
+      /*in=*/ephemeral_key->private_key,
       /*len=*/internal::Ed25519KeyPrivKeySize()));
   if (ssl_priv_key == nullptr) {
     return util::Status(absl::StatusCode::kInternal,
@@ -194,7 +291,7 @@ EciesHkdfX25519SendKemBoringSsl::GenerateKey(
                                           peer_public_key_.get());
 
   auto public_key = absl::string_view(
-      reinterpret_cast<const char*>((*ephemeral_key)->public_value),
+      reinterpret_cast<const char*>(ephemeral_key->public_value),
       internal::X25519KeyPubKeySize());
 
   util::StatusOr<util::SecretData> symmetric_key_or =
@@ -23,6 +23,7 @@
 
 #include "absl/strings/string_view.h"
 #include "openssl/evp.h"
+#include "tink/internal/ec_ephemeral_key_pool.h"
 #include "tink/internal/fips_utils.h"
 #include "tink/internal/ssl_unique_ptr.h"
 #include "tink/subtle/common_enums.h"
@@ -61,6 +62,14 @@ class EciesHkdfSenderKemBoringSsl {
   New(EllipticCurveType curve, const std::string& pubx,
       const std::string& puby);
 
+  // Same as above, but GenerateKey() uses ephemeral key pairs from a pool of
+  // at most `ephemeral_key_pool_capacity` precomputed key pairs while the
+  // pool is not empty. The pool is filled by RefillEphemeralKeyPool().
+  static crypto::tink::util::StatusOr<
+      std::unique_ptr<const EciesHkdfSenderKemBoringSsl>>
+  New(EllipticCurveType curve, const std::string& pubx,
+      const std::string& puby, int ephemeral_key_pool_capacity);
+
   // Generates ephemeral key pairs, computes ECDH's shared secret based on
   // generated ephemeral key and recipient's public key, then uses HKDF
   // to derive the symmetric key from the shared secret, 'hkdf_info' and
@@ -70,7 +79,24 @@ class EciesHkdfSenderKemBoringSsl {
               absl::string_view hkdf_info, uint32_t key_size_in_bytes,
               EcPointFormat point_format) const = 0;
 
+  // Generates ephemeral key pairs until the pool is full, and returns the
+  // number of key pairs that were added. Meant to be called from a
+  // background thread. Returns an error if the KEM was created without a
+  // pool.
+  crypto::tink::util::StatusOr<int> RefillEphemeralKeyPool() const;
+
   virtual ~EciesHkdfSenderKemBoringSsl() = default;
+
+ protected:
+  // Creates the pool used by TakeEphemeralKey(), if `capacity` is positive.
+  void InitEphemeralKeyPool(EllipticCurveType curve, int capacity);
+
+  // Returns a precomputed ephemeral key pair, or an empty one if there is
+  // none.
+  internal::EcEphemeralKey TakeEphemeralKey() const;
+
+ private:
+  std::unique_ptr<internal::EcEphemeralKeyPool> ephemeral_key_pool_;
 };
 
 // Implementation of EciesHkdfSenderKemBoringSsl for the NIST P-curves.
@@ -83,6 +109,12 @@ class EciesHkdfNistPCurveSendKemBoringSsl : public EciesHkdfSenderKemBoringSsl {
   New(EllipticCurveType curve, const std::string& pubx,
       const std::string& puby);
 
+  // Same as above, with a pool of precomputed ephemeral key pairs.
+  static crypto::tink::util::StatusOr<
+      std::unique_ptr<const EciesHkdfSenderKemBoringSsl>>
+  New(EllipticCurveType curve, const std::string& pubx,
+      const std::string& puby, int ephemeral_key_pool_capacity);
+
   // Generates ephemeral key pairs, computes ECDH's shared secret based on
   // generated ephemeral key and recipient's public key, then uses HKDF
   // to derive the symmetric key from the shared secret, 'hkdf_info' and
@@ -115,6 +147,12 @@ class EciesHkdfX25519SendKemBoringSsl : public EciesHkdfSenderKemBoringSsl {
   New(EllipticCurveType curve, const std::string& pubx,
       const std::string& puby);
 
+  // Same as above, with a pool of precomputed ephemeral key pairs.
+  static crypto::tink::util::StatusOr<
+      std::unique_ptr<const EciesHkdfSenderKemBoringSsl>>
+  New(EllipticCurveType curve, const std::string& pubx,
+      const std::string& puby, int ephemeral_key_pool_capacity);
+
   // Generates ephemeral key pairs, computes ECDH's shared secret based on
   // generated ephemeral key and recipient's public key, then uses HKDF
   // to derive the symmetric key from the shared secret, 'hkdf_info' and
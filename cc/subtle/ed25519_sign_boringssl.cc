@@ -76,7 +76,11 @@ util::StatusOr<std::string> Ed25519SignBoringSsl::Sign(
   uint8_t out_sig[kEd25519SignatureLenInBytes];
   std::fill(std::begin(out_sig), std::end(out_sig), 0);
 
-  internal::SslUniquePtr<EVP_MD_CTX> md_ctx(EVP_MD_CTX_create());
+  internal::EvpMdCtxPool::ScopedCtx md_ctx = md_ctx_pool_.Get();
+  if (md_ctx.get() == nullptr) {
+    return util::Status(absl::StatusCode::kInternal,
+                        "EVP_MD_CTX_new failed.");
+  }
   size_t sig_len = kEd25519SignatureLenInBytes;
   // type must be set to nullptr with Ed25519.
   // See https://www.openssl.org/docs/man1.1.1/man3/EVP_DigestSignInit.html.
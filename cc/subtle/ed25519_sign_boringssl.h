@@ -23,6 +23,7 @@
 
 #include "openssl/evp.h"
 #include "tink/config/tink_fips.h"
+#include "tink/internal/evp_md_ctx_pool.h"
 #include "tink/internal/ssl_unique_ptr.h"
 #include "tink/public_key_sign.h"
 #include "tink/util/secret_data.h"
@@ -49,6 +50,8 @@ class Ed25519SignBoringSsl : public PublicKeySign {
       : priv_key_(std::move(priv_key)) {}
 
   const internal::SslUniquePtr<EVP_PKEY> priv_key_;
+  // Signing contexts initialized with `priv_key_`.
+  mutable internal::EvpMdCtxPool md_ctx_pool_;
 };
 
 }  // namespace subtle
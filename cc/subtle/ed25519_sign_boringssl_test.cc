@@ -19,11 +19,13 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
 #include "absl/strings/escaping.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "tink/config/tink_fips.h"
 #include "tink/internal/ec_util.h"
 #include "tink/public_key_sign.h"
@@ -42,6 +44,7 @@ namespace {
 
 using ::crypto::tink::test::IsOk;
 using ::crypto::tink::test::StatusIs;
+using ::testing::Not;
 
 constexpr int kEd25519SignatureLenInBytes = 64;
 
@@ -109,6 +112,48 @@ TEST_F(Ed25519SignBoringSslTest, testBasicSign) {
   }
 }
 
+TEST_F(Ed25519SignBoringSslTest, VerifyBatch) {
+  if (IsFipsModeEnabled()) {
+    GTEST_SKIP() << "Test assumes kOnlyUseFips is false.";
+  }
+
+  util::StatusOr<Ed25519KeyPair> key = NewKeyPair();
+  ASSERT_THAT(key, IsOk());
+  util::StatusOr<std::unique_ptr<PublicKeySign>> signer =
+      Ed25519SignBoringSsl::New(key->private_key);
+  ASSERT_THAT(signer, IsOk());
+  util::StatusOr<std::unique_ptr<PublicKeyVerify>> verifier =
+      Ed25519VerifyBoringSsl::New(key->public_key);
+  ASSERT_THAT(verifier, IsOk());
+
+  std::vector<std::string> messages;
+  std::vector<std::string> signatures;
+  for (int i = 0; i < 10; ++i) {
+    messages.push_back(Random::GetRandomBytes(i));
+    util::StatusOr<std::string> signature = (*signer)->Sign(messages.back());
+    ASSERT_THAT(signature, IsOk());
+    signatures.push_back(*signature);
+  }
+  signatures[3] = "some bad signature";
+  signatures[7][0] ^= 1;
+  messages[8] = "some bad message";
+
+  std::vector<absl::string_view> signature_views(signatures.begin(),
+                                                 signatures.end());
+  std::vector<absl::string_view> message_views(messages.begin(),
+                                               messages.end());
+  std::vector<util::Status> results =
+      (*verifier)->VerifyBatch(signature_views, message_views);
+  ASSERT_EQ(results.size(), signatures.size());
+  for (int i = 0; i < results.size(); ++i) {
+    if (i == 3 || i == 7 || i == 8) {
+      EXPECT_THAT(results[i], Not(IsOk()));
+    } else {
+      EXPECT_THAT(results[i], IsOk());
+    }
+  }
+}
+
 TEST_F(Ed25519SignBoringSslTest, testInvalidPrivateKeys) {
   if (IsFipsModeEnabled()) {
     GTEST_SKIP() << "Test assumes kOnlyUseFips is false.";
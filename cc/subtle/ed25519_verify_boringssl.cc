@@ -19,6 +19,7 @@
 #include <cstring>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
@@ -64,6 +65,28 @@ util::StatusOr<std::unique_ptr<PublicKeyVerify>> Ed25519VerifyBoringSsl::New(
 
 util::Status Ed25519VerifyBoringSsl::Verify(absl::string_view signature,
                                             absl::string_view data) const {
+  internal::EvpMdCtxPool::ScopedCtx md_ctx = md_ctx_pool_.Get();
+  return VerifyWithContext(md_ctx.get(), signature, data);
+}
+
+std::vector<util::Status> Ed25519VerifyBoringSsl::VerifyBatch(
+    absl::Span<const absl::string_view> signatures,
+    absl::Span<const absl::string_view> data) const {
+  if (signatures.size() != data.size()) {
+    return PublicKeyVerify::VerifyBatch(signatures, data);
+  }
+  internal::EvpMdCtxPool::ScopedCtx md_ctx = md_ctx_pool_.Get();
+  std::vector<util::Status> results;
+  results.reserve(signatures.size());
+  for (size_t i = 0; i < signatures.size(); ++i) {
+    results.push_back(VerifyWithContext(md_ctx.get(), signatures[i], data[i]));
+  }
+  return results;
+}
+
+util::Status Ed25519VerifyBoringSsl::VerifyWithContext(
+    EVP_MD_CTX *md_ctx, absl::string_view signature,
+    absl::string_view data) const {
   signature = internal::EnsureStringNonNull(signature);
   data = internal::EnsureStringNonNull(data);
 
@@ -75,16 +98,19 @@ util::Status Ed25519VerifyBoringSsl::Verify(absl::string_view signature,
                         signature.size(), kEd25519SignatureLenInBytes));
   }
 
-  internal::SslUniquePtr<EVP_MD_CTX> md_ctx(EVP_MD_CTX_create());
+  if (md_ctx == nullptr) {
+    return util::Status(absl::StatusCode::kInternal,
+                        "EVP_MD_CTX_new failed.");
+  }
   // `type` must be set to nullptr with Ed25519.
-  if (EVP_DigestVerifyInit(md_ctx.get(), /*pctx=*/nullptr, /*type=*/nullptr,
+  if (EVP_DigestVerifyInit(md_ctx, /*pctx=*/nullptr, /*type=*/nullptr,
                            /*e=*/nullptr, public_key_.get()) != 1) {
     return util::Status(absl::StatusCode::kInternal,
                         "EVP_DigestVerifyInit failed.");
   }
 
   if (EVP_DigestVerify(
-          md_ctx.get(),
+          md_ctx,
           /*sig=*/reinterpret_cast<const uint8_t *>(signature.data()),
           signature.size(),
           /*data=*/reinterpret_cast<const uint8_t *>(data.data()),
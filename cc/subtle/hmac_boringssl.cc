@@ -83,20 +83,12 @@ util::StatusOr<std::string> HmacBoringSsl::ComputeMac(
 
 util::Status HmacBoringSsl::VerifyMac(absl::string_view mac,
                                       absl::string_view data) const {
-  // BoringSSL expects a non-null pointer for data,
-  // regardless of whether the size is 0.
-  data = internal::EnsureStringNonNull(data);
-
   if (mac.size() != tag_size_) {
     return util::Status(absl::StatusCode::kInvalidArgument,
                         "incorrect tag size");
   }
   uint8_t buf[EVP_MAX_MD_SIZE];
-  unsigned int out_len;
-  const uint8_t* res = HMAC(md_, key_.data(), key_.size(),
-                            reinterpret_cast<const uint8_t*>(data.data()),
-                            data.size(), buf, &out_len);
-  if (res == nullptr) {
+  if (!ComputeUntruncatedMac(data, buf)) {
     return util::Status(absl::StatusCode::kInternal,
                         "BoringSSL failed to compute HMAC");
   }
@@ -107,6 +99,24 @@ util::Status HmacBoringSsl::VerifyMac(absl::string_view mac,
   return util::OkStatus();
 }
 
+bool HmacBoringSsl::TryVerifyMac(absl::string_view mac,
+                                 absl::string_view data) const {
+  uint8_t buf[EVP_MAX_MD_SIZE];
+  return mac.size() == tag_size_ && ComputeUntruncatedMac(data, buf) &&
+         CRYPTO_memcmp(buf, mac.data(), tag_size_) == 0;
+}
+
+bool HmacBoringSsl::ComputeUntruncatedMac(absl::string_view data,
+                                          uint8_t* mac) const {
+  // BoringSSL expects a non-null pointer for data,
+  // regardless of whether the size is 0.
+  data = internal::EnsureStringNonNull(data);
+  unsigned int out_len;
+  return HMAC(md_, key_.data(), key_.size(),
+              reinterpret_cast<const uint8_t*>(data.data()), data.size(), mac,
+              &out_len) != nullptr;
+}
+
 }  // namespace subtle
 }  // namespace tink
 }  // namespace crypto
@@ -24,6 +24,7 @@
 #include "absl/strings/string_view.h"
 #include "openssl/evp.h"
 #include "tink/internal/fips_utils.h"
+#include "tink/internal/trial_decryption.h"
 #include "tink/mac.h"
 #include "tink/subtle/common_enums.h"
 #include "tink/util/secret_data.h"
@@ -34,7 +35,7 @@ namespace crypto {
 namespace tink {
 namespace subtle {
 
-class HmacBoringSsl : public Mac {
+class HmacBoringSsl : public Mac, public internal::TrialVerificationMac {
  public:
   static crypto::tink::util::StatusOr<std::unique_ptr<Mac>> New(
       HashType hash_type, uint32_t tag_size, util::SecretData key);
@@ -49,6 +50,9 @@ class HmacBoringSsl : public Mac {
       absl::string_view mac,
       absl::string_view data) const override;
 
+  bool TryVerifyMac(absl::string_view mac,
+                    absl::string_view data) const override;
+
   static constexpr crypto::tink::internal::FipsCompatibility kFipsStatus =
       crypto::tink::internal::FipsCompatibility::kRequiresBoringCrypto;
 
@@ -59,6 +63,10 @@ class HmacBoringSsl : public Mac {
   HmacBoringSsl(const EVP_MD* md, uint32_t tag_size, util::SecretData key)
       : md_(md), tag_size_(tag_size), key_(std::move(key)) {}
 
+  // Computes the HMAC of `data`, before truncation to tag_size_, into `mac`,
+  // which must hold EVP_MAX_MD_SIZE bytes. Returns false on failure.
+  bool ComputeUntruncatedMac(absl::string_view data, uint8_t* mac) const;
+
   // HmacBoringSsl is not owner of md (it is owned by BoringSSL).
   const EVP_MD* const md_;
   const uint32_t tag_size_;
@@ -32,6 +32,7 @@
 #include "tink/internal/rsa_util.h"
 #include "tink/internal/ssl_unique_ptr.h"
 #include "tink/internal/util.h"
+#include "tink/signature/internal/rsa_key_replicas.h"
 #include "tink/subtle/subtle_util.h"
 #include "tink/util/statusor.h"
 
@@ -42,6 +43,12 @@ namespace subtle {
 util::StatusOr<std::unique_ptr<PublicKeySign>> RsaSsaPkcs1SignBoringSsl::New(
     const internal::RsaPrivateKey& private_key,
     const internal::RsaSsaPkcs1Params& params) {
+  return New(private_key, params, /*num_key_replicas=*/1);
+}
+
+util::StatusOr<std::unique_ptr<PublicKeySign>> RsaSsaPkcs1SignBoringSsl::New(
+    const internal::RsaPrivateKey& private_key,
+    const internal::RsaSsaPkcs1Params& params, int num_key_replicas) {
   util::Status status =
       internal::CheckFipsCompatibility<RsaSsaPkcs1SignBoringSsl>();
   if (!status.ok()) {
@@ -73,8 +80,8 @@ util::StatusOr<std::unique_ptr<PublicKeySign>> RsaSsaPkcs1SignBoringSsl::New(
 
   // The RSA modulus and exponent are checked as part of the conversion to
   // internal::SslUniquePtr<RSA>.
-  util::StatusOr<internal::SslUniquePtr<RSA>> rsa =
-      internal::RsaPrivateKeyToRsa(private_key);
+  util::StatusOr<std::unique_ptr<internal::RsaKeyReplicas>> rsa =
+      internal::RsaKeyReplicas::New(private_key, num_key_replicas);
   if (!rsa.ok()) {
     return rsa.status();
   }
@@ -91,8 +98,9 @@ util::StatusOr<std::string> RsaSsaPkcs1SignBoringSsl::Sign(
     return digest.status();
   }
 
+  RSA* private_key = private_keys_->Get();
   std::string signature;
-  ResizeStringUninitialized(&signature, RSA_size(private_key_.get()));
+  ResizeStringUninitialized(&signature, RSA_size(private_key));
   unsigned int signature_length = 0;
 
   if (RSA_sign(/*hash_nid=*/EVP_MD_type(sig_hash_),
@@ -100,7 +108,7 @@ util::StatusOr<std::string> RsaSsaPkcs1SignBoringSsl::Sign(
                /*digest_len=*/digest->size(),
                /*out=*/reinterpret_cast<uint8_t*>(&signature[0]),
                /*out_len=*/&signature_length,
-               /*rsa=*/private_key_.get()) != 1) {
+               /*rsa=*/private_key) != 1) {
     // TODO(b/112581512): Decide if it's safe to propagate the BoringSSL error.
     // For now, just empty the error stack.
     internal::GetSslErrors();
@@ -28,6 +28,7 @@
 #include "tink/internal/rsa_util.h"
 #include "tink/internal/ssl_unique_ptr.h"
 #include "tink/public_key_sign.h"
+#include "tink/signature/internal/rsa_key_replicas.h"
 #include "tink/subtle/common_enums.h"
 #include "tink/util/statusor.h"
 
@@ -45,6 +46,13 @@ class RsaSsaPkcs1SignBoringSsl : public PublicKeySign {
       const internal::RsaPrivateKey& private_key,
       const internal::RsaSsaPkcs1Params& params);
 
+  // Same as above, but the signer uses `num_key_replicas` independent RSA
+  // objects for the key in turn, so that concurrent calls to Sign() do not
+  // all contend on the blinding lock of a single RSA object.
+  static crypto::tink::util::StatusOr<std::unique_ptr<PublicKeySign>> New(
+      const internal::RsaPrivateKey& private_key,
+      const internal::RsaSsaPkcs1Params& params, int num_key_replicas);
+
   // Computes the signature for 'data'.
   crypto::tink::util::StatusOr<std::string> Sign(
       absl::string_view data) const override;
@@ -55,11 +63,12 @@ class RsaSsaPkcs1SignBoringSsl : public PublicKeySign {
       crypto::tink::internal::FipsCompatibility::kRequiresBoringCrypto;
 
  private:
-  RsaSsaPkcs1SignBoringSsl(internal::SslUniquePtr<RSA> private_key,
-                           const EVP_MD* sig_hash)
-      : private_key_(std::move(private_key)), sig_hash_(sig_hash) {}
+  RsaSsaPkcs1SignBoringSsl(
+      std::unique_ptr<internal::RsaKeyReplicas> private_keys,
+      const EVP_MD* sig_hash)
+      : private_keys_(std::move(private_keys)), sig_hash_(sig_hash) {}
 
-  const internal::SslUniquePtr<RSA> private_key_;
+  const std::unique_ptr<internal::RsaKeyReplicas> private_keys_;
   const EVP_MD* const sig_hash_;  // Owned by BoringSSL.
 };
 
@@ -17,6 +17,10 @@
 #include "tink/subtle/rsa_ssa_pkcs1_sign_boringssl.h"
 
 #include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -28,7 +32,10 @@
 #include "tink/config/tink_fips.h"
 #include "tink/internal/rsa_util.h"
 #include "tink/internal/ssl_unique_ptr.h"
+#include "tink/public_key_sign.h"
+#include "tink/signature/internal/rsa_key_replicas.h"
 #include "tink/subtle/rsa_ssa_pkcs1_verify_boringssl.h"
+#include "tink/util/statusor.h"
 #include "tink/util/test_matchers.h"
 
 namespace crypto {
@@ -77,6 +84,61 @@ TEST_F(RsaPkcs1SignBoringsslTest, EncodesPkcs1) {
               IsOk());
 }
 
+TEST_F(RsaPkcs1SignBoringsslTest, SignsWithKeyReplicas) {
+  if (IsFipsModeEnabled()) {
+    GTEST_SKIP() << "Test not run in FIPS-only mode";
+  }
+
+  internal::RsaSsaPkcs1Params params{/*sig_hash=*/HashType::SHA256};
+
+  util::StatusOr<std::unique_ptr<PublicKeySign>> signer =
+      RsaSsaPkcs1SignBoringSsl::New(private_key_, params,
+          /*num_key_replicas=*/4);
+  ASSERT_THAT(signer, IsOk());
+  util::StatusOr<std::unique_ptr<RsaSsaPkcs1VerifyBoringSsl>> verifier =
+      RsaSsaPkcs1VerifyBoringSsl::New(public_key_, params);
+  ASSERT_THAT(verifier, IsOk());
+
+  constexpr int kNumThreads = 8;
+  constexpr int kSignaturesPerThread = 5;
+  std::vector<std::vector<std::string>> signatures(kNumThreads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([&, i]() {
+      for (int j = 0; j < kSignaturesPerThread; ++j) {
+        util::StatusOr<std::string> signature = (*signer)->Sign("testdata");
+        if (signature.ok()) signatures[i].push_back(*signature);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  for (const std::vector<std::string>& thread_signatures : signatures) {
+    ASSERT_EQ(thread_signatures.size(), kSignaturesPerThread);
+    for (const std::string& signature : thread_signatures) {
+      EXPECT_THAT((*verifier)->Verify(signature, "testdata"), IsOk());
+    }
+  }
+}
+
+TEST_F(RsaPkcs1SignBoringsslTest, RejectsInvalidNumberOfKeyReplicas) {
+  if (IsFipsModeEnabled()) {
+    GTEST_SKIP() << "Test not run in FIPS-only mode";
+  }
+
+  internal::RsaSsaPkcs1Params params{/*sig_hash=*/HashType::SHA256};
+
+  for (int num_key_replicas :
+       {-1, 0, internal::RsaKeyReplicas::kMaxReplicas + 1}) {
+    EXPECT_THAT(RsaSsaPkcs1SignBoringSsl::New(private_key_, params,
+                                              num_key_replicas)
+                    .status(),
+                StatusIs(absl::StatusCode::kInvalidArgument));
+  }
+}
+
 TEST_F(RsaPkcs1SignBoringsslTest, EncodesPkcs1WithSeparateHashes) {
   if (IsFipsModeEnabled()) {
     GTEST_SKIP() << "Test not run in FIPS-only mode";
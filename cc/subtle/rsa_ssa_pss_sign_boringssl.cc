@@ -32,6 +32,7 @@
 #include "tink/internal/rsa_util.h"
 #include "tink/internal/ssl_unique_ptr.h"
 #include "tink/internal/util.h"
+#include "tink/signature/internal/rsa_key_replicas.h"
 #include "tink/subtle/subtle_util.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
@@ -103,6 +104,12 @@ util::StatusOr<std::string> SslRsaSsaPssSign(RSA* rsa_private_key,
 util::StatusOr<std::unique_ptr<PublicKeySign>> RsaSsaPssSignBoringSsl::New(
     const internal::RsaPrivateKey& private_key,
     const internal::RsaSsaPssParams& params) {
+  return New(private_key, params, /*num_key_replicas=*/1);
+}
+
+util::StatusOr<std::unique_ptr<PublicKeySign>> RsaSsaPssSignBoringSsl::New(
+    const internal::RsaPrivateKey& private_key,
+    const internal::RsaSsaPssParams& params, int num_key_replicas) {
   util::Status status =
       internal::CheckFipsCompatibility<RsaSsaPssSignBoringSsl>();
   if (!status.ok()) {
@@ -129,8 +136,8 @@ util::StatusOr<std::unique_ptr<PublicKeySign>> RsaSsaPssSignBoringSsl::New(
 
   // The RSA modulus and exponent are checked as part of the conversion to
   // internal::SslUniquePtr<RSA>.
-  util::StatusOr<internal::SslUniquePtr<RSA>> rsa =
-      internal::RsaPrivateKeyToRsa(private_key);
+  util::StatusOr<std::unique_ptr<internal::RsaKeyReplicas>> rsa =
+      internal::RsaKeyReplicas::New(private_key, num_key_replicas);
   if (!rsa.ok()) {
     return rsa.status();
   }
@@ -148,7 +155,7 @@ util::StatusOr<std::string> RsaSsaPssSignBoringSsl::Sign(
   }
 
   util::StatusOr<std::string> signature = SslRsaSsaPssSign(
-      private_key_.get(), *digest, sig_hash_, mgf1_hash_, salt_length_);
+      private_keys_->Get(), *digest, sig_hash_, mgf1_hash_, salt_length_);
   if (!signature.ok()) {
     return util::Status(absl::StatusCode::kInternal, "Signing failed.");
   }
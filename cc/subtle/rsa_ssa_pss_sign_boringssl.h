@@ -28,6 +28,7 @@
 #include "tink/internal/rsa_util.h"
 #include "tink/internal/ssl_unique_ptr.h"
 #include "tink/public_key_sign.h"
+#include "tink/signature/internal/rsa_key_replicas.h"
 #include "tink/subtle/common_enums.h"
 #include "tink/util/statusor.h"
 
@@ -44,6 +45,14 @@ class RsaSsaPssSignBoringSsl : public PublicKeySign {
       const crypto::tink::internal::RsaPrivateKey& private_key,
       const crypto::tink::internal::RsaSsaPssParams& params);
 
+  // Same as above, but the signer uses `num_key_replicas` independent RSA
+  // objects for the key in turn, so that concurrent calls to Sign() do not
+  // all contend on the blinding lock of a single RSA object.
+  static crypto::tink::util::StatusOr<std::unique_ptr<PublicKeySign>> New(
+      const crypto::tink::internal::RsaPrivateKey& private_key,
+      const crypto::tink::internal::RsaSsaPssParams& params,
+      int num_key_replicas);
+
   ~RsaSsaPssSignBoringSsl() override = default;
 
   crypto::tink::util::StatusOr<std::string> Sign(
@@ -53,15 +62,15 @@ class RsaSsaPssSignBoringSsl : public PublicKeySign {
       crypto::tink::internal::FipsCompatibility::kRequiresBoringCrypto;
 
  private:
-  RsaSsaPssSignBoringSsl(crypto::tink::internal::SslUniquePtr<RSA> private_key,
-                         const EVP_MD* sig_hash, const EVP_MD* mgf1_hash,
-                         int32_t salt_length)
-      : private_key_(std::move(private_key)),
+  RsaSsaPssSignBoringSsl(
+      std::unique_ptr<crypto::tink::internal::RsaKeyReplicas> private_keys,
+      const EVP_MD* sig_hash, const EVP_MD* mgf1_hash, int32_t salt_length)
+      : private_keys_(std::move(private_keys)),
         sig_hash_(sig_hash),
         mgf1_hash_(mgf1_hash),
         salt_length_(salt_length) {}
 
-  const crypto::tink::internal::SslUniquePtr<RSA> private_key_;
+  const std::unique_ptr<crypto::tink::internal::RsaKeyReplicas> private_keys_;
   // Pointers to singletons owned by OpenSSL/BoringSSL.
   const EVP_MD* sig_hash_;
   const EVP_MD* mgf1_hash_;
@@ -16,6 +16,11 @@
 
 #include "tink/subtle/rsa_ssa_pss_sign_boringssl.h"
 
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
@@ -25,7 +30,10 @@
 #include "tink/config/tink_fips.h"
 #include "tink/internal/rsa_util.h"
 #include "tink/internal/ssl_unique_ptr.h"
+#include "tink/public_key_sign.h"
+#include "tink/signature/internal/rsa_key_replicas.h"
 #include "tink/subtle/rsa_ssa_pss_verify_boringssl.h"
+#include "tink/util/statusor.h"
 #include "tink/util/test_matchers.h"
 
 namespace crypto {
@@ -76,6 +84,65 @@ TEST_F(RsaPssSignBoringsslTest, EncodesPss) {
               IsOk());
 }
 
+TEST_F(RsaPssSignBoringsslTest, SignsWithKeyReplicas) {
+  if (IsFipsModeEnabled()) {
+    GTEST_SKIP() << "Test not run in FIPS-only mode";
+  }
+
+  internal::RsaSsaPssParams params{/*sig_hash=*/HashType::SHA256,
+                                   /*mgf1_hash=*/HashType::SHA256,
+                                   /*salt_length=*/32};
+
+  util::StatusOr<std::unique_ptr<PublicKeySign>> signer =
+      RsaSsaPssSignBoringSsl::New(private_key_, params,
+          /*num_key_replicas=*/4);
+  ASSERT_THAT(signer, IsOk());
+  util::StatusOr<std::unique_ptr<RsaSsaPssVerifyBoringSsl>> verifier =
+      RsaSsaPssVerifyBoringSsl::New(public_key_, params);
+  ASSERT_THAT(verifier, IsOk());
+
+  constexpr int kNumThreads = 8;
+  constexpr int kSignaturesPerThread = 5;
+  std::vector<std::vector<std::string>> signatures(kNumThreads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([&, i]() {
+      for (int j = 0; j < kSignaturesPerThread; ++j) {
+        util::StatusOr<std::string> signature = (*signer)->Sign("testdata");
+        if (signature.ok()) signatures[i].push_back(*signature);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  for (const std::vector<std::string>& thread_signatures : signatures) {
+    ASSERT_EQ(thread_signatures.size(), kSignaturesPerThread);
+    for (const std::string& signature : thread_signatures) {
+      EXPECT_THAT((*verifier)->Verify(signature, "testdata"), IsOk());
+    }
+  }
+}
+
+TEST_F(RsaPssSignBoringsslTest, RejectsInvalidNumberOfKeyReplicas) {
+  if (IsFipsModeEnabled()) {
+    GTEST_SKIP() << "Test not run in FIPS-only mode";
+  }
+
+  internal::RsaSsaPssParams params{/*sig_hash=*/HashType::SHA256,
+                                   /*mgf1_hash=*/HashType::SHA256,
+                                   /*salt_length=*/32};
+
+  for (int num_key_replicas :
+       {-1, 0, internal::RsaKeyReplicas::kMaxReplicas + 1}) {
+    EXPECT_THAT(RsaSsaPssSignBoringSsl::New(private_key_, params,
+                                            num_key_replicas)
+                    .status(),
+                StatusIs(absl::StatusCode::kInvalidArgument));
+  }
+}
+
 TEST_F(RsaPssSignBoringsslTest, EncodesPssWithSeparateHashes) {
   if (IsFipsModeEnabled()) {
     GTEST_SKIP() << "Test not run in FIPS-only mode";
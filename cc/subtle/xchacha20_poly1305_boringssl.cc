@@ -104,6 +104,24 @@ util::StatusOr<std::string> XChacha20Poly1305BoringSsl::Decrypt(
   return plaintext;
 }
 
+bool XChacha20Poly1305BoringSsl::TryDecrypt(absl::string_view ciphertext,
+                                            absl::string_view associated_data,
+                                            std::string* plaintext) const {
+  if (ciphertext.size() < kNonceSizeInBytes + kTagSizeInBytes) {
+    return false;
+  }
+  ResizeStringUninitialized(
+      plaintext, aead_->PlaintextSize(ciphertext.size() - kNonceSizeInBytes));
+  int64_t written_bytes = 0;
+  if (!aead_->TryDecrypt(ciphertext.substr(kNonceSizeInBytes), associated_data,
+                         ciphertext.substr(0, kNonceSizeInBytes),
+                         absl::MakeSpan(*plaintext), &written_bytes)) {
+    return false;
+  }
+  plaintext->resize(written_bytes);
+  return true;
+}
+
 }  // namespace subtle
 }  // namespace tink
 }  // namespace crypto
@@ -25,6 +25,7 @@
 #include "tink/aead.h"
 #include "tink/aead/internal/ssl_aead.h"
 #include "tink/internal/fips_utils.h"
+#include "tink/internal/trial_decryption.h"
 #include "tink/util/secret_data.h"
 #include "tink/util/status.h"
 #include "tink/util/statusor.h"
@@ -33,7 +34,8 @@ namespace crypto {
 namespace tink {
 namespace subtle {
 
-class XChacha20Poly1305BoringSsl : public Aead {
+class XChacha20Poly1305BoringSsl : public Aead,
+                                   public internal::TrialDecryptionAead {
  public:
   // Constructs a new Aead cipher for XChacha20-Poly1305.
   // Currently supported key size is 256 bits.
@@ -50,6 +52,10 @@ class XChacha20Poly1305BoringSsl : public Aead {
       absl::string_view ciphertext,
       absl::string_view associated_data) const override;
 
+  bool TryDecrypt(absl::string_view ciphertext,
+                  absl::string_view associated_data,
+                  std::string* plaintext) const override;
+
   static constexpr crypto::tink::internal::FipsCompatibility kFipsStatus =
       crypto::tink::internal::FipsCompatibility::kNotFips;
 